@@ -20,6 +20,8 @@ void AudioAnalyzer::processAudioBlock(const float** inputChannelData,
     
     if (numChannels == 0 || numSamples == 0)
         return;
+
+    auto startTicks = juce::Time::getHighResolutionTicks();
     
     // Mix down to mono if multiple channels
     for (int i = 0; i < numSamples && i < FFT_SIZE; ++i)
@@ -62,6 +64,9 @@ void AudioAnalyzer::processAudioBlock(const float** inputChannelData,
     
     // Update beat detection
     updateBeatDetection();
+
+    lastProcessingMs = juce::Time::highResolutionTicksToSeconds(
+        juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
 }
 
 void AudioAnalyzer::calculateFrequencyBands()
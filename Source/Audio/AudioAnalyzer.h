@@ -60,6 +60,12 @@ public:
     };
     Beat detectBeat() const;
 
+    /**
+     * @brief Time spent in the most recent processAudioBlock() call
+     * @return Milliseconds (safe to read from any thread)
+     */
+    double getLastProcessingTimeMs() const { return lastProcessingMs.load(); }
+
 private:
     //==========================================================================
     static constexpr int FFT_ORDER = 10;  // 2^10 = 1024 samples
@@ -98,4 +104,5 @@ private:
     void updateBeatDetection();
     
     juce::CriticalSection lock;
+    std::atomic<double> lastProcessingMs {0.0};
 };
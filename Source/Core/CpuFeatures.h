@@ -0,0 +1,64 @@
+#pragma once
+
+/**
+ * @file CpuFeatures.h
+ * @brief Runtime CPU feature checks for hand-written SIMD kernels
+ *
+ * Builds target the baseline instruction set, so AVX2 kernels are compiled
+ * per function with FLARKVIZ_TARGET_AVX2 and only called when
+ * CpuFeatures::hasAVX2() says the machine can run them. Translation units
+ * guard their kernels with FLARKVIZ_AVX2_DISPATCH, which is 0 where the
+ * compiler can't emit AVX2 (non-x86 targets).
+ */
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+ #define FLARKVIZ_AVX2_DISPATCH 1
+ #define FLARKVIZ_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+ #define FLARKVIZ_AVX2_DISPATCH 1
+ #define FLARKVIZ_TARGET_AVX2
+#else
+ #define FLARKVIZ_AVX2_DISPATCH 0
+ #define FLARKVIZ_TARGET_AVX2
+#endif
+
+#if FLARKVIZ_AVX2_DISPATCH
+ #include <immintrin.h>
+ #if defined(_MSC_VER)
+  #include <intrin.h>
+ #endif
+#endif
+
+namespace CpuFeatures
+{
+    /**
+     * @brief Whether this CPU and OS can run AVX2 code (checked once)
+     */
+    inline bool hasAVX2()
+    {
+       #if !FLARKVIZ_AVX2_DISPATCH
+        return false;
+       #elif defined(_MSC_VER)
+        static const bool supported = []
+        {
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] < 7)
+                return false;
+
+            // AVX needs OSXSAVE and the OS saving the YMM registers
+            __cpuid(info, 1);
+            if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0
+                || (_xgetbv(0) & 6) != 6)
+                return false;
+
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+        }();
+        return supported;
+       #else
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+       #endif
+    }
+}
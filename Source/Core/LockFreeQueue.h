@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+/**
+ * @class LockFreeQueue
+ * @brief Bounded multi-producer/multi-consumer queue without locks
+ *
+ * Dmitry Vyukov's bounded MPMC design: each cell carries a sequence number
+ * that tells producers and consumers whether it is free or full for the
+ * current lap, so push and pop are a single CAS on the shared position in
+ * the common case. Neither side ever blocks; tryPush() fails when full and
+ * tryPop() fails when empty, leaving the waiting policy to the caller.
+ *
+ * Capacity is rounded up to a power of two.
+ */
+template <typename T>
+class LockFreeQueue
+{
+public:
+    explicit LockFreeQueue(size_t requestedCapacity)
+    {
+        size_t capacity = 2;
+        while (capacity < requestedCapacity)
+            capacity <<= 1;
+
+        mask = capacity - 1;
+        cells = std::make_unique<Cell[]>(capacity);
+
+        for (size_t i = 0; i < capacity; ++i)
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    bool tryPush(T value)
+    {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            Cell& cell = cells[pos & mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+
+            if (diff == 0)
+            {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    cell.data = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;  // Full
+            }
+            else
+            {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool tryPop(T& result)
+    {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            Cell& cell = cells[pos & mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+
+            if (diff == 0)
+            {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    result = std::move(cell.data);
+                    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;  // Empty
+            }
+            else
+            {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    size_t getCapacity() const { return mask + 1; }
+
+    /**
+     * @brief Number of queued items (approximate while other threads are active)
+     */
+    size_t getApproximateSize() const
+    {
+        size_t tail = enqueuePos.load(std::memory_order_relaxed);
+        size_t head = dequeuePos.load(std::memory_order_relaxed);
+        return tail >= head ? tail - head : 0;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence {0};
+        T data {};
+    };
+
+    static constexpr size_t cacheLineSize = 64;
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask = 0;
+
+    // Producers and consumers touch different cache lines
+    alignas(cacheLineSize) std::atomic<size_t> enqueuePos {0};
+    alignas(cacheLineSize) std::atomic<size_t> dequeuePos {0};
+
+    LockFreeQueue(const LockFreeQueue&) = delete;
+    LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+};
@@ -0,0 +1,353 @@
+#include "SharedFrameRing.h"
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+ #define FLARKVIZ_HAS_POSIX_SHM 1
+ #include <cerrno>
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <time.h>
+ #include <unistd.h>
+#else
+ #define FLARKVIZ_HAS_POSIX_SHM 0
+#endif
+
+#if defined(__linux__)
+ #include <linux/futex.h>
+ #include <sys/syscall.h>
+#endif
+
+static_assert(sizeof(SharedFrameRing::SlotHeader) <= SharedFrameRing::slotHeaderSize,
+              "SlotHeader must fit in front of the pixels");
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "Shared-memory atomics must be lock-free to work across processes");
+
+namespace
+{
+    std::string toShmName(const std::string& name)
+    {
+        return name.empty() || name[0] != '/' ? "/" + name : name;
+    }
+
+    size_t roundUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+#if FLARKVIZ_HAS_POSIX_SHM
+    std::string describeErrno(const char* what)
+    {
+        return std::string(what) + ": " + std::strerror(errno);
+    }
+
+    /** Tell consumers of a ring left behind (restart, resize, crash) that it is gone */
+    void retireExisting(const std::string& shmName)
+    {
+        int fd = shm_open(shmName.c_str(), O_RDWR, 0);
+        if (fd < 0)
+            return;
+
+        struct stat info {};
+        if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(SharedFrameRing::Header))
+        {
+            void* mapping = mmap(nullptr, sizeof(SharedFrameRing::Header), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (mapping != MAP_FAILED)
+            {
+                auto* header = static_cast<SharedFrameRing::Header*>(mapping);
+                if (header->magic == SharedFrameRing::magicValue)
+                {
+                    header->closed.store(1, std::memory_order_release);
+                    header->notifyCounter.fetch_add(1, std::memory_order_release);
+#if defined(__linux__)
+                    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&header->notifyCounter), FUTEX_WAKE, INT_MAX,
+                            nullptr, nullptr, 0);
+#endif
+                }
+                munmap(mapping, sizeof(SharedFrameRing::Header));
+            }
+        }
+
+        close(fd);
+        shm_unlink(shmName.c_str());
+    }
+#endif
+}
+
+//==============================================================================
+SharedFrameRing::SharedFrameRing(const std::string& ringName, void* ringMapping, size_t size, bool publisher)
+    : name(ringName)
+    , mapping(ringMapping)
+    , mappingSize(size)
+    , isPublisher(publisher)
+    , header(static_cast<Header*>(ringMapping))
+{
+    nextWriteSequence = header->latestSequence.load(std::memory_order_relaxed);
+}
+
+SharedFrameRing::~SharedFrameRing()
+{
+#if FLARKVIZ_HAS_POSIX_SHM
+    if (isPublisher)
+    {
+        header->closed.store(1, std::memory_order_release);
+        wakeConsumers();
+        shm_unlink(toShmName(name).c_str());
+    }
+
+    munmap(mapping, mappingSize);
+#endif
+}
+
+std::unique_ptr<SharedFrameRing> SharedFrameRing::create(const std::string& name, size_t slotCapacity,
+                                                         int numSlots, std::string& error)
+{
+#if FLARKVIZ_HAS_POSIX_SHM
+    if (numSlots < 2 || slotCapacity == 0)
+    {
+        error = "A ring needs at least two non-empty slots";
+        return nullptr;
+    }
+
+    const auto shmName = toShmName(name);
+    retireExisting(shmName);
+
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t dataOffset = roundUp(sizeof(Header), 64);
+    const size_t slotStride = roundUp(slotHeaderSize + slotCapacity, pageSize);
+    const size_t totalSize = roundUp(dataOffset, pageSize) + slotStride * static_cast<size_t>(numSlots);
+
+    int fd = shm_open(shmName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+    {
+        error = describeErrno(("shm_open " + shmName).c_str());
+        return nullptr;
+    }
+
+    if (ftruncate(fd, static_cast<off_t>(totalSize)) != 0)
+    {
+        error = describeErrno("ftruncate");
+        close(fd);
+        shm_unlink(shmName.c_str());
+        return nullptr;
+    }
+
+    void* mapping = mmap(nullptr, totalSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (mapping == MAP_FAILED)
+    {
+        error = describeErrno("mmap");
+        shm_unlink(shmName.c_str());
+        return nullptr;
+    }
+
+    // ftruncate zero-fills, so every atomic starts at 0; magic goes last
+    auto* header = static_cast<Header*>(mapping);
+    header->version = versionValue;
+    header->numSlots = static_cast<uint32_t>(numSlots);
+    header->headerSize = sizeof(Header);
+    header->slotCapacity = slotCapacity;
+    header->slotStride = slotStride;
+    header->dataOffset = roundUp(dataOffset, pageSize);
+    header->publisherPid = static_cast<int64_t>(getpid());
+
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = magicValue;
+
+    return std::unique_ptr<SharedFrameRing>(new SharedFrameRing(name, mapping, totalSize, true));
+#else
+    (void) name; (void) slotCapacity; (void) numSlots;
+    error = "Shared-memory output is not supported on this platform";
+    return nullptr;
+#endif
+}
+
+std::unique_ptr<SharedFrameRing> SharedFrameRing::open(const std::string& name, std::string& error)
+{
+#if FLARKVIZ_HAS_POSIX_SHM
+    const auto shmName = toShmName(name);
+
+    int fd = shm_open(shmName.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+    {
+        error = describeErrno(("shm_open " + shmName).c_str());
+        return nullptr;
+    }
+
+    struct stat info {};
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(Header))
+    {
+        error = shmName + " is not a FlarkViz frame ring (too small)";
+        close(fd);
+        return nullptr;
+    }
+
+    // Read-only: a consumer can never corrupt the ring for others
+    const auto size = static_cast<size_t>(info.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (mapping == MAP_FAILED)
+    {
+        error = describeErrno("mmap");
+        return nullptr;
+    }
+
+    auto* header = static_cast<const Header*>(mapping);
+    const bool hasMagic = header->magic == magicValue;
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    if (!hasMagic || header->version != versionValue
+        || header->dataOffset + header->slotStride * header->numSlots > size)
+    {
+        error = shmName + " is not a compatible FlarkViz frame ring";
+        munmap(mapping, size);
+        return nullptr;
+    }
+
+    return std::unique_ptr<SharedFrameRing>(new SharedFrameRing(name, mapping, size, false));
+#else
+    (void) name;
+    error = "Shared-memory output is not supported on this platform";
+    return nullptr;
+#endif
+}
+
+//==============================================================================
+SharedFrameRing::SlotHeader& SharedFrameRing::getSlot(uint64_t index) const
+{
+    auto* base = static_cast<uint8_t*>(mapping) + header->dataOffset;
+    return *reinterpret_cast<SlotHeader*>(base + (index % header->numSlots) * header->slotStride);
+}
+
+uint8_t* SharedFrameRing::beginWrite()
+{
+    auto& slot = getSlot(nextWriteSequence);
+
+    // Readers that see 0 (or a changed value afterwards) discard what they read
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    return reinterpret_cast<uint8_t*>(&slot) + slotHeaderSize;
+}
+
+void SharedFrameRing::commitWrite(int64_t frameNumber, double timeSeconds, int width, int height,
+                                  int stride, uint32_t format)
+{
+    auto& slot = getSlot(nextWriteSequence);
+    const uint64_t sequence = ++nextWriteSequence;
+
+    slot.timestampNs = getMonotonicNanos();
+    slot.timeSeconds = timeSeconds;
+    slot.frameNumber = frameNumber;
+    slot.width = static_cast<uint32_t>(width);
+    slot.height = static_cast<uint32_t>(height);
+    slot.stride = static_cast<uint32_t>(stride);
+    slot.format = format;
+    slot.size = static_cast<uint64_t>(stride) * static_cast<uint64_t>(height);
+
+    slot.sequence.store(sequence, std::memory_order_release);
+    header->latestSequence.store(sequence, std::memory_order_release);
+    wakeConsumers();
+}
+
+void SharedFrameRing::wakeConsumers()
+{
+    header->notifyCounter.fetch_add(1, std::memory_order_release);
+
+#if defined(__linux__)
+    // Not FUTEX_PRIVATE: waiters live in other processes
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&header->notifyCounter), FUTEX_WAKE, INT_MAX,
+            nullptr, nullptr, 0);
+#endif
+}
+
+//==============================================================================
+bool SharedFrameRing::acquireLatest(FrameView& view) const
+{
+    for (;;)
+    {
+        const uint64_t latest = header->latestSequence.load(std::memory_order_acquire);
+        if (latest == 0)
+            return false;
+
+        auto& slot = getSlot(latest - 1);
+        const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+
+        // Overwritten between the two loads; a newer frame is there by now
+        if (sequence != latest)
+            continue;
+
+        view.pixels = reinterpret_cast<const uint8_t*>(&slot) + slotHeaderSize;
+        view.width = static_cast<int>(slot.width);
+        view.height = static_cast<int>(slot.height);
+        view.stride = static_cast<int>(slot.stride);
+        view.format = slot.format;
+        view.sequence = sequence;
+        view.frameNumber = slot.frameNumber;
+        view.timestampNs = slot.timestampNs;
+        view.timeSeconds = slot.timeSeconds;
+        view.slot = &slot;
+
+        if (isStillValid(view))
+            return true;
+    }
+}
+
+bool SharedFrameRing::isStillValid(const FrameView& view) const
+{
+    if (view.slot == nullptr)
+        return false;
+
+    // Keep the pixel reads above from moving past the check
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return view.slot->sequence.load(std::memory_order_relaxed) == view.sequence;
+}
+
+bool SharedFrameRing::waitForFrame(uint64_t lastSequence, int timeoutMs) const
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+
+    for (;;)
+    {
+        const uint32_t counter = header->notifyCounter.load(std::memory_order_acquire);
+
+        if (isClosed())
+            return false;
+        if (header->latestSequence.load(std::memory_order_acquire) > lastSequence)
+            return true;
+
+        auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - std::chrono::steady_clock::now());
+        if (timeoutMs >= 0 && remaining.count() <= 0)
+            return false;
+
+#if defined(__linux__)
+        // Sleeps only if nothing was published since `counter` was read
+        struct timespec timeout {};
+        timeout.tv_sec = static_cast<time_t>(remaining.count() / 1000000000);
+        timeout.tv_nsec = static_cast<long>(remaining.count() % 1000000000);
+
+        syscall(SYS_futex, reinterpret_cast<const uint32_t*>(&header->notifyCounter), FUTEX_WAIT, counter,
+                timeoutMs >= 0 ? &timeout : nullptr, nullptr, 0);
+#else
+        (void) counter;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+#endif
+    }
+}
+
+uint64_t SharedFrameRing::getMonotonicNanos()
+{
+#if FLARKVIZ_HAS_POSIX_SHM
+    struct timespec now {};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000ull + static_cast<uint64_t>(now.tv_nsec);
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
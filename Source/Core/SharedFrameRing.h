@@ -0,0 +1,153 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/**
+ * @class SharedFrameRing
+ * @brief Ring of video frames in POSIX shared memory for other local processes
+ *
+ * One publisher creates the ring under a name ("/flarkviz" by default);
+ * any number of consumers open it read-only and read pixels straight out
+ * of the mapping, without copies or sockets. The layout is plain C structs
+ * (see Header and SlotHeader) so consumers in other languages can read it
+ * too; the reference consumer is Source/Tools/ShmConsumerMain.cpp.
+ *
+ * Each slot is a seqlock: the publisher zeroes the slot's sequence before
+ * writing and sets it to the commit number when done, so a consumer
+ * checks isStillValid() after reading to know the frame was not
+ * overwritten meanwhile. Consumers never block the publisher; a slow
+ * consumer just skips frames.
+ *
+ * Publishing bumps a 32-bit counter in the header and wakes waiters with a
+ * futex on Linux (elsewhere waitForFrame() polls). A named segment is used
+ * rather than a memfd so consumers can attach by name without passing file
+ * descriptors over a socket.
+ */
+class SharedFrameRing
+{
+public:
+    static constexpr uint32_t magicValue = 0x525A5646;  // "FVZR"
+    static constexpr uint32_t versionValue = 1;
+
+    enum Format : uint32_t
+    {
+        RGBA8 = 1   // Tightly packed, top row first
+    };
+
+    /** At offset 0 of the segment */
+    struct alignas(64) Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t numSlots;
+        uint32_t headerSize;            // sizeof(Header)
+        uint64_t slotCapacity;          // Pixel bytes per slot
+        uint64_t slotStride;            // Distance between slots, including SlotHeader
+        uint64_t dataOffset;            // First SlotHeader
+        int64_t publisherPid;
+
+        std::atomic<uint64_t> latestSequence;   // Commits so far; slot = (latest - 1) % numSlots
+        std::atomic<uint32_t> notifyCounter;    // Futex word, bumped on every commit
+        std::atomic<uint32_t> closed;           // Non-zero once the publisher has gone
+    };
+
+    /** At the start of each slot; pixels follow at slotHeaderSize */
+    struct alignas(64) SlotHeader
+    {
+        std::atomic<uint64_t> sequence;  // Commit number (1, 2, ...) when complete, 0 while being written
+        uint64_t timestampNs;            // CLOCK_MONOTONIC at commit
+        double timeSeconds;              // Preset time the frame was rendered for
+        int64_t frameNumber;             // Publisher's own frame count (gaps = frames it dropped)
+        uint32_t width;
+        uint32_t height;
+        uint32_t stride;
+        uint32_t format;
+        uint64_t size;
+    };
+
+    static constexpr size_t slotHeaderSize = 64;
+
+    /** A frame in the mapping; valid until the publisher laps the ring */
+    struct FrameView
+    {
+        const uint8_t* pixels = nullptr;
+        int width = 0;
+        int height = 0;
+        int stride = 0;
+        uint32_t format = 0;
+        uint64_t sequence = 0;
+        int64_t frameNumber = 0;
+        uint64_t timestampNs = 0;
+        double timeSeconds = 0.0;
+        const SlotHeader* slot = nullptr;
+    };
+
+    ~SharedFrameRing();
+
+    /**
+     * @brief Create (or replace) a ring as the publisher
+     * @param slotCapacity Largest frame in bytes
+     * @return nullptr on failure, with the reason in error
+     */
+    static std::unique_ptr<SharedFrameRing> create(const std::string& name, size_t slotCapacity,
+                                                   int numSlots, std::string& error);
+
+    /**
+     * @brief Attach to an existing ring as a read-only consumer
+     */
+    static std::unique_ptr<SharedFrameRing> open(const std::string& name, std::string& error);
+
+    //==========================================================================
+    // Publisher
+
+    /** Pixels of the slot the next frame goes into; marks the slot busy */
+    uint8_t* beginWrite();
+
+    /** Publish the slot returned by beginWrite() and wake consumers */
+    void commitWrite(int64_t frameNumber, double timeSeconds, int width, int height, int stride, uint32_t format);
+
+    size_t getSlotCapacity() const { return static_cast<size_t>(header->slotCapacity); }
+
+    //==========================================================================
+    // Consumer
+
+    /** Most recent complete frame; false if none has been published */
+    bool acquireLatest(FrameView& view) const;
+
+    /** True if the frame was not overwritten while it was being read */
+    bool isStillValid(const FrameView& view) const;
+
+    /**
+     * @brief Wait until a commit newer than lastSequence (a FrameView::sequence) is published
+     * @param timeoutMs -1 waits forever
+     * @return false on timeout or when the publisher closed the ring
+     */
+    bool waitForFrame(uint64_t lastSequence, int timeoutMs) const;
+
+    bool isClosed() const { return header->closed.load(std::memory_order_acquire) != 0; }
+    int getNumSlots() const { return static_cast<int>(header->numSlots); }
+    const std::string& getName() const { return name; }
+
+    /** CLOCK_MONOTONIC, comparable with SlotHeader::timestampNs across processes */
+    static uint64_t getMonotonicNanos();
+
+private:
+    SharedFrameRing(const std::string& name, void* mapping, size_t mappingSize, bool isPublisher);
+
+    SlotHeader& getSlot(uint64_t index) const;
+    void wakeConsumers();
+
+    std::string name;
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+    bool isPublisher = false;
+    Header* header = nullptr;
+    uint64_t nextWriteSequence = 0;
+
+    SharedFrameRing(const SharedFrameRing&) = delete;
+    SharedFrameRing& operator=(const SharedFrameRing&) = delete;
+};
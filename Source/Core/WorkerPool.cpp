@@ -0,0 +1,128 @@
+#include "WorkerPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+WorkerPool::WorkerPool(int numThreads)
+{
+    if (numThreads <= 0)
+        numThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+
+    threads.reserve(static_cast<size_t>(numThreads));
+    for (int i = 0; i < numThreads; ++i)
+        threads.emplace_back([this] { workerLoop(); });
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        shuttingDown = true;
+    }
+    taskAvailable.notify_all();
+
+    for (auto& t : threads)
+        t.join();
+}
+
+void WorkerPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    taskAvailable.notify_one();
+}
+
+void WorkerPool::workerLoop()
+{
+    for (;;)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            taskAvailable.wait(lock, [this] { return shuttingDown || !tasks.empty(); });
+
+            // Drain what is queued before exiting so no caller waits forever
+            if (tasks.empty())
+                return;
+
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+bool WorkerPool::runOneTask()
+{
+    std::function<void()> task;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tasks.empty())
+            return false;
+
+        task = std::move(tasks.front());
+        tasks.pop_front();
+    }
+    task();
+    return true;
+}
+
+void WorkerPool::parallelFor(int numTasks, const std::function<void(int)>& body)
+{
+    if (numTasks <= 0)
+        return;
+
+    if (numTasks == 1)
+    {
+        body(0);
+        return;
+    }
+
+    // Indices are claimed from a shared counter, so whichever threads get
+    // there first share the work; helpers that arrive late find nothing left.
+    struct Batch
+    {
+        std::atomic<int> next {0};
+        std::atomic<int> remaining {0};
+        std::mutex doneMutex;
+        std::condition_variable done;
+    };
+
+    auto batch = std::make_shared<Batch>();
+    batch->remaining = numTasks;
+
+    auto drain = [batch, numTasks, &body]
+    {
+        for (int i = batch->next.fetch_add(1); i < numTasks; i = batch->next.fetch_add(1))
+        {
+            body(i);
+
+            if (batch->remaining.fetch_sub(1) == 1)
+            {
+                std::lock_guard<std::mutex> lock(batch->doneMutex);
+                batch->done.notify_all();
+            }
+        }
+    };
+
+    int helpers = std::min(numTasks - 1, getNumThreads());
+    for (int i = 0; i < helpers; ++i)
+        submit(drain);
+
+    drain();
+
+    // While others finish, help with whatever else is queued (nested
+    // parallelFor calls from workers rely on this to make progress)
+    while (batch->remaining.load() > 0)
+    {
+        if (runOneTask())
+            continue;
+
+        std::unique_lock<std::mutex> lock(batch->doneMutex);
+        batch->done.wait_for(lock, std::chrono::milliseconds(1),
+                             [&] { return batch->remaining.load() == 0; });
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class WorkerPool
+ * @brief Fixed set of threads running short CPU-bound tasks
+ *
+ * Meant for data-parallel work such as converting or encoding a frame in
+ * bands. parallelFor() lets the calling thread take tasks too, so a pool
+ * of N threads gives N + 1 way parallelism and never deadlocks when
+ * called from inside a task.
+ */
+class WorkerPool
+{
+public:
+    /**
+     * @param numThreads Worker count; <= 0 uses hardware concurrency - 1
+     */
+    explicit WorkerPool(int numThreads = 0);
+    ~WorkerPool();
+
+    /**
+     * @brief Queue a task; runs on some worker at some point
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Run body(0) ... body(numTasks - 1) and return when all finished
+     *
+     * Tasks may run in any order and on any thread, including the caller's.
+     */
+    void parallelFor(int numTasks, const std::function<void(int)>& body);
+
+    int getNumThreads() const { return static_cast<int>(threads.size()); }
+
+private:
+    void workerLoop();
+    bool runOneTask();
+
+    std::vector<std::thread> threads;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable taskAvailable;
+    bool shuttingDown = false;
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+};
@@ -191,6 +191,7 @@ public:
     double warp = 1.0;
     double sx = 1.0;
     double sy = 1.0;
+    double decay = 0.98;
 
     // Wave colors
     double wave_r = 1.0;
@@ -234,6 +235,7 @@ public:
         if (name == "warp") return warp;
         if (name == "sx") return sx;
         if (name == "sy") return sy;
+        if (name == "decay") return decay;
         if (name == "wave_r") return wave_r;
         if (name == "wave_g") return wave_g;
         if (name == "wave_b") return wave_b;
@@ -280,6 +282,7 @@ public:
         if (name == "warp") { warp = value; return; }
         if (name == "sx") { sx = value; return; }
         if (name == "sy") { sy = value; return; }
+        if (name == "decay") { decay = value; return; }
         if (name == "wave_r") { wave_r = value; return; }
         if (name == "wave_g") { wave_g = value; return; }
         if (name == "wave_b") { wave_b = value; return; }
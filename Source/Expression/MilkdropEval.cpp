@@ -22,6 +22,20 @@ void MilkdropEval::clear()
     lastError.clear();
 }
 
+size_t MilkdropEval::getMemorySize() const
+{
+    size_t bytes = sizeof(*this)
+                 + compiled.bytecode.capacity() * sizeof(MilkDrop::Instruction)
+                 + compiled.variableNames.capacity() * sizeof(std::string)
+                 + stack.capacity() * sizeof(double)
+                 + tokens.capacity() * sizeof(MilkDrop::Token);
+
+    for (const auto& name : compiled.variableNames)
+        bytes += name.capacity();
+
+    return bytes;
+}
+
 // ============================================================================
 // LEXER
 // ============================================================================
@@ -49,6 +49,16 @@ public:
      */
     void clear();
 
+    /**
+     * @brief Approximate heap and object size of the compiled code
+     */
+    size_t getMemorySize() const;
+
+    /**
+     * @brief Number of bytecode instructions compiled
+     */
+    size_t getInstructionCount() const { return compiled.bytecode.size(); }
+
 private:
     MilkDrop::CompiledExpression compiled;
     std::string lastError;
@@ -0,0 +1,247 @@
+#include "AudioFeatureSource.h"
+
+std::unique_ptr<AudioFeatureSource> AudioFeatureSource::createForFile(const juce::File& file,
+                                                                      juce::String& error,
+                                                                      juce::Range<double> neededSeconds)
+{
+    if (!file.existsAsFile())
+    {
+        error = "File does not exist: " + file.getFullPathName();
+        return nullptr;
+    }
+
+    if (file.hasFileExtension(".csv"))
+    {
+        auto track = std::make_unique<FeatureTrackSource>();
+        if (!track->load(file, error))
+            return nullptr;
+        return track;
+    }
+
+    auto audio = std::make_unique<AudioFileFeatureSource>();
+    if (!audio->load(file, error, neededSeconds))
+        return nullptr;
+    return audio;
+}
+
+double AudioFeatureSource::getLengthOfFile(const juce::File& file, juce::String& error)
+{
+    if (file.hasFileExtension(".csv") || !file.existsAsFile())
+    {
+        auto source = createForFile(file, error);
+        return source != nullptr ? source->getLengthSeconds() : -1.0;
+    }
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+    if (reader == nullptr || reader->sampleRate <= 0.0)
+    {
+        error = "Unsupported audio file: " + file.getFileName();
+        return -1.0;
+    }
+
+    return static_cast<double>(reader->lengthInSamples) / reader->sampleRate;
+}
+
+//==============================================================================
+bool AudioFileFeatureSource::load(const juce::File& file, juce::String& error,
+                                  juce::Range<double> neededSeconds)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+    if (reader == nullptr)
+    {
+        error = "Unsupported audio file: " + file.getFileName();
+        return false;
+    }
+
+    if (reader->lengthInSamples <= 0 || reader->numChannels == 0)
+    {
+        error = "Audio file is empty: " + file.getFileName();
+        return false;
+    }
+
+    // Decode up front; rendering then never waits on disk
+    sampleRate = reader->sampleRate;
+    totalSamples = reader->lengthInSamples;
+    bufferStart = 0;
+    juce::int64 bufferEnd = totalSamples;
+
+    if (!neededSeconds.isEmpty())
+    {
+        // The first needed frame analyses the window that ends at its time
+        bufferStart = juce::jlimit<juce::int64>(0, totalSamples,
+            static_cast<juce::int64>(neededSeconds.getStart() * sampleRate) - windowSize);
+        bufferEnd = juce::jlimit<juce::int64>(bufferStart, totalSamples,
+            static_cast<juce::int64>(neededSeconds.getEnd() * sampleRate) + 1);
+    }
+
+    buffer.setSize(static_cast<int>(reader->numChannels),
+                   static_cast<int>(bufferEnd - bufferStart));
+    reader->read(&buffer, 0, buffer.getNumSamples(), bufferStart, true, true);
+
+    DBG("FlarkViz: Loaded " << file.getFileName() << " ("
+        << juce::String(getLengthSeconds(), 1) << "s, " << buffer.getNumChannels()
+        << " ch, " << sampleRate << " Hz)");
+    return true;
+}
+
+AudioFeatureSource::Features AudioFileFeatureSource::getFeaturesAt(double timeSeconds)
+{
+    // Analyse the window that ends at this frame, zero-padded at the start
+    // of the file (buffer positions are relative to bufferStart)
+    int end = static_cast<int>(juce::jlimit<juce::int64>(0, buffer.getNumSamples(),
+                                   static_cast<juce::int64>(timeSeconds * sampleRate) - bufferStart));
+    int start = end - windowSize;
+
+    const int numChannels = buffer.getNumChannels();
+    std::vector<const float*> channels(static_cast<size_t>(numChannels));
+    juce::AudioBuffer<float> padded;
+
+    if (start >= 0)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            channels[static_cast<size_t>(ch)] = buffer.getReadPointer(ch, start);
+    }
+    else
+    {
+        padded.setSize(numChannels, windowSize);
+        padded.clear();
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            if (end > 0)
+                padded.copyFrom(ch, -start, buffer, ch, 0, end);
+            channels[static_cast<size_t>(ch)] = padded.getReadPointer(ch);
+        }
+    }
+
+    analyzer.processAudioBlock(channels.data(), numChannels, windowSize);
+
+    Features f;
+    f.bass = analyzer.getBass();
+    f.mid = analyzer.getMid();
+    f.treb = analyzer.getTreb();
+    f.bassAtt = analyzer.getBassAtt();
+    f.midAtt = analyzer.getMidAtt();
+    f.trebAtt = analyzer.getTrebAtt();
+    return f;
+}
+
+double AudioFileFeatureSource::getLengthSeconds() const
+{
+    return sampleRate > 0.0 ? static_cast<double>(totalSamples) / sampleRate : 0.0;
+}
+
+//==============================================================================
+bool FeatureTrackSource::load(const juce::File& file, juce::String& error)
+{
+    juce::StringArray lines;
+    file.readLines(lines);
+
+    rows.clear();
+    hasAttenuated = true;
+
+    for (int i = 0; i < lines.size(); ++i)
+    {
+        auto line = lines[i].trim();
+        if (line.isEmpty() || line.startsWithChar('#'))
+            continue;
+
+        juce::StringArray fields;
+        fields.addTokens(line, ",", "\"");
+        fields.trim();
+
+        // Header row (or anything else non-numeric in the time column)
+        if (!fields[0].containsOnly("0123456789.-+eE"))
+            continue;
+
+        if (fields.size() < 4)
+        {
+            error = "Feature track line " + juce::String(i + 1) + ": expected time,bass,mid,treb";
+            return false;
+        }
+
+        Row row;
+        row.time = fields[0].getDoubleValue();
+        row.features.bass = fields[1].getFloatValue();
+        row.features.mid = fields[2].getFloatValue();
+        row.features.treb = fields[3].getFloatValue();
+
+        if (fields.size() >= 7)
+        {
+            row.features.bassAtt = fields[4].getFloatValue();
+            row.features.midAtt = fields[5].getFloatValue();
+            row.features.trebAtt = fields[6].getFloatValue();
+        }
+        else
+        {
+            hasAttenuated = false;
+        }
+
+        if (!rows.empty() && row.time <= rows.back().time)
+        {
+            error = "Feature track line " + juce::String(i + 1) + ": times must increase";
+            return false;
+        }
+
+        rows.push_back(row);
+    }
+
+    if (rows.empty())
+    {
+        error = "Feature track has no rows: " + file.getFileName();
+        return false;
+    }
+
+    cursor = 0;
+    smoothed = {};
+    return true;
+}
+
+AudioFeatureSource::Features FeatureTrackSource::getFeaturesAt(double timeSeconds)
+{
+    // Times only move forward, so the search resumes where it left off
+    while (cursor + 1 < rows.size() && rows[cursor + 1].time <= timeSeconds)
+        ++cursor;
+
+    const auto& a = rows[cursor];
+    Features f = a.features;
+
+    if (cursor + 1 < rows.size() && timeSeconds > a.time)
+    {
+        const auto& b = rows[cursor + 1];
+        float t = static_cast<float>((timeSeconds - a.time) / (b.time - a.time));
+
+        auto lerp = [t](float x, float y) { return x + (y - x) * t; };
+        f.bass = lerp(a.features.bass, b.features.bass);
+        f.mid = lerp(a.features.mid, b.features.mid);
+        f.treb = lerp(a.features.treb, b.features.treb);
+        f.bassAtt = lerp(a.features.bassAtt, b.features.bassAtt);
+        f.midAtt = lerp(a.features.midAtt, b.features.midAtt);
+        f.trebAtt = lerp(a.features.trebAtt, b.features.trebAtt);
+    }
+
+    if (!hasAttenuated)
+    {
+        // Same damping as AudioAnalyzer::calculateFrequencyBands()
+        smoothed.bassAtt = smoothed.bassAtt * 0.95f + f.bass * 0.05f;
+        smoothed.midAtt = smoothed.midAtt * 0.95f + f.mid * 0.05f;
+        smoothed.trebAtt = smoothed.trebAtt * 0.95f + f.treb * 0.05f;
+
+        f.bassAtt = smoothed.bassAtt;
+        f.midAtt = smoothed.midAtt;
+        f.trebAtt = smoothed.trebAtt;
+    }
+
+    return f;
+}
+
+double FeatureTrackSource::getLengthSeconds() const
+{
+    return rows.empty() ? 0.0 : rows.back().time;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../Audio/AudioAnalyzer.h"
+#include <memory>
+#include <vector>
+
+/**
+ * @class AudioFeatureSource
+ * @brief Supplies MilkDrop audio variables for a given point in time
+ *
+ * The offline renderer samples a source once per output frame at a fixed
+ * timestep, so results depend only on the input and the frame rate, never
+ * on how fast the machine renders.
+ */
+class AudioFeatureSource
+{
+public:
+    struct Features
+    {
+        float bass = 0.0f;
+        float mid = 0.0f;
+        float treb = 0.0f;
+        float bassAtt = 0.0f;
+        float midAtt = 0.0f;
+        float trebAtt = 0.0f;
+    };
+
+    virtual ~AudioFeatureSource() = default;
+
+    /**
+     * @brief Features at the given time
+     *
+     * Calls are made with strictly increasing times, one per frame; sources
+     * may keep smoothing state between calls.
+     */
+    virtual Features getFeaturesAt(double timeSeconds) = 0;
+
+    /**
+     * @brief Length of the material in seconds
+     */
+    virtual double getLengthSeconds() const = 0;
+
+    /**
+     * @brief Open an audio file (any format JUCE can read) or a .csv feature track
+     * @param neededSeconds Times getFeaturesAt() will be called for; audio files
+     *                      only decode this part (plus one analysis window), so
+     *                      a worker rendering one segment of a long set does not
+     *                      hold the whole file. Empty = everything.
+     * @return nullptr on failure, with the reason in error
+     */
+    static std::unique_ptr<AudioFeatureSource> createForFile(const juce::File& file,
+                                                             juce::String& error,
+                                                             juce::Range<double> neededSeconds = {});
+
+    /**
+     * @brief Length of an audio file or feature track without decoding the audio
+     * @return < 0 on failure, with the reason in error
+     */
+    static double getLengthOfFile(const juce::File& file, juce::String& error);
+};
+
+/**
+ * @class AudioFileFeatureSource
+ * @brief Runs AudioAnalyzer over a decoded audio file
+ *
+ * Each frame analyses the FFT window that ends at the frame's timestamp,
+ * using the same analyzer (and smoothing) as live input.
+ */
+class AudioFileFeatureSource : public AudioFeatureSource
+{
+public:
+    AudioFileFeatureSource() = default;
+
+    /**
+     * @param neededSeconds Decode only this range (see createForFile); empty = all
+     */
+    bool load(const juce::File& file, juce::String& error, juce::Range<double> neededSeconds = {});
+
+    Features getFeaturesAt(double timeSeconds) override;
+    double getLengthSeconds() const override;
+
+private:
+    juce::AudioBuffer<float> buffer;
+    juce::int64 bufferStart = 0;     // File position of buffer sample 0
+    juce::int64 totalSamples = 0;    // Length of the whole file
+    double sampleRate = 44100.0;
+    AudioAnalyzer analyzer;
+
+    static constexpr int windowSize = 1024;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioFileFeatureSource)
+};
+
+/**
+ * @class FeatureTrackSource
+ * @brief Pre-computed features read from CSV
+ *
+ * One row per sample: time,bass,mid,treb[,bass_att,mid_att,treb_att].
+ * A header row and '#' comments are ignored. Values are linearly
+ * interpolated; when the _att columns are missing they are derived with
+ * the same per-frame smoothing AudioAnalyzer uses.
+ */
+class FeatureTrackSource : public AudioFeatureSource
+{
+public:
+    FeatureTrackSource() = default;
+
+    bool load(const juce::File& file, juce::String& error);
+
+    Features getFeaturesAt(double timeSeconds) override;
+    double getLengthSeconds() const override;
+
+private:
+    struct Row
+    {
+        double time = 0.0;
+        Features features;
+    };
+
+    std::vector<Row> rows;
+    bool hasAttenuated = false;
+    size_t cursor = 0;
+    Features smoothed;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FeatureTrackSource)
+};
@@ -0,0 +1,223 @@
+#include "ColorConversion.h"
+#include "../Core/CpuFeatures.h"
+#include <cstddef>
+
+namespace
+{
+    inline uint8_t clampToByte(int value)
+    {
+        return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+    }
+
+    //==========================================================================
+    // Scalar kernels (also handle the tails the SIMD loops leave over)
+
+    void lumaRowScalar(const uint8_t* src, uint8_t* dst, int x0, int x1)
+    {
+        for (int x = x0; x < x1; ++x)
+        {
+            int r = src[x * 4 + 0];
+            int g = src[x * 4 + 1];
+            int b = src[x * 4 + 2];
+            dst[x] = clampToByte(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        }
+    }
+
+    /** Chroma for columns [cx0, cx1); U/V are written every `step` bytes */
+    void chromaRowScalar(const uint8_t* row0, const uint8_t* row1, int width, int cx0, int cx1,
+                         uint8_t* u, uint8_t* v, int step)
+    {
+        for (int cx = cx0; cx < cx1; ++cx)
+        {
+            int x0 = cx * 2 * 4;
+            int x1 = (cx * 2 + 1 < width) ? x0 + 4 : x0;
+
+            int r = row0[x0 + 0] + row0[x1 + 0] + row1[x0 + 0] + row1[x1 + 0];
+            int g = row0[x0 + 1] + row0[x1 + 1] + row1[x0 + 1] + row1[x1 + 1];
+            int b = row0[x0 + 2] + row0[x1 + 2] + row1[x0 + 2] + row1[x1 + 2];
+
+            // Sums are 4x the average; the /4 is folded into the shift
+            u[cx * step] = clampToByte(((-38 * r - 74 * g + 112 * b + 512) >> 10) + 128);
+            v[cx * step] = clampToByte(((112 * r - 94 * g - 18 * b + 512) >> 10) + 128);
+        }
+    }
+
+#if FLARKVIZ_AVX2_DISPATCH
+    //==========================================================================
+    // AVX2 kernels: 16 pixels per iteration, same integer maths as above.
+    //
+    // Each 32-bit pixel is A<<24 | B<<16 | G<<8 | R. Masking gives two
+    // 16-bit lanes per pixel, (R, B) and (G, A), so _mm256_madd_epi16 with
+    // per-lane coefficients evaluates the dot products in 32-bit precision.
+    // They are only called when the CPU has AVX2.
+
+    FLARKVIZ_TARGET_AVX2 inline __m128i packToBytes(__m256i a, __m256i b)
+    {
+        // 16 x int32 -> 16 x uint8, restoring pixel order across the lanes
+        __m256i words = _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), 0xD8);
+        return _mm_packus_epi16(_mm256_castsi256_si128(words), _mm256_extracti128_si256(words, 1));
+    }
+
+    FLARKVIZ_TARGET_AVX2 inline __m256i lumaFromPixels(__m256i px)
+    {
+        const __m256i mask = _mm256_set1_epi32(0x00FF00FF);
+        const __m256i coeffRB = _mm256_set1_epi32((25 << 16) | 66);
+        const __m256i coeffGA = _mm256_set1_epi32(129);
+        const __m256i round = _mm256_set1_epi32(128);
+        const __m256i offset = _mm256_set1_epi32(16);
+
+        __m256i rb = _mm256_and_si256(px, mask);
+        __m256i ga = _mm256_and_si256(_mm256_srli_epi32(px, 8), mask);
+
+        __m256i sum = _mm256_add_epi32(_mm256_madd_epi16(rb, coeffRB), _mm256_madd_epi16(ga, coeffGA));
+        return _mm256_add_epi32(_mm256_srai_epi32(_mm256_add_epi32(sum, round), 8), offset);
+    }
+
+    FLARKVIZ_TARGET_AVX2 int lumaRowAVX2(const uint8_t* src, uint8_t* dst, int width)
+    {
+        int x = 0;
+        for (; x + 16 <= width; x += 16)
+        {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + x * 4));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + x * 4 + 32));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), packToBytes(lumaFromPixels(a), lumaFromPixels(b)));
+        }
+        return x;
+    }
+
+    /** U and V for 8 pixels (4 chroma samples) as int32 in the even elements */
+    FLARKVIZ_TARGET_AVX2 inline void chromaFromPixels(__m256i top, __m256i bottom, __m256i& u, __m256i& v)
+    {
+        const __m256i mask = _mm256_set1_epi32(0x00FF00FF);
+
+        // Vertical then horizontal pair sums; 16-bit lanes cannot overflow (max 1020)
+        __m256i rb = _mm256_add_epi16(_mm256_and_si256(top, mask), _mm256_and_si256(bottom, mask));
+        __m256i ga = _mm256_add_epi16(_mm256_and_si256(_mm256_srli_epi32(top, 8), mask),
+                                      _mm256_and_si256(_mm256_srli_epi32(bottom, 8), mask));
+        rb = _mm256_add_epi16(rb, _mm256_srli_epi64(rb, 32));
+        ga = _mm256_add_epi16(ga, _mm256_srli_epi64(ga, 32));
+
+        const __m256i round = _mm256_set1_epi32(512);
+        const __m256i offset = _mm256_set1_epi32(128);
+
+        __m256i uSum = _mm256_add_epi32(_mm256_madd_epi16(rb, _mm256_set1_epi32((112 << 16) | (-38 & 0xFFFF))),
+                                        _mm256_madd_epi16(ga, _mm256_set1_epi32(-74 & 0xFFFF)));
+        __m256i vSum = _mm256_add_epi32(_mm256_madd_epi16(rb, _mm256_set1_epi32((-18 << 16) | 112)),
+                                        _mm256_madd_epi16(ga, _mm256_set1_epi32(-94 & 0xFFFF)));
+
+        u = _mm256_add_epi32(_mm256_srai_epi32(_mm256_add_epi32(uSum, round), 10), offset);
+        v = _mm256_add_epi32(_mm256_srai_epi32(_mm256_add_epi32(vSum, round), 10), offset);
+    }
+
+    /** Gather the even int32 elements of a and b into 8 bytes */
+    FLARKVIZ_TARGET_AVX2 inline __m128i packEvenToBytes(__m256i a, __m256i b)
+    {
+        const __m256i evens = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+        __m256i ca = _mm256_permutevar8x32_epi32(a, evens);
+        __m256i cb = _mm256_permutevar8x32_epi32(b, evens);
+        __m128i words = _mm_packs_epi32(_mm256_castsi256_si128(ca), _mm256_castsi256_si128(cb));
+        return _mm_packus_epi16(words, words);
+    }
+
+    /** Returns the number of chroma columns converted */
+    FLARKVIZ_TARGET_AVX2 int chromaRowAVX2(const uint8_t* row0, const uint8_t* row1, int width,
+                                         uint8_t* u, uint8_t* v, uint8_t* uv)
+    {
+        int cx = 0;
+        for (; (cx + 8) * 2 <= width; cx += 8)
+        {
+            const uint8_t* p0 = row0 + cx * 8;
+            const uint8_t* p1 = row1 + cx * 8;
+
+            __m256i uA, vA, uB, vB;
+            chromaFromPixels(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p0)),
+                             _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p1)), uA, vA);
+            chromaFromPixels(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p0 + 32)),
+                             _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p1 + 32)), uB, vB);
+
+            __m128i u8 = packEvenToBytes(uA, uB);
+            __m128i v8 = packEvenToBytes(vA, vB);
+
+            if (uv != nullptr)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(uv + cx * 2), _mm_unpacklo_epi8(u8, v8));
+            }
+            else
+            {
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(u + cx), u8);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(v + cx), v8);
+            }
+        }
+        return cx;
+    }
+#endif
+
+    //==========================================================================
+    void convertRows(const uint8_t* rgba, int width, int height, int rowBegin, int rowEnd,
+                     uint8_t* y, uint8_t* u, uint8_t* v, bool interleaved)
+    {
+        const size_t stride = static_cast<size_t>(width) * 4;
+        const int chromaWidth = (width + 1) / 2;
+        const size_t chromaStride = interleaved ? static_cast<size_t>(chromaWidth) * 2
+                                                : static_cast<size_t>(chromaWidth);
+
+        for (int row = rowBegin; row < rowEnd; ++row)
+        {
+            const uint8_t* src = rgba + static_cast<size_t>(row) * stride;
+            uint8_t* dst = y + static_cast<size_t>(row) * static_cast<size_t>(width);
+
+            int x = 0;
+#if FLARKVIZ_AVX2_DISPATCH
+            if (CpuFeatures::hasAVX2())
+                x = lumaRowAVX2(src, dst, width);
+#endif
+            lumaRowScalar(src, dst, x, width);
+        }
+
+        for (int cy = rowBegin / 2; cy < (rowEnd + 1) / 2; ++cy)
+        {
+            const uint8_t* row0 = rgba + static_cast<size_t>(cy * 2) * stride;
+            const uint8_t* row1 = (cy * 2 + 1 < height) ? row0 + stride : row0;
+
+            uint8_t* uRow = u + static_cast<size_t>(cy) * chromaStride;
+            uint8_t* vRow = interleaved ? uRow + 1 : v + static_cast<size_t>(cy) * chromaStride;
+
+            int cx = 0;
+#if FLARKVIZ_AVX2_DISPATCH
+            if (CpuFeatures::hasAVX2())
+                cx = chromaRowAVX2(row0, row1, width, uRow, vRow, interleaved ? uRow : nullptr);
+#endif
+            chromaRowScalar(row0, row1, width, cx, chromaWidth, uRow, vRow, interleaved ? 2 : 1);
+        }
+    }
+}
+
+namespace ColorConversion
+{
+    void rgbaToI420Rows(const uint8_t* rgba, int width, int height, int rowBegin, int rowEnd,
+                        uint8_t* y, uint8_t* u, uint8_t* v)
+    {
+        convertRows(rgba, width, height, rowBegin, rowEnd, y, u, v, false);
+    }
+
+    void rgbaToNV12Rows(const uint8_t* rgba, int width, int height, int rowBegin, int rowEnd,
+                        uint8_t* y, uint8_t* uv)
+    {
+        convertRows(rgba, width, height, rowBegin, rowEnd, y, uv, nullptr, true);
+    }
+
+    void rgbaToI420(const uint8_t* rgba, int width, int height, uint8_t* y, uint8_t* u, uint8_t* v)
+    {
+        rgbaToI420Rows(rgba, width, height, 0, height, y, u, v);
+    }
+
+    void rgbaToNV12(const uint8_t* rgba, int width, int height, uint8_t* y, uint8_t* uv)
+    {
+        rgbaToNV12Rows(rgba, width, height, 0, height, y, uv);
+    }
+
+    bool isAccelerated()
+    {
+        return CpuFeatures::hasAVX2();
+    }
+}
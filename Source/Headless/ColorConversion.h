@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @namespace ColorConversion
+ * @brief RGBA8 to 4:2:0 YUV (BT.601, limited range) for video output
+ *
+ * Both layouts share one fixed-point formula; chroma is the average of each
+ * 2x2 block, with the last row/column replicated for odd sizes. On CPUs
+ * with AVX2 the inner loops process 16 pixels per iteration and produce
+ * bit-identical results to the scalar path.
+ *
+ * The *Rows functions convert the luma rows [rowBegin, rowEnd) and the
+ * chroma rows covering them, so a frame can be split into bands and
+ * converted in parallel. rowBegin must be even.
+ */
+namespace ColorConversion
+{
+    /** Planar: Y plane, then U and V planes of ceil(w/2) x ceil(h/2) */
+    void rgbaToI420Rows(const uint8_t* rgba, int width, int height, int rowBegin, int rowEnd,
+                        uint8_t* y, uint8_t* u, uint8_t* v);
+
+    /** Semi-planar: Y plane, then one interleaved UV plane */
+    void rgbaToNV12Rows(const uint8_t* rgba, int width, int height, int rowBegin, int rowEnd,
+                        uint8_t* y, uint8_t* uv);
+
+    /** Whole-frame convenience wrappers */
+    void rgbaToI420(const uint8_t* rgba, int width, int height, uint8_t* y, uint8_t* u, uint8_t* v);
+    void rgbaToNV12(const uint8_t* rgba, int width, int height, uint8_t* y, uint8_t* uv);
+
+    /** Bytes needed for a 4:2:0 frame */
+    inline int64_t getYUV420Size(int width, int height)
+    {
+        return static_cast<int64_t>(width) * height
+             + 2 * static_cast<int64_t>((width + 1) / 2) * ((height + 1) / 2);
+    }
+
+    /** True when this CPU runs the AVX2 kernels */
+    bool isAccelerated();
+}
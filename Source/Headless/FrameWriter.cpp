@@ -0,0 +1,38 @@
+#include "FrameWriter.h"
+#include "VideoStreamWriter.h"
+#include "ImageSequenceWriter.h"
+
+std::unique_ptr<FrameWriter> FrameWriter::createForPath(const juce::String& path, const Options& options)
+{
+    auto video = [&](VideoStreamWriter::Format format)
+    {
+        return std::make_unique<VideoStreamWriter>(path, format, options.numThreads);
+    };
+
+    if (path == "-" || path.endsWithIgnoreCase(".y4m"))
+        return video(VideoStreamWriter::Format::Y4M);
+
+    if (path.endsWithIgnoreCase(".yuv"))
+        return video(VideoStreamWriter::Format::RawI420);
+
+    if (path.endsWithIgnoreCase(".nv12"))
+        return video(VideoStreamWriter::Format::RawNV12);
+
+    if (path.endsWithIgnoreCase(".rgba") || path.endsWithIgnoreCase(".raw"))
+        return video(VideoStreamWriter::Format::RawRGBA);
+
+    if (path.endsWithIgnoreCase(".png"))
+        return std::make_unique<ImageSequenceWriter>(path, ImageSequenceWriter::Format::PNG,
+                                                     options.compressionLevel, options.numThreads);
+
+    if (path.endsWithIgnoreCase(".exr"))
+        return std::make_unique<ImageSequenceWriter>(path, ImageSequenceWriter::Format::EXR,
+                                                     options.compressionLevel, options.numThreads);
+
+    return nullptr;
+}
+
+bool FrameWriter::isImageSequencePath(const juce::String& path)
+{
+    return path.endsWithIgnoreCase(".png") || path.endsWithIgnoreCase(".exr");
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <memory>
+
+/**
+ * @class FrameWriter
+ * @brief Destination for rendered frames
+ *
+ * Frames are tightly packed 8-bit RGBA with the top row first.
+ */
+class FrameWriter
+{
+public:
+    struct StreamInfo
+    {
+        int width = 0;
+        int height = 0;
+        int fpsNumerator = 60;
+        int fpsDenominator = 1;
+    };
+
+    virtual ~FrameWriter() = default;
+
+    /**
+     * @brief Prepare the output; called once before the first frame
+     */
+    virtual bool open(const StreamInfo& info) = 0;
+
+    /**
+     * @brief Write one frame
+     * @param rgba width * height * 4 bytes, top row first
+     * @param frameIndex Zero-based index of the frame in the render
+     */
+    virtual bool writeFrame(const uint8_t* rgba, int64_t frameIndex) = 0;
+
+    /**
+     * @brief Flush and close; further writes fail
+     */
+    virtual bool close() = 0;
+
+    juce::String getLastError() const { return lastError; }
+
+    /**
+     * @brief One-line description of throughput for the log, or empty
+     */
+    virtual juce::String getStatsSummary() const { return {}; }
+
+    /** Tuning shared by the writers that compress or convert on worker threads */
+    struct Options
+    {
+        int numThreads = 0;         // <= 0 picks from the core count
+        int compressionLevel = -1;  // zlib level for PNG/EXR; -1 is the default
+    };
+
+    /**
+     * @brief Pick a writer from the output path
+     *
+     * "-" or *.y4m writes a YUV4MPEG2 stream, *.yuv / *.nv12 headerless
+     * I420 / NV12, *.rgba / *.raw headerless RGBA, and *.png / *.exr an
+     * image sequence (optionally with a printf-style frame number such as
+     * "frame_%05d.png").
+     *
+     * @return nullptr if the extension is not recognised
+     */
+    static std::unique_ptr<FrameWriter> createForPath(const juce::String& path, const Options& options);
+
+    /**
+     * @brief True if createForPath() would write one file per frame, named by frame index
+     */
+    static bool isImageSequencePath(const juce::String& path);
+
+protected:
+    juce::String lastError;
+};
@@ -0,0 +1,258 @@
+#include "HeadlessGLContext.h"
+#include <cstring>
+
+#if FLARKVIZ_HEADLESS_OSMESA
+ #include <GL/osmesa.h>
+#else
+ #include <EGL/egl.h>
+ #include <EGL/eglext.h>
+#endif
+
+using namespace juce::gl;
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+ #define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+struct HeadlessGLContext::Impl
+{
+#if FLARKVIZ_HEADLESS_OSMESA
+    OSMesaContext context = nullptr;
+    std::vector<uint8_t> buffer;  // OSMesa requires a colour buffer to bind
+#else
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+    EGLSurface surface = EGL_NO_SURFACE;
+#endif
+};
+
+HeadlessGLContext::HeadlessGLContext()
+    : impl(std::make_unique<Impl>())
+{
+}
+
+HeadlessGLContext::~HeadlessGLContext()
+{
+    destroy();
+}
+
+bool HeadlessGLContext::create()
+{
+    if (valid)
+        return true;
+
+#if FLARKVIZ_HEADLESS_OSMESA
+    valid = createOSMesa();
+#else
+    valid = createEGL();
+#endif
+
+    if (!valid)
+    {
+        destroy();
+        return false;
+    }
+
+    // Resolve GL entry points against the context we just made current
+    juce::gl::loadFunctions();
+
+    auto* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    auto* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    description << " (" << (renderer ? renderer : "unknown renderer")
+                << ", GL " << (version ? version : "?") << ")";
+
+    DBG("FlarkViz: Headless context created: " << description);
+    return true;
+}
+
+void HeadlessGLContext::finish()
+{
+    if (valid)
+        glFinish();
+}
+
+//==============================================================================
+#if FLARKVIZ_HEADLESS_OSMESA
+
+bool HeadlessGLContext::createOSMesa()
+{
+    const int attribs[] = {
+        OSMESA_FORMAT, OSMESA_RGBA,
+        OSMESA_DEPTH_BITS, 0,
+        OSMESA_STENCIL_BITS, 0,
+        OSMESA_PROFILE, OSMESA_CORE_PROFILE,
+        OSMESA_CONTEXT_MAJOR_VERSION, 3,
+        OSMESA_CONTEXT_MINOR_VERSION, 3,
+        0
+    };
+
+    impl->context = OSMesaCreateContextAttribs(attribs, nullptr);
+    if (impl->context == nullptr)
+    {
+        lastError = "OSMesaCreateContextAttribs failed (GL 3.3 core unavailable)";
+        return false;
+    }
+
+    // Rendering goes to FBOs; the default buffer only has to exist
+    impl->buffer.assign(4, 0);
+    if (!OSMesaMakeCurrent(impl->context, impl->buffer.data(), GL_UNSIGNED_BYTE, 1, 1))
+    {
+        lastError = "OSMesaMakeCurrent failed";
+        return false;
+    }
+
+    description = "OSMesa";
+    return true;
+}
+
+bool HeadlessGLContext::createEGL()
+{
+    lastError = "Built without EGL support";
+    return false;
+}
+
+void HeadlessGLContext::destroy()
+{
+    if (impl->context != nullptr)
+    {
+        OSMesaDestroyContext(impl->context);
+        impl->context = nullptr;
+    }
+
+    impl->buffer.clear();
+    valid = false;
+}
+
+//==============================================================================
+#else
+
+bool HeadlessGLContext::createOSMesa()
+{
+    lastError = "Built without OSMesa support";
+    return false;
+}
+
+bool HeadlessGLContext::createEGL()
+{
+    // Prefer Mesa's surfaceless platform: no X11, Wayland or GBM device needed
+    auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+        eglGetProcAddress("eglGetPlatformDisplayEXT"));
+
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    bool hasSurfaceless = clientExtensions != nullptr
+                       && std::strstr(clientExtensions, "EGL_MESA_platform_surfaceless") != nullptr;
+
+    bool surfaceless = false;
+    if (getPlatformDisplay != nullptr && hasSurfaceless)
+    {
+        impl->display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        surfaceless = impl->display != EGL_NO_DISPLAY;
+    }
+
+    if (impl->display == EGL_NO_DISPLAY)
+        impl->display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    if (impl->display == EGL_NO_DISPLAY)
+    {
+        lastError = "No EGL display available";
+        return false;
+    }
+
+    EGLint major = 0, minor = 0;
+    if (!eglInitialize(impl->display, &major, &minor))
+    {
+        lastError = "eglInitialize failed: 0x" + juce::String::toHexString(static_cast<int>(eglGetError()));
+        impl->display = EGL_NO_DISPLAY;
+        return false;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        lastError = "EGL implementation does not support desktop OpenGL";
+        return false;
+    }
+
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_NONE
+    };
+
+    EGLConfig config = nullptr;
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(impl->display, configAttribs, &config, 1, &numConfigs) || numConfigs == 0)
+    {
+        // Mesa's surfaceless platform may expose no configs at all; a context
+        // that only renders to FBOs does not need one
+        const char* displayExtensions = eglQueryString(impl->display, EGL_EXTENSIONS);
+        bool noConfigContext = displayExtensions != nullptr
+                            && std::strstr(displayExtensions, "EGL_KHR_no_config_context") != nullptr;
+
+        if (!surfaceless || !noConfigContext)
+        {
+            lastError = "No EGL config with desktop GL support";
+            return false;
+        }
+
+        config = EGL_NO_CONFIG_KHR;
+    }
+
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+
+    impl->context = eglCreateContext(impl->display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (impl->context == EGL_NO_CONTEXT)
+    {
+        lastError = "eglCreateContext failed (GL 3.3 core unavailable): 0x"
+                  + juce::String::toHexString(static_cast<int>(eglGetError()));
+        return false;
+    }
+
+    // Without the surfaceless platform, bind a tiny pbuffer as the default surface
+    if (!surfaceless)
+    {
+        const EGLint pbufferAttribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        impl->surface = eglCreatePbufferSurface(impl->display, config, pbufferAttribs);
+    }
+
+    if (!eglMakeCurrent(impl->display, impl->surface, impl->surface, impl->context))
+    {
+        lastError = "eglMakeCurrent failed: 0x" + juce::String::toHexString(static_cast<int>(eglGetError()));
+        return false;
+    }
+
+    description = juce::String("EGL ") + juce::String(major) + "." + juce::String(minor)
+                + (surfaceless ? " surfaceless" : " pbuffer");
+    return true;
+}
+
+void HeadlessGLContext::destroy()
+{
+    if (impl->display != EGL_NO_DISPLAY)
+    {
+        eglMakeCurrent(impl->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+        if (impl->surface != EGL_NO_SURFACE)
+            eglDestroySurface(impl->display, impl->surface);
+
+        if (impl->context != EGL_NO_CONTEXT)
+            eglDestroyContext(impl->display, impl->context);
+
+        eglTerminate(impl->display);
+    }
+
+    impl->display = EGL_NO_DISPLAY;
+    impl->context = EGL_NO_CONTEXT;
+    impl->surface = EGL_NO_SURFACE;
+    valid = false;
+}
+
+#endif
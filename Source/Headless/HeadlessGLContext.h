@@ -0,0 +1,59 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * @class HeadlessGLContext
+ * @brief OpenGL 3.3 core context with no window or display server
+ *
+ * Uses EGL on Mesa's surfaceless platform (EGL_MESA_platform_surfaceless),
+ * falling back to the default EGL display with a 1x1 pbuffer. When built
+ * with FLARKVIZ_HEADLESS_OSMESA=1 an OSMesa context is used instead, which
+ * works even where no EGL driver is installed. Software rasterisers such
+ * as llvmpipe are fine; the renderer only needs GL 3.3.
+ *
+ * All rendering happens into FBOs, so the context never presents anything.
+ */
+class HeadlessGLContext
+{
+public:
+    HeadlessGLContext();
+    ~HeadlessGLContext();
+
+    /**
+     * @brief Create the context, make it current and load GL entry points
+     * @return false if no suitable context could be created (see getLastError)
+     */
+    bool create();
+
+    /**
+     * @brief Release the context
+     */
+    void destroy();
+
+    bool isValid() const { return valid; }
+
+    /**
+     * @brief Block until all submitted GL work has completed
+     */
+    void finish();
+
+    /**
+     * @brief Human-readable backend, e.g. "EGL surfaceless (llvmpipe ...)"
+     */
+    juce::String getDescription() const { return description; }
+    juce::String getLastError() const { return lastError; }
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+
+    bool valid = false;
+    juce::String description;
+    juce::String lastError;
+
+    bool createEGL();
+    bool createOSMesa();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HeadlessGLContext)
+};
@@ -0,0 +1,431 @@
+#include "ImageEncoding.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    /** Appends to a vector whose capacity survives between frames */
+    class VectorOutputStream : public juce::OutputStream
+    {
+    public:
+        explicit VectorOutputStream(std::vector<uint8_t>& target) : data(target) {}
+
+        void flush() override {}
+        bool setPosition(juce::int64) override { return false; }
+        juce::int64 getPosition() override { return static_cast<juce::int64>(data.size()); }
+
+        bool write(const void* source, size_t numBytes) override
+        {
+            auto* bytes = static_cast<const uint8_t*>(source);
+            data.insert(data.end(), bytes, bytes + numBytes);
+            return true;
+        }
+
+    private:
+        std::vector<uint8_t>& data;
+    };
+
+    /** Appends a zlib stream (RFC 1950, as both PNG and EXR expect) */
+    bool deflateAppend(const uint8_t* source, size_t numBytes, int level, std::vector<uint8_t>& out)
+    {
+        VectorOutputStream dest(out);
+        juce::GZIPCompressorOutputStream zlib(dest, std::clamp(level, -1, 9));
+
+        bool ok = zlib.write(source, numBytes);
+        zlib.flush();  // Finishes the stream; no more writes after this
+        return ok;
+    }
+
+    void appendBigEndian32(std::vector<uint8_t>& out, uint32_t value)
+    {
+        uint8_t bytes[4] = { uint8_t(value >> 24), uint8_t(value >> 16), uint8_t(value >> 8), uint8_t(value) };
+        out.insert(out.end(), bytes, bytes + 4);
+    }
+
+    void appendLittleEndian(std::vector<uint8_t>& out, uint64_t value, int numBytes)
+    {
+        for (int i = 0; i < numBytes; ++i)
+            out.push_back(uint8_t(value >> (8 * i)));
+    }
+
+    void putLittleEndian(uint8_t* dest, uint64_t value, int numBytes)
+    {
+        for (int i = 0; i < numBytes; ++i)
+            dest[i] = uint8_t(value >> (8 * i));
+    }
+
+    //==========================================================================
+    // PNG
+
+    uint32_t crc32(const uint8_t* data, size_t size)
+    {
+        static const auto table = []
+        {
+            std::vector<uint32_t> t(256);
+            for (uint32_t n = 0; n < 256; ++n)
+            {
+                uint32_t c = n;
+                for (int k = 0; k < 8; ++k)
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                t[n] = c;
+            }
+            return t;
+        }();
+
+        uint32_t c = 0xFFFFFFFFu;
+        for (size_t i = 0; i < size; ++i)
+            c = table[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+        return c ^ 0xFFFFFFFFu;
+    }
+
+    /** Writes length and type, leaving the caller to append data then call endChunk */
+    size_t beginChunk(std::vector<uint8_t>& out, const char* type)
+    {
+        size_t start = out.size();
+        appendBigEndian32(out, 0);
+        out.insert(out.end(), type, type + 4);
+        return start;
+    }
+
+    void endChunk(std::vector<uint8_t>& out, size_t start)
+    {
+        auto length = static_cast<uint32_t>(out.size() - start - 8);
+        for (int i = 0; i < 4; ++i)
+            out[start + static_cast<size_t>(i)] = uint8_t(length >> (24 - 8 * i));
+
+        appendBigEndian32(out, crc32(out.data() + start + 4, out.size() - start - 4));
+    }
+
+    inline uint8_t paeth(int left, int up, int upLeft)
+    {
+        int p = left + up - upLeft;
+        int pa = std::abs(p - left), pb = std::abs(p - up), pc = std::abs(p - upLeft);
+        if (pa <= pb && pa <= pc) return uint8_t(left);
+        return uint8_t(pb <= pc ? up : upLeft);
+    }
+
+    enum PngFilter : uint8_t { FilterNone = 0, FilterSub = 1, FilterUp = 2, FilterPaeth = 4 };
+
+    /**
+     * Filter one row into dest (filter byte first). With adaptive selection
+     * the filter with the smallest sum of absolute residuals wins, which is
+     * libpng's heuristic and usually the best size for the time.
+     */
+    void filterRow(const uint8_t* row, const uint8_t* prev, size_t rowBytes, uint8_t* dest, bool adaptive)
+    {
+        const size_t bpp = 4;
+        PngFilter filter = FilterNone;
+
+        if (adaptive)
+        {
+            uint64_t sums[3] = { 0, 0, 0 };  // Sub, Up, Paeth
+            for (size_t i = 0; i < rowBytes; ++i)
+            {
+                int x = row[i];
+                int a = i >= bpp ? row[i - bpp] : 0;
+                int b = prev != nullptr ? prev[i] : 0;
+                int c = (prev != nullptr && i >= bpp) ? prev[i - bpp] : 0;
+
+                sums[0] += static_cast<uint64_t>(std::abs(int8_t(uint8_t(x - a))));
+                sums[1] += static_cast<uint64_t>(std::abs(int8_t(uint8_t(x - b))));
+                sums[2] += static_cast<uint64_t>(std::abs(int8_t(uint8_t(x - paeth(a, b, c)))));
+            }
+
+            uint64_t noneSum = 0;
+            for (size_t i = 0; i < rowBytes; ++i)
+                noneSum += static_cast<uint64_t>(std::abs(int8_t(row[i])));
+
+            uint64_t best = noneSum;
+            const PngFilter candidates[3] = { FilterSub, FilterUp, FilterPaeth };
+            for (int f = 0; f < 3; ++f)
+            {
+                if (sums[f] < best)
+                {
+                    best = sums[f];
+                    filter = candidates[f];
+                }
+            }
+        }
+
+        dest[0] = filter;
+        uint8_t* out = dest + 1;
+
+        switch (filter)
+        {
+            case FilterNone:
+                std::memcpy(out, row, rowBytes);
+                break;
+
+            case FilterSub:
+                for (size_t i = 0; i < rowBytes; ++i)
+                    out[i] = uint8_t(row[i] - (i >= bpp ? row[i - bpp] : 0));
+                break;
+
+            case FilterUp:
+                for (size_t i = 0; i < rowBytes; ++i)
+                    out[i] = uint8_t(row[i] - (prev != nullptr ? prev[i] : 0));
+                break;
+
+            case FilterPaeth:
+                for (size_t i = 0; i < rowBytes; ++i)
+                {
+                    int a = i >= bpp ? row[i - bpp] : 0;
+                    int b = prev != nullptr ? prev[i] : 0;
+                    int c = (prev != nullptr && i >= bpp) ? prev[i - bpp] : 0;
+                    out[i] = uint8_t(row[i] - paeth(a, b, c));
+                }
+                break;
+        }
+    }
+
+    //==========================================================================
+    // OpenEXR
+
+    uint16_t floatToHalf(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        uint32_t sign = (bits >> 16) & 0x8000u;
+        int exponent = static_cast<int>((bits >> 23) & 0xFF) - 127 + 15;
+        uint32_t mantissa = bits & 0x7FFFFFu;
+
+        // Smallest non-zero input is sRGB 1/255 -> 3e-4, well inside half's normal range
+        if (exponent <= 0)
+            return static_cast<uint16_t>(sign);
+        if (exponent >= 31)
+            return static_cast<uint16_t>(sign | 0x7C00u);
+
+        uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+
+        // Round to nearest even; a carry correctly bumps the exponent
+        uint32_t rest = mantissa & 0x1FFFu;
+        if (rest > 0x1000u || (rest == 0x1000u && (half & 1u)))
+            ++half;
+
+        return static_cast<uint16_t>(half);
+    }
+
+    struct HalfTables
+    {
+        uint16_t colour[256];   // sRGB-encoded byte -> linear half
+        uint16_t alpha[256];    // byte -> half
+    };
+
+    const HalfTables& getHalfTables()
+    {
+        static const HalfTables tables = []
+        {
+            HalfTables t {};
+            for (int i = 0; i < 256; ++i)
+            {
+                double c = i / 255.0;
+                double linear = c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+                t.colour[i] = floatToHalf(static_cast<float>(linear));
+                t.alpha[i] = floatToHalf(static_cast<float>(c));
+            }
+            return t;
+        }();
+        return tables;
+    }
+
+    void appendAttribute(std::vector<uint8_t>& out, const char* name, const char* type, uint32_t size)
+    {
+        out.insert(out.end(), name, name + std::strlen(name) + 1);
+        out.insert(out.end(), type, type + std::strlen(type) + 1);
+        appendLittleEndian(out, size, 4);
+    }
+
+    void appendFloat(std::vector<uint8_t>& out, float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        appendLittleEndian(out, bits, 4);
+    }
+
+    /** OpenEXR's ZIP pre-pass: split even/odd bytes, then delta-encode */
+    void exrPredict(const uint8_t* source, size_t size, uint8_t* dest)
+    {
+        uint8_t* t1 = dest;
+        uint8_t* t2 = dest + (size + 1) / 2;
+
+        for (size_t i = 0; i < size; i += 2)
+        {
+            *t1++ = source[i];
+            if (i + 1 < size)
+                *t2++ = source[i + 1];
+        }
+
+        int p = dest[0];
+        for (size_t i = 1; i < size; ++i)
+        {
+            int d = int(dest[i]) - p + (128 + 256);
+            p = dest[i];
+            dest[i] = uint8_t(d);
+        }
+    }
+}
+
+namespace ImageEncoding
+{
+    bool encodePNG(const uint8_t* rgba, int width, int height, int compressionLevel,
+                   std::vector<uint8_t>& out, std::vector<uint8_t>& scratch)
+    {
+        out.clear();
+        if (width <= 0 || height <= 0)
+            return false;
+
+        const size_t rowBytes = static_cast<size_t>(width) * 4;
+        scratch.resize(static_cast<size_t>(height) * (rowBytes + 1));
+
+        const bool adaptive = compressionLevel != 0;
+        for (int y = 0; y < height; ++y)
+        {
+            const uint8_t* row = rgba + static_cast<size_t>(y) * rowBytes;
+            filterRow(row, y > 0 ? row - rowBytes : nullptr, rowBytes,
+                      scratch.data() + static_cast<size_t>(y) * (rowBytes + 1), adaptive);
+        }
+
+        static const uint8_t signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+        out.insert(out.end(), signature, signature + 8);
+
+        auto chunk = beginChunk(out, "IHDR");
+        appendBigEndian32(out, static_cast<uint32_t>(width));
+        appendBigEndian32(out, static_cast<uint32_t>(height));
+        const uint8_t format[5] = { 8, 6, 0, 0, 0 };  // 8-bit, RGBA, deflate, adaptive filters, no interlace
+        out.insert(out.end(), format, format + 5);
+        endChunk(out, chunk);
+
+        chunk = beginChunk(out, "IDAT");
+        if (!deflateAppend(scratch.data(), scratch.size(), compressionLevel, out))
+            return false;
+        endChunk(out, chunk);
+
+        endChunk(out, beginChunk(out, "IEND"));
+        return true;
+    }
+
+    bool encodeEXR(const uint8_t* rgba, int width, int height, int compressionLevel,
+                   std::vector<uint8_t>& out, std::vector<uint8_t>& scratch)
+    {
+        out.clear();
+        if (width <= 0 || height <= 0)
+            return false;
+
+        const bool zip = compressionLevel != 0;
+        const int linesPerBlock = zip ? 16 : 1;
+        const int numBlocks = (height + linesPerBlock - 1) / linesPerBlock;
+
+        // Magic, version 2, single-part scanline
+        appendLittleEndian(out, 20000630, 4);
+        appendLittleEndian(out, 2, 4);
+
+        // Channels are stored in alphabetical order
+        static const char channelNames[4] = { 'A', 'B', 'G', 'R' };
+        appendAttribute(out, "channels", "chlist", 4 * 18 + 1);
+        for (char name : channelNames)
+        {
+            out.push_back(uint8_t(name));
+            out.push_back(0);
+            appendLittleEndian(out, 1, 4);     // HALF
+            appendLittleEndian(out, 0, 4);     // pLinear + reserved
+            appendLittleEndian(out, 1, 4);     // xSampling
+            appendLittleEndian(out, 1, 4);     // ySampling
+        }
+        out.push_back(0);
+
+        appendAttribute(out, "compression", "compression", 1);
+        out.push_back(zip ? 3 : 0);            // ZIP_COMPRESSION : NO_COMPRESSION
+
+        for (const char* window : { "dataWindow", "displayWindow" })
+        {
+            appendAttribute(out, window, "box2i", 16);
+            appendLittleEndian(out, 0, 4);
+            appendLittleEndian(out, 0, 4);
+            appendLittleEndian(out, static_cast<uint32_t>(width - 1), 4);
+            appendLittleEndian(out, static_cast<uint32_t>(height - 1), 4);
+        }
+
+        appendAttribute(out, "lineOrder", "lineOrder", 1);
+        out.push_back(0);                      // INCREASING_Y
+
+        appendAttribute(out, "pixelAspectRatio", "float", 4);
+        appendFloat(out, 1.0f);
+
+        appendAttribute(out, "screenWindowCenter", "v2f", 8);
+        appendFloat(out, 0.0f);
+        appendFloat(out, 0.0f);
+
+        appendAttribute(out, "screenWindowWidth", "float", 4);
+        appendFloat(out, 1.0f);
+
+        out.push_back(0);                      // End of header
+
+        // Offset table, filled in as blocks are written
+        const size_t tableOffset = out.size();
+        out.resize(out.size() + static_cast<size_t>(numBlocks) * 8);
+
+        const size_t lineBytes = static_cast<size_t>(width) * 4 * 2;
+        scratch.resize(2 * lineBytes * static_cast<size_t>(linesPerBlock));
+        uint8_t* raw = scratch.data();
+        uint8_t* predicted = raw + lineBytes * static_cast<size_t>(linesPerBlock);
+
+        const auto& tables = getHalfTables();
+        static const int channelOffsets[4] = { 3, 2, 1, 0 };  // A, B, G, R within a pixel
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            putLittleEndian(out.data() + tableOffset + static_cast<size_t>(block) * 8, out.size(), 8);
+
+            const int y0 = block * linesPerBlock;
+            const int lines = std::min(linesPerBlock, height - y0);
+            const size_t rawSize = lineBytes * static_cast<size_t>(lines);
+
+            uint8_t* dest = raw;
+            for (int y = y0; y < y0 + lines; ++y)
+            {
+                const uint8_t* row = rgba + static_cast<size_t>(y) * static_cast<size_t>(width) * 4;
+
+                for (int offset : channelOffsets)
+                {
+                    const uint16_t* table = offset == 3 ? tables.alpha : tables.colour;
+                    for (int x = 0; x < width; ++x)
+                    {
+                        uint16_t half = table[row[x * 4 + offset]];
+                        *dest++ = uint8_t(half);
+                        *dest++ = uint8_t(half >> 8);
+                    }
+                }
+            }
+
+            appendLittleEndian(out, static_cast<uint32_t>(y0), 4);
+            const size_t sizePosition = out.size();
+            appendLittleEndian(out, 0, 4);
+
+            if (zip)
+            {
+                exrPredict(raw, rawSize, predicted);
+
+                const size_t start = out.size();
+                if (!deflateAppend(predicted, rawSize, compressionLevel, out))
+                    return false;
+
+                // Readers treat a block as uncompressed when it is not smaller
+                const size_t compressedSize = out.size() - start;
+                if (compressedSize < rawSize)
+                {
+                    putLittleEndian(out.data() + sizePosition, compressedSize, 4);
+                    continue;
+                }
+                out.resize(start);
+            }
+
+            out.insert(out.end(), raw, raw + rawSize);
+            putLittleEndian(out.data() + sizePosition, rawSize, 4);
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @namespace ImageEncoding
+ * @brief Thread-safe PNG and OpenEXR encoders for 8-bit RGBA frames
+ *
+ * Unlike juce::PNGImageFormat these take the frame as-is (no juce::Image
+ * copy), expose the zlib level, and encode into caller-owned vectors so
+ * an image-sequence writer can reuse the same memory for every frame.
+ * Each function clears `out` and leaves the complete file in it; `scratch`
+ * is working memory that only grows.
+ *
+ * compressionLevel is zlib's: 0 stores, 1 is fastest, 9 smallest and
+ * -1 the zlib default (6).
+ */
+namespace ImageEncoding
+{
+    /** 8-bit RGBA PNG, with per-row adaptive filtering unless level is 0 */
+    bool encodePNG(const uint8_t* rgba, int width, int height, int compressionLevel,
+                   std::vector<uint8_t>& out, std::vector<uint8_t>& scratch);
+
+    /**
+     * Scanline OpenEXR with half-float A, B, G, R channels. Colour is
+     * decoded from sRGB to linear, alpha is kept linear. Blocks of 16 lines
+     * use ZIP compression, or none when the level is 0.
+     */
+    bool encodeEXR(const uint8_t* rgba, int width, int height, int compressionLevel,
+                   std::vector<uint8_t>& out, std::vector<uint8_t>& scratch);
+}
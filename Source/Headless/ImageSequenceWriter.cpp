@@ -0,0 +1,292 @@
+#include "ImageSequenceWriter.h"
+#include "ImageEncoding.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    double ticksToMs(juce::int64 ticks)
+    {
+        return juce::Time::highResolutionTicksToSeconds(ticks) * 1000.0;
+    }
+}
+
+ImageSequenceWriter::ImageSequenceWriter(const juce::String& pathPattern, Format imageFormat,
+                                         int level, int encoderThreads)
+    : pattern(pathPattern)
+    , format(imageFormat)
+    , compressionLevel(level)
+    , numThreads(encoderThreads)
+{
+}
+
+ImageSequenceWriter::~ImageSequenceWriter()
+{
+    close();
+}
+
+bool ImageSequenceWriter::open(const StreamInfo& streamInfo)
+{
+    info = streamInfo;
+
+    auto dir = getFileForFrame(0).getParentDirectory();
+    if (!dir.createDirectory())
+    {
+        lastError = "Cannot create directory " + dir.getFullPathName();
+        return false;
+    }
+
+    workers = std::make_unique<WorkerPool>(numThreads);
+
+    // One slot per encoder, plus one being filled and one being written
+    const int numSlots = workers->getNumThreads() + 2;
+    const size_t frameBytes = static_cast<size_t>(info.width) * static_cast<size_t>(info.height) * 4;
+
+    slots.clear();
+    freeSlots.clear();
+    inFlight.clear();
+
+    for (int i = 0; i < numSlots; ++i)
+    {
+        auto slot = std::make_unique<Slot>();
+        slot->pixels.resize(frameBytes);
+        freeSlots.push_back(slot.get());
+        slots.push_back(std::move(slot));
+    }
+
+    stats = {};
+    stats.encoderThreads = workers->getNumThreads();
+    closing = false;
+    failed = false;
+    failure = {};
+
+    fileThread = std::thread([this] { fileLoop(); });
+    isOpen = true;
+
+    DBG("FlarkViz: Image sequence " << (format == Format::PNG ? "PNG" : "EXR")
+        << " with " << workers->getNumThreads() << " encoder threads, " << numSlots << " slots");
+
+    return true;
+}
+
+bool ImageSequenceWriter::writeFrame(const uint8_t* rgba, int64_t frameIndex)
+{
+    if (!isOpen)
+    {
+        lastError = "Sequence is not open";
+        return false;
+    }
+
+    Slot* slot = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        if (freeSlots.empty() && !failed)
+        {
+            auto t0 = juce::Time::getHighResolutionTicks();
+            slotFreed.wait(lock, [this] { return !freeSlots.empty() || failed; });
+
+            stats.backpressureMs += ticksToMs(juce::Time::getHighResolutionTicks() - t0);
+            stats.backpressureStalls++;
+        }
+
+        if (failed)
+        {
+            lastError = failure;
+            return false;
+        }
+
+        slot = freeSlots.front();
+        freeSlots.pop_front();
+    }
+
+    // The caller's pixels are only valid during this call
+    auto t0 = juce::Time::getHighResolutionTicks();
+    std::memcpy(slot->pixels.data(), rgba, slot->pixels.size());
+    double copyMs = ticksToMs(juce::Time::getHighResolutionTicks() - t0);
+
+    slot->frameIndex = frameIndex;
+    slot->state = Slot::State::Encoding;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        stats.copyMs += copyMs;
+        inFlight.push_back(slot);
+        stats.maxInFlight = std::max(stats.maxInFlight, static_cast<int>(inFlight.size()));
+    }
+
+    workers->submit([this, slot] { encodeSlot(*slot); });
+    return true;
+}
+
+void ImageSequenceWriter::encodeSlot(Slot& slot)
+{
+    auto t0 = juce::Time::getHighResolutionTicks();
+
+    bool ok = format == Format::PNG
+        ? ImageEncoding::encodePNG(slot.pixels.data(), info.width, info.height, compressionLevel,
+                                   slot.encoded, slot.scratch)
+        : ImageEncoding::encodeEXR(slot.pixels.data(), info.width, info.height, compressionLevel,
+                                   slot.encoded, slot.scratch);
+
+    double encodeMs = ticksToMs(juce::Time::getHighResolutionTicks() - t0);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.encodeMs += encodeMs;
+        slot.state = ok ? Slot::State::Encoded : Slot::State::Failed;
+    }
+    slotEncoded.notify_one();
+}
+
+void ImageSequenceWriter::fileLoop()
+{
+    for (;;)
+    {
+        Slot* slot = nullptr;
+        bool skipWrite = false;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+
+            // Only the oldest frame may be written, which keeps files in order
+            slotEncoded.wait(lock, [this]
+            {
+                if (inFlight.empty())
+                    return closing;
+                auto state = inFlight.front()->state;
+                return state == Slot::State::Encoded || state == Slot::State::Failed;
+            });
+
+            if (inFlight.empty())
+                return;
+
+            slot = inFlight.front();
+            inFlight.pop_front();
+
+            if (slot->state == Slot::State::Failed && !failed)
+            {
+                failed = true;
+                failure = "Failed to encode frame " + juce::String(slot->frameIndex);
+            }
+            skipWrite = failed;
+        }
+
+        // After a failure keep recycling slots so writeFrame() never waits forever
+        bool ok = true;
+        double ioMs = 0.0;
+        auto file = getFileForFrame(slot->frameIndex);
+
+        if (!skipWrite)
+        {
+            auto t0 = juce::Time::getHighResolutionTicks();
+
+            file.deleteFile();
+            juce::FileOutputStream out(file, 1 << 16);
+            ok = out.openedOk() && out.write(slot->encoded.data(), slot->encoded.size());
+            out.flush();
+            ok = ok && !out.getStatus().failed();
+
+            ioMs = ticksToMs(juce::Time::getHighResolutionTicks() - t0);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (!skipWrite)
+            {
+                stats.ioMs += ioMs;
+                if (ok)
+                {
+                    stats.framesWritten++;
+                    stats.bytesWritten += static_cast<int64_t>(slot->encoded.size());
+                }
+                else if (!failed)
+                {
+                    failed = true;
+                    failure = "Failed to write " + file.getFullPathName();
+                }
+            }
+
+            slot->state = Slot::State::Free;
+            freeSlots.push_back(slot);
+        }
+        slotFreed.notify_one();
+    }
+}
+
+bool ImageSequenceWriter::close()
+{
+    if (!isOpen)
+        return false;
+
+    isOpen = false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closing = true;
+    }
+    slotEncoded.notify_all();
+
+    if (fileThread.joinable())
+        fileThread.join();
+
+    workers.reset();
+
+    bool ok = !failed;
+    if (!ok)
+        lastError = failure;
+
+    freeSlots.clear();
+    slots.clear();
+    return ok;
+}
+
+ImageSequenceWriter::Stats ImageSequenceWriter::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+juce::String ImageSequenceWriter::getStatsSummary() const
+{
+    auto s = getStats();
+    auto perFrame = [&s](double totalMs) { return s.framesWritten > 0 ? totalMs / s.framesWritten : 0.0; };
+
+    juce::String summary;
+    summary << (format == Format::PNG ? "png" : "exr") << " " << s.framesWritten << " frames, "
+            << juce::String(s.bytesWritten / (1024.0 * 1024.0), 1) << " MB; per frame "
+            << juce::String(perFrame(s.copyMs), 2) << " ms copy, "
+            << juce::String(perFrame(s.encodeMs), 2) << " ms encode on " << s.encoderThreads << " threads, "
+            << juce::String(perFrame(s.ioMs), 2) << " ms I/O; backpressure "
+            << juce::String(s.backpressureMs, 1) << " ms over " << s.backpressureStalls
+            << " stalls, in flight peak " << s.maxInFlight;
+
+    return summary;
+}
+
+juce::File ImageSequenceWriter::getFileForFrame(int64_t frameIndex) const
+{
+    auto cwd = juce::File::getCurrentWorkingDirectory();
+    int percent = pattern.indexOfChar('%');
+
+    if (percent >= 0)
+    {
+        // Accept "%d" / "%05d" style fields
+        int end = percent + 1;
+        while (end < pattern.length() && juce::CharacterFunctions::isDigit(pattern[end]))
+            ++end;
+
+        if (end < pattern.length() && pattern[end] == 'd')
+        {
+            int width = pattern.substring(percent + 1, end).getIntValue();
+            auto number = juce::String(frameIndex).paddedLeft('0', width);
+            return cwd.getChildFile(pattern.substring(0, percent) + number + pattern.substring(end + 1));
+        }
+    }
+
+    auto base = cwd.getChildFile(pattern);
+    return base.getSiblingFile(base.getFileNameWithoutExtension() + "_"
+                               + juce::String(frameIndex).paddedLeft('0', 6)
+                               + base.getFileExtension());
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "FrameWriter.h"
+#include "../Core/WorkerPool.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class ImageSequenceWriter
+ * @brief Writes each frame to its own PNG or OpenEXR file
+ *
+ * The path may contain a printf-style integer field ("shot_%05d.png");
+ * otherwise a zero-padded frame number is appended to the file name.
+ * Missing parent directories are created.
+ *
+ * Frames are copied into a fixed pool of slots and compressed on a
+ * WorkerPool, several at once. A file thread writes the finished images
+ * strictly in frame order, so frame N on disk implies every earlier frame
+ * is there too. When every slot is busy, writeFrame() blocks; the time
+ * spent there is the backpressure figure in the stats.
+ */
+class ImageSequenceWriter : public FrameWriter
+{
+public:
+    enum class Format
+    {
+        PNG,
+        EXR
+    };
+
+    struct Stats
+    {
+        int64_t framesWritten = 0;
+        int64_t bytesWritten = 0;
+        double copyMs = 0.0;            // Caller thread, copying into a slot
+        double encodeMs = 0.0;          // Summed over workers
+        double ioMs = 0.0;              // File thread
+        double backpressureMs = 0.0;    // Caller thread, waiting for a free slot
+        int64_t backpressureStalls = 0;
+        int maxInFlight = 0;
+        int encoderThreads = 0;
+    };
+
+    /**
+     * @param compressionLevel zlib level 0-9, or -1 for the default
+     * @param numThreads Encoder threads; <= 0 picks from the core count
+     */
+    ImageSequenceWriter(const juce::String& pathPattern, Format format,
+                        int compressionLevel = -1, int numThreads = 0);
+    ~ImageSequenceWriter() override;
+
+    bool open(const StreamInfo& info) override;
+    bool writeFrame(const uint8_t* rgba, int64_t frameIndex) override;
+    bool close() override;
+
+    Stats getStats() const;
+    juce::String getStatsSummary() const override;
+
+    /**
+     * @brief Resolve the file for a frame index
+     */
+    juce::File getFileForFrame(int64_t frameIndex) const;
+
+private:
+    /** A frame's memory; vectors keep their capacity across frames */
+    struct Slot
+    {
+        enum class State { Free, Encoding, Encoded, Failed };
+
+        std::vector<uint8_t> pixels;
+        std::vector<uint8_t> encoded;
+        std::vector<uint8_t> scratch;
+        int64_t frameIndex = 0;
+        State state = State::Free;
+    };
+
+    void encodeSlot(Slot& slot);
+    void fileLoop();
+
+    juce::String pattern;
+    Format format;
+    int compressionLevel;
+    int numThreads;
+    StreamInfo info;
+    bool isOpen = false;
+
+    std::unique_ptr<WorkerPool> workers;
+    std::vector<std::unique_ptr<Slot>> slots;
+    std::deque<Slot*> freeSlots;
+    std::deque<Slot*> inFlight;     // Submission (= frame) order
+
+    std::thread fileThread;
+    mutable std::mutex mutex;
+    std::condition_variable slotFreed;
+    std::condition_variable slotEncoded;
+    bool closing = false;
+    bool failed = false;
+    juce::String failure;
+
+    Stats stats;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ImageSequenceWriter)
+};
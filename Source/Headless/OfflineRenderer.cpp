@@ -0,0 +1,295 @@
+#include "OfflineRenderer.h"
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+using namespace juce::gl;
+
+namespace
+{
+    double ticksToMs(juce::int64 ticks)
+    {
+        return juce::Time::highResolutionTicksToSeconds(ticks) * 1000.0;
+    }
+
+    FrameWriter::StreamInfo getStreamInfo(const OfflineRenderer::Settings& settings)
+    {
+        FrameWriter::StreamInfo info;
+        info.width = settings.width;
+        info.height = settings.height;
+        info.fpsNumerator = settings.fps;
+        info.fpsDenominator = 1;
+        return info;
+    }
+}
+
+OfflineRenderer::OfflineRenderer()
+{
+}
+
+OfflineRenderer::~OfflineRenderer()
+{
+}
+
+int64_t OfflineRenderer::getFrameCount(double seconds, int fps)
+{
+    return static_cast<int64_t>(std::ceil(seconds * fps - 1.0e-9));
+}
+
+bool OfflineRenderer::render(const MilkDropPreset& preset,
+                             AudioFeatureSource* audio,
+                             FrameWriter& writer,
+                             const Settings& settings,
+                             ProgressCallback progress)
+{
+    stats = {};
+
+    if (settings.width <= 0 || settings.height <= 0 || settings.fps <= 0)
+    {
+        lastError = "Invalid output size or frame rate";
+        return false;
+    }
+
+    if (settings.startFrame < 0 || settings.preRollFrames < 0)
+    {
+        lastError = "Invalid start frame or pre-roll";
+        return false;
+    }
+
+    int64_t totalFrames = settings.numFrames;
+    if (totalFrames <= 0 && audio != nullptr)
+        totalFrames = getFrameCount(audio->getLengthSeconds(), settings.fps) - settings.startFrame;
+
+    if (totalFrames <= 0)
+    {
+        lastError = "Nothing to render: give a frame count or an audio source";
+        return false;
+    }
+
+    if (settings.backend == RenderBackend::Type::Software)
+        return renderSoftware(preset, audio, writer, settings, totalFrames, progress);
+
+    // The renderer owns GL objects, so it lives exactly as long as this render
+    PresetRenderer renderer;
+    renderer.setViewportSize(settings.width, settings.height);
+    renderer.setFeedbackFormat(settings.feedbackFormat);
+    renderer.setDynamicResolutionEnabled(false);
+    renderer.initializeGL();
+
+    if (!renderer.loadPreset(preset))
+    {
+        lastError = "Failed to load preset: " + preset.name;
+        renderer.cleanupGL();
+        return false;
+    }
+
+    renderer.waitUntilResourcesReady();
+
+    // Composite into an offscreen RGBA8 target instead of a window
+    auto* output = renderer.getRenderTargetPool().acquire(RenderTargetFormat::RGBA8,
+                                                          settings.width, settings.height);
+    if (output == nullptr)
+    {
+        lastError = "Failed to create " + juce::String(settings.width) + "x"
+                  + juce::String(settings.height) + " output target";
+        renderer.cleanupGL();
+        return false;
+    }
+
+    renderer.setOutputFramebuffer(output->fbo);
+
+    if (!writer.open(getStreamInfo(settings)))
+    {
+        lastError = writer.getLastError();
+        renderer.cleanupGL();
+        return false;
+    }
+
+    // Readback goes through a PBO ring; a writer thread drains the frames
+    // so encoding overlaps rendering. Block rather than drop: offline
+    // output must contain every frame.
+    // Attached once the pre-roll is done, so the writer's frame 0 is startFrame
+    FrameCapture capture(4, 6, FrameCapture::DropPolicy::Block);
+
+    std::atomic<bool> renderFinished {false};
+    std::atomic<bool> writeFailed {false};
+    std::atomic<double> writeMs {0.0};
+    juce::String writeError;
+
+    std::thread writerThread([&]
+    {
+        for (;;)
+        {
+            auto* frame = capture.popFrame(50);
+            if (frame == nullptr)
+            {
+                if (renderFinished && capture.getNumPending() == 0)
+                    break;
+                continue;
+            }
+
+            // After a failure keep draining so the render thread never stalls
+            if (!writeFailed)
+            {
+                auto t0 = juce::Time::getHighResolutionTicks();
+
+                if (!writer.writeFrame(frame->pixels.data(), frame->sequence))
+                {
+                    writeError = "Frame " + juce::String(frame->sequence) + ": " + writer.getLastError();
+                    writeFailed = true;
+                }
+
+                writeMs = writeMs.load() + ticksToMs(juce::Time::getHighResolutionTicks() - t0);
+            }
+
+            capture.releaseFrame(frame);
+        }
+    });
+
+    const float dt = 1.0f / static_cast<float>(settings.fps);
+    const int64_t firstFrame = juce::jmax<int64_t>(0, settings.startFrame - settings.preRollFrames);
+    const int64_t endFrame = settings.startFrame + totalFrames;
+    const int64_t framesToRender = endFrame - firstFrame;
+    auto startTicks = juce::Time::getHighResolutionTicks();
+
+    for (int64_t frame = firstFrame; frame < endFrame && !writeFailed; ++frame)
+    {
+        auto t0 = juce::Time::getHighResolutionTicks();
+
+        if (frame == settings.startFrame)
+            renderer.setFrameCapture(&capture);
+
+        AudioFeatureSource::Features f;
+        if (audio != nullptr)
+            f = audio->getFeaturesAt(static_cast<double>(frame) / settings.fps);
+
+        renderer.setClock(frame, static_cast<double>(frame) / settings.fps);
+        renderer.beginFrame(dt);
+        renderer.renderPreset(f.bass, f.mid, f.treb, f.bassAtt, f.midAtt, f.trebAtt);
+        renderer.endFrame();
+
+        stats.renderMs += ticksToMs(juce::Time::getHighResolutionTicks() - t0);
+
+        if (frame < settings.startFrame)
+            stats.preRollFrames++;
+        else
+            stats.framesRendered++;
+
+        if (progress && !progress(frame - firstFrame + 1, framesToRender))
+            break;
+    }
+
+    // Deliver the readbacks still in flight, then let the writer finish
+    capture.flush();
+    renderFinished = true;
+    writerThread.join();
+
+    renderer.setFrameCapture(nullptr);
+    capture.cleanupGL();
+
+    stats.wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    stats.captureMs = capture.getStats().totalRenderThreadMs;
+    stats.writeMs = writeMs.load();
+
+    bool ok = !writeFailed;
+    if (!ok)
+        lastError = writeError;
+
+    if (!writer.close() && ok)
+    {
+        lastError = writer.getLastError();
+        ok = false;
+    }
+
+    renderer.setOutputFramebuffer(0);
+    renderer.getRenderTargetPool().release(output);
+    renderer.cleanupGL();
+
+    DBG("FlarkViz: Offline render " << stats.framesRendered << " frames in "
+        << juce::String(stats.wallSeconds, 2) << "s ("
+        << juce::String(stats.getRealtimeFactor(settings.fps), 2) << "x realtime)");
+
+    return ok;
+}
+
+bool OfflineRenderer::renderSoftware(const MilkDropPreset& preset,
+                                     AudioFeatureSource* audio,
+                                     FrameWriter& writer,
+                                     const Settings& settings,
+                                     int64_t totalFrames,
+                                     ProgressCallback progress)
+{
+    SoftwareRenderer renderer(settings.softwareThreads);
+    renderer.setViewportSize(settings.width, settings.height);
+    renderer.initialise();
+
+    if (!renderer.loadPreset(preset))
+    {
+        lastError = "Failed to load preset: " + preset.name;
+        return false;
+    }
+
+    if (!writer.open(getStreamInfo(settings)))
+    {
+        lastError = writer.getLastError();
+        return false;
+    }
+
+    const float dt = 1.0f / static_cast<float>(settings.fps);
+    const int64_t firstFrame = juce::jmax<int64_t>(0, settings.startFrame - settings.preRollFrames);
+    const int64_t endFrame = settings.startFrame + totalFrames;
+    const int64_t framesToRender = endFrame - firstFrame;
+    auto startTicks = juce::Time::getHighResolutionTicks();
+    bool ok = true;
+
+    for (int64_t frame = firstFrame; frame < endFrame; ++frame)
+    {
+        auto t0 = juce::Time::getHighResolutionTicks();
+
+        AudioFeatureSource::Features f;
+        if (audio != nullptr)
+            f = audio->getFeaturesAt(static_cast<double>(frame) / settings.fps);
+
+        renderer.setClock(frame, static_cast<double>(frame) / settings.fps);
+        renderer.beginFrame(dt);
+        renderer.renderPreset(f.bass, f.mid, f.treb, f.bassAtt, f.midAtt, f.trebAtt);
+        renderer.endFrame();
+
+        auto t1 = juce::Time::getHighResolutionTicks();
+        stats.renderMs += ticksToMs(t1 - t0);
+
+        if (frame < settings.startFrame)
+        {
+            stats.preRollFrames++;
+        }
+        else
+        {
+            if (!writer.writeFrame(renderer.getPixels(), frame - settings.startFrame))
+            {
+                lastError = "Frame " + juce::String(frame - settings.startFrame) + ": " + writer.getLastError();
+                ok = false;
+                break;
+            }
+
+            stats.writeMs += ticksToMs(juce::Time::getHighResolutionTicks() - t1);
+            stats.framesRendered++;
+        }
+
+        if (progress && !progress(frame - firstFrame + 1, framesToRender))
+            break;
+    }
+
+    stats.wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+
+    if (!writer.close() && ok)
+    {
+        lastError = writer.getLastError();
+        ok = false;
+    }
+
+    DBG("FlarkViz: Offline render (software) " << stats.framesRendered << " frames in "
+        << juce::String(stats.wallSeconds, 2) << "s ("
+        << juce::String(stats.getRealtimeFactor(settings.fps), 2) << "x realtime)");
+
+    return ok;
+}
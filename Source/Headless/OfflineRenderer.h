@@ -0,0 +1,112 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../Rendering/PresetRenderer.h"
+#include "../Rendering/SoftwareRenderer.h"
+#include "AudioFeatureSource.h"
+#include "FrameWriter.h"
+#include <functional>
+
+/**
+ * @class OfflineRenderer
+ * @brief Drives a RenderBackend with a fixed timestep instead of wall-clock time
+ *
+ * Frame N is rendered for time N / fps with the audio features sampled at
+ * that time, as fast as the GPU (or llvmpipe) allows. The preset clock is
+ * set from the frame number rather than accumulated, so a render can start
+ * part-way through a timeline (see Settings::startFrame) and still see the
+ * same times as one that started at frame 0. Frames are read back
+ * asynchronously through a FrameCapture and written by a separate thread,
+ * so the FrameWriter runs in parallel with rendering. Dynamic resolution
+ * is disabled and background resources are waited for, so the same inputs
+ * always produce the same frames.
+ *
+ * The OpenGL backend requires a current GL context (see HeadlessGLContext).
+ * The software backend needs none: each frame is composited on the CPU and
+ * handed straight to the FrameWriter, whose conversion already overlaps the
+ * next frame.
+ */
+class OfflineRenderer
+{
+public:
+    struct Settings
+    {
+        int width = 1920;
+        int height = 1080;
+        int fps = 60;
+
+        /** Number of frames to render; <= 0 renders the length of the audio */
+        int64_t numFrames = 0;
+
+        /** First frame to write; the writer sees it as frame index 0 */
+        int64_t startFrame = 0;
+
+        /**
+         * Frames rendered before startFrame but not written, so the feedback
+         * buffer, expression state and audio smoothing can converge to what a
+         * render from frame 0 would have at startFrame
+         */
+        int64_t preRollFrames = 0;
+
+        RenderTargetFormat feedbackFormat = RenderTargetFormat::RGBA16F;
+
+        RenderBackend::Type backend = RenderBackend::Type::OpenGL;
+
+        /** Software backend render threads; <= 0 uses hardware concurrency - 1 */
+        int softwareThreads = 0;
+    };
+
+    struct Stats
+    {
+        int64_t framesRendered = 0;     // Written frames, excluding pre-roll
+        int64_t preRollFrames = 0;
+        double wallSeconds = 0.0;
+        double renderMs = 0.0;      // Render thread: expressions, GL submission, capture
+        double captureMs = 0.0;     // Render thread share spent queueing readbacks
+        double writeMs = 0.0;       // Writer thread: conversion and I/O in the FrameWriter
+
+        /** Seconds of output produced per second of wall time */
+        double getRealtimeFactor(int fps) const
+        {
+            return wallSeconds > 0.0 ? (framesRendered / static_cast<double>(fps)) / wallSeconds : 0.0;
+        }
+    };
+
+    /** Called after each frame (pre-roll included); return false to stop early */
+    using ProgressCallback = std::function<bool(int64_t framesDone, int64_t totalFrames)>;
+
+    OfflineRenderer();
+    ~OfflineRenderer();
+
+    /**
+     * @brief Render a preset to a writer
+     * @param audio Feature source, or nullptr for silence (numFrames must then be set)
+     * @return false on failure (see getLastError)
+     */
+    bool render(const MilkDropPreset& preset,
+                AudioFeatureSource* audio,
+                FrameWriter& writer,
+                const Settings& settings,
+                ProgressCallback progress = nullptr);
+
+    const Stats& getStats() const { return stats; }
+    juce::String getLastError() const { return lastError; }
+
+    /**
+     * @brief Frame count for a duration at the given rate (rounded up)
+     */
+    static int64_t getFrameCount(double seconds, int fps);
+
+private:
+    bool renderSoftware(const MilkDropPreset& preset,
+                        AudioFeatureSource* audio,
+                        FrameWriter& writer,
+                        const Settings& settings,
+                        int64_t totalFrames,
+                        ProgressCallback progress);
+
+    Stats stats;
+    juce::String lastError;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OfflineRenderer)
+};
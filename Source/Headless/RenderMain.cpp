@@ -0,0 +1,440 @@
+/**
+ * flarkviz-render: headless offline renderer
+ *
+ * Renders a preset against an audio file or feature track with a fixed
+ * timestep, as fast as the machine allows, without a window or display
+ * server. Progress goes to stderr so stdout can carry a video stream:
+ *
+ *   flarkviz-render --preset a.milk --audio set.wav -o - | ffmpeg -i - -i set.wav out.mp4
+ *   flarkviz-render --preset a.milk --features set.csv --size 3840x2160 -o frames/%05d.png
+ *   flarkviz-render --preset a.milk --audio set.wav --shards 8 --preroll 10 -o set.y4m
+ *   flarkviz-render --preset a.milk --audio set.wav --renderer cpu -o set.y4m
+ *
+ * With --shards the process only coordinates: it runs itself once per
+ * segment with --segment and the internal --seam-head, --seam-tail and
+ * --progress-lines options, then joins the results (see ShardedRender).
+ */
+
+#include <JuceHeader.h>
+#include "HeadlessGLContext.h"
+#include "OfflineRenderer.h"
+#include "ShardedRender.h"
+#include "../Presets/PresetLoader.h"
+#include <iostream>
+#include <map>
+
+namespace
+{
+    void printUsage()
+    {
+        std::cerr <<
+            "Usage: flarkviz-render --preset <file.milk> [options] -o <output>\n"
+            "\n"
+            "Input:\n"
+            "  --audio <file>        Audio file to analyse (wav, flac, ogg, aiff, ...)\n"
+            "  --features <file.csv> Pre-computed features: time,bass,mid,treb[,bass_att,mid_att,treb_att]\n"
+            "\n"
+            "Output:\n"
+            "  -o, --output <path>   '-' or *.y4m (YUV4MPEG2), *.yuv (raw I420), *.nv12,\n"
+            "                        *.rgba/*.raw (raw RGBA),\n"
+            "                        *.png / *.exr (image sequence, e.g. frames/%05d.png)\n"
+            "  --size <WxH>          Output size (default 1920x1080)\n"
+            "  --fps <n>             Frame rate (default 60)\n"
+            "  --duration <seconds>  Length to render (default: length of the input)\n"
+            "  --frames <n>          Number of frames to render (overrides --duration)\n"
+            "  --feedback <format>   rgba8, rgba16f (default) or r11g11b10f\n"
+            "  --renderer <name>     opengl (default) or cpu: software rendering, no GL context needed\n"
+            "  --threads <n>         Conversion / compression threads (default: cores - 1)\n"
+            "  --compression <0-9>   PNG/EXR zlib level (default 6; 0 = uncompressed)\n"
+            "\n"
+            "Parallel rendering:\n"
+            "  --shards <n>          Split the timeline across n worker processes and join the output\n"
+            "  --segment <start:n>   Render only frames start..start+n-1 (e.g. on several machines)\n"
+            "  --preroll <seconds>   Rendered before each segment, not written, so feedback and\n"
+            "                        expression state match a full render (default 5)\n"
+            "  --seam-frames <n>     Frames compared at each seam (default 2)\n"
+            "  --seam-report <file>  Write per-frame seam error as CSV\n";
+    }
+
+    constexpr double defaultPreRollSeconds = 5.0;
+
+    bool parseSize(const juce::String& text, int& width, int& height)
+    {
+        auto w = text.upToFirstOccurrenceOf("x", false, true).getIntValue();
+        auto h = text.fromFirstOccurrenceOf("x", false, true).getIntValue();
+
+        if (w <= 0 || h <= 0)
+            return false;
+
+        width = w;
+        height = h;
+        return true;
+    }
+
+    /** "--name value" / "--name=value" pairs; a bare "-" is a value (stdout) */
+    struct Options
+    {
+        std::map<juce::String, juce::String> values;
+        juce::StringArray unknown;
+
+        bool contains(const juce::String& name) const { return values.count(name) > 0; }
+        juce::String get(const juce::String& name) const
+        {
+            auto it = values.find(name);
+            return it != values.end() ? it->second : juce::String();
+        }
+    };
+
+    Options parseOptions(int argc, char* argv[])
+    {
+        static const std::map<juce::String, juce::String> aliases = { { "-p", "--preset" },
+                                                                      { "-o", "--output" },
+                                                                      { "-h", "--help" } };
+        Options options;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            juce::String arg(argv[i]);
+            juce::String value;
+
+            if (arg.startsWith("--") && arg.containsChar('='))
+            {
+                value = arg.fromFirstOccurrenceOf("=", false, false);
+                arg = arg.upToFirstOccurrenceOf("=", false, false);
+            }
+            else if (i + 1 < argc && (argv[i + 1][0] != '-' || juce::String(argv[i + 1]) == "-"))
+            {
+                value = argv[++i];
+            }
+
+            auto alias = aliases.find(arg);
+            if (alias != aliases.end())
+                arg = alias->second;
+
+            if (!arg.startsWith("--"))
+                options.unknown.add(arg);
+            else
+                options.values[arg] = value;
+        }
+
+        return options;
+    }
+
+    int fail(const juce::String& message)
+    {
+        std::cerr << "flarkviz-render: " << message << std::endl;
+        return 1;
+    }
+
+    juce::String getAbsolutePath(const juce::String& path)
+    {
+        return juce::File::getCurrentWorkingDirectory().getChildFile(path).getFullPathName();
+    }
+
+    /** Coordinator for --shards: runs this executable once per segment */
+    int renderSharded(const Options& args, const OfflineRenderer::Settings& settings,
+                      int numShards, const juce::String& outputPath)
+    {
+        ShardedRender::Settings sharded;
+        sharded.numShards = numShards;
+        sharded.totalFrames = settings.numFrames;
+        sharded.fps = settings.fps;
+        sharded.width = settings.width;
+        sharded.height = settings.height;
+        sharded.outputPath = outputPath;
+
+        if (args.contains("--seam-frames"))
+            sharded.seamFrames = juce::jmax(0, args.get("--seam-frames").getIntValue());
+
+        auto audioOption = args.contains("--features") ? juce::String("--features") : juce::String("--audio");
+        auto audioPath = args.get(audioOption);
+
+        if (sharded.totalFrames <= 0)
+        {
+            juce::String error;
+            double length = AudioFeatureSource::getLengthOfFile(juce::File(getAbsolutePath(audioPath)), error);
+            if (length < 0.0)
+                return fail(error);
+
+            sharded.totalFrames = OfflineRenderer::getFrameCount(length, settings.fps);
+        }
+
+        // Workers share the machine, so split the writer threads between them
+        auto threads = args.contains("--threads")
+            ? args.get("--threads")
+            : juce::String(juce::jmax(1, (juce::SystemStats::getNumCpus() - 1) / numShards));
+
+        auto& workerArgs = sharded.workerArguments;
+        auto addOption = [&workerArgs](const juce::String& name, const juce::String& value)
+        {
+            workerArgs.add(name);
+            workerArgs.add(value);
+        };
+
+        addOption("--preset", getAbsolutePath(args.get("--preset")));
+        addOption("--size", juce::String(settings.width) + "x" + juce::String(settings.height));
+        addOption("--fps", juce::String(settings.fps));
+        addOption("--threads", threads);
+
+        if (audioPath.isNotEmpty())
+            addOption(audioOption, getAbsolutePath(audioPath));
+
+        for (auto option : { "--feedback", "--compression", "--preroll", "--renderer" })
+            if (args.contains(option))
+                addOption(option, args.get(option));
+
+        std::cerr << "flarkviz-render: " << sharded.totalFrames << " frames across "
+                  << numShards << " workers" << std::endl;
+
+        ShardedRender render;
+        auto startTicks = juce::Time::getHighResolutionTicks();
+
+        bool ok = render.run(sharded, [](int64_t done, int64_t total)
+        {
+            std::cerr << "\r  frame " << done << "/" << total << " (including pre-roll)" << std::flush;
+        });
+
+        std::cerr << std::endl;
+
+        if (!ok)
+            return fail(render.getLastError());
+
+        auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+        std::cerr << "flarkviz-render: " << sharded.totalFrames << " frames in " << juce::String(seconds, 2)
+                  << "s (" << juce::String(sharded.totalFrames / static_cast<double>(settings.fps) / seconds, 2)
+                  << "x realtime)" << std::endl;
+
+        auto seamSummary = render.getSeamSummary();
+        if (seamSummary.isNotEmpty())
+            std::cerr << "flarkviz-render: " << seamSummary << std::endl;
+
+        if (args.contains("--seam-report"))
+        {
+            juce::File report(getAbsolutePath(args.get("--seam-report")));
+            if (!render.writeSeamReport(report))
+                return fail("cannot write " + report.getFullPathName());
+        }
+
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    auto args = parseOptions(argc, argv);
+
+    if (args.contains("--help") || argc < 2)
+    {
+        printUsage();
+        return argc < 2 ? 1 : 0;
+    }
+
+    if (!args.unknown.isEmpty())
+        return fail("unexpected argument '" + args.unknown[0] + "'");
+
+    //==========================================================================
+    // Options
+    auto presetPath = args.get("--preset");
+    auto outputPath = args.get("--output");
+
+    if (presetPath.isEmpty() || outputPath.isEmpty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    OfflineRenderer::Settings settings;
+
+    if (args.contains("--size") && !parseSize(args.get("--size"), settings.width, settings.height))
+        return fail("--size must look like 1920x1080");
+
+    if (args.contains("--fps"))
+        settings.fps = args.get("--fps").getIntValue();
+
+    if (settings.fps <= 0)
+        return fail("--fps must be positive");
+
+    if (args.contains("--frames"))
+        settings.numFrames = args.get("--frames").getLargeIntValue();
+    else if (args.contains("--duration"))
+        settings.numFrames = OfflineRenderer::getFrameCount(args.get("--duration").getDoubleValue(),
+                                                            settings.fps);
+
+    int64_t preRollFrames = OfflineRenderer::getFrameCount(defaultPreRollSeconds, settings.fps);
+    if (args.contains("--preroll"))
+    {
+        auto seconds = args.get("--preroll").getDoubleValue();
+        if (seconds < 0.0)
+            return fail("--preroll must not be negative");
+
+        preRollFrames = OfflineRenderer::getFrameCount(seconds, settings.fps);
+    }
+
+    const int numShards = args.contains("--shards") ? args.get("--shards").getIntValue() : 1;
+    if (numShards < 1)
+        return fail("--shards must be at least 1");
+
+    // Worker side of --shards, or a manual split
+    const bool isSegment = args.contains("--segment");
+    int64_t segmentFrames = 0;
+    int seamFrames = 0;
+
+    if (isSegment)
+    {
+        auto range = args.get("--segment");
+        settings.startFrame = range.upToFirstOccurrenceOf(":", false, false).getLargeIntValue();
+        segmentFrames = range.fromFirstOccurrenceOf(":", false, false).getLargeIntValue();
+
+        if (!range.containsChar(':') || settings.startFrame < 0 || segmentFrames <= 0)
+            return fail("--segment must look like 3600:1800 (first frame:frame count)");
+
+        if (numShards > 1)
+            return fail("--segment and --shards cannot be combined");
+
+        seamFrames = juce::jmax(0, args.get("--seam-frames").getIntValue());
+        settings.preRollFrames = preRollFrames;
+
+        // The tail probe needs a few frames past the segment
+        settings.numFrames = segmentFrames + (args.contains("--seam-tail") ? seamFrames : 0);
+    }
+
+    if (args.contains("--feedback"))
+    {
+        auto format = args.get("--feedback").toLowerCase();
+
+        if (format == "rgba8")
+            settings.feedbackFormat = RenderTargetFormat::RGBA8;
+        else if (format == "rgba16f")
+            settings.feedbackFormat = RenderTargetFormat::RGBA16F;
+        else if (format == "r11g11b10f")
+            settings.feedbackFormat = RenderTargetFormat::R11G11B10F;
+        else
+            return fail("unknown feedback format '" + format + "'");
+    }
+
+    if (args.contains("--renderer") && !RenderBackend::parseType(args.get("--renderer"), settings.backend))
+        return fail("unknown renderer '" + args.get("--renderer") + "' (use opengl or cpu)");
+
+    //==========================================================================
+    // Inputs
+    PresetLoader loader;
+    auto preset = loader.loadPreset(juce::File::getCurrentWorkingDirectory().getChildFile(presetPath));
+    if (preset == nullptr)
+        return fail(loader.getLastError());
+
+    if (outputPath != "-")
+        outputPath = getAbsolutePath(outputPath);
+
+    if (numShards > 1)
+    {
+        if (settings.numFrames <= 0 && !args.contains("--audio") && !args.contains("--features"))
+            return fail("without --audio or --features, give --duration or --frames");
+
+        return renderSharded(args, settings, numShards, outputPath);
+    }
+
+    std::unique_ptr<AudioFeatureSource> audio;
+    auto audioPath = args.contains("--features") ? args.get("--features") : args.get("--audio");
+    if (audioPath.isNotEmpty())
+    {
+        // A segment only needs its own stretch of the audio, pre-roll included
+        juce::Range<double> neededSeconds;
+        if (isSegment)
+            neededSeconds = { static_cast<double>(juce::jmax<int64_t>(0, settings.startFrame - settings.preRollFrames)) / settings.fps,
+                              static_cast<double>(settings.startFrame + settings.numFrames) / settings.fps };
+
+        juce::String error;
+        audio = AudioFeatureSource::createForFile(juce::File(getAbsolutePath(audioPath)), error, neededSeconds);
+        if (audio == nullptr)
+            return fail(error);
+    }
+    else if (settings.numFrames <= 0)
+    {
+        return fail("without --audio or --features, give --duration or --frames");
+    }
+
+    FrameWriter::Options writerOptions;
+    writerOptions.numThreads = args.get("--threads").getIntValue();
+
+    if (args.contains("--compression"))
+    {
+        writerOptions.compressionLevel = args.get("--compression").getIntValue();
+        if (writerOptions.compressionLevel < 0 || writerOptions.compressionLevel > 9)
+            return fail("--compression must be 0-9");
+    }
+
+    auto writer = FrameWriter::createForPath(outputPath, writerOptions);
+    if (writer == nullptr)
+        return fail("unrecognised output type '" + outputPath + "'");
+
+    if (isSegment)
+    {
+        auto probeFile = [&args](const char* option)
+        {
+            return args.contains(option) ? juce::File(getAbsolutePath(args.get(option))) : juce::File();
+        };
+
+        writer = std::make_unique<SegmentWriter>(std::move(writer), settings.startFrame, segmentFrames,
+                                                 FrameWriter::isImageSequencePath(outputPath), seamFrames,
+                                                 probeFile("--seam-head"), probeFile("--seam-tail"));
+    }
+
+    //==========================================================================
+    // Render
+    HeadlessGLContext context;
+    if (settings.backend == RenderBackend::Type::OpenGL)
+    {
+        if (!context.create())
+            return fail("no headless OpenGL 3.3 context: " + context.getLastError()
+                        + " (--renderer cpu renders without one)");
+
+        std::cerr << "flarkviz-render: " << context.getDescription() << std::endl;
+    }
+    else
+    {
+        std::cerr << "flarkviz-render: software renderer" << std::endl;
+    }
+
+    OfflineRenderer renderer;
+    auto lastReport = juce::Time::getMillisecondCounter();
+    const bool progressLines = args.contains("--progress-lines");
+
+    bool ok = renderer.render(*preset, audio.get(), *writer, settings,
+        [&](int64_t done, int64_t total)
+        {
+            auto now = juce::Time::getMillisecondCounter();
+            if (now - lastReport >= (progressLines ? 250u : 1000u) || done == total)
+            {
+                lastReport = now;
+
+                // A --shards coordinator parses these
+                if (progressLines)
+                    std::cerr << "progress " << done << " " << total << std::endl;
+                else
+                    std::cerr << "\r  frame " << done << "/" << total << std::flush;
+            }
+            return true;
+        });
+
+    std::cerr << std::endl;
+
+    if (!ok)
+        return fail(renderer.getLastError());
+
+    const auto& stats = renderer.getStats();
+    auto perFrame = [&stats](double totalMs) { return stats.framesRendered > 0 ? totalMs / stats.framesRendered : 0.0; };
+
+    std::cerr << "flarkviz-render: " << stats.framesRendered << " frames in "
+              << juce::String(stats.wallSeconds, 2) << "s ("
+              << juce::String(stats.getRealtimeFactor(settings.fps), 2) << "x realtime; per frame "
+              << juce::String(perFrame(stats.renderMs), 2) << " ms render (of which "
+              << juce::String(perFrame(stats.captureMs), 2) << " ms capture), "
+              << juce::String(perFrame(stats.writeMs), 2) << " ms write)" << std::endl;
+
+    auto writerSummary = writer->getStatsSummary();
+    if (writerSummary.isNotEmpty())
+        std::cerr << "flarkviz-render: " << writerSummary << std::endl;
+
+    context.destroy();
+    return 0;
+}
@@ -0,0 +1,513 @@
+#include "ShardedRender.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+SegmentWriter::SegmentWriter(std::unique_ptr<FrameWriter> innerWriter, int64_t first, int64_t count,
+                             bool globalFrameIndices, int probes,
+                             const juce::File& headProbe, const juce::File& tailProbe)
+    : inner(std::move(innerWriter))
+    , firstFrame(first)
+    , numFrames(count)
+    , globalIndices(globalFrameIndices)
+    , probeFrames(juce::jmax(0, probes))
+    , headFile(headProbe)
+    , tailFile(tailProbe)
+{
+}
+
+std::unique_ptr<juce::FileOutputStream> SegmentWriter::openProbe(const juce::File& file)
+{
+    file.getParentDirectory().createDirectory();
+    file.deleteFile();  // FileOutputStream appends to existing files
+
+    auto stream = std::make_unique<juce::FileOutputStream>(file);
+    if (!stream->openedOk())
+    {
+        lastError = "Cannot open " + file.getFullPathName() + ": " + stream->getStatus().getErrorMessage();
+        return nullptr;
+    }
+
+    return stream;
+}
+
+bool SegmentWriter::open(const StreamInfo& info)
+{
+    frameBytes = static_cast<size_t>(info.width) * static_cast<size_t>(info.height) * 4;
+
+    if (!inner->open(info))
+    {
+        lastError = inner->getLastError();
+        return false;
+    }
+
+    if (probeFrames > 0 && headFile != juce::File() && (head = openProbe(headFile)) == nullptr)
+        return false;
+
+    if (probeFrames > 0 && tailFile != juce::File() && (tail = openProbe(tailFile)) == nullptr)
+        return false;
+
+    return true;
+}
+
+bool SegmentWriter::writeFrame(const uint8_t* rgba, int64_t frameIndex)
+{
+    if (frameIndex < numFrames)
+    {
+        if (!inner->writeFrame(rgba, globalIndices ? firstFrame + frameIndex : frameIndex))
+        {
+            lastError = inner->getLastError();
+            return false;
+        }
+
+        if (head != nullptr && frameIndex < probeFrames && !head->write(rgba, frameBytes))
+        {
+            lastError = "Failed to write " + headFile.getFullPathName();
+            return false;
+        }
+    }
+    else if (tail != nullptr && frameIndex - numFrames < probeFrames && !tail->write(rgba, frameBytes))
+    {
+        lastError = "Failed to write " + tailFile.getFullPathName();
+        return false;
+    }
+
+    return true;
+}
+
+bool SegmentWriter::close()
+{
+    bool ok = inner->close();
+    if (!ok)
+        lastError = inner->getLastError();
+
+    for (auto* probe : { &head, &tail })
+    {
+        if (*probe == nullptr)
+            continue;
+
+        (*probe)->flush();
+        if ((*probe)->getStatus().failed() && ok)
+        {
+            lastError = "Failed to write seam probe: " + (*probe)->getStatus().getErrorMessage();
+            ok = false;
+        }
+
+        probe->reset();
+    }
+
+    return ok;
+}
+
+//==============================================================================
+struct ShardedRender::Worker
+{
+    juce::ChildProcess process;
+    std::thread reader;
+    std::atomic<int64_t> framesDone {0};
+    std::atomic<int64_t> framesTotal {0};
+
+    std::mutex mutex;
+    juce::String lastMessage;   // Last non-progress line, reported if the worker fails
+
+    /** Worker stderr: "progress <done> <total>" lines, anything else is kept as a message */
+    void readOutput()
+    {
+        std::string pending;
+        char buffer[4096];
+
+        for (;;)
+        {
+            int numRead = process.readProcessOutput(buffer, static_cast<int>(sizeof(buffer)));
+            if (numRead <= 0)
+                break;
+
+            pending.append(buffer, static_cast<size_t>(numRead));
+
+            for (auto newline = pending.find('\n'); newline != std::string::npos; newline = pending.find('\n'))
+            {
+                auto line = juce::String(pending.substr(0, newline)).trim();
+                pending.erase(0, newline + 1);
+
+                if (line.startsWith("progress "))
+                {
+                    auto fields = juce::StringArray::fromTokens(line, " ", "");
+                    framesDone = fields[1].getLargeIntValue();
+                    framesTotal = fields[2].getLargeIntValue();
+                }
+                else if (line.isNotEmpty())
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    lastMessage = line.fromFirstOccurrenceOf("flarkviz-render: ", false, false);
+                    if (lastMessage.isEmpty())
+                        lastMessage = line;
+                }
+            }
+        }
+    }
+};
+
+//==============================================================================
+std::vector<ShardedRender::Segment> ShardedRender::planSegments(int64_t totalFrames, int numShards)
+{
+    std::vector<Segment> result;
+    if (totalFrames <= 0)
+        return result;
+
+    const int64_t count = juce::jlimit<int64_t>(1, totalFrames, numShards);
+
+    for (int64_t i = 0; i < count; ++i)
+    {
+        Segment segment;
+        segment.startFrame = totalFrames * i / count;
+        segment.numFrames = totalFrames * (i + 1) / count - segment.startFrame;
+        result.push_back(segment);
+    }
+
+    return result;
+}
+
+ShardedRender::SeamError ShardedRender::compareFrames(const uint8_t* reference, const uint8_t* shard,
+                                                      int width, int height)
+{
+    const size_t numPixels = static_cast<size_t>(width) * static_cast<size_t>(height);
+    uint64_t sumAbs = 0;
+    uint64_t sumSquared = 0;
+    uint64_t visible = 0;
+    int maxAbs = 0;
+
+    // Alpha is always opaque; only colour can show a seam
+    for (size_t i = 0; i < numPixels; ++i)
+    {
+        int pixelMax = 0;
+
+        for (size_t c = 0; c < 3; ++c)
+        {
+            int diff = std::abs(static_cast<int>(reference[i * 4 + c]) - static_cast<int>(shard[i * 4 + c]));
+            sumAbs += static_cast<uint64_t>(diff);
+            sumSquared += static_cast<uint64_t>(diff * diff);
+            pixelMax = juce::jmax(pixelMax, diff);
+        }
+
+        maxAbs = juce::jmax(maxAbs, pixelMax);
+        if (pixelMax > visibleThreshold)
+            visible++;
+    }
+
+    SeamError error;
+    const double numSamples = static_cast<double>(juce::jmax<size_t>(1, numPixels * 3));
+    const double mse = static_cast<double>(sumSquared) / numSamples;
+
+    error.meanAbsError = static_cast<double>(sumAbs) / numSamples;
+    error.maxAbsError = maxAbs;
+    error.psnr = mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : std::numeric_limits<double>::infinity();
+    error.visibleFraction = static_cast<double>(visible) / static_cast<double>(juce::jmax<size_t>(1, numPixels));
+    return error;
+}
+
+//==============================================================================
+bool ShardedRender::run(const Settings& newSettings, ProgressCallback progress)
+{
+    settings = newSettings;
+    seamErrors.clear();
+    lastError = {};
+    segments = planSegments(settings.totalFrames, settings.numShards);
+
+    if (segments.empty() || settings.width <= 0 || settings.height <= 0)
+    {
+        lastError = "Nothing to render";
+        return false;
+    }
+
+    // Every seam needs its probe frames inside both neighbouring segments
+    int64_t seamFrames = settings.seamFrames;
+    for (const auto& segment : segments)
+        seamFrames = juce::jmin(seamFrames, segment.numFrames);
+
+    const bool toStdout = settings.outputPath == "-";
+    const bool imageSequence = FrameWriter::isImageSequencePath(settings.outputPath);
+    const juce::File output = toStdout ? juce::File() : juce::File(settings.outputPath);
+
+    // Segment files sit next to the output so concatenation can move the first one into place
+    auto workDir = toStdout
+        ? juce::File::getSpecialLocation(juce::File::tempDirectory)
+              .getNonexistentChildFile("flarkviz-render-segments", "", false)
+        : output.getParentDirectory().getNonexistentChildFile("." + output.getFileNameWithoutExtension()
+                                                              + ".segments", "", false);
+
+    if (!workDir.createDirectory())
+    {
+        lastError = "Cannot create " + workDir.getFullPathName();
+        return false;
+    }
+
+    const auto extension = toStdout ? juce::String(".y4m") : output.getFileExtension();
+    const auto executable = juce::File::getSpecialLocation(juce::File::currentExecutableFile).getFullPathName();
+    const int numSegments = static_cast<int>(segments.size());
+
+    std::vector<juce::File> parts;
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    auto seamFile = [&](int seam, const char* side)
+    {
+        return workDir.getChildFile("seam_" + juce::String(seam) + "_" + side + ".rgba");
+    };
+
+    //==========================================================================
+    // Start one worker per segment
+    for (int i = 0; i < numSegments && lastError.isEmpty(); ++i)
+    {
+        const auto& segment = segments[static_cast<size_t>(i)];
+        parts.push_back(workDir.getChildFile("segment_" + juce::String(i) + extension));
+
+        juce::StringArray args;
+        args.add(executable);
+        args.addArray(settings.workerArguments);
+        args.add("--segment");
+        args.add(juce::String(segment.startFrame) + ":" + juce::String(segment.numFrames));
+        args.add("--seam-frames");
+        args.add(juce::String(seamFrames));
+
+        if (i > 0)
+        {
+            args.add("--seam-head");
+            args.add(seamFile(i - 1, "segment").getFullPathName());
+        }
+
+        if (i < numSegments - 1)
+        {
+            args.add("--seam-tail");
+            args.add(seamFile(i, "reference").getFullPathName());
+        }
+
+        args.add("--progress-lines");
+        args.add("--output");
+        args.add(imageSequence ? settings.outputPath : parts.back().getFullPathName());
+
+        auto worker = std::make_unique<Worker>();
+        if (!worker->process.start(args, juce::ChildProcess::wantStdErr))
+        {
+            lastError = "Failed to start worker for segment " + juce::String(i);
+            break;
+        }
+
+        auto* w = worker.get();
+        worker->reader = std::thread([w] { w->readOutput(); });
+        workers.push_back(std::move(worker));
+    }
+
+    DBG("FlarkViz: Rendering " << settings.totalFrames << " frames in " << numSegments
+        << " segments, " << seamFrames << " seam frames");
+
+    //==========================================================================
+    // Wait, reporting combined progress; stop everything on the first failure
+    for (;;)
+    {
+        bool running = false;
+
+        for (size_t i = 0; i < workers.size(); ++i)
+        {
+            auto& worker = *workers[i];
+
+            if (worker.process.isRunning())
+            {
+                running = true;
+            }
+            else if (worker.process.getExitCode() != 0 && lastError.isEmpty())
+            {
+                const auto& segment = segments[i];
+                std::lock_guard<std::mutex> lock(worker.mutex);
+                lastError = "Segment " + juce::String(static_cast<int>(i)) + " (frames "
+                          + juce::String(segment.startFrame) + "-"
+                          + juce::String(segment.startFrame + segment.numFrames - 1) + ") failed: "
+                          + (worker.lastMessage.isNotEmpty() ? worker.lastMessage : juce::String("no output"));
+            }
+        }
+
+        if (lastError.isNotEmpty())
+        {
+            for (auto& worker : workers)
+                worker->process.kill();
+        }
+
+        if (progress)
+        {
+            int64_t done = 0, total = 0;
+            for (auto& worker : workers)
+            {
+                done += worker->framesDone.load();
+                total += worker->framesTotal.load();
+            }
+
+            if (total > 0)
+                progress(done, total);
+        }
+
+        if (!running)
+            break;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    }
+
+    for (auto& worker : workers)
+    {
+        worker->process.waitForProcessToFinish(-1);
+        if (worker->reader.joinable())
+            worker->reader.join();
+    }
+
+    //==========================================================================
+    // Seams first (the probes live in workDir), then join the segments
+    bool ok = lastError.isEmpty()
+           && measureSeams(workDir, numSegments - 1, seamFrames)
+           && (imageSequence || concatenate(parts, extension.equalsIgnoreCase(".y4m")));
+
+    workDir.deleteRecursively();
+    return ok;
+}
+
+//==============================================================================
+bool ShardedRender::measureSeams(const juce::File& workDir, int numSeams, int64_t seamFrameCount)
+{
+    const size_t frameBytes = static_cast<size_t>(settings.width) * static_cast<size_t>(settings.height) * 4;
+    std::vector<uint8_t> reference(frameBytes), shard(frameBytes);
+
+    for (int seam = 0; seam < numSeams; ++seam)
+    {
+        auto referenceFile = workDir.getChildFile("seam_" + juce::String(seam) + "_reference.rgba");
+        auto shardFile = workDir.getChildFile("seam_" + juce::String(seam) + "_segment.rgba");
+
+        juce::FileInputStream referenceStream(referenceFile);
+        juce::FileInputStream shardStream(shardFile);
+
+        for (int64_t i = 0; i < seamFrameCount; ++i)
+        {
+            if (referenceStream.read(reference.data(), static_cast<int>(frameBytes)) != static_cast<int>(frameBytes)
+                || shardStream.read(shard.data(), static_cast<int>(frameBytes)) != static_cast<int>(frameBytes))
+            {
+                lastError = "Seam probes for seam " + juce::String(seam) + " are incomplete";
+                return false;
+            }
+
+            auto error = compareFrames(reference.data(), shard.data(), settings.width, settings.height);
+            error.seam = seam;
+            error.frame = segments[static_cast<size_t>(seam) + 1].startFrame + i;
+            seamErrors.push_back(error);
+        }
+    }
+
+    return true;
+}
+
+bool ShardedRender::concatenate(const std::vector<juce::File>& parts, bool skipY4MHeaders)
+{
+    const bool toStdout = settings.outputPath == "-";
+    std::unique_ptr<juce::FileOutputStream> fileStream;
+    size_t firstToCopy = 0;
+
+    if (!toStdout)
+    {
+        // The first segment becomes the output; the rest are appended to it
+        juce::File output(settings.outputPath);
+        output.deleteFile();
+
+        if (parts.front().moveFileTo(output))
+            firstToCopy = 1;
+
+        fileStream = std::make_unique<juce::FileOutputStream>(output, 1 << 20);
+        if (!fileStream->openedOk())
+        {
+            lastError = "Cannot open " + settings.outputPath + ": " + fileStream->getStatus().getErrorMessage();
+            return false;
+        }
+    }
+
+    auto write = [&](const void* data, size_t numBytes)
+    {
+        return toStdout ? std::fwrite(data, 1, numBytes, stdout) == numBytes
+                        : fileStream->write(data, numBytes);
+    };
+
+    std::vector<char> buffer(1 << 22);
+
+    for (size_t i = firstToCopy; i < parts.size(); ++i)
+    {
+        juce::FileInputStream input(parts[i]);
+        if (input.failedToOpen())
+        {
+            lastError = "Missing segment output " + parts[i].getFullPathName();
+            return false;
+        }
+
+        // Every segment starts with the same stream header; keep only the first
+        if (skipY4MHeaders && i > 0)
+            input.readNextLine();
+
+        for (;;)
+        {
+            int numRead = input.read(buffer.data(), static_cast<int>(buffer.size()));
+            if (numRead <= 0)
+                break;
+
+            if (!write(buffer.data(), static_cast<size_t>(numRead)))
+            {
+                lastError = "Write failed while joining segments (disk full or closed pipe?)";
+                return false;
+            }
+        }
+
+        // Free the space as we go; all segments together are as large as the output
+        parts[i].deleteFile();
+    }
+
+    if (toStdout)
+        std::fflush(stdout);
+    else
+        fileStream->flush();
+
+    return true;
+}
+
+//==============================================================================
+juce::String ShardedRender::getSeamSummary() const
+{
+    if (seamErrors.empty())
+        return {};
+
+    const auto* worst = &seamErrors.front();
+    for (const auto& error : seamErrors)
+        if (error.meanAbsError > worst->meanAbsError)
+            worst = &error;
+
+    juce::String summary;
+    summary << (seamErrors.back().seam + 1) << " seams; worst at frame " << worst->frame
+            << ": mean error " << juce::String(worst->meanAbsError, 3) << "/255, max " << worst->maxAbsError
+            << ", PSNR " << (std::isinf(worst->psnr) ? juce::String("inf") : juce::String(worst->psnr, 1))
+            << " dB, " << juce::String(worst->visibleFraction * 100.0, 2) << "% of pixels visibly different";
+
+    if (worst->visibleFraction > 0.001)
+        summary << " (try a longer --preroll)";
+
+    return summary;
+}
+
+bool ShardedRender::writeSeamReport(const juce::File& csvFile) const
+{
+    juce::String text = "seam,frame,mean_abs_error,max_abs_error,psnr_db,visible_fraction\n";
+
+    for (const auto& error : seamErrors)
+    {
+        text << error.seam << "," << error.frame << ","
+             << juce::String(error.meanAbsError, 4) << "," << error.maxAbsError << ","
+             << (std::isinf(error.psnr) ? juce::String("inf") : juce::String(error.psnr, 2)) << ","
+             << juce::String(error.visibleFraction, 6) << "\n";
+    }
+
+    csvFile.getParentDirectory().createDirectory();
+    return csvFile.replaceWithText(text);
+}
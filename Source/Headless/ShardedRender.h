@@ -0,0 +1,149 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "FrameWriter.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * @class SegmentWriter
+ * @brief Writer used by a flarkviz-render process that renders one segment
+ *
+ * Passes the segment's frames on to the real writer - renumbered to the
+ * global frame index for image sequences, so every segment's files land
+ * under their final names - and copies the frames either side of each seam
+ * into raw RGBA probe files for ShardedRender to compare:
+ *
+ *   head probe: the segment's first probeFrames frames (rendered after pre-roll)
+ *   tail probe: probeFrames extra frames past the segment's end, i.e. the
+ *               next segment's head as a continuous render produces it
+ */
+class SegmentWriter : public FrameWriter
+{
+public:
+    /**
+     * @param firstFrame Global index of the segment's first frame
+     * @param numFrames Frames in the segment; later frames only go to the tail probe
+     * @param globalFrameIndices Number frames from firstFrame (image sequences) rather than 0
+     * @param headProbe / tailProbe Raw RGBA files, or File() for none
+     */
+    SegmentWriter(std::unique_ptr<FrameWriter> inner, int64_t firstFrame, int64_t numFrames,
+                  bool globalFrameIndices, int probeFrames,
+                  const juce::File& headProbe, const juce::File& tailProbe);
+
+    bool open(const StreamInfo& info) override;
+    bool writeFrame(const uint8_t* rgba, int64_t frameIndex) override;
+    bool close() override;
+    juce::String getStatsSummary() const override { return inner->getStatsSummary(); }
+
+private:
+    std::unique_ptr<juce::FileOutputStream> openProbe(const juce::File& file);
+
+    std::unique_ptr<FrameWriter> inner;
+    const int64_t firstFrame;
+    const int64_t numFrames;
+    const bool globalIndices;
+    const int probeFrames;
+    juce::File headFile, tailFile;
+    std::unique_ptr<juce::FileOutputStream> head, tail;
+    size_t frameBytes = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SegmentWriter)
+};
+
+//==============================================================================
+/**
+ * @class ShardedRender
+ * @brief Splits an offline render across flarkviz-render worker processes
+ *
+ * The timeline is cut into one contiguous segment per worker. Each worker
+ * is this executable again, run with --segment: it starts rendering
+ * preRollFrames before its segment so the feedback loop and expression
+ * state converge, writes only the segment, then renders seamFrames more so
+ * the next segment's first frames can be checked against a continuous
+ * render. Video streams are written to one file per segment and
+ * concatenated in order afterwards; image sequences are written in place.
+ *
+ * Every process needs its own GL context, so on a single GPU the speed-up
+ * comes from overlapping the CPU-side work (expressions, readback,
+ * conversion, compression); with llvmpipe it scales with the cores.
+ */
+class ShardedRender
+{
+public:
+    struct Settings
+    {
+        int numShards = 2;
+        int64_t totalFrames = 0;
+        int fps = 60;
+        int width = 0;
+        int height = 0;
+        int seamFrames = 2;
+
+        /** Output as given to flarkviz-render ("-" = stdout) */
+        juce::String outputPath;
+
+        /** Options every worker gets unchanged (preset, audio, size, --preroll, ...) */
+        juce::StringArray workerArguments;
+    };
+
+    struct Segment
+    {
+        int64_t startFrame = 0;
+        int64_t numFrames = 0;
+    };
+
+    /** Difference between a segment's first frames and a continuous render */
+    struct SeamError
+    {
+        int seam = 0;                   // Between segment `seam` and `seam + 1`
+        int64_t frame = 0;              // Global frame index
+        double meanAbsError = 0.0;      // Per channel, 0-255
+        int maxAbsError = 0;
+        double psnr = 0.0;              // dB; infinity when identical
+        double visibleFraction = 0.0;   // Pixels with a channel off by more than visibleThreshold
+    };
+
+    static constexpr int visibleThreshold = 3;
+
+    /** Called from the coordinating thread about twice a second */
+    using ProgressCallback = std::function<void(int64_t framesDone, int64_t totalFrames)>;
+
+    ShardedRender() = default;
+
+    /**
+     * @brief Run the workers, concatenate their output and measure the seams
+     * @return false on failure (see getLastError); worker output is cleaned up
+     */
+    bool run(const Settings& settings, ProgressCallback progress = nullptr);
+
+    const std::vector<SeamError>& getSeamErrors() const { return seamErrors; }
+
+    /** One-line summary of the worst seam, for the log */
+    juce::String getSeamSummary() const;
+
+    /** seam,frame,mean_abs_error,max_abs_error,psnr_db,visible_fraction */
+    bool writeSeamReport(const juce::File& csvFile) const;
+
+    juce::String getLastError() const { return lastError; }
+
+    //==========================================================================
+    /** Contiguous, near-equal segments covering [0, totalFrames) */
+    static std::vector<Segment> planSegments(int64_t totalFrames, int numShards);
+
+    static SeamError compareFrames(const uint8_t* reference, const uint8_t* shard, int width, int height);
+
+private:
+    struct Worker;
+
+    bool concatenate(const std::vector<juce::File>& parts, bool skipY4MHeaders);
+    bool measureSeams(const juce::File& workDir, int numSeams, int64_t seamFrameCount);
+
+    Settings settings;
+    std::vector<Segment> segments;
+    std::vector<SeamError> seamErrors;
+    juce::String lastError;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ShardedRender)
+};
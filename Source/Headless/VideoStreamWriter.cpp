@@ -0,0 +1,355 @@
+#include "VideoStreamWriter.h"
+#include "ColorConversion.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    /** Unbuffered-by-JUCE stream on stdout (FileOutputStream needs a seekable file) */
+    class StdoutOutputStream : public juce::OutputStream
+    {
+    public:
+        void flush() override { std::fflush(stdout); }
+        bool setPosition(juce::int64) override { return false; }
+        juce::int64 getPosition() override { return position; }
+
+        bool write(const void* data, size_t numBytes) override
+        {
+            if (std::fwrite(data, 1, numBytes, stdout) != numBytes)
+                return false;
+
+            position += static_cast<juce::int64>(numBytes);
+            return true;
+        }
+
+    private:
+        juce::int64 position = 0;
+    };
+
+    double ticksToMs(juce::int64 ticks)
+    {
+        return juce::Time::highResolutionTicksToSeconds(ticks) * 1000.0;
+    }
+
+    const char* getFormatName(VideoStreamWriter::Format format)
+    {
+        switch (format)
+        {
+            case VideoStreamWriter::Format::Y4M:     return "y4m";
+            case VideoStreamWriter::Format::RawI420: return "i420";
+            case VideoStreamWriter::Format::RawNV12: return "nv12";
+            case VideoStreamWriter::Format::RawRGBA: return "rgba";
+        }
+        return "";
+    }
+}
+
+VideoStreamWriter::VideoStreamWriter(const juce::String& outputPath, Format outputFormat,
+                                     int conversionThreads, int outputBuffers)
+    : path(outputPath)
+    , format(outputFormat)
+    , numThreads(conversionThreads)
+    , numBuffers(std::max(1, outputBuffers))
+{
+}
+
+VideoStreamWriter::~VideoStreamWriter()
+{
+    close();
+}
+
+bool VideoStreamWriter::open(const StreamInfo& streamInfo)
+{
+    info = streamInfo;
+
+    if (path == "-")
+    {
+        stream = std::make_unique<StdoutOutputStream>();
+    }
+    else
+    {
+        juce::File file(path);
+        file.getParentDirectory().createDirectory();
+        file.deleteFile();  // FileOutputStream appends to existing files
+
+        // Whole frames are larger than the buffer, so they bypass it and
+        // go to the file in one write each
+        auto fileStream = std::make_unique<juce::FileOutputStream>(file, 1 << 20);
+        if (!fileStream->openedOk())
+        {
+            lastError = "Cannot open " + path + ": " + fileStream->getStatus().getErrorMessage();
+            return false;
+        }
+        stream = std::move(fileStream);
+    }
+
+    static const char frameHeader[] = "FRAME\n";
+    headerSize = 0;
+
+    if (format == Format::Y4M)
+    {
+        // C420jpeg would be full range; plain 420 with limited range is the common default
+        juce::String header;
+        header << "YUV4MPEG2 W" << info.width << " H" << info.height
+               << " F" << info.fpsNumerator << ":" << info.fpsDenominator
+               << " Ip A1:1 C420 XCOLORRANGE=LIMITED\n";
+
+        if (!stream->write(header.toRawUTF8(), header.getNumBytesAsUTF8()))
+        {
+            lastError = "Failed to write Y4M header";
+            return false;
+        }
+
+        headerSize = sizeof(frameHeader) - 1;
+    }
+
+    size_t frameSize = format == Format::RawRGBA
+        ? static_cast<size_t>(info.width) * static_cast<size_t>(info.height) * 4
+        : static_cast<size_t>(ColorConversion::getYUV420Size(info.width, info.height));
+
+    buffers.clear();
+    freeBuffers.clear();
+    queuedBuffers.clear();
+
+    for (int i = 0; i < numBuffers; ++i)
+    {
+        auto buffer = std::make_unique<Buffer>();
+        buffer->data.resize(headerSize + frameSize);
+        std::memcpy(buffer->data.data(), frameHeader, headerSize);
+
+        freeBuffers.push_back(buffer.get());
+        buffers.push_back(std::move(buffer));
+    }
+
+    workers = std::make_unique<WorkerPool>(numThreads);
+    stats = {};
+    nextFrameIndex = 0;
+    closing = false;
+    ioFailed = false;
+
+    ioThread = std::thread([this] { ioLoop(); });
+
+    DBG("FlarkViz: Video writer " << getFormatName(format) << " " << info.width << "x" << info.height
+        << ", " << (workers->getNumThreads() + 1) << " conversion threads"
+        << (ColorConversion::isAccelerated() ? " (AVX2)" : ""));
+
+    return true;
+}
+
+bool VideoStreamWriter::writeFrame(const uint8_t* rgba, int64_t frameIndex)
+{
+    if (stream == nullptr)
+    {
+        lastError = "Stream is not open";
+        return false;
+    }
+
+    // The stream has no timestamps, so it can only go forwards
+    if (frameIndex < nextFrameIndex)
+    {
+        lastError = "Frame " + juce::String(frameIndex) + " arrived after frame "
+                  + juce::String(nextFrameIndex - 1);
+        return false;
+    }
+
+    Buffer* buffer = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        if (freeBuffers.empty() && !ioFailed)
+        {
+            auto t0 = juce::Time::getHighResolutionTicks();
+            bufferFreed.wait(lock, [this] { return !freeBuffers.empty() || ioFailed; });
+
+            stats.backpressureMs += ticksToMs(juce::Time::getHighResolutionTicks() - t0);
+            stats.backpressureStalls++;
+        }
+
+        if (ioFailed)
+        {
+            lastError = "Write failed (disk full or closed pipe?)";
+            return false;
+        }
+
+        buffer = freeBuffers.front();
+        freeBuffers.pop_front();
+    }
+
+    auto t0 = juce::Time::getHighResolutionTicks();
+    convertFrame(rgba, *buffer);
+    double convertMs = ticksToMs(juce::Time::getHighResolutionTicks() - t0);
+
+    buffer->frameIndex = frameIndex;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        stats.convertMs += convertMs;
+        stats.framesSkipped += frameIndex - nextFrameIndex;
+
+        queuedBuffers.push_back(buffer);
+        stats.maxQueueDepth = std::max(stats.maxQueueDepth, static_cast<int>(queuedBuffers.size()));
+    }
+    bufferQueued.notify_one();
+
+    nextFrameIndex = frameIndex + 1;
+    return true;
+}
+
+void VideoStreamWriter::convertFrame(const uint8_t* rgba, Buffer& buffer)
+{
+    const int width = info.width;
+    const int height = info.height;
+    uint8_t* out = buffer.data.data() + headerSize;
+
+    // A few bands per thread evens out uneven scheduling; bands start on
+    // even rows so each one owns whole chroma rows
+    const int numBands = std::min((height + 1) / 2, (workers->getNumThreads() + 1) * 4);
+    const int rowsPerBand = ((height + numBands - 1) / numBands + 1) & ~1;
+    const int bandCount = (height + rowsPerBand - 1) / rowsPerBand;
+
+    const size_t lumaSize = static_cast<size_t>(width) * static_cast<size_t>(height);
+    const size_t chromaSize = static_cast<size_t>((width + 1) / 2) * static_cast<size_t>((height + 1) / 2);
+
+    workers->parallelFor(bandCount, [&](int band)
+    {
+        int rowBegin = band * rowsPerBand;
+        int rowEnd = std::min(height, rowBegin + rowsPerBand);
+
+        switch (format)
+        {
+            case Format::Y4M:
+            case Format::RawI420:
+                ColorConversion::rgbaToI420Rows(rgba, width, height, rowBegin, rowEnd,
+                                                out, out + lumaSize, out + lumaSize + chromaSize);
+                break;
+
+            case Format::RawNV12:
+                ColorConversion::rgbaToNV12Rows(rgba, width, height, rowBegin, rowEnd,
+                                                out, out + lumaSize);
+                break;
+
+            case Format::RawRGBA:
+            {
+                // Still copied: the caller's pixels are only valid during writeFrame()
+                size_t stride = static_cast<size_t>(width) * 4;
+                std::memcpy(out + static_cast<size_t>(rowBegin) * stride,
+                            rgba + static_cast<size_t>(rowBegin) * stride,
+                            static_cast<size_t>(rowEnd - rowBegin) * stride);
+                break;
+            }
+        }
+    });
+}
+
+void VideoStreamWriter::ioLoop()
+{
+    for (;;)
+    {
+        Buffer* buffer = nullptr;
+        bool skipWrite = false;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            bufferQueued.wait(lock, [this] { return closing || !queuedBuffers.empty(); });
+
+            if (queuedBuffers.empty())
+                return;
+
+            buffer = queuedBuffers.front();
+            queuedBuffers.pop_front();
+            skipWrite = ioFailed;
+        }
+
+        // After a failure keep recycling buffers so writeFrame() never waits forever
+        bool ok = true;
+        double ioMs = 0.0;
+        if (!skipWrite)
+        {
+            auto t0 = juce::Time::getHighResolutionTicks();
+            ok = stream->write(buffer->data.data(), buffer->data.size());
+            ioMs = ticksToMs(juce::Time::getHighResolutionTicks() - t0);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (!skipWrite)
+            {
+                stats.ioMs += ioMs;
+                if (ok)
+                {
+                    stats.framesWritten++;
+                    stats.bytesWritten += static_cast<int64_t>(buffer->data.size());
+                }
+                else
+                {
+                    ioFailed = true;
+                }
+            }
+
+            freeBuffers.push_back(buffer);
+        }
+        bufferFreed.notify_one();
+    }
+}
+
+bool VideoStreamWriter::close()
+{
+    if (stream == nullptr)
+        return false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closing = true;
+    }
+    bufferQueued.notify_all();
+
+    if (ioThread.joinable())
+        ioThread.join();
+
+    stream->flush();
+
+    bool ok = !ioFailed;
+    if (!ok)
+        lastError = "Write failed (disk full or closed pipe?)";
+
+    if (auto* fileStream = dynamic_cast<juce::FileOutputStream*>(stream.get()))
+        ok = ok && !fileStream->getStatus().failed();
+
+    stream.reset();
+    workers.reset();
+    freeBuffers.clear();
+    buffers.clear();
+
+    if (stats.framesSkipped > 0)
+        DBG("FlarkViz: Video writer skipped " << stats.framesSkipped << " missing frames");
+
+    return ok;
+}
+
+VideoStreamWriter::Stats VideoStreamWriter::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+juce::String VideoStreamWriter::getStatsSummary() const
+{
+    auto s = getStats();
+    auto perFrame = [&s](double totalMs) { return s.framesWritten > 0 ? totalMs / s.framesWritten : 0.0; };
+
+    juce::String summary;
+    summary << getFormatName(format) << " " << s.framesWritten << " frames, "
+            << juce::String(s.bytesWritten / (1024.0 * 1024.0), 1) << " MB; per frame "
+            << juce::String(perFrame(s.convertMs), 2) << " ms convert"
+            << (ColorConversion::isAccelerated() ? " (AVX2)" : "") << ", "
+            << juce::String(perFrame(s.ioMs), 2) << " ms I/O; backpressure "
+            << juce::String(s.backpressureMs, 1) << " ms over " << s.backpressureStalls
+            << " stalls, queue peak " << s.maxQueueDepth << "/" << numBuffers;
+
+    if (s.framesSkipped > 0)
+        summary << ", " << s.framesSkipped << " frames missing";
+
+    return summary;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "FrameWriter.h"
+#include "../Core/WorkerPool.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class VideoStreamWriter
+ * @brief Writes frames as a YUV4MPEG2 stream or raw I420 / NV12 / RGBA
+ *
+ * Y4M is what ffmpeg, x264 and most encoders accept on stdin without any
+ * extra flags, e.g. `flarkviz-render ... -o - | ffmpeg -i - out.mp4`.
+ * Raw output is headerless and needs `-f rawvideo -pix_fmt <fmt> -s WxH`.
+ *
+ * writeFrame() converts the frame into one of a few pooled output buffers,
+ * split into row bands across a WorkerPool (AVX2 kernels where available,
+ * see ColorConversion), and hands it to an I/O thread that writes each
+ * frame with a single large write. Frames leave in the order they were
+ * given. When all buffers are waiting on I/O, writeFrame() blocks; that
+ * backpressure is reported in the stats.
+ */
+class VideoStreamWriter : public FrameWriter
+{
+public:
+    enum class Format
+    {
+        Y4M,
+        RawI420,
+        RawNV12,
+        RawRGBA
+    };
+
+    struct Stats
+    {
+        int64_t framesWritten = 0;
+        int64_t framesSkipped = 0;      // Gaps in frameIndex (dropped upstream)
+        int64_t bytesWritten = 0;
+        double convertMs = 0.0;         // Caller thread, converting into a buffer
+        double ioMs = 0.0;              // I/O thread, inside write()
+        double backpressureMs = 0.0;    // Caller thread, waiting for a free buffer
+        int64_t backpressureStalls = 0;
+        int maxQueueDepth = 0;
+    };
+
+    /**
+     * @param path Output file, or "-" for stdout
+     * @param numThreads Conversion threads; <= 0 picks from the core count
+     * @param numBuffers Frames that can be converted ahead of the disk or pipe
+     */
+    VideoStreamWriter(const juce::String& path, Format format, int numThreads = 0, int numBuffers = 3);
+    ~VideoStreamWriter() override;
+
+    bool open(const StreamInfo& info) override;
+    bool writeFrame(const uint8_t* rgba, int64_t frameIndex) override;
+    bool close() override;
+
+    Stats getStats() const;
+    juce::String getStatsSummary() const override;
+
+private:
+    struct Buffer
+    {
+        std::vector<uint8_t> data;
+        int64_t frameIndex = 0;
+    };
+
+    void convertFrame(const uint8_t* rgba, Buffer& buffer);
+    void ioLoop();
+
+    juce::String path;
+    Format format;
+    int numThreads;
+    int numBuffers;
+    StreamInfo info;
+
+    std::unique_ptr<juce::OutputStream> stream;
+    std::unique_ptr<WorkerPool> workers;
+
+    std::vector<std::unique_ptr<Buffer>> buffers;
+    std::deque<Buffer*> freeBuffers;
+    std::deque<Buffer*> queuedBuffers;
+    size_t headerSize = 0;
+    int64_t nextFrameIndex = 0;
+
+    std::thread ioThread;
+    mutable std::mutex mutex;
+    std::condition_variable bufferFreed;
+    std::condition_variable bufferQueued;
+    bool closing = false;
+    bool ioFailed = false;
+
+    Stats stats;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VideoStreamWriter)
+};
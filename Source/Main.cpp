@@ -19,9 +19,9 @@ public:
 
     void initialise (const juce::String& commandLine) override
     {
-        juce::ignoreUnused (commandLine);
-
-        mainWindow.reset (new MainWindow (getApplicationName()));
+        // --renderer=cpu or FLARKVIZ_RENDERER=cpu for machines without usable OpenGL
+        mainWindow.reset (new MainWindow (getApplicationName(),
+                                          RenderBackend::getPreferredType (commandLine)));
     }
 
     void shutdown() override
@@ -46,13 +46,13 @@ public:
     class MainWindow : public juce::DocumentWindow
     {
     public:
-        MainWindow (juce::String name)
+        MainWindow (juce::String name, RenderBackend::Type backend)
             : DocumentWindow (name,
                             juce::Colour (0xFF000000),  // flarkAUDIO black
                             DocumentWindow::allButtons)
         {
             setUsingNativeTitleBar (true);
-            setContentOwned (new MainComponent(), true);
+            setContentOwned (new MainComponent (backend), true);
 
            #if JUCE_IOS || JUCE_ANDROID
             setFullScreen (true);
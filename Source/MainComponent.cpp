@@ -1,30 +1,38 @@
 #include "MainComponent.h"
 
-MainComponent::MainComponent()
+MainComponent::MainComponent (RenderBackend::Type backend)
 {
     setSize (1280, 720);
     
-    // Initialize OpenGL
-    openGLContext.setRenderer (this);
-    openGLContext.attachTo (*this);
-    openGLContext.setContinuousRepainting (true);
-    
     // Initialize audio analyzer
     audioAnalyzer = std::make_unique<AudioAnalyzer>();
     
     // Initialize preset system
     presetManager = std::make_unique<PresetManager>();
-    renderer = std::make_unique<PresetRenderer>();
+    
+    if (backend == RenderBackend::Type::Software)
+    {
+        useSoftwareRenderer();
+    }
+    else
+    {
+        renderer = std::make_unique<PresetRenderer>();
+
+        // Initialize OpenGL
+        openGLContext.setRenderer (this);
+        openGLContext.attachTo (*this);
+        openGLContext.setContinuousRepainting (true);
+
+        // Load default preset
+        loadDefaultPreset();
+
+        // Start timer for UI updates (30 FPS is enough for UI)
+        startTimer (33);
+    }
     
     // Setup audio input
     setupAudioInput();
     
-    // Load default preset
-    loadDefaultPreset();
-    
-    // Start timer for UI updates (30 FPS is enough for UI)
-    startTimer (33);
-    
     setWantsKeyboardFocus (true);
 }
 
@@ -37,14 +45,34 @@ MainComponent::~MainComponent()
 
 void MainComponent::paint (juce::Graphics& g)
 {
-    // OpenGL handles all rendering
+    if (softwareRenderer != nullptr)
+    {
+        g.fillAll (flarkBlack);
+        g.drawImage (softwareFrame, getLocalBounds().toFloat());
+
+        if (showProfiler)
+        {
+            g.setColour (flarkOrange);
+            g.setFont (juce::Font (juce::Font::getDefaultMonospacedFontName(), 13.0f, juce::Font::plain));
+            g.drawText (juce::String::formatted ("software renderer  %dx%d  %.2f ms/frame  %d threads",
+                                                 softwareRenderer->getWidth(), softwareRenderer->getHeight(),
+                                                 softwareRenderer->getLastFrameMs(),
+                                                 softwareRenderer->getNumThreads()),
+                        18, 15, 500, 16, juce::Justification::left, false);
+        }
+        return;
+    }
+
+    // OpenGL handles all rendering; only overlays are painted here
+    if (showProfiler && renderer != nullptr)
+        paintProfilerOverlay (g);
 }
 
 void MainComponent::resized()
 {
     // Update renderer viewport
-    if (renderer != nullptr)
-        renderer->setViewportSize (getWidth(), getHeight());
+    if (auto* backend = getBackend())
+        backend->setViewportSize (getWidth(), getHeight());
 }
 
 //==============================================================================
@@ -52,6 +80,20 @@ void MainComponent::resized()
 
 void MainComponent::newOpenGLContextCreated()
 {
+    // The pipeline's shaders need GLSL 3.30; older drivers get the CPU renderer
+    if (juce::OpenGLShaderProgram::getLanguageVersion() < 3.3)
+    {
+        DBG ("FlarkViz: OpenGL 3.3 not available, switching to the software renderer");
+        openGLUnusable = true;
+
+        juce::MessageManager::callAsync ([safeThis = juce::Component::SafePointer<MainComponent> (this)]
+        {
+            if (safeThis != nullptr)
+                safeThis->useSoftwareRenderer();
+        });
+        return;
+    }
+
     // Initialize OpenGL resources
     if (renderer != nullptr)
         renderer->initializeGL();
@@ -61,6 +103,9 @@ void MainComponent::renderOpenGL()
 {
     using namespace juce::gl;
 
+    if (openGLUnusable)
+        return;
+
     // Get audio levels from analyzer
     float bass = audioAnalyzer->getBass();
     float mid = audioAnalyzer->getMid();
@@ -75,15 +120,48 @@ void MainComponent::renderOpenGL()
     // Render current preset
     if (renderer != nullptr)
     {
+        renderer->getProfiler().addCpuSample (FrameProfiler::Stage::Audio,
+                                              audioAnalyzer->getLastProcessingTimeMs());
+
+        updateSharedOutput();
+
+        if (renderer->isPipelinedEvaluation() != pipelinedEvaluation)
+            renderer->setPipelinedEvaluation (pipelinedEvaluation);
+
+        // Presets are prepared in the background; switching is a pointer swap,
+        // and frames without a switch link the next candidates' programs
+        auto& prefetcher = presetManager->getPrefetcher();
+        if (auto prepared = prefetcher.takeSelected())
+        {
+            // The replaced preset keeps its compiled code in the prefetcher's cache
+            renderer->loadPreparedPreset (std::move (prepared));
+            prefetcher.retire (renderer->takeRetiredPreset());
+            presetManager->getBudget().presetSwitched();
+        }
+        else
+            prefetcher.warmNext ([this] (const PreparedPreset& upcoming) { renderer->warmPreset (upcoming); });
+
         renderer->beginFrame(deltaTime);
         renderer->renderPreset(bass, mid, treb, bassAtt, midAtt, trebAtt);
         renderer->endFrame();
+
+        // Random picks learn what this machine can afford from real frame times
+        auto& profiler = renderer->getProfiler();
+        presetManager->getBudget().addFrameTime (profiler.getLastCpuFrameMs(), profiler.getLastGpuFrameMs(),
+                                                 renderer->getResolutionScale());
     }
 }
 
 void MainComponent::openGLContextClosing()
 {
     // Cleanup OpenGL resources
+    if (sharedOutput != nullptr)
+    {
+        renderer->setFramePublisher (nullptr);
+        sharedOutput->cleanupGL();
+        sharedOutput.reset();
+    }
+
     if (renderer != nullptr)
         renderer->cleanupGL();
 }
@@ -105,6 +183,32 @@ bool MainComponent::keyPressed (const juce::KeyPress& key)
     {
         currentFPS = (currentFPS == 60) ? 90 : (currentFPS == 90) ? 120 : 60;
         // Update OpenGL swap interval
+
+        if (softwareRenderer != nullptr)
+            startTimerHz (currentFPS);
+        return true;
+    }
+    
+    // F5: Toggle profiler overlay, Shift+F5: dump profile to JSON
+    if (key.getKeyCode() == juce::KeyPress::F5Key)
+    {
+        if (key.getModifiers().isShiftDown())
+            dumpProfile();
+        else
+            showProfiler = !showProfiler;
+
+        repaint();
+        return true;
+    }
+    
+    // F6: Toggle pipelined expression evaluation, Shift+F6: dump the render graph's frame plan
+    if (key.getKeyCode() == juce::KeyPress::F6Key)
+    {
+        if (key.getModifiers().isShiftDown())
+            dumpFramePlan();
+        else
+            pipelinedEvaluation = !pipelinedEvaluation.load();
+
         return true;
     }
     
@@ -120,10 +224,18 @@ bool MainComponent::keyPressed (const juce::KeyPress& key)
         return true;
     }
     
+    // F8: Toggle shared-memory frame output for other processes
+    if (key.getKeyCode() == juce::KeyPress::F8Key)
+    {
+        sharedOutputEnabled = !sharedOutputEnabled.load();
+        return true;
+    }
+    
     // F9: Enter double-preset mode
     if (key.getKeyCode() == juce::KeyPress::F9Key)
     {
-        renderer->enableDoublePresetMode (true);
+        if (renderer != nullptr)
+            renderer->enableDoublePresetMode (true);
         return true;
     }
     
@@ -141,6 +253,27 @@ bool MainComponent::keyPressed (const juce::KeyPress& key)
         return true;
     }
     
+    // 'f': Toggle favorite, 'F' (Shift+f): Next favorite
+    if (key.getTextCharacter() == 'f')
+    {
+        presetManager->toggleFavorite();
+        return true;
+    }
+    
+    if (key.getTextCharacter() == 'F')
+    {
+        presetManager->loadNextFavorite();
+        return true;
+    }
+    
+    // 'b': Toggle leaving presets over the frame budget out of random picks
+    if (key.getTextCharacter() == 'b')
+    {
+        auto& budget = presetManager->getBudget();
+        budget.setEnabled (! budget.isEnabled());
+        return true;
+    }
+    
     // 'c': Randomize colors
     if (key.getTextCharacter() == 'c')
     {
@@ -156,7 +289,156 @@ bool MainComponent::keyPressed (const juce::KeyPress& key)
 
 void MainComponent::timerCallback()
 {
+    if (softwareRenderer != nullptr)
+    {
+        renderSoftwareFrame();
+        repaint();
+        return;
+    }
+
     // Update UI elements if needed
+    if (showProfiler)
+        repaint();
+}
+
+void MainComponent::paintProfilerOverlay (juce::Graphics& g)
+{
+    auto report = renderer->getProfiler().getReport();
+    auto& pool = renderer->getRenderTargetPool();
+
+    const int lineHeight = 16;
+    const int numLines = FrameProfiler::numStages + 9;
+    const juce::Rectangle<int> area (10, 10, 520, numLines * lineHeight + 10);
+
+    g.setColour (flarkBlack.withAlpha (0.75f));
+    g.fillRect (area);
+
+    g.setColour (flarkOrange);
+    g.setFont (juce::Font (juce::Font::getDefaultMonospacedFontName(), 13.0f, juce::Font::plain));
+
+    int y = area.getY() + 5;
+    auto drawLine = [&] (const juce::String& text)
+    {
+        g.drawText (text, area.getX() + 8, y, area.getWidth() - 16, lineHeight,
+                    juce::Justification::left, false);
+        y += lineHeight;
+    };
+
+    auto formatRow = [] (const char* name, const RollingHistogram::Percentiles& cpu,
+                         const RollingHistogram::Percentiles* gpu)
+    {
+        auto row = juce::String::formatted ("%-12s %6.2f %6.2f %6.2f", name, cpu.p50, cpu.p95, cpu.p99);
+        if (gpu != nullptr)
+            row += juce::String::formatted ("   %6.2f %6.2f %6.2f", gpu->p50, gpu->p95, gpu->p99);
+        return row;
+    };
+
+    drawLine ("stage        cpu ms p50    p95    p99   gpu ms p50    p95    p99");
+
+    for (const auto& stage : report.stages)
+        drawLine (formatRow (stage.name, stage.cpu, stage.hasGpu ? &stage.gpu : nullptr));
+
+    drawLine (formatRow ("frame", report.frameCpu, &report.frameGpu));
+
+    drawLine (juce::String::formatted ("scale %.2f (%dx%d)   targets %.1f MB in use, %.1f MB cached",
+                                       renderer->getResolutionScale(),
+                                       renderer->getFeedbackWidth(), renderer->getFeedbackHeight(),
+                                       pool.getBytesInUse() / (1024.0 * 1024.0),
+                                       pool.getBytesCached() / (1024.0 * 1024.0)));
+
+    drawLine (juce::String::formatted ("expressions %.2f ms, %s", renderer->getLastEvaluationMs(),
+                                       renderer->isPipelinedEvaluation() ? "pipelined on worker (F6)"
+                                                                         : "on GL thread (F6)"));
+
+    const auto& noise = renderer->getNoiseTextures();
+    if (noise.isReady())
+        drawLine (juce::String::formatted ("noise textures %.1f ms, %s", noise.getCreationTimeMs(),
+                                           noise.wasLoadedFromCache() ? "mapped from cache"
+                                           : NoiseGenerator::isAccelerated() ? "generated with AVX2"
+                                                                             : "generated"));
+    else
+        drawLine ("noise textures loading");
+
+    auto glStats = renderer->getGLStats();
+    drawLine (juce::String::formatted ("gl calls %d (%d redundant skipped), %d draws, %d clears",
+                                       glStats.issued, glStats.skipped, glStats.draws, glStats.clears));
+
+    auto prefetchStats = presetManager->getPrefetcher().getStats();
+    auto cacheStats = presetManager->getPrefetcher().getCacheStats();
+    drawLine (juce::String::formatted ("presets %d/%d switches prefetched, cache %d (%.1f of %.0f MB, %.0f%% hits)",
+                                       prefetchStats.hits, prefetchStats.hits + prefetchStats.misses,
+                                       cacheStats.numPresets,
+                                       cacheStats.residentBytes / (1024.0 * 1024.0),
+                                       cacheStats.budgetBytes / (1024.0 * 1024.0),
+                                       cacheStats.getHitRate() * 100.0));
+
+    auto budgetStats = presetManager->getBudget().getStats();
+    drawLine (budgetStats.enforcing
+                ? juce::String::formatted ("budget %.0f cost max (%.2f ms + %.5f ms/cost, %d samples) (b)",
+                                           budgetStats.costBudget, budgetStats.baseMs,
+                                           budgetStats.msPerCost, budgetStats.samples)
+                : juce::String::formatted ("budget not enforced, %d samples (b)", budgetStats.samples));
+
+    drawLine ("F5 hide   Shift+F5 dump JSON");
+}
+
+void MainComponent::dumpProfile()
+{
+    if (renderer == nullptr)
+        return;
+
+    auto folder = juce::File::getSpecialLocation (juce::File::userDocumentsDirectory)
+                    .getChildFile ("FlarkViz/profiles");
+    folder.createDirectory();
+
+    auto file = folder.getChildFile ("frame-profile-"
+                                     + juce::Time::getCurrentTime().formatted ("%Y%m%d-%H%M%S")
+                                     + ".json");
+
+    if (file.replaceWithText (renderer->getProfiler().toJSON()))
+        DBG ("FlarkViz: Profile written to " << file.getFullPathName());
+    else
+        DBG ("FlarkViz: Failed to write profile to " << file.getFullPathName());
+}
+
+void MainComponent::dumpFramePlan()
+{
+    if (renderer == nullptr)
+        return;
+
+    auto folder = juce::File::getSpecialLocation (juce::File::userDocumentsDirectory)
+                    .getChildFile ("FlarkViz/profiles");
+    folder.createDirectory();
+
+    auto file = folder.getChildFile ("frame-plan-"
+                                     + juce::Time::getCurrentTime().formatted ("%Y%m%d-%H%M%S")
+                                     + ".txt");
+
+    // The plan is produced by the next rendered frame, on the GL thread
+    renderer->requestFramePlan ([file] (const std::string& plan)
+    {
+        if (file.replaceWithText (plan))
+            DBG ("FlarkViz: Frame plan written to " << file.getFullPathName());
+        else
+            DBG ("FlarkViz: Failed to write frame plan to " << file.getFullPathName());
+    });
+}
+
+void MainComponent::updateSharedOutput()
+{
+    // Readback buffers belong to the GL context, so the publisher is
+    // created and torn down here rather than in keyPressed()
+    if (sharedOutputEnabled && sharedOutput == nullptr)
+    {
+        sharedOutput = std::make_unique<SharedFramePublisher> ("flarkviz");
+        renderer->setFramePublisher (sharedOutput.get());
+    }
+    else if (!sharedOutputEnabled && sharedOutput != nullptr)
+    {
+        renderer->setFramePublisher (nullptr);
+        sharedOutput->cleanupGL();
+        sharedOutput.reset();
+    }
 }
 
 void MainComponent::setupAudioInput()
@@ -182,11 +464,14 @@ void MainComponent::setupAudioInput()
 
 void MainComponent::loadDefaultPreset()
 {
-    if (!renderer)
+    auto* backend = getBackend();
+    if (backend == nullptr)
         return;
 
-    // Create a simple default preset for testing
-    MilkDropPreset preset;
+    // Create a simple default preset for testing; it must outlive the
+    // renderer, which keeps a pointer to it
+    MilkDropPreset& preset = defaultPreset;
+    preset = {};
     preset.name = "FlarkViz Default";
     preset.author = "flarkAUDIO";
 
@@ -207,6 +492,51 @@ void MainComponent::loadDefaultPreset()
 
     preset.fDecay = 0.98f;
 
-    renderer->loadPreset(preset);
+    backend->loadPreset(preset);
     DBG("FlarkViz: Default preset loaded");
 }
+
+void MainComponent::useSoftwareRenderer()
+{
+    // detach() stops the GL thread, so the GL renderer can go with it
+    stopTimer();
+    openGLContext.detach();
+    renderer.reset();
+    sharedOutputEnabled = false;
+
+    softwareRenderer = std::make_unique<SoftwareRenderer>();
+    softwareRenderer->setViewportSize (getWidth(), getHeight());
+    softwareRenderer->initialise();
+    loadDefaultPreset();
+
+    // Frames are rendered on the message thread, paced by the timer
+    startTimerHz (currentFPS);
+    DBG ("FlarkViz: Using the software renderer (" << softwareRenderer->getNumThreads() << " threads)");
+}
+
+void MainComponent::renderSoftwareFrame()
+{
+    auto& prefetcher = presetManager->getPrefetcher();
+    if (auto prepared = prefetcher.takeSelected())
+    {
+        softwareRenderer->loadPreparedPreset (std::move (prepared));
+        prefetcher.retire (softwareRenderer->takeRetiredPreset());
+        presetManager->getBudget().presetSwitched();
+    }
+
+    softwareRenderer->beginFrame (1.0f / static_cast<float> (currentFPS));
+    softwareRenderer->renderPreset (audioAnalyzer->getBass(), audioAnalyzer->getMid(), audioAnalyzer->getTreb(),
+                                    audioAnalyzer->getBassAtt(), audioAnalyzer->getMidAtt(), audioAnalyzer->getTrebAtt());
+    softwareRenderer->endFrame();
+    presetManager->getBudget().addFrameTime (softwareRenderer->getLastFrameMs(), 0.0, 1.0f);
+
+    softwareRenderer->copyToImage (softwareFrame);
+}
+
+RenderBackend* MainComponent::getBackend()
+{
+    if (softwareRenderer != nullptr)
+        return softwareRenderer.get();
+
+    return renderer.get();
+}
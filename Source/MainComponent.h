@@ -3,6 +3,7 @@
 #include <JuceHeader.h>
 #include "Audio/AudioAnalyzer.h"
 #include "Rendering/PresetRenderer.h"
+#include "Rendering/SoftwareRenderer.h"
 #include "Presets/PresetManager.h"
 
 /**
@@ -11,13 +12,17 @@
  * 
  * Handles audio input, visualization rendering, and user interaction.
  * Designed with flarkAUDIO aesthetics: orange on black.
+ *
+ * Renders with OpenGL, or on the CPU when asked to (--renderer=cpu,
+ * FLARKVIZ_RENDERER=cpu) or when the GL context turns out to be too old
+ * for the pipeline.
  */
 class MainComponent : public juce::Component,
                       public juce::OpenGLRenderer,
                       private juce::Timer
 {
 public:
-    MainComponent();
+    explicit MainComponent (RenderBackend::Type backend = RenderBackend::Type::OpenGL);
     ~MainComponent() override;
 
     //==========================================================================
@@ -39,6 +44,13 @@ private:
     void timerCallback() override;
     void setupAudioInput();
     void loadDefaultPreset();
+    void useSoftwareRenderer();
+    void renderSoftwareFrame();
+    RenderBackend* getBackend();
+    void paintProfilerOverlay (juce::Graphics& g);
+    void dumpProfile();
+    void dumpFramePlan();
+    void updateSharedOutput();
 
     //==========================================================================
     juce::OpenGLContext openGLContext;
@@ -50,9 +62,23 @@ private:
     // Rendering
     std::unique_ptr<PresetRenderer> renderer;
     std::unique_ptr<PresetManager> presetManager;
+    MilkDropPreset defaultPreset;
+
+    // CPU rendering instead of `renderer`; frames are rendered on the timer
+    std::unique_ptr<SoftwareRenderer> softwareRenderer;
+    juce::Image softwareFrame;
+    std::atomic<bool> openGLUnusable {false};
+
+    // Shared-memory frame output; created and destroyed on the GL thread
+    std::unique_ptr<SharedFramePublisher> sharedOutput;
+    std::atomic<bool> sharedOutputEnabled {false};
+
+    // Evaluate expressions one frame ahead on a worker (F6); applied on the GL thread
+    std::atomic<bool> pipelinedEvaluation {true};
     
     // State
     bool isFullscreen = false;
+    bool showProfiler = false;
     int currentFPS = 60;
     float transitionProgress = 0.0f;
     
@@ -60,30 +60,48 @@ FlarkVizPluginEditor::FlarkVizPluginEditor(FlarkVizPlugin& p)
     transitionTimeAttachment.reset(new juce::AudioProcessorValueTreeState::SliderAttachment(
         audioProcessor.getParameters(), "transitionTime", transitionTimeSlider));
 
+    // Visualization backend, chosen once per editor
+    if (RenderBackend::getPreferredType() == RenderBackend::Type::Software)
+    {
+        useSoftwareRenderer();
+    }
+    else
+    {
+        glRenderer = std::make_unique<PresetRenderer>();
+
+        visualizer.setInterceptsMouseClicks(false, false);
+        addAndMakeVisible(visualizer);
+
+        openGLContext.setRenderer(this);
+        openGLContext.attachTo(visualizer);
+        openGLContext.setContinuousRepainting(true);
+    }
+
+    resized();
+
     // Start timer for updates
     startTimerHz(30); // 30 FPS
 }
 
 FlarkVizPluginEditor::~FlarkVizPluginEditor()
 {
+    stopTimer();
+    openGLContext.detach();
 }
 
 void FlarkVizPluginEditor::paint(juce::Graphics& g)
 {
     g.fillAll(juce::Colours::black);
 
-    // Draw visualization area
-    juce::Rectangle<int> vizArea(10, 10, getWidth() - 20, getHeight() - 200);
-    g.setColour(juce::Colours::darkgrey);
-    g.fillRect(vizArea);
+    // Draw visualization area (OpenGL draws over it)
+    auto vizArea = getVisualizationArea();
+
+    if (softwareRenderer != nullptr)
+        g.drawImage(softwareFrame, vizArea.toFloat());
 
     g.setColour(juce::Colours::white);
     g.drawRect(vizArea, 2);
 
-    // Draw placeholder text
-    g.setFont(24.0f);
-    g.drawText("FlarkViz Visualization", vizArea, juce::Justification::centred);
-
     // Draw audio levels
     auto* analyzer = audioProcessor.getAudioAnalyzer();
     if (analyzer)
@@ -105,7 +123,13 @@ void FlarkVizPluginEditor::resized()
     auto area = getLocalBounds();
 
     // Reserve top area for visualization
-    auto vizArea = area.removeFromTop(getHeight() - 180);
+    area.removeFromTop(getHeight() - 180);
+
+    auto vizArea = getVisualizationArea();
+    visualizer.setBounds(vizArea);
+
+    if (auto* backend = getBackend())
+        backend->setViewportSize(vizArea.getWidth(), vizArea.getHeight());
 
     // Control area
     area.removeFromTop(10); // Padding
@@ -143,6 +167,110 @@ void FlarkVizPluginEditor::resized()
 
 void FlarkVizPluginEditor::timerCallback()
 {
+    if (softwareRenderer != nullptr)
+    {
+        auto* analyzer = audioProcessor.getAudioAnalyzer();
+
+        softwareRenderer->beginFrame(1.0f / 30.0f);
+        softwareRenderer->renderPreset(analyzer->getBass(), analyzer->getMid(), analyzer->getTreb(),
+                                       analyzer->getBassAtt(), analyzer->getMidAtt(), analyzer->getTrebAtt());
+        softwareRenderer->endFrame();
+        softwareRenderer->copyToImage(softwareFrame);
+    }
+
     // Trigger repaint to update visualization
     repaint();
 }
+
+//==============================================================================
+// OpenGL Callbacks
+
+void FlarkVizPluginEditor::newOpenGLContextCreated()
+{
+    // The pipeline's shaders need GLSL 3.30; older drivers get the CPU renderer
+    if (juce::OpenGLShaderProgram::getLanguageVersion() < 3.3)
+    {
+        DBG("FlarkViz: OpenGL 3.3 not available in the plugin, switching to the software renderer");
+        openGLUnusable = true;
+
+        juce::MessageManager::callAsync([safeThis = juce::Component::SafePointer<FlarkVizPluginEditor>(this)]
+        {
+            if (safeThis != nullptr)
+                safeThis->useSoftwareRenderer();
+        });
+        return;
+    }
+
+    // Shaders are compiled with the context current
+    glRenderer->initializeGL();
+    loadVisualizerPreset();
+}
+
+void FlarkVizPluginEditor::renderOpenGL()
+{
+    if (openGLUnusable)
+        return;
+
+    auto* analyzer = audioProcessor.getAudioAnalyzer();
+
+    glRenderer->beginFrame(1.0f / 60.0f);
+    glRenderer->renderPreset(analyzer->getBass(), analyzer->getMid(), analyzer->getTreb(),
+                             analyzer->getBassAtt(), analyzer->getMidAtt(), analyzer->getTrebAtt());
+    glRenderer->endFrame();
+}
+
+void FlarkVizPluginEditor::openGLContextClosing()
+{
+    if (glRenderer != nullptr)
+        glRenderer->cleanupGL();
+}
+
+//==============================================================================
+juce::Rectangle<int> FlarkVizPluginEditor::getVisualizationArea() const
+{
+    return { 10, 10, getWidth() - 20, getHeight() - 200 };
+}
+
+void FlarkVizPluginEditor::loadVisualizerPreset()
+{
+    auto* backend = getBackend();
+    if (backend == nullptr)
+        return;
+
+    // Kept as a member: the renderer holds a pointer to it
+    visualizerPreset = {};
+    visualizerPreset.name = "FlarkViz Plugin Default";
+    visualizerPreset.author = "flarkAUDIO";
+    visualizerPreset.perFrameCode = R"(
+        zoom = 1.01 + 0.04 * bass_att;
+        rot = 0.01 * sin(time * 0.3);
+        wave_r = 1.0;
+        wave_g = 0.4 + 0.2 * sin(time);
+        wave_b = 0.0;
+    )";
+    visualizerPreset.fDecay = 0.97f;
+
+    backend->loadPreset(visualizerPreset);
+}
+
+void FlarkVizPluginEditor::useSoftwareRenderer()
+{
+    // detach() stops the GL thread, so the GL renderer can go with it
+    openGLContext.detach();
+    glRenderer.reset();
+    removeChildComponent(&visualizer);
+
+    auto vizArea = getVisualizationArea();
+    softwareRenderer = std::make_unique<SoftwareRenderer>();
+    softwareRenderer->setViewportSize(vizArea.getWidth(), vizArea.getHeight());
+    softwareRenderer->initialise();
+    loadVisualizerPreset();
+}
+
+RenderBackend* FlarkVizPluginEditor::getBackend()
+{
+    if (softwareRenderer != nullptr)
+        return softwareRenderer.get();
+
+    return glRenderer.get();
+}
@@ -2,6 +2,7 @@
 
 #include <JuceHeader.h>
 #include "FlarkVizPlugin.h"
+#include "../Rendering/SoftwareRenderer.h"
 
 /**
  * @class FlarkVizPluginEditor
@@ -9,8 +10,12 @@
  *
  * Provides a visual interface showing the visualization and controls
  * for brightness, contrast, saturation, and preset selection.
+ *
+ * The visualization uses OpenGL, or the CPU renderer when the host machine
+ * has no usable GL (FLARKVIZ_RENDERER=cpu, or a context older than 3.3).
  */
 class FlarkVizPluginEditor : public juce::AudioProcessorEditor,
+                              public juce::OpenGLRenderer,
                               private juce::Timer
 {
 public:
@@ -21,11 +26,31 @@ public:
     void paint(juce::Graphics&) override;
     void resized() override;
 
+    //==============================================================================
+    // OpenGLRenderer callbacks
+    void newOpenGLContextCreated() override;
+    void renderOpenGL() override;
+    void openGLContextClosing() override;
+
 private:
     void timerCallback() override;
+    juce::Rectangle<int> getVisualizationArea() const;
+    void loadVisualizerPreset();
+    void useSoftwareRenderer();
+    RenderBackend* getBackend();
 
     FlarkVizPlugin& audioProcessor;
 
+    // Visualization: a GL context attached to `visualizer`, or CPU frames
+    // painted by the editor
+    juce::Component visualizer;
+    juce::OpenGLContext openGLContext;
+    std::unique_ptr<PresetRenderer> glRenderer;
+    std::unique_ptr<SoftwareRenderer> softwareRenderer;
+    juce::Image softwareFrame;
+    MilkDropPreset visualizerPreset;
+    std::atomic<bool> openGLUnusable {false};
+
     // UI Components
     juce::Slider brightnessSlider;
     juce::Slider contrastSlider;
@@ -1,4 +1,5 @@
 #include "Milk2Loader.h"
+#include "PresetParser.h"
 #include <sstream>
 
 Milk2Loader::Milk2Loader() {}
@@ -9,54 +10,78 @@ Milk2Loader::DoublePreset Milk2Loader::loadFromFile(const juce::File& file)
     if (!file.existsAsFile())
         return DoublePreset();
 
-    juce::String content = file.loadFileAsString();
-    return loadFromString(content);
+    juce::MemoryMappedFile mapping(file, juce::MemoryMappedFile::readOnly);
+    std::string_view text;
+
+    if (mapping.getData() != nullptr)
+        text = std::string_view(static_cast<const char*>(mapping.getData()), mapping.getSize());
+
+    if (PresetParser::isUtf16(text))
+        return loadFromString(file.loadFileAsString());
+
+    return loadFromBuffer(text);
 }
 
 Milk2Loader::DoublePreset Milk2Loader::loadFromString(const juce::String& content)
+{
+    return loadFromBuffer(std::string_view(content.toRawUTF8(), content.getNumBytesAsUTF8()));
+}
+
+Milk2Loader::DoublePreset Milk2Loader::loadFromBuffer(std::string_view text)
 {
     DoublePreset result;
-    juce::StringArray lines = juce::StringArray::fromLines(content);
 
     // Find the separator between preset A and preset B
-    // .milk2 files use [preset_a] and [preset_b] sections
-    int presetAStart = -1;
-    int presetAEnd = -1;
-    int presetBStart = -1;
-    int presetBEnd = -1;
-    int metaStart = -1;
-
-    for (int i = 0; i < lines.size(); ++i)
+    // .milk2 files use [preset_a] and [preset_b] sections.
+    // Positions are byte offsets of line starts; npos = not found.
+    constexpr auto none = std::string_view::npos;
+    size_t presetAStart = none;
+    size_t presetAEnd = none;
+    size_t presetBStart = none;
+    size_t presetBEnd = none;
+    size_t metaEnd = none;      // End of the [milk2_meta] header line
+
+    for (size_t lineStart = 0; lineStart < text.size();)
     {
-        juce::String line = lines[i].trim();
+        const auto newline = text.find('\n', lineStart);
+        const size_t lineEnd = newline == none ? text.size() : newline + 1;
+        const auto line = text.substr(lineStart, lineEnd - lineStart);
 
-        if (line.contains("[preset_a]") || line.contains("[preset00]"))
+        if (line.find("[preset_a]") != none || line.find("[preset00]") != none)
         {
-            if (presetAStart == -1)
-                presetAStart = i;
+            if (presetAStart == none)
+                presetAStart = lineStart;
         }
-        else if (line.contains("[preset_b]") || (line.contains("[preset00]") && presetAStart != -1))
+        else if (line.find("[preset_b]") != none)
         {
-            presetAEnd = i;
-            presetBStart = i;
+            presetAEnd = lineStart;
+            presetBStart = lineStart;
         }
-        else if (line.contains("[milk2_meta]"))
+        else if (line.find("[milk2_meta]") != none)
         {
-            if (presetBStart != -1 && presetBEnd == -1)
-                presetBEnd = i;
-            metaStart = i;
+            if (presetBStart != none && presetBEnd == none)
+                presetBEnd = lineStart;
+            metaEnd = lineEnd;
         }
+
+        lineStart = lineEnd;
     }
 
-    if (presetBEnd == -1)
-        presetBEnd = lines.size();
+    if (presetBEnd == none)
+        presetBEnd = text.size();
 
-    // Parse metadata section if exists
-    if (metaStart != -1)
+    // Parse metadata section if exists (a few lines; not worth a fast path)
+    if (metaEnd != none)
     {
-        for (int i = metaStart + 1; i < lines.size(); ++i)
+        auto meta = text.substr(metaEnd);
+
+        while (!meta.empty())
         {
-            juce::String line = lines[i].trim();
+            const auto newline = meta.find('\n');
+            const auto rawLine = meta.substr(0, newline);
+            meta.remove_prefix(newline == none ? meta.size() : newline + 1);
+
+            juce::String line = juce::String::fromUTF8(rawLine.data(), static_cast<int>(rawLine.size())).trim();
             if (line.isEmpty() || line.startsWith("//"))
                 continue;
 
@@ -75,23 +100,12 @@ Milk2Loader::DoublePreset Milk2Loader::loadFromString(const juce::String& conten
         }
     }
 
-    // Extract preset A content
-    if (presetAStart != -1 && presetAEnd != -1)
-    {
-        juce::String presetAContent;
-        for (int i = presetAStart; i < presetAEnd; ++i)
-            presetAContent += lines[i] + "\n";
-        result.presetA.loadFromString(presetAContent);
-    }
+    // Preset A and B are parsed in place
+    if (presetAStart != none && presetAEnd != none)
+        result.presetA.loadFromBuffer(text.substr(presetAStart, presetAEnd - presetAStart));
 
-    // Extract preset B content
-    if (presetBStart != -1 && presetBEnd != -1)
-    {
-        juce::String presetBContent;
-        for (int i = presetBStart; i < presetBEnd; ++i)
-            presetBContent += lines[i] + "\n";
-        result.presetB.loadFromString(presetBContent);
-    }
+    if (presetBStart != none && presetBEnd != none)
+        result.presetB.loadFromBuffer(text.substr(presetBStart, presetBEnd - presetBStart));
 
     return result;
 }
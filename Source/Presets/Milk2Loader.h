@@ -3,6 +3,7 @@
 #include "Preset.h"
 #include <JuceHeader.h>
 #include <string>
+#include <string_view>
 
 /**
  * @class Milk2Loader
@@ -44,6 +45,13 @@ public:
      */
     static DoublePreset loadFromString(const juce::String& content);
 
+    /**
+     * @brief Load from .milk2 text in place (e.g. a memory-mapped file)
+     * @param text UTF-8 .milk2 content
+     * @return DoublePreset structure
+     */
+    static DoublePreset loadFromBuffer(std::string_view text);
+
     /**
      * @brief Save a double preset to .milk2 format
      * @param doublePreset The double preset to save
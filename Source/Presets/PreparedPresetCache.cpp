@@ -0,0 +1,91 @@
+#include "PreparedPresetCache.h"
+
+PreparedPresetCache::PreparedPresetCache(size_t budgetBytes)
+    : budget(budgetBytes)
+{
+}
+
+void PreparedPresetCache::put(std::unique_ptr<PreparedPreset> prepared)
+{
+    if (prepared == nullptr || prepared->contentHash == 0)
+        return;
+
+    auto existing = index.find(prepared->contentHash);
+    if (existing != index.end())
+    {
+        residentBytes -= existing->second->bytes;
+        entries.erase(existing->second);
+        index.erase(existing);
+    }
+
+    Entry entry;
+    entry.bytes = prepared->getMemorySize();
+    entry.prepared = std::move(prepared);
+
+    // A preset bigger than the whole budget isn't worth evicting everything for
+    if (entry.bytes > budget)
+        return;
+
+    residentBytes += entry.bytes;
+    entries.push_front(std::move(entry));
+    index.emplace(entries.front().prepared->contentHash, entries.begin());
+
+    evictToBudget();
+}
+
+std::unique_ptr<PreparedPreset> PreparedPresetCache::take(uint64_t contentHash)
+{
+    auto found = index.find(contentHash);
+    if (found == index.end())
+    {
+        ++misses;
+        return nullptr;
+    }
+
+    ++hits;
+    auto entry = found->second;
+    auto prepared = std::move(entry->prepared);
+
+    residentBytes -= entry->bytes;
+    index.erase(found);
+    entries.erase(entry);
+
+    return prepared;
+}
+
+void PreparedPresetCache::setBudget(size_t budgetBytes)
+{
+    budget = budgetBytes;
+    evictToBudget();
+}
+
+void PreparedPresetCache::clear()
+{
+    index.clear();
+    entries.clear();
+    residentBytes = 0;
+}
+
+PreparedPresetCache::Stats PreparedPresetCache::getStats() const
+{
+    Stats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.evictions = evictions;
+    stats.residentBytes = residentBytes;
+    stats.budgetBytes = budget;
+    stats.numPresets = static_cast<int>(entries.size());
+    return stats;
+}
+
+void PreparedPresetCache::evictToBudget()
+{
+    while (residentBytes > budget && !entries.empty())
+    {
+        auto& oldest = entries.back();
+        residentBytes -= oldest.bytes;
+        index.erase(oldest.prepared->contentHash);
+        entries.pop_back();
+        ++evictions;
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "../Rendering/PreparedPreset.h"
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+/**
+ * @class PreparedPresetCache
+ * @brief Least recently used store of prepared presets, bounded by memory
+ *
+ * Presets that have been shown (or prepared and not shown) are kept
+ * whole: parsed preset, compiled evaluators and, while cached, their
+ * linked programs. Going back through the history or to a favorite then
+ * takes the preset out of here instead of loading it again.
+ *
+ * Presets are keyed by normalized content hash rather than path, so
+ * files with the same preset in them (PresetCatalog aliases) share one
+ * prepared copy; presets without a hash aren't cached.
+ *
+ * Entries are evicted least recently used first once the total of
+ * PreparedPreset::getMemorySize() exceeds the budget. Not thread-safe;
+ * PresetPrefetcher calls it under its lock.
+ */
+class PreparedPresetCache
+{
+public:
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t residentBytes = 0;
+        size_t budgetBytes = 0;
+        int numPresets = 0;
+
+        double getHitRate() const { return hits + misses > 0 ? static_cast<double>(hits) / static_cast<double>(hits + misses) : 0.0; }
+    };
+
+    static constexpr size_t defaultBudgetBytes = 64 * 1024 * 1024;
+
+    explicit PreparedPresetCache(size_t budgetBytes = defaultBudgetBytes);
+
+    /** Store a preset under its content hash, replacing an older copy; may evict others */
+    void put(std::unique_ptr<PreparedPreset> prepared);
+
+    /** Remove and return the preset with a content hash; counts as a hit or a miss */
+    std::unique_ptr<PreparedPreset> take(uint64_t contentHash);
+
+    bool contains(uint64_t contentHash) const { return index.count(contentHash) != 0; }
+
+    /** Change the budget; evicts straight away if it shrank */
+    void setBudget(size_t budgetBytes);
+
+    void clear();
+
+    Stats getStats() const;
+
+private:
+    struct Entry
+    {
+        std::unique_ptr<PreparedPreset> prepared;
+        size_t bytes = 0;
+    };
+
+    void evictToBudget();
+
+    // Most recently used at the front
+    std::list<Entry> entries;
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+
+    size_t budget;
+    size_t residentBytes = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+};
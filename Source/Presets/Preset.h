@@ -2,6 +2,7 @@
 
 #include <JuceHeader.h>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 
@@ -133,5 +134,8 @@ struct MilkDropPreset
     // ========== Helper Methods ==========
     bool loadFromFile(const juce::File& file);
     bool loadFromString(const juce::String& content);
+
+    /** Parse .milk text in place (see PresetParser) */
+    bool loadFromBuffer(std::string_view text);
     void reset();
 };
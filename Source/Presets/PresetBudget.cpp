@@ -0,0 +1,186 @@
+#include "PresetBudget.h"
+#include <algorithm>
+#include <cmath>
+
+PresetBudget::PresetBudget()
+{
+    reset();
+}
+
+void PresetBudget::setSettings(const Settings& newSettings)
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    settings = newSettings;
+    settings.softFraction = std::clamp(settings.softFraction, 0.0, 1.0);
+    settings.framesPerSample = std::max(settings.framesPerSample, 1);
+    settings.minSamples = std::max(settings.minSamples, 1);
+    settings.forgetting = std::clamp(settings.forgetting, 0.0, 1.0);
+}
+
+PresetBudget::Settings PresetBudget::getSettings() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return settings;
+}
+
+void PresetBudget::setEnabled(bool shouldBeEnabled)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    enabled = shouldBeEnabled;
+}
+
+bool PresetBudget::isEnabled() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return enabled;
+}
+
+void PresetBudget::reset()
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    selectedCost = 0.0;
+    currentCost = 0.0;
+    framesSinceSwitch = 0;
+    framesInSample = 0;
+    sampleMsTotal = 0.0;
+
+    sumWeight = sumCost = sumMs = sumCostCost = sumCostMs = 0.0;
+    minCost = maxCost = 0.0;
+    numSamples = 0;
+
+    baseMs = 0.0;
+    msPerCost = 0.0;
+    fitted = false;
+}
+
+void PresetBudget::presetSelected(float cost)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    selectedCost = cost;
+}
+
+void PresetBudget::presetSwitched()
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    // A preset shown for most of a sample still counts
+    if (currentCost > 0.0 && framesInSample * 2 >= settings.framesPerSample)
+        addSample(currentCost, sampleMsTotal / framesInSample);
+
+    currentCost = selectedCost;
+    framesSinceSwitch = 0;
+    framesInSample = 0;
+    sampleMsTotal = 0.0;
+}
+
+void PresetBudget::addFrameTime(double cpuMs, double gpuMs, float resolutionScale)
+{
+    // What the frame would have cost at full resolution
+    const double scale = std::clamp(static_cast<double>(resolutionScale), 0.01, 1.0);
+    const double frameMs = std::max(cpuMs, gpuMs / (scale * scale));
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (currentCost <= 0.0 || !std::isfinite(frameMs))
+        return;
+
+    // The first frames of a preset pay for links and cold caches
+    if (++framesSinceSwitch <= settings.settleFrames)
+        return;
+
+    sampleMsTotal += frameMs;
+
+    if (++framesInSample >= settings.framesPerSample)
+    {
+        addSample(currentCost, sampleMsTotal / framesInSample);
+        framesInSample = 0;
+        sampleMsTotal = 0.0;
+    }
+}
+
+void PresetBudget::addSample(double cost, double frameMs)
+{
+    sumWeight = sumWeight * settings.forgetting + 1.0;
+    sumCost = sumCost * settings.forgetting + cost;
+    sumMs = sumMs * settings.forgetting + frameMs;
+    sumCostCost = sumCostCost * settings.forgetting + cost * cost;
+    sumCostMs = sumCostMs * settings.forgetting + cost * frameMs;
+
+    minCost = numSamples == 0 ? cost : std::min(minCost, cost);
+    maxCost = numSamples == 0 ? cost : std::max(maxCost, cost);
+    ++numSamples;
+
+    fit();
+}
+
+void PresetBudget::fit()
+{
+    fitted = false;
+
+    if (sumWeight <= 0.0 || sumCost <= 0.0)
+        return;
+
+    // A slope needs presets of clearly different cost; until then assume
+    // frame time proportional to cost, which overestimates expensive ones
+    const double denominator = sumWeight * sumCostCost - sumCost * sumCost;
+    double slope = 0.0;
+
+    if (numSamples >= 2 && maxCost >= minCost * settings.minCostSpread && denominator > 0.0)
+        slope = (sumWeight * sumCostMs - sumCost * sumMs) / denominator;
+
+    if (slope > 0.0)
+    {
+        msPerCost = slope;
+        baseMs = std::max(0.0, (sumMs - slope * sumCost) / sumWeight);
+    }
+    else
+    {
+        msPerCost = sumMs / sumCost;
+        baseMs = 0.0;
+    }
+
+    fitted = msPerCost > 0.0;
+}
+
+double PresetBudget::predictFrameMs(float cost) const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return fitted ? baseMs + msPerCost * cost : 0.0;
+}
+
+float PresetBudget::getWeight(float cost) const
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (!enabled || !fitted || numSamples < settings.minSamples || cost <= 0.0f)
+        return 1.0f;
+
+    const double budget = (settings.targetFrameMs - baseMs) / msPerCost;
+    const double soft = (settings.targetFrameMs * settings.softFraction - baseMs) / msPerCost;
+
+    if (cost >= budget)
+        return 0.0f;
+
+    if (cost <= soft)
+        return 1.0f;
+
+    return static_cast<float>((budget - cost) / (budget - soft));
+}
+
+PresetBudget::Stats PresetBudget::getStats() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    Stats stats;
+    stats.samples = numSamples;
+    stats.baseMs = baseMs;
+    stats.msPerCost = msPerCost;
+    stats.enforcing = enabled && fitted && numSamples >= settings.minSamples;
+
+    if (stats.enforcing)
+        stats.costBudget = std::max(0.0, (settings.targetFrameMs - baseMs) / msPerCost);
+
+    return stats;
+}
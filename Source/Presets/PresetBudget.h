@@ -0,0 +1,150 @@
+#pragma once
+
+#include <mutex>
+
+/**
+ * @class PresetBudget
+ * @brief Learns which preset costs the machine can render within its frame budget
+ *
+ * Every catalog entry carries an estimated cost (PresetCatalog::estimateCost),
+ * which ranks presets but says nothing about milliseconds. This measures
+ * them: while a preset is on screen its frame times (the larger of CPU and
+ * GPU time) are averaged into (cost, ms) samples, skipping the first frames
+ * after a switch. A line fitted through the samples, with older ones
+ * gradually forgotten, predicts the frame time of any cost, and so gives
+ * the highest cost that still fits the frame budget.
+ *
+ * Frame times are measured at full resolution. The ResolutionScaler lowers
+ * the render scale under exactly the presets that matter here, which would
+ * make them look cheap, so GPU time is normalized per rendered pixel
+ * (divided by the scale squared, the scaler's own fill-rate model) before
+ * it goes into a sample. CPU time doesn't depend on the scale.
+ *
+ * Random selection then gives presets under the soft limit full weight,
+ * fades the weight out between the soft limit and the budget, and leaves
+ * out presets above it. Until enough presets have been measured nothing
+ * is excluded.
+ *
+ * presetSelected() is called when a preset is chosen, presetSwitched()
+ * when the renderer actually swaps it in and addFrameTime() once per
+ * rendered frame, usually not all on the same thread; all methods are
+ * thread-safe.
+ */
+class PresetBudget
+{
+public:
+    /**
+     * @struct Settings
+     * @brief Tuning parameters
+     */
+    struct Settings
+    {
+        double targetFrameMs = 1000.0 / 60.0;  // Frame budget
+        double softFraction = 0.75;     // Weight starts to fall above this fraction of the budget
+        int settleFrames = 60;          // Frames ignored after a switch (program links, cache warm-up)
+        int framesPerSample = 120;      // Frames averaged into one sample
+        int minSamples = 4;             // Samples needed before presets are excluded
+        double minCostSpread = 1.5;     // Highest / lowest sampled cost needed to fit a slope
+        double forgetting = 0.95;       // Weight older samples keep when a new one arrives
+    };
+
+    /**
+     * @struct Stats
+     * @brief Snapshot of the fitted model, for telemetry
+     */
+    struct Stats
+    {
+        int samples = 0;
+        double baseMs = 0.0;            // Predicted frame time at zero cost
+        double msPerCost = 0.0;
+        double costBudget = 0.0;        // Highest affordable cost; 0 while not enforcing
+        bool enforcing = false;
+    };
+
+    PresetBudget();
+
+    /**
+     * @brief Replace the tuning parameters
+     */
+    void setSettings(const Settings& newSettings);
+    Settings getSettings() const;
+
+    /**
+     * @brief Enable or disable excluding presets
+     *
+     * Measuring carries on either way.
+     */
+    void setEnabled(bool shouldBeEnabled);
+    bool isEnabled() const;
+
+    /**
+     * @brief A preset was chosen; it is measured once presetSwitched() is called
+     * @param cost Its estimated cost; presets without one (<= 0) aren't measured
+     */
+    void presetSelected(float cost);
+
+    /**
+     * @brief The renderer switched to the last selected preset
+     */
+    void presetSwitched();
+
+    /**
+     * @brief Record the cost of one frame
+     * @param cpuMs CPU time for the frame (milliseconds)
+     * @param gpuMs GPU time for the frame (milliseconds)
+     * @param resolutionScale Render scale the GPU time was measured at
+     */
+    void addFrameTime(double cpuMs, double gpuMs, float resolutionScale);
+
+    /**
+     * @brief Frame time the fitted model expects for a cost; 0 while unfitted
+     */
+    double predictFrameMs(float cost) const;
+
+    /**
+     * @brief Relative chance of picking a preset of this cost at random
+     * @return 1 up to the soft limit, falling to 0 at the budget, 0 above it;
+     *         always 1 while disabled or not enough has been measured
+     */
+    float getWeight(float cost) const;
+
+    /**
+     * @brief Forget all measurements
+     */
+    void reset();
+
+    /**
+     * @brief Get a telemetry snapshot
+     */
+    Stats getStats() const;
+
+private:
+    void addSample(double cost, double frameMs);
+    void fit();
+
+    mutable std::mutex lock;
+    Settings settings;
+    bool enabled = true;
+
+    // Current preset
+    double selectedCost = 0.0;
+    double currentCost = 0.0;
+    int framesSinceSwitch = 0;
+    int framesInSample = 0;
+    double sampleMsTotal = 0.0;
+
+    // Weighted sums for the least-squares fit
+    double sumWeight = 0.0;
+    double sumCost = 0.0;
+    double sumMs = 0.0;
+    double sumCostCost = 0.0;
+    double sumCostMs = 0.0;
+    double minCost = 0.0;
+    double maxCost = 0.0;
+    int numSamples = 0;
+
+    // Fitted model
+    double baseMs = 0.0;
+    double msPerCost = 0.0;
+    bool fitted = false;
+};
@@ -0,0 +1,956 @@
+#include "PresetCatalog.h"
+#include "Preset.h"
+#include "Milk2Loader.h"
+#include "PresetPack.h"
+#include "PresetParser.h"
+#include "../Expression/MilkdropEval.h"
+#include "../Rendering/ShaderCompiler.h"
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+
+namespace
+{
+    const char catalogMagic[8] = { 'F', 'V', 'C', 'A', 'T', 'L', 'G', '\0' };
+
+    constexpr uint64_t fnvOffsetBasis = 0xcbf29ce484222325ull;
+    constexpr uint64_t fnvPrime = 0x100000001b3ull;
+
+    inline void fnvMix(uint64_t& hash, uint8_t byte)
+    {
+        hash ^= byte;
+        hash *= fnvPrime;
+    }
+
+    bool pathLess(const PresetCatalog::Entry& a, const PresetCatalog::Entry& b)
+    {
+        return a.path < b.path;
+    }
+
+    uint32_t featuresOf(const MilkDropPreset& preset)
+    {
+        uint32_t features = 0;
+
+        if (!preset.warpShaderCode.empty())
+            features |= PresetCatalog::warpShader;
+
+        if (!preset.compShaderCode.empty())
+            features |= PresetCatalog::compositeShader;
+
+        if (!preset.perPixelCode.empty())
+            features |= PresetCatalog::perPixelCode;
+
+        for (const auto& wave : preset.waves)
+            if (wave.enabled)
+                features |= PresetCatalog::customWaves;
+
+        for (const auto& shape : preset.shapes)
+            if (shape.enabled)
+                features |= PresetCatalog::customShapes;
+
+        return features;
+    }
+
+    // Instructions compiled per block, for estimateCost()
+    struct InstructionCounts
+    {
+        double perFrame = 0.0;
+        double perPixel = 0.0;
+        double waves = 0.0;         // Enabled waves: per_frame plus per_point for every sample
+        double shapes = 0.0;        // Enabled shapes: per_frame
+    };
+
+    bool compiles(MilkdropEval& eval, const std::string& code, const std::string& block, std::string& error,
+                  double& instructions)
+    {
+        if (code.empty())
+            return true;
+
+        if (eval.compileBlock(code))
+        {
+            instructions = static_cast<double>(eval.getInstructionCount());
+            return true;
+        }
+
+        error = block + ": " + eval.getLastError();
+        return false;
+    }
+
+    // Samples a custom wave's per_point code runs for
+    constexpr double wavePoints = 512.0;
+
+    // Compile every expression block, as RenderState would when loading it
+    bool validate(const MilkDropPreset& preset, std::string& error, InstructionCounts& counts)
+    {
+        MilkdropEval eval;
+        double init = 0.0;
+
+        if (!compiles(eval, preset.perFrameInitCode, "per_frame_init", error, init)
+            || !compiles(eval, preset.perFrameCode, "per_frame", error, counts.perFrame)
+            || !compiles(eval, preset.perPixelCode, "per_pixel", error, counts.perPixel))
+            return false;
+
+        auto compilesAll = [&](const std::vector<MilkDropPreset::WaveOrShape>& items, const char* kind,
+                               double pointsPerItem, double& total)
+        {
+            for (size_t i = 0; i < items.size(); ++i)
+            {
+                const auto& item = items[i];
+                const std::string prefix = kind + std::to_string(i) + " ";
+                double perFrame = 0.0;
+                double perPoint = 0.0;
+
+                if (!compiles(eval, item.initCode, prefix + "init", error, init)
+                    || !compiles(eval, item.perFrameCode, prefix + "per_frame", error, perFrame)
+                    || !compiles(eval, item.perPointCode, prefix + "per_point", error, perPoint))
+                    return false;
+
+                if (item.enabled)
+                    total += perFrame + perPoint * pointsPerItem;
+            }
+
+            return true;
+        };
+
+        return compilesAll(preset.waves, "wave_", wavePoints, counts.waves)
+            && compilesAll(preset.shapes, "shape_", 0.0, counts.shapes);
+    }
+
+    int countOccurrences(const std::string& text, std::string_view token)
+    {
+        int count = 0;
+        for (size_t pos = text.find(token); pos != std::string::npos; pos = text.find(token, pos + token.size()))
+            ++count;
+
+        return count;
+    }
+
+    // Rough rates for turning GPU work into expression VM instructions, so
+    // a single number ranks presets; PresetBudget learns what it costs here
+    constexpr double meshVertices = 49.0 * 37.0;       // SoftwareRenderer's 48x36 mesh
+    constexpr double waveDrawCost = 400.0;
+    constexpr double shapeDrawCost = 200.0;
+    constexpr double textureSampleCost = 2000.0;       // One fetch for every pixel of a pass
+    constexpr double shaderStatementCost = 300.0;
+    constexpr double blurLevelCost = 6000.0;           // Two passes per level
+    constexpr double basePassCost = 4000.0;            // Warp and composite with default shaders
+
+    double shaderCost(const std::string& hlsl, int& blurLevels)
+    {
+        blurLevels = std::max(blurLevels, ShaderCompiler::getRequiredBlurLevels(hlsl));
+
+        const int samples = countOccurrences(hlsl, "tex2D") + countOccurrences(hlsl, "tex3D")
+                          + countOccurrences(hlsl, "GetBlur") + countOccurrences(hlsl, "GetMain")
+                          + countOccurrences(hlsl, "GetPixel");
+
+        return samples * textureSampleCost + countOccurrences(hlsl, ";") * shaderStatementCost;
+    }
+
+    float costOf(const MilkDropPreset& preset, const InstructionCounts& counts)
+    {
+        int blurLevels = 0;
+        double cost = basePassCost + counts.perFrame + counts.perPixel * meshVertices
+                    + counts.waves + counts.shapes
+                    + shaderCost(preset.warpShaderCode, blurLevels)
+                    + shaderCost(preset.compShaderCode, blurLevels);
+
+        for (const auto& wave : preset.waves)
+            cost += wave.enabled ? waveDrawCost : 0.0;
+
+        for (const auto& shape : preset.shapes)
+            cost += shape.enabled ? shapeDrawCost : 0.0;
+
+        return static_cast<float>(cost + blurLevels * blurLevelCost);
+    }
+
+    // The parser stores MILKDROP_PRESET_VERSION as the name, and most
+    // presets have no name line at all; the file name is the real title
+    std::string displayName(const MilkDropPreset& preset, const juce::File& file)
+    {
+        juce::String name = juce::String::fromUTF8(preset.name.c_str()).trim();
+
+        if (name.isEmpty() || name.containsOnly("0123456789."))
+            return file.getFileNameWithoutExtension().toStdString();
+
+        return name.toStdString();
+    }
+}
+
+PresetCatalog::PresetCatalog()
+    : snapshot(std::make_shared<const std::vector<Entry>>())
+{
+}
+
+PresetCatalog::~PresetCatalog()
+{
+    cancelReconcile();
+}
+
+juce::File PresetCatalog::getDefaultCatalogFile()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+             .getChildFile("FlarkViz/cache/preset-catalog.bin");
+}
+
+//==============================================================================
+void PresetCatalog::open(const juce::File& presetsFolder, const juce::File& catalogFile)
+{
+    cancelReconcile();
+
+    const std::string root = presetsFolder.getFullPathName().toStdString();
+
+    auto startTicks = juce::Time::getHighResolutionTicks();
+    const bool catalogLoaded = mapCatalog(catalogFile, root);
+    loadTimeMs = juce::Time::highResolutionTicksToSeconds(
+        juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+
+    if (catalogLoaded)
+        DBG("FlarkViz: Preset catalog mapped in " << loadTimeMs << " ms ("
+            << (int) getSnapshot()->size() << " presets)");
+    else
+        publish({});
+
+    cancelRequested = false;
+    reconciling = true;
+    reconcileThread = std::thread([this, presetsFolder, catalogFile, catalogLoaded,
+                                   numThreads = numParseThreads]
+    {
+        reconcile(presetsFolder, catalogFile, catalogLoaded, numThreads);
+    });
+}
+
+PresetCatalog::Snapshot PresetCatalog::getSnapshot() const
+{
+    std::lock_guard<std::mutex> lock(snapshotLock);
+    return snapshot;
+}
+
+int PresetCatalog::indexOf(const std::vector<Entry>& entries, const std::string& path)
+{
+    auto it = std::lower_bound(entries.begin(), entries.end(), path,
+                               [](const Entry& entry, const std::string& p) { return entry.path < p; });
+
+    if (it == entries.end() || it->path != path)
+        return -1;
+
+    return static_cast<int>(it - entries.begin());
+}
+
+int PresetCatalog::findEntry(const std::vector<Entry>& entries, const std::string& path)
+{
+    const int index = indexOf(entries, path);
+    if (index >= 0)
+        return index;
+
+    for (size_t i = 0; i < entries.size(); ++i)
+        for (const auto& alias : entries[i].aliases)
+            if (alias.path == path)
+                return static_cast<int>(i);
+
+    return -1;
+}
+
+void PresetCatalog::waitForReconcile()
+{
+    if (reconcileThread.joinable())
+        reconcileThread.join();
+}
+
+void PresetCatalog::cancelReconcile()
+{
+    cancelRequested = true;
+    waitForReconcile();
+}
+
+void PresetCatalog::publish(std::vector<Entry> entries)
+{
+    auto published = std::make_shared<const std::vector<Entry>>(std::move(entries));
+
+    {
+        std::lock_guard<std::mutex> lock(snapshotLock);
+        snapshot = std::move(published);
+    }
+
+    ++generation;
+}
+
+//==============================================================================
+uint64_t PresetCatalog::hashContent(const void* data, size_t size)
+{
+    auto* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = fnvOffsetBasis;
+
+    for (size_t i = 0; i < size; ++i)
+        fnvMix(hash, bytes[i]);
+
+    return hash;
+}
+
+uint64_t PresetCatalog::hashNormalized(std::string_view text)
+{
+    if (text.substr(0, 3) == "\xEF\xBB\xBF")
+        text.remove_prefix(3);
+
+    uint64_t hash = fnvOffsetBasis;
+    bool inLine = false;        // Something on this line has been hashed
+    bool pendingSpace = false;  // Whitespace since then
+
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        const char c = text[i];
+
+        if (c == '\n' || c == '\r')
+        {
+            if (inLine)
+                fnvMix(hash, '\n');
+
+            inLine = false;
+            pendingSpace = false;
+        }
+        else if (c == ' ' || c == '\t' || c == '\f' || c == '\v')
+        {
+            pendingSpace = inLine;
+        }
+        else if (!inLine && c == '/' && i + 1 < text.size() && text[i + 1] == '/')
+        {
+            // A comment line, which the parsers skip: on to its line ending
+            while (i + 1 < text.size() && text[i + 1] != '\n' && text[i + 1] != '\r')
+                ++i;
+        }
+        else
+        {
+            if (pendingSpace)
+                fnvMix(hash, ' ');
+
+            fnvMix(hash, static_cast<uint8_t>(c));
+            inLine = true;
+            pendingSpace = false;
+        }
+    }
+
+    // With or without a final line ending
+    if (inLine)
+        fnvMix(hash, '\n');
+
+    return hash;
+}
+
+bool PresetCatalog::readEntry(const juce::File& file, Entry& entry)
+{
+    // Hash and parse straight out of the mapping; empty files don't map
+    juce::MemoryMappedFile mapping(file, juce::MemoryMappedFile::readOnly);
+    std::string_view text;
+
+    if (mapping.getData() != nullptr)
+        text = std::string_view(static_cast<const char*>(mapping.getData()), mapping.getSize());
+    else if (!file.existsAsFile() || file.getSize() > 0)
+        return false;
+
+    entry.path = file.getFullPathName().toStdString();
+    entry.modificationTime = file.getLastModificationTime().toMilliseconds();
+    entry.fileSize = static_cast<int64_t>(text.size());
+    entry.contentHash = hashContent(text.data(), text.size());
+
+    // Rare UTF-16 files go through juce::String to become UTF-8
+    juce::String converted;
+    if (PresetParser::isUtf16(text))
+    {
+        converted = file.loadFileAsString();
+        text = std::string_view(converted.toRawUTF8(), converted.getNumBytesAsUTF8());
+    }
+
+    parseEntry(text, file, entry);
+    return true;
+}
+
+float PresetCatalog::estimateCost(const MilkDropPreset& preset)
+{
+    std::string error;
+    InstructionCounts counts;
+    validate(preset, error, counts);
+    return costOf(preset, counts);
+}
+
+void PresetCatalog::parseEntry(std::string_view text, const juce::File& file, Entry& entry)
+{
+    entry.normalizedHash = hashNormalized(text);
+
+    if (file.hasFileExtension("milk2"))
+    {
+        auto pair = Milk2Loader::loadFromBuffer(text);
+
+        entry.name = file.getFileNameWithoutExtension().toStdString();
+        entry.author = pair.presetA.author;
+        entry.rating = pair.presetA.fRating;
+        entry.features = doublePreset | featuresOf(pair.presetA) | featuresOf(pair.presetB);
+
+        // Double-preset mode shows both at once
+        std::string error;
+        InstructionCounts countsA, countsB;
+
+        if (!validate(pair.presetA, error, countsA))
+            entry.error = "preset A " + error;
+        else if (!validate(pair.presetB, error, countsB))
+            entry.error = "preset B " + error;
+
+        entry.cost = costOf(pair.presetA, countsA) + costOf(pair.presetB, countsB);
+    }
+    else
+    {
+        MilkDropPreset preset;
+        preset.loadFromBuffer(text);
+
+        entry.name = displayName(preset, file);
+        entry.author = preset.author;
+        entry.rating = preset.fRating;
+        entry.features = featuresOf(preset);
+
+        InstructionCounts counts;
+        validate(preset, entry.error, counts);
+        entry.cost = costOf(preset, counts);
+    }
+
+    entry.valid = entry.error.empty();
+}
+
+//==============================================================================
+std::shared_ptr<const PresetPack> PresetCatalog::getPack(const juce::File& packFile, int64_t modificationTime,
+                                                         int64_t fileSize)
+{
+    std::lock_guard<std::mutex> lock(packsLock);
+    const auto path = packFile.getFullPathName().toStdString();
+
+    auto it = openPacks.find(path);
+    if (it != openPacks.end() && it->second.modificationTime == modificationTime && it->second.fileSize == fileSize)
+        if (auto pack = it->second.pack.lock())
+            return pack;
+
+    // Member indexes are only good for the pack they were read from
+    if (packFile.getLastModificationTime().toMilliseconds() != modificationTime || packFile.getSize() != fileSize)
+        return nullptr;
+
+    auto pack = std::make_shared<PresetPack>();
+    if (!pack->open(packFile))
+    {
+        DBG("FlarkViz: Could not open preset pack " << packFile.getFullPathName() << ": " << pack->getLastError());
+        return nullptr;
+    }
+
+    // Packs no snapshot lists any more are already unmapped
+    for (auto open = openPacks.begin(); open != openPacks.end();)
+        open = open->second.pack.expired() ? openPacks.erase(open) : std::next(open);
+
+    openPacks[path] = { pack, modificationTime, fileSize };
+    return pack;
+}
+
+int PresetCatalog::readPack(const juce::File& packFile, int64_t modificationTime, int64_t fileSize,
+                            std::vector<Entry>& entries)
+{
+    auto pack = getPack(packFile, modificationTime, fileSize);
+    if (pack == nullptr)
+    {
+        DBG("FlarkViz: Skipping preset pack " << packFile.getFullPathName());
+        return 0;
+    }
+
+    // The index was filled in by PresetCatalog::parseEntry() when the pack was built
+    for (int i = 0; i < pack->getNumMembers(); ++i)
+    {
+        const auto member = pack->getMember(i);
+
+        Entry entry;
+        entry.path = PresetPack::getMemberFile(packFile, member.name).getFullPathName().toStdString();
+        entry.modificationTime = modificationTime;
+        entry.fileSize = fileSize;
+        entry.contentHash = member.contentHash;
+        entry.normalizedHash = member.normalizedHash;
+        entry.name = std::string(member.title);
+        entry.author = std::string(member.author);
+        entry.rating = member.rating;
+        entry.cost = member.cost;
+        entry.features = member.features | packed;
+        entry.valid = member.valid;
+        entry.error = std::string(member.error);
+        entry.pack = pack;
+        entry.packMember = i;
+        entries.push_back(std::move(entry));
+    }
+
+    return pack->getNumMembers();
+}
+
+std::vector<PresetCatalog::Entry> PresetCatalog::expandAliases(const std::vector<Entry>& entries)
+{
+    // One entry per file again; aliases take their entry's metadata
+    std::vector<Entry> files;
+    files.reserve(entries.size());
+
+    for (const auto& entry : entries)
+    {
+        files.push_back(entry);
+        files.back().aliases.clear();
+
+        for (const auto& alias : entry.aliases)
+        {
+            Entry file = files.back();
+            file.path = alias.path;
+            file.name = alias.name;
+            file.modificationTime = alias.modificationTime;
+            file.fileSize = alias.fileSize;
+            file.contentHash = alias.contentHash;
+            file.pack = alias.pack;
+            file.packMember = alias.packMember;
+            files.push_back(std::move(file));
+        }
+    }
+
+    std::sort(files.begin(), files.end(), pathLess);
+    return files;
+}
+
+int PresetCatalog::collapseDuplicates(std::vector<Entry>& entries)
+{
+    // Entries are in path order, so the first of a group becomes the entry
+    // and the rest (in path order) its aliases. A .milk and a .milk2 with
+    // the same text are still different presets.
+    std::unordered_map<uint64_t, size_t> firstByHash;
+    firstByHash.reserve(entries.size());
+    std::vector<char> folded(entries.size(), 0);
+    int duplicates = 0;
+
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        auto& entry = entries[i];
+        const uint64_t key = entry.normalizedHash ^ (entry.hasFeature(doublePreset) ? 0x9e3779b97f4a7c15ull : 0);
+        auto [first, inserted] = firstByHash.emplace(key, i);
+
+        if (inserted)
+            continue;
+
+        Alias alias;
+        alias.path = std::move(entry.path);
+        alias.name = std::move(entry.name);
+        alias.modificationTime = entry.modificationTime;
+        alias.fileSize = entry.fileSize;
+        alias.contentHash = entry.contentHash;
+        alias.pack = std::move(entry.pack);
+        alias.packMember = entry.packMember;
+        entries[first->second].aliases.push_back(std::move(alias));
+
+        folded[i] = 1;
+        ++duplicates;
+    }
+
+    if (duplicates > 0)
+    {
+        // Entries before the first folded one stay where they are; moving
+        // one onto itself would empty it
+        size_t kept = 0;
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            if (folded[i])
+                continue;
+
+            if (kept != i)
+                entries[kept] = std::move(entries[i]);
+
+            ++kept;
+        }
+
+        entries.resize(kept);
+    }
+
+    return duplicates;
+}
+
+void PresetCatalog::reconcile(juce::File presetsFolder, juce::File catalogFile, bool catalogLoaded,
+                              int numThreads)
+{
+    auto startTicks = juce::Time::getHighResolutionTicks();
+    ReconcileStats stats;
+
+    // Compared file by file, so aliases are looked up like any other file
+    const auto previous = expandAliases(*getSnapshot());
+    std::unordered_map<std::string_view, const Entry*> previousByPath;
+    previousByPath.reserve(previous.size());
+
+    for (const auto& entry : previous)
+        previousByPath.emplace(entry.path, &entry);
+
+    struct ChangedFile
+    {
+        juce::File file;
+        int64_t modificationTime;
+        int64_t fileSize;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<ChangedFile> changed;
+    entries.reserve(previous.size());
+    int previousSeen = 0;
+
+    if (presetsFolder.isDirectory())
+    {
+        // One walk for all extensions; the iterator already has each
+        // file's time and size, so unchanged files are never opened
+        for (const auto& item : juce::RangedDirectoryIterator(presetsFolder, true, "*.milk;*.milk2;*.fvpack",
+                                                              juce::File::findFiles))
+        {
+            if (cancelRequested)
+            {
+                reconciling = false;
+                return;
+            }
+
+            const auto file = item.getFile();
+            const std::string path = file.getFullPathName().toStdString();
+            const int64_t modificationTime = item.getModificationTime().toMilliseconds();
+            const int64_t fileSize = item.getFileSize();
+
+            if (file.hasFileExtension(PresetPack::fileExtension))
+            {
+                // Members carry the pack's time and size and sit together in path order
+                const std::string prefix = path + juce::File::getSeparatorString().toStdString();
+                auto first = std::lower_bound(previous.begin(), previous.end(), prefix,
+                                              [](const Entry& entry, const std::string& p) { return entry.path < p; });
+                auto last = first;
+
+                while (last != previous.end() && last->path.compare(0, prefix.size(), prefix) == 0)
+                    ++last;
+
+                previousSeen += static_cast<int>(last - first);
+
+                if (first != last && first->modificationTime == modificationTime && first->fileSize == fileSize)
+                {
+                    entries.insert(entries.end(), first, last);
+                    stats.reused += static_cast<int>(last - first);
+                    continue;
+                }
+
+                stats.packMembers += readPack(file, modificationTime, fileSize, entries);
+                ++stats.packs;
+                continue;
+            }
+
+            auto it = previousByPath.find(path);
+            if (it != previousByPath.end())
+                ++previousSeen;
+
+            if (it != previousByPath.end()
+                && it->second->modificationTime == modificationTime
+                && it->second->fileSize == fileSize)
+            {
+                entries.push_back(*it->second);
+                ++stats.reused;
+                continue;
+            }
+
+            changed.push_back({ file, modificationTime, fileSize });
+        }
+    }
+    else
+    {
+        DBG("FlarkViz: Presets folder does not exist: " << presetsFolder.getFullPathName());
+    }
+
+    // Parse and validate new or changed files, one task per file; tasks
+    // are claimed one at a time, so a few slow presets don't hold up a core
+    if (!changed.empty())
+    {
+        auto parseStart = juce::Time::getHighResolutionTicks();
+
+        std::vector<Entry> parsed(changed.size());
+        std::vector<char> readOk(changed.size(), 0);
+
+        WorkerPool pool(numThreads);
+        stats.parseThreads = pool.getNumThreads() + 1;
+
+        pool.parallelFor(static_cast<int>(changed.size()), [&](int i)
+        {
+            if (cancelRequested)
+                return;
+
+            const auto& source = changed[static_cast<size_t>(i)];
+            auto& entry = parsed[static_cast<size_t>(i)];
+
+            readOk[static_cast<size_t>(i)] = readEntry(source.file, entry) ? 1 : 0;
+
+            // Keep the directory's view, which the next reconcile compares against
+            entry.modificationTime = source.modificationTime;
+            entry.fileSize = source.fileSize;
+        });
+
+        if (cancelRequested)
+        {
+            reconciling = false;
+            return;
+        }
+
+        for (size_t i = 0; i < parsed.size(); ++i)
+        {
+            if (readOk[i])
+            {
+                entries.push_back(std::move(parsed[i]));
+                ++stats.parsed;
+            }
+        }
+
+        stats.parseMs = juce::Time::highResolutionTicksToSeconds(
+            juce::Time::getHighResolutionTicks() - parseStart) * 1000.0;
+    }
+
+    std::sort(entries.begin(), entries.end(), pathLess);
+
+    stats.files = static_cast<int>(entries.size());
+    stats.removed = static_cast<int>(previous.size()) - previousSeen;
+    stats.invalid = static_cast<int>(std::count_if(entries.begin(), entries.end(),
+                                                   [](const Entry& e) { return !e.valid; }));
+    stats.duplicates = collapseDuplicates(entries);
+
+    const bool anythingChanged = !changed.empty() || stats.packs > 0 || stats.removed > 0;
+
+    if (anythingChanged || !catalogLoaded)
+    {
+        if (!writeCatalog(catalogFile, presetsFolder.getFullPathName().toStdString(), entries))
+            DBG("FlarkViz: Could not write preset catalog " << catalogFile.getFullPathName());
+
+        publish(std::move(entries));
+    }
+
+    stats.timeMs = juce::Time::highResolutionTicksToSeconds(
+        juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+    lastStats = stats;
+
+    DBG("FlarkViz: Preset catalog reconciled in " << stats.timeMs << " ms: "
+        << stats.files << " presets (" << stats.invalid << " invalid), "
+        << stats.parsed << " parsed, " << stats.reused << " unchanged, "
+        << stats.removed << " removed");
+
+    if (stats.duplicates > 0)
+        DBG("FlarkViz: Folded " << stats.duplicates << " duplicate presets into "
+            << stats.files - stats.duplicates << " entries");
+
+    if (stats.packs > 0)
+        DBG("FlarkViz: Read " << stats.packMembers << " presets from " << stats.packs << " packs");
+
+    if (stats.parsed > 0)
+        DBG("FlarkViz: Parsed " << stats.parsed << " presets on " << stats.parseThreads
+            << " threads in " << stats.parseMs << " ms ("
+            << juce::roundToInt(stats.getFilesPerSecond()) << " files/s)");
+
+    reconciling = false;
+}
+
+//==============================================================================
+bool PresetCatalog::mapCatalog(const juce::File& catalogFile, const std::string& root)
+{
+    if (!catalogFile.existsAsFile())
+        return false;
+
+    juce::MemoryMappedFile mapping(catalogFile, juce::MemoryMappedFile::readOnly);
+    if (mapping.getData() == nullptr || mapping.getSize() < sizeof(FileHeader))
+        return false;
+
+    auto* base = static_cast<const char*>(mapping.getData());
+
+    FileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+
+    const uint64_t recordBytes = static_cast<uint64_t>(header.numEntries) * sizeof(Record);
+    if (std::memcmp(header.magic, catalogMagic, sizeof(catalogMagic)) != 0
+        || header.version != version
+        || mapping.getSize() < sizeof(FileHeader) + recordBytes + header.stringBytes
+        || header.rootLength > header.stringBytes)
+    {
+        DBG("FlarkViz: Ignoring stale preset catalog");
+        return false;
+    }
+
+    const char* strings = base + sizeof(FileHeader) + recordBytes;
+
+    if (std::string_view(strings, header.rootLength) != root)
+        return false;
+
+    auto stringAt = [&](uint32_t offset, uint32_t length, std::string& out)
+    {
+        if (static_cast<uint64_t>(offset) + length > header.stringBytes)
+            return false;
+
+        out.assign(strings + offset, length);
+        return true;
+    };
+
+    std::vector<Entry> entries;
+    entries.reserve(header.numEntries);
+
+    // Members of one pack are consecutive in path order
+    std::string packPrefix;
+    std::shared_ptr<const PresetPack> pack;
+
+    auto findPack = [&](const std::string& path, const Record& record)
+    {
+        if (record.packMember < 0)
+            return std::shared_ptr<const PresetPack>();
+
+        if (packPrefix.empty() || path.compare(0, packPrefix.size(), packPrefix) != 0)
+        {
+            juce::File packFile;
+            std::string memberName;
+            if (!PresetPack::splitMemberPath(juce::File(juce::String::fromUTF8(path.c_str())), packFile, memberName))
+                return std::shared_ptr<const PresetPack>();
+
+            packPrefix = (packFile.getFullPathName() + juce::File::getSeparatorString()).toStdString();
+            pack = getPack(packFile, record.modificationTime, record.fileSize);
+        }
+
+        return pack;
+    };
+
+    for (uint32_t i = 0; i < header.numEntries; ++i)
+    {
+        Record record;
+        std::memcpy(&record, base + sizeof(FileHeader) + i * sizeof(Record), sizeof(record));
+
+        bool ok = true;
+
+        if (record.aliasOf == noAlias)
+        {
+            auto& entry = entries.emplace_back();
+            entry.contentHash = record.contentHash;
+            entry.normalizedHash = record.normalizedHash;
+            entry.modificationTime = record.modificationTime;
+            entry.fileSize = record.fileSize;
+            entry.rating = record.rating;
+            entry.cost = record.cost;
+            entry.features = record.features;
+            entry.valid = record.valid != 0;
+
+            ok = stringAt(record.pathOffset, record.pathLength, entry.path)
+                 && stringAt(record.nameOffset, record.nameLength, entry.name)
+                 && stringAt(record.authorOffset, record.authorLength, entry.author)
+                 && stringAt(record.errorOffset, record.errorLength, entry.error);
+
+            if (ok)
+            {
+                entry.pack = findPack(entry.path, record);
+                entry.packMember = entry.pack != nullptr ? record.packMember : -1;
+            }
+        }
+        else if (record.aliasOf < entries.size())
+        {
+            auto& alias = entries[record.aliasOf].aliases.emplace_back();
+            alias.contentHash = record.contentHash;
+            alias.modificationTime = record.modificationTime;
+            alias.fileSize = record.fileSize;
+
+            ok = stringAt(record.pathOffset, record.pathLength, alias.path)
+                 && stringAt(record.nameOffset, record.nameLength, alias.name);
+
+            if (ok)
+            {
+                alias.pack = findPack(alias.path, record);
+                alias.packMember = alias.pack != nullptr ? record.packMember : -1;
+            }
+        }
+        else
+        {
+            ok = false;
+        }
+
+        if (!ok)
+        {
+            DBG("FlarkViz: Ignoring corrupt preset catalog");
+            return false;
+        }
+    }
+
+    publish(std::move(entries));
+    return true;
+}
+
+bool PresetCatalog::writeCatalog(const juce::File& catalogFile, const std::string& root,
+                                 const std::vector<Entry>& entries)
+{
+    catalogFile.getParentDirectory().createDirectory();
+
+    std::string strings = root;
+    std::vector<Record> records;
+    records.reserve(entries.size());
+
+    auto addString = [&strings](const std::string& s, uint32_t& offset, uint32_t& length)
+    {
+        offset = static_cast<uint32_t>(strings.size());
+        length = static_cast<uint32_t>(s.size());
+        strings += s;
+    };
+
+    for (const auto& entry : entries)
+    {
+        Record record;
+        std::memset(&record, 0, sizeof(record));
+
+        record.contentHash = entry.contentHash;
+        record.normalizedHash = entry.normalizedHash;
+        record.modificationTime = entry.modificationTime;
+        record.fileSize = entry.fileSize;
+        record.rating = entry.rating;
+        record.cost = entry.cost;
+        record.features = entry.features;
+        record.valid = entry.valid ? 1 : 0;
+        record.aliasOf = noAlias;
+        record.packMember = entry.packMember;
+        addString(entry.path, record.pathOffset, record.pathLength);
+        addString(entry.name, record.nameOffset, record.nameLength);
+        addString(entry.author, record.authorOffset, record.authorLength);
+        addString(entry.error, record.errorOffset, record.errorLength);
+        records.push_back(record);
+    }
+
+    // Aliases after all entries, so reading them back never looks ahead;
+    // everything but their own file details comes from their entry
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        for (const auto& alias : entries[i].aliases)
+        {
+            Record record;
+            std::memset(&record, 0, sizeof(record));
+
+            record.contentHash = alias.contentHash;
+            record.modificationTime = alias.modificationTime;
+            record.fileSize = alias.fileSize;
+            record.aliasOf = static_cast<uint32_t>(i);
+            record.packMember = alias.packMember;
+            addString(alias.path, record.pathOffset, record.pathLength);
+            addString(alias.name, record.nameOffset, record.nameLength);
+            records.push_back(record);
+        }
+    }
+
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, catalogMagic, sizeof(catalogMagic));
+    header.version = version;
+    header.numEntries = static_cast<uint32_t>(records.size());
+    header.stringBytes = strings.size();
+    header.rootLength = static_cast<uint32_t>(root.size());
+
+    // Write beside the target and swap in, so a crash never leaves a torn catalog
+    juce::TemporaryFile temp(catalogFile);
+    {
+        juce::FileOutputStream out(temp.getFile());
+        if (!out.openedOk())
+            return false;
+
+        out.write(&header, sizeof(header));
+        out.write(records.data(), records.size() * sizeof(Record));
+        out.write(strings.data(), strings.size());
+        out.flush();
+
+        if (out.getStatus().failed())
+            return false;
+    }
+
+    return temp.overwriteTargetFileWithTemporary();
+}
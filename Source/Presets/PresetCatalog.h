@@ -0,0 +1,290 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../Core/WorkerPool.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct MilkDropPreset;
+class PresetPack;
+
+/**
+ * @class PresetCatalog
+ * @brief Persistent index of the preset library
+ *
+ * One entry per .milk / .milk2 file with what is needed to list and pick
+ * presets without opening them: path, modification time, size, content
+ * hash, name, author, rating, estimated cost and feature flags.
+ *
+ * open() memory-maps the catalog file written by the last run and
+ * publishes its entries straight away, so startup costs one mapping
+ * rather than a recursive scan of the library. A background thread then
+ * walks the folder and reconciles: files whose modification time and size
+ * match their entry are kept as they are, and only new or changed files
+ * are read and parsed. If anything changed, the new entries are published
+ * and the catalog file is rewritten.
+ *
+ * Preset packs (.fvpack, see PresetPack) in the folder are listed member
+ * by member alongside loose files. Their index already carries everything
+ * an entry needs, so a new or changed pack is read without parsing any
+ * preset, and an unchanged one is reused like a file. Packs stay mapped
+ * while a snapshot lists their members: each such entry holds the open
+ * PresetPack and its member index, so loading a member is a record read
+ * (see PreparedPreset::loadFromPack()). The catalog keeps a registry of the
+ * open packs, so snapshots share one mapping per pack.
+ *
+ * Files whose text only differs in whitespace (line endings, indentation,
+ * blank lines) or in comment lines share a normalized content hash. They
+ * are collapsed into one entry, the first by path, which lists the others
+ * as aliases, so duplicates in community packs are neither listed nor
+ * picked twice.
+ *
+ * Parsing happens on a WorkerPool, one file per task. Every preset is
+ * parsed with MilkDropPreset / Milk2Loader and all of its expression
+ * blocks are compiled, so broken presets are marked invalid (with the
+ * error) at scan time rather than found on screen.
+ *
+ * Entries are sorted by path. Readers take an immutable snapshot; a
+ * reconcile replaces the snapshot rather than editing it, and bumps the
+ * generation.
+ */
+class PresetCatalog
+{
+public:
+    /** Feature flags of an entry */
+    enum Feature : uint32_t
+    {
+        doublePreset    = 1u << 0,  // .milk2
+        warpShader      = 1u << 1,
+        compositeShader = 1u << 2,
+        customWaves     = 1u << 3,
+        customShapes    = 1u << 4,
+        perPixelCode    = 1u << 5,
+        packed          = 1u << 6   // Member of a .fvpack
+    };
+
+    /** Another file with the same normalized content as an entry */
+    struct Alias
+    {
+        std::string path;
+        std::string name;
+        int64_t modificationTime = 0;
+        int64_t fileSize = 0;
+        uint64_t contentHash = 0;
+        std::shared_ptr<const PresetPack> pack;     // As in Entry
+        int packMember = -1;
+    };
+
+    struct Entry
+    {
+        std::string path;
+        int64_t modificationTime = 0;   // Milliseconds since the epoch
+        int64_t fileSize = 0;
+        uint64_t contentHash = 0;       // hashContent() of the file bytes
+        uint64_t normalizedHash = 0;    // hashNormalized() of the text
+        std::string name;
+        std::string author;
+        float rating = 3.0f;
+        float cost = 0.0f;              // estimateCost()
+        uint32_t features = 0;
+        bool valid = true;
+        std::string error;              // Why the preset is invalid
+        std::vector<Alias> aliases;     // Duplicates, sorted by path
+
+        // Pack members only: the open pack and the member's record index
+        std::shared_ptr<const PresetPack> pack;
+        int packMember = -1;
+
+        juce::File getFile() const { return juce::File(juce::String::fromUTF8(path.c_str())); }
+        bool hasFeature(Feature feature) const { return (features & feature) != 0; }
+    };
+
+    using Snapshot = std::shared_ptr<const std::vector<Entry>>;
+
+    struct ReconcileStats
+    {
+        int files = 0;      // Including duplicates
+        int reused = 0;     // Unchanged since the catalog was written
+        int parsed = 0;     // New or changed
+        int removed = 0;
+        int invalid = 0;    // Of all files, not just the parsed ones
+        int duplicates = 0; // Files folded into another entry as aliases
+        int packs = 0;      // Packs whose index was read
+        int packMembers = 0;
+        int parseThreads = 0;
+        double parseMs = 0.0;
+        double timeMs = 0.0;
+
+        double getFilesPerSecond() const { return parseMs > 0.0 ? parsed * 1000.0 / parseMs : 0.0; }
+    };
+
+    PresetCatalog();
+    ~PresetCatalog();
+
+    /**
+     * @brief Load the catalog for a presets folder and start reconciling it
+     * @param presetsFolder Library root, searched recursively
+     * @param catalogFile Where the catalog is persisted
+     *
+     * A catalog written for a different folder, or by another version, is
+     * ignored; the library is then published once the first scan is done.
+     */
+    void open(const juce::File& presetsFolder, const juce::File& catalogFile);
+
+    /** Current entries, sorted by path; never null */
+    Snapshot getSnapshot() const;
+
+    /** Incremented every time a new snapshot is published */
+    uint32_t getGeneration() const { return generation.load(); }
+
+    /** Index of a path in a snapshot, or -1 */
+    static int indexOf(const std::vector<Entry>& entries, const std::string& path);
+
+    /**
+     * @brief Index of the entry a path is listed under, or -1
+     *
+     * Like indexOf(), but also finds paths that are another entry's alias
+     * (by a linear search, so not for every frame).
+     */
+    static int findEntry(const std::vector<Entry>& entries, const std::string& path);
+
+    bool isReconciling() const { return reconciling.load(); }
+
+    /** Block until the background reconcile has finished */
+    void waitForReconcile();
+
+    /** Stop the background reconcile early; nothing is published or written */
+    void cancelReconcile();
+
+    /**
+     * @brief Threads that parse presets during a reconcile
+     * @param numThreads Worker count; <= 0 uses hardware concurrency - 1.
+     *                   The reconcile thread works alongside them.
+     *                   Takes effect at the next open().
+     */
+    void setNumParseThreads(int numThreads) { numParseThreads = numThreads; }
+
+    /** Valid once isReconciling() returns false */
+    ReconcileStats getLastReconcileStats() const { return lastStats; }
+
+    /** Time spent mapping the catalog in open() */
+    double getLoadTimeMs() const { return loadTimeMs; }
+
+    /** 64-bit FNV-1a of a file's bytes */
+    static uint64_t hashContent(const void* data, size_t size);
+
+    /**
+     * @brief 64-bit FNV-1a of preset text with whitespace and comment differences removed
+     *
+     * Ignores a UTF-8 byte order mark, line endings, leading and trailing
+     * whitespace on each line, blank lines and lines starting with "//"
+     * (which the parsers skip), and treats any run of spaces and tabs
+     * inside a line as a single space.
+     */
+    static uint64_t hashNormalized(std::string_view text);
+
+    /**
+     * @brief Read, parse and validate one preset file into a catalog entry
+     * @return false if the file couldn't be read
+     */
+    static bool readEntry(const juce::File& file, Entry& entry);
+
+    /**
+     * @brief Parse and validate UTF-8 preset text into an entry's metadata
+     * @param file Decides .milk / .milk2 and gives the fallback name
+     *
+     * Sets normalizedHash, name, author, rating, features, valid and
+     * error; leaves path, time, size and contentHash to the caller.
+     */
+    static void parseEntry(std::string_view text, const juce::File& file, Entry& entry);
+
+    /**
+     * @brief Estimated work per frame, in expression VM instructions
+     *
+     * Counts the instructions of per_frame code, of per_pixel code for
+     * every mesh vertex and of custom waves for every sample, and converts
+     * shader texture fetches and statements, blur levels and wave / shape
+     * draws at fixed rates. Only good for ranking presets against each
+     * other; PresetBudget learns what a unit costs on the machine.
+     */
+    static float estimateCost(const MilkDropPreset& preset);
+
+    /** Default catalog location in the user's application data folder */
+    static juce::File getDefaultCatalogFile();
+
+private:
+    struct FileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t numEntries;        // Records, entries and aliases
+        uint64_t stringBytes;
+        uint32_t rootLength;        // Library root, first in the string table
+        uint32_t reserved;
+    };
+
+    struct Record
+    {
+        uint64_t contentHash;
+        int64_t modificationTime;
+        int64_t fileSize;
+        float rating;
+        uint32_t features;
+        uint32_t pathOffset, pathLength;
+        uint32_t nameOffset, nameLength;
+        uint32_t authorOffset, authorLength;
+        uint32_t errorOffset, errorLength;
+        uint32_t valid;
+        uint32_t aliasOf;           // Record of the entry it is an alias of, or noAlias
+        uint64_t normalizedHash;
+        float cost;
+        int32_t packMember;         // Record index in its pack, or -1
+    };
+
+    // Entries are written first, then their aliases
+    static constexpr uint32_t noAlias = 0xffffffffu;
+    static constexpr uint32_t version = 7;
+
+    /** A pack mapped for some snapshot's entries */
+    struct OpenPack
+    {
+        std::weak_ptr<const PresetPack> pack;
+        int64_t modificationTime = 0;
+        int64_t fileSize = 0;
+    };
+
+    bool mapCatalog(const juce::File& catalogFile, const std::string& root);
+    bool writeCatalog(const juce::File& catalogFile, const std::string& root,
+                      const std::vector<Entry>& entries);
+    int readPack(const juce::File& packFile, int64_t modificationTime, int64_t fileSize,
+                 std::vector<Entry>& entries);
+    std::shared_ptr<const PresetPack> getPack(const juce::File& packFile, int64_t modificationTime,
+                                              int64_t fileSize);
+    static std::vector<Entry> expandAliases(const std::vector<Entry>& entries);
+    static int collapseDuplicates(std::vector<Entry>& entries);
+    void reconcile(juce::File presetsFolder, juce::File catalogFile, bool catalogLoaded, int numThreads);
+    void publish(std::vector<Entry> entries);
+
+    mutable std::mutex snapshotLock;
+    Snapshot snapshot;
+
+    std::mutex packsLock;
+    std::unordered_map<std::string, OpenPack> openPacks;   // By pack path
+    std::atomic<uint32_t> generation {0};
+
+    std::thread reconcileThread;
+    std::atomic<bool> reconciling {false};
+    std::atomic<bool> cancelRequested {false};
+    int numParseThreads = 0;
+    ReconcileStats lastStats;
+    double loadTimeMs = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetCatalog)
+};
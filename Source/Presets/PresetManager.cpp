@@ -1,8 +1,17 @@
 #include "PresetManager.h"
 
+namespace
+{
+    constexpr size_t historySize = 50;
+    constexpr int defaultNoRepeatWindow = 50;
+
+    // A favorite is picked as often as this many presets of the same rating
+    constexpr double favoriteBoost = 3.0;
+}
+
 PresetManager::PresetManager()
 {
-    // Scan for presets in default location
+    // Open the catalog for the default location; no scan on this thread
     auto presetsFolder = juce::File::getSpecialLocation (juce::File::userDocumentsDirectory)
                            .getChildFile ("FlarkViz/presets");
     
@@ -12,6 +21,8 @@ PresetManager::PresetManager()
         DBG ("FlarkViz: Created presets folder at " << presetsFolder.getFullPathName());
     }
     
+    loadFavorites();
+    sampler.setWindowSize (defaultNoRepeatWindow);
     scanPresetsFolder (presetsFolder);
 }
 
@@ -21,32 +32,88 @@ PresetManager::~PresetManager()
 
 void PresetManager::scanPresetsFolder (const juce::File& folder)
 {
-    presets.clear();
-    
-    if (!folder.exists())
+    // Publishes the cached library now and reconciles it in the background
+    catalog.open (folder, PresetCatalog::getDefaultCatalogFile());
+    syncWithCatalog();
+
+    DBG ("FlarkViz: Found " << (int) presets->size() << " presets in catalog");
+}
+
+void PresetManager::syncWithCatalog()
+{
+    if (presets != nullptr && catalog.getGeneration() == presetsGeneration)
+        return;
+
+    presetsGeneration = catalog.getGeneration();
+    auto previous = presets;
+    presets = catalog.getSnapshot();
+    resolveFavoriteAliases();
+
+    if (previous == nullptr)
     {
-        DBG ("FlarkViz: Presets folder does not exist: " << folder.getFullPathName());
+        rebuildSampler ({});
+        queueUpcoming();
         return;
     }
-    
-    // Find all .milk and .milk2 files
-    auto milkFiles = folder.findChildFiles (juce::File::findFiles, 
-                                           true, 
-                                           "*.milk");
-    
-    auto milk2Files = folder.findChildFiles (juce::File::findFiles, 
-                                            true, 
-                                            "*.milk2");
-    
-    presets.insert (presets.end(), milkFiles.begin(), milkFiles.end());
-    presets.insert (presets.end(), milk2Files.begin(), milk2Files.end());
-    
-    DBG ("FlarkViz: Found " << presets.size() << " presets");
+
+    // Entries may have moved, or been folded into a duplicate; follow the
+    // current preset and history by path
+    auto remap = [&] (int index)
+    {
+        if (index < 0 || index >= (int) previous->size())
+            return -1;
+
+        return PresetCatalog::findEntry (*presets, (*previous)[(size_t) index].path);
+    };
+
+    currentPresetIndex = juce::jmax (0, remap (currentPresetIndex));
+
+    std::deque<int> remappedHistory;
+    for (int index : history)
+    {
+        int remapped = remap (index);
+        if (remapped >= 0)
+            remappedHistory.push_back (remapped);
+    }
+
+    history = std::move (remappedHistory);
+
+    // Indexes have shifted, so the weights are rebuilt (linear, once per
+    // catalog generation) and the no-repeat window carried over by path
+    std::vector<int> recent;
+    for (int index : sampler.getRecent())
+    {
+        int remapped = remap (index);
+        if (remapped >= 0)
+            recent.push_back (remapped);
+    }
+
+    rebuildSampler (recent);
+    upcomingRandomIndex = remap (upcomingRandomIndex);
+    queueUpcoming();
+}
+
+int PresetManager::getPresetCount()
+{
+    syncWithCatalog();
+    return (int) presets->size();
+}
+
+juce::File PresetManager::getPresetFile (int index)
+{
+    syncWithCatalog();
+
+    if (index >= 0 && index < (int) presets->size())
+        return (*presets)[(size_t) index].getFile();
+
+    return {};
 }
 
 void* PresetManager::getPreset (int index)
 {
-    if (index >= 0 && index < (int)presets.size())
+    syncWithCatalog();
+
+    if (index >= 0 && index < (int) presets->size())
     {
         currentPresetIndex = index;
         // TODO: Actually load and parse preset
@@ -57,40 +124,297 @@ void* PresetManager::getPreset (int index)
 
 void PresetManager::loadRandomPreset()
 {
-    if (presets.empty())
+    syncWithCatalog();
+
+    if (presets->empty())
     {
         DBG ("FlarkViz: No presets available");
         return;
     }
     
     // Save current index to history
-    history.push_back (currentPresetIndex);
-    if (history.size() > 50)
-        history.erase (history.begin());
+    pushHistory();
     
-    // Select random preset
-    currentPresetIndex = juce::Random::getSystemRandom().nextInt (presets.size());
+    // The pick was rolled when the last one was made, so it is usually
+    // prepared already, unless it has been shown since
+    const int count = (int) presets->size();
+    const bool upcomingUsable = upcomingRandomIndex >= 0 && upcomingRandomIndex < count
+                                 && ! sampler.isRecent (upcomingRandomIndex);
+
+    currentPresetIndex = upcomingUsable ? upcomingRandomIndex : pickRandomIndex();
+    upcomingRandomIndex = -1;  // Rolled once the current one is in the no-repeat window
     
-    DBG ("FlarkViz: Loading random preset: " << presets[currentPresetIndex].getFileName());
+    DBG ("FlarkViz: Loading random preset: " << (*presets)[(size_t) currentPresetIndex].name);
+    selectCurrentPreset();
 }
 
 void PresetManager::loadNextPreset()
 {
-    if (presets.empty())
+    syncWithCatalog();
+
+    if (presets->empty())
         return;
     
-    currentPresetIndex = (currentPresetIndex + 1) % presets.size();
-    DBG ("FlarkViz: Loading next preset: " << presets[currentPresetIndex].getFileName());
+    currentPresetIndex = findNextValidIndex (currentPresetIndex);
+
+    DBG ("FlarkViz: Loading next preset: " << (*presets)[(size_t) currentPresetIndex].name);
+    selectCurrentPreset();
 }
 
 void PresetManager::loadPreviousPreset()
 {
+    syncWithCatalog();
+
     if (!history.empty())
     {
         currentPresetIndex = history.back();
         history.pop_back();
         DBG ("FlarkViz: Loading previous preset from history");
+        selectCurrentPreset();
+    }
+}
+
+//==============================================================================
+void PresetManager::toggleFavorite()
+{
+    syncWithCatalog();
+
+    if (presets->empty())
+        return;
+
+    const auto& path = (*presets)[(size_t) currentPresetIndex].path;
+
+    if (favorites.erase (path) == 0)
+        favorites.insert (path);
+
+    sampler.setWeight (currentPresetIndex, getSamplerWeight (currentPresetIndex));
+    saveFavorites();
+    queueUpcoming();
+}
+
+bool PresetManager::isFavorite (int index)
+{
+    syncWithCatalog();
+    return index >= 0 && index < (int) presets->size()
+        && favorites.count ((*presets)[(size_t) index].path) != 0;
+}
+
+void PresetManager::loadNextFavorite()
+{
+    syncWithCatalog();
+
+    const int index = findNextFavoriteIndex();
+    if (index < 0)
+        return;
+
+    pushHistory();
+
+    currentPresetIndex = index;
+    DBG ("FlarkViz: Loading favorite: " << (*presets)[(size_t) currentPresetIndex].name);
+    selectCurrentPreset();
+}
+
+int PresetManager::findNextFavoriteIndex() const
+{
+    if (favorites.empty() || presets->empty())
+        return -1;
+
+    // Both are sorted by path, so the next favorite in library order is
+    // the first one after the current path (wrapping round)
+    const auto& currentPath = (*presets)[(size_t) currentPresetIndex].path;
+    auto it = favorites.upper_bound (currentPath);
+
+    for (size_t tries = 0; tries < favorites.size(); ++tries, ++it)
+    {
+        if (it == favorites.end())
+            it = favorites.begin();
+
+        const int index = PresetCatalog::indexOf (*presets, *it);
+        if (index >= 0 && (*presets)[(size_t) index].valid)
+            return index;
     }
+
+    return -1;
+}
+
+void PresetManager::resolveFavoriteAliases()
+{
+    // A favorite that is now another entry's duplicate becomes that entry
+    std::vector<std::pair<std::string, std::string>> renamed;
+
+    for (const auto& path : favorites)
+    {
+        if (PresetCatalog::indexOf (*presets, path) >= 0)
+            continue;
+
+        const int index = PresetCatalog::findEntry (*presets, path);
+        if (index >= 0)
+            renamed.emplace_back (path, (*presets)[(size_t) index].path);
+    }
+
+    if (renamed.empty())
+        return;
+
+    for (const auto& [from, to] : renamed)
+    {
+        favorites.erase (from);
+        favorites.insert (to);
+    }
+
+    saveFavorites();
+}
+
+void PresetManager::setNoRepeatWindow (int numPresets)
+{
+    sampler.setWindowSize (numPresets);
+}
+
+void PresetManager::loadFavorites()
+{
+    juce::StringArray lines;
+    lines.addLines (getFavoritesFile().loadFileAsString());
+
+    for (const auto& line : lines)
+        if (line.isNotEmpty())
+            favorites.insert (line.toStdString());
+}
+
+void PresetManager::saveFavorites() const
+{
+    juce::String text;
+    for (const auto& path : favorites)
+        text << juce::String::fromUTF8 (path.c_str()) << "\n";
+
+    auto file = getFavoritesFile();
+    file.getParentDirectory().createDirectory();
+
+    if (!file.replaceWithText (text))
+        DBG ("FlarkViz: Failed to write favorites to " << file.getFullPathName());
+}
+
+juce::File PresetManager::getFavoritesFile()
+{
+    return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+             .getChildFile ("FlarkViz/favorites.txt");
+}
+
+//==============================================================================
+int PresetManager::pickRandomIndex() const
+{
+    // The sampler weighs by rating and favorites and skips recent presets;
+    // a pick is then accepted with its budget weight, so presets over the
+    // frame budget are left out (the budget moves as it learns, so it
+    // isn't folded into the sampler's weights)
+    const int count = (int) presets->size();
+    if (count == 0)
+        return -1;
+
+    auto& random = juce::Random::getSystemRandom();
+    int firstPick = -1;
+
+    for (int attempts = 0; attempts < 32; ++attempts)
+    {
+        const int index = sampler.pick (random.nextDouble());
+        if (index < 0)
+            break;
+
+        if (firstPick < 0)
+            firstPick = index;
+
+        if (random.nextFloat() < budget.getWeight ((*presets)[(size_t) index].cost))
+            return index;
+    }
+
+    // Nothing affordable turned up; an expensive preset beats none
+    if (firstPick >= 0)
+        return firstPick;
+
+    // Nothing has any weight (every preset rated 0): any valid one
+    return findNextValidIndex (random.nextInt (count));
+}
+
+void PresetManager::rebuildSampler (const std::vector<int>& recent)
+{
+    std::vector<double> weights (presets->size());
+    for (size_t i = 0; i < weights.size(); ++i)
+        weights[i] = getSamplerWeight ((int) i);
+
+    sampler.assign (weights);
+
+    for (int index : recent)
+        sampler.markShown (index);
+}
+
+double PresetManager::getSamplerWeight (int index) const
+{
+    // Like MilkDrop, picks are proportional to the 0-5 rating; 0 is never picked
+    const auto& entry = (*presets)[(size_t) index];
+    if (! entry.valid)
+        return 0.0;
+
+    const double weight = juce::jlimit (0.0, 5.0, (double) entry.rating);
+    return favorites.count (entry.path) != 0 ? weight * favoriteBoost : weight;
+}
+
+void PresetManager::pushHistory()
+{
+    history.push_back (currentPresetIndex);
+    if (history.size() > historySize)
+        history.pop_front();
+}
+
+int PresetManager::findNextValidIndex (int from) const
+{
+    const int count = (int) presets->size();
+    int index = from;
+
+    for (int tries = 0; tries < count; ++tries)
+    {
+        index = (index + 1) % count;
+        if ((*presets)[(size_t) index].valid)
+            break;
+    }
+
+    return index;
+}
+
+PresetPrefetcher::Request PresetManager::getRequest (int index) const
+{
+    const auto& entry = (*presets)[(size_t) index];
+    return { entry.getFile(), entry.normalizedHash, entry.pack, entry.packMember };
+}
+
+void PresetManager::selectCurrentPreset()
+{
+    budget.presetSelected ((*presets)[(size_t) currentPresetIndex].cost);
+    sampler.markShown (currentPresetIndex);
+    prefetcher.select (getRequest (currentPresetIndex));
+    queueUpcoming();
+}
+
+void PresetManager::queueUpcoming()
+{
+    const int count = (int) presets->size();
+    if (count == 0)
+        return;
+
+    if (upcomingRandomIndex < 0 || upcomingRandomIndex >= count)
+        upcomingRandomIndex = pickRandomIndex();
+
+    // Most likely first: space, next in order, back through the history,
+    // next favorite (the last two are usually cached already)
+    std::vector<PresetPrefetcher::Request> requests;
+    requests.push_back (getRequest (upcomingRandomIndex));
+    requests.push_back (getRequest (findNextValidIndex (currentPresetIndex)));
+
+    if (!history.empty())
+        requests.push_back (getRequest (history.back()));
+
+    const int favoriteIndex = findNextFavoriteIndex();
+    if (favoriteIndex >= 0)
+        requests.push_back (getRequest (favoriteIndex));
+
+    prefetcher.setUpcoming (requests);
 }
 
 void PresetManager::mashupRandom()
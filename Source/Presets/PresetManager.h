@@ -1,12 +1,36 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "PresetCatalog.h"
+#include "PresetBudget.h"
+#include "PresetPrefetcher.h"
+#include "PresetSampler.h"
+#include <deque>
+#include <set>
 
 /**
  * @class PresetManager
  * @brief Manages preset library and selection
  * 
- * Handles loading, caching, and organizing MilkDrop presets
+ * Handles loading, caching, and organizing MilkDrop presets. The library
+ * comes from a PresetCatalog, so construction only maps the catalog file;
+ * new and changed presets show up once the background reconcile is done.
+ *
+ * Selecting a preset doesn't load it here: the choice goes to the
+ * PresetPrefetcher, and the render thread picks the prepared preset up
+ * from there. The random pick is rolled one step ahead, so it and the
+ * next preset in order, the next favorite and the last one in the history
+ * are normally prepared before anyone asks for them. Presets that were
+ * shown stay prepared in the prefetcher's cache, within its memory budget.
+ *
+ * Random picks are weighted by rating, with favorites boosted, and skip
+ * the presets shown most recently (PresetSampler). They are also
+ * cost-aware: a PresetBudget learns from the renderer's frame times which
+ * estimated preset costs fit the frame budget, and presets above it are
+ * left out (those near it picked less often).
+ *
+ * The catalog lists duplicate presets once, so a favorite or history item
+ * naming a duplicate's path follows it to the entry it was folded into.
  */
 class PresetManager
 {
@@ -17,7 +41,9 @@ public:
     //==========================================================================
     // Library management
     void scanPresetsFolder (const juce::File& folder);
-    int getPresetCount() const { return presets.size(); }
+    int getPresetCount();
+    juce::File getPresetFile (int index);
+    const PresetCatalog& getCatalog() const { return catalog; }
     
     //==========================================================================
     // Preset selection
@@ -25,15 +51,52 @@ public:
     void loadRandomPreset();
     void loadNextPreset();
     void loadPreviousPreset();
+
+    //==========================================================================
+    // Favorites, kept by path in the user's application data folder
+    void toggleFavorite();
+    bool isFavorite (int index);
+    void loadNextFavorite();
+
+    /** How many recently shown presets random picks avoid (at most half the library) */
+    void setNoRepeatWindow (int numPresets);
+
+    /** Where selected presets are prepared; the render thread takes them from here */
+    PresetPrefetcher& getPrefetcher() { return prefetcher; }
+
+    /** Frame budget for random picks; the renderer reports switches and frame times to it */
+    PresetBudget& getBudget() { return budget; }
     
     //==========================================================================
     // Mash-up / mixing
     void mashupRandom();
     
 private:
-    std::vector<juce::File> presets;
+    void syncWithCatalog();
+    int pickRandomIndex() const;
+    void rebuildSampler (const std::vector<int>& recent);
+    double getSamplerWeight (int index) const;
+    void pushHistory();
+    int findNextValidIndex (int from) const;
+    int findNextFavoriteIndex() const;
+    void selectCurrentPreset();
+    void queueUpcoming();
+    PresetPrefetcher::Request getRequest (int index) const;
+    void resolveFavoriteAliases();
+    void loadFavorites();
+    void saveFavorites() const;
+    static juce::File getFavoritesFile();
+
+    PresetCatalog catalog;
+    PresetCatalog::Snapshot presets;
+    uint32_t presetsGeneration = 0;
     int currentPresetIndex = 0;
-    std::vector<int> history;  // For undo functionality
+    std::deque<int> history;  // For undo functionality
+    int upcomingRandomIndex = -1;  // What the next loadRandomPreset() picks
+    std::set<std::string> favorites;  // Paths, in the catalog's order
+    PresetPrefetcher prefetcher;
+    PresetBudget budget;
+    PresetSampler sampler;  // Indexes match presets
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetManager)
 };
@@ -0,0 +1,416 @@
+#include "PresetPack.h"
+#include "PresetCatalog.h"
+#include "PresetParser.h"
+#include "../Core/WorkerPool.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    const char packMagic[8] = { 'F', 'V', 'P', 'A', 'C', 'K', '\0', '\0' };
+
+    // Compressed bodies have to save at least this much to be worth inflating
+    constexpr double minCompressionSaving = 0.1;
+
+    // Deflate never expands data by more than this
+    constexpr uint64_t maxInflateRatio = 1032;
+
+    // offset + length <= size, without wrapping on a corrupt offset
+    bool fitsWithin(uint64_t offset, uint64_t length, uint64_t size)
+    {
+        return offset <= size && length <= size - offset;
+    }
+}
+
+PresetPack::PresetPack()
+{
+}
+
+PresetPack::~PresetPack()
+{
+}
+
+bool PresetPack::open(const juce::File& packFile)
+{
+    close();
+
+    auto mapped = std::make_unique<juce::MemoryMappedFile>(packFile, juce::MemoryMappedFile::readOnly);
+    if (mapped->getData() == nullptr || mapped->getSize() < sizeof(FileHeader))
+    {
+        lastError = "could not map " + packFile.getFullPathName().toStdString();
+        return false;
+    }
+
+    const uint64_t size = mapped->getSize();
+    std::memcpy(&header, mapped->getData(), sizeof(header));
+
+    if (std::memcmp(header.magic, packMagic, sizeof(packMagic)) != 0)
+    {
+        lastError = "not a preset pack";
+        return false;
+    }
+
+    if (header.version != version)
+    {
+        lastError = "unsupported pack version " + std::to_string(header.version);
+        return false;
+    }
+
+    if (!fitsWithin(header.recordsOffset, static_cast<uint64_t>(header.numMembers) * sizeof(Record), size)
+        || !fitsWithin(header.stringsOffset, header.stringBytes, size)
+        || !fitsWithin(header.bodiesOffset, header.bodyBytes, size))
+    {
+        lastError = "truncated pack";
+        return false;
+    }
+
+    base = static_cast<const char*>(mapped->getData());
+    mapping = std::move(mapped);
+    numMembers = static_cast<int>(header.numMembers);
+    lastError.clear();
+    return true;
+}
+
+void PresetPack::close()
+{
+    mapping.reset();
+    base = nullptr;
+    numMembers = 0;
+}
+
+PresetPack::Record PresetPack::getRecord(int index) const
+{
+    // Copied out; the mapping makes no alignment promises
+    Record record;
+    std::memcpy(&record, base + header.recordsOffset + static_cast<uint64_t>(index) * sizeof(Record),
+                sizeof(record));
+    return record;
+}
+
+std::string_view PresetPack::stringAt(uint32_t offset, uint32_t length) const
+{
+    if (static_cast<uint64_t>(offset) + length > header.stringBytes)
+        return {};
+
+    return std::string_view(base + header.stringsOffset + offset, length);
+}
+
+PresetPack::Member PresetPack::getMember(int index) const
+{
+    Member member;
+    if (index < 0 || index >= numMembers)
+        return member;
+
+    const Record record = getRecord(index);
+    member.name = stringAt(record.nameOffset, record.nameLength);
+    member.title = stringAt(record.titleOffset, record.titleLength);
+    member.author = stringAt(record.authorOffset, record.authorLength);
+    member.error = stringAt(record.errorOffset, record.errorLength);
+    member.contentHash = record.contentHash;
+    member.normalizedHash = record.normalizedHash;
+    member.size = record.size;
+    member.storedSize = record.storedSize;
+    member.rating = record.rating;
+    member.cost = record.cost;
+    member.features = record.features;
+    member.valid = record.valid != 0;
+    member.compressed = record.compressed != 0;
+    return member;
+}
+
+int PresetPack::indexOf(std::string_view name) const
+{
+    int low = 0;
+    int high = numMembers;
+
+    while (low < high)
+    {
+        const int mid = low + (high - low) / 2;
+        const Record record = getRecord(mid);
+
+        if (stringAt(record.nameOffset, record.nameLength) < name)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    if (low < numMembers)
+    {
+        const Record record = getRecord(low);
+        if (stringAt(record.nameOffset, record.nameLength) == name)
+            return low;
+    }
+
+    return -1;
+}
+
+bool PresetPack::readBody(int index, std::string& storage, std::string_view& text) const
+{
+    if (index < 0 || index >= numMembers)
+        return false;
+
+    const Record record = getRecord(index);
+    if (!fitsWithin(record.bodyOffset, record.storedSize, header.bodyBytes))
+        return false;
+
+    const char* body = base + header.bodiesOffset + record.bodyOffset;
+
+    if (record.compressed == 0)
+    {
+        text = std::string_view(body, record.storedSize);
+        return PresetCatalog::hashContent(text.data(), text.size()) == record.contentHash;
+    }
+
+    if (record.size > record.storedSize * maxInflateRatio)
+        return false;
+
+    juce::MemoryInputStream compressed(body, record.storedSize, false);
+    juce::GZIPDecompressorInputStream inflater(compressed);
+
+    storage.resize(record.size);
+    size_t done = 0;
+
+    while (done < storage.size())
+    {
+        const int read = inflater.read(storage.data() + done, static_cast<int>(storage.size() - done));
+        if (read <= 0)
+            return false;
+
+        done += static_cast<size_t>(read);
+    }
+
+    text = storage;
+    return PresetCatalog::hashContent(text.data(), text.size()) == record.contentHash;
+}
+
+//==============================================================================
+bool PresetPack::splitMemberPath(const juce::File& file, juce::File& packFile, std::string& memberName)
+{
+    for (auto dir = file.getParentDirectory(); dir != dir.getParentDirectory(); dir = dir.getParentDirectory())
+    {
+        if (dir.hasFileExtension(fileExtension))
+        {
+            packFile = dir;
+            memberName = file.getRelativePathFrom(dir).replaceCharacter('\\', '/').toStdString();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+juce::File PresetPack::getMemberFile(const juce::File& packFile, std::string_view memberName)
+{
+    return packFile.getChildFile(juce::String::fromUTF8(memberName.data(), static_cast<int>(memberName.size())));
+}
+
+bool PresetPack::readMemberFile(const juce::File& file, std::string& text)
+{
+    juce::File packFile;
+    std::string memberName;
+
+    if (!splitMemberPath(file, packFile, memberName))
+        return false;
+
+    PresetPack pack;
+    if (!pack.open(packFile))
+        return false;
+
+    std::string storage;
+    std::string_view body;
+
+    if (!pack.readBody(pack.indexOf(memberName), storage, body))
+        return false;
+
+    text.assign(body.data(), body.size());
+    return true;
+}
+
+//==============================================================================
+bool PresetPack::build(const juce::File& folder, const juce::File& packFile,
+                       const BuildOptions& options, BuildStats& stats, std::string& error)
+{
+    auto startTicks = juce::Time::getHighResolutionTicks();
+    stats = {};
+
+    if (!folder.isDirectory())
+    {
+        error = "not a folder: " + folder.getFullPathName().toStdString();
+        return false;
+    }
+
+    std::vector<juce::File> files;
+    for (const auto& item : juce::RangedDirectoryIterator(folder, true, "*.milk;*.milk2", juce::File::findFiles))
+        files.push_back(item.getFile());
+
+    struct Built
+    {
+        std::string name;
+        PresetCatalog::Entry entry;
+        std::string body;
+        uint32_t size = 0;
+        bool compressed = false;
+        bool ok = false;
+    };
+
+    std::vector<Built> built(files.size());
+    WorkerPool pool(options.numThreads);
+
+    // Read, validate and compress one file per task
+    pool.parallelFor(static_cast<int>(files.size()), [&](int i)
+    {
+        const auto& file = files[static_cast<size_t>(i)];
+        auto& item = built[static_cast<size_t>(i)];
+
+        juce::MemoryBlock data;
+        if (!file.loadFileAsData(data))
+            return;
+
+        // Bodies are always stored as UTF-8
+        std::string text(static_cast<const char*>(data.getData()), data.getSize());
+        if (PresetParser::isUtf16(text))
+            text = file.loadFileAsString().toStdString();
+
+        item.name = file.getRelativePathFrom(folder).replaceCharacter('\\', '/').toStdString();
+        item.entry.contentHash = PresetCatalog::hashContent(text.data(), text.size());
+        PresetCatalog::parseEntry(text, file, item.entry);
+        item.size = static_cast<uint32_t>(text.size());
+
+        if (options.compress)
+        {
+            juce::MemoryOutputStream deflated;
+            {
+                juce::GZIPCompressorOutputStream deflater(deflated, 9);
+                deflater.write(text.data(), text.size());
+            }
+
+            if (static_cast<double>(deflated.getDataSize()) < static_cast<double>(text.size()) * (1.0 - minCompressionSaving))
+            {
+                item.body.assign(static_cast<const char*>(deflated.getData()), deflated.getDataSize());
+                item.compressed = true;
+            }
+        }
+
+        if (!item.compressed)
+            item.body = std::move(text);
+
+        item.ok = true;
+    });
+
+    std::vector<Built*> members;
+    for (auto& item : built)
+    {
+        if (item.ok)
+            members.push_back(&item);
+        else
+            ++stats.skipped;
+    }
+
+    std::sort(members.begin(), members.end(),
+              [](const Built* a, const Built* b) { return a->name < b->name; });
+
+    std::string strings;
+    std::vector<Record> records(members.size());
+    std::vector<const Built*> bodies;   // Written in this order
+    std::unordered_map<uint64_t, size_t> recordByContent;
+    uint64_t bodyBytes = 0;
+
+    auto addString = [&strings](const std::string& s, uint32_t& offset, uint32_t& length)
+    {
+        offset = static_cast<uint32_t>(strings.size());
+        length = static_cast<uint32_t>(s.size());
+        strings += s;
+    };
+
+    for (size_t i = 0; i < members.size(); ++i)
+    {
+        const auto& item = *members[i];
+        auto& record = records[i];
+        std::memset(&record, 0, sizeof(record));
+
+        record.contentHash = item.entry.contentHash;
+        record.normalizedHash = item.entry.normalizedHash;
+        record.size = item.size;
+        record.storedSize = static_cast<uint32_t>(item.body.size());
+        record.rating = item.entry.rating;
+        record.cost = item.entry.cost;
+        record.features = item.entry.features;
+        record.compressed = item.compressed ? 1 : 0;
+        record.valid = item.entry.valid ? 1 : 0;
+        addString(item.name, record.nameOffset, record.nameLength);
+        addString(item.entry.name, record.titleOffset, record.titleLength);
+        addString(item.entry.author, record.authorOffset, record.authorLength);
+        addString(item.entry.error, record.errorOffset, record.errorLength);
+
+        ++stats.members;
+        stats.invalid += item.entry.valid ? 0 : 1;
+        stats.rawBytes += item.size;
+
+        // A byte-identical copy points at the body stored for the first one
+        auto [first, inserted] = recordByContent.emplace(item.entry.contentHash, i);
+        const auto& original = *members[first->second];
+
+        if (!inserted && original.compressed == item.compressed && original.body == item.body)
+        {
+            record.bodyOffset = records[first->second].bodyOffset;
+            ++stats.sharedBodies;
+            continue;
+        }
+
+        record.bodyOffset = bodyBytes;
+        bodyBytes += item.body.size();
+        bodies.push_back(&item);
+
+        stats.compressed += item.compressed ? 1 : 0;
+        stats.storedBytes += static_cast<int64_t>(item.body.size());
+    }
+
+    FileHeader fileHeader;
+    std::memset(&fileHeader, 0, sizeof(fileHeader));
+    std::memcpy(fileHeader.magic, packMagic, sizeof(packMagic));
+    fileHeader.version = version;
+    fileHeader.numMembers = static_cast<uint32_t>(records.size());
+    fileHeader.recordsOffset = sizeof(FileHeader);
+    fileHeader.stringsOffset = fileHeader.recordsOffset + records.size() * sizeof(Record);
+    fileHeader.stringBytes = strings.size();
+    fileHeader.bodiesOffset = fileHeader.stringsOffset + strings.size();
+    fileHeader.bodyBytes = bodyBytes;
+
+    // Write beside the target and swap in, so a pack in use is never torn
+    packFile.getParentDirectory().createDirectory();
+    juce::TemporaryFile temp(packFile);
+    {
+        juce::FileOutputStream out(temp.getFile());
+        if (!out.openedOk())
+        {
+            error = "could not write " + temp.getFile().getFullPathName().toStdString();
+            return false;
+        }
+
+        out.write(&fileHeader, sizeof(fileHeader));
+        out.write(records.data(), records.size() * sizeof(Record));
+        out.write(strings.data(), strings.size());
+
+        for (const auto* item : bodies)
+            out.write(item->body.data(), item->body.size());
+
+        out.flush();
+
+        if (out.getStatus().failed())
+        {
+            error = out.getStatus().getErrorMessage().toStdString();
+            return false;
+        }
+    }
+
+    if (!temp.overwriteTargetFileWithTemporary())
+    {
+        error = "could not replace " + packFile.getFullPathName().toStdString();
+        return false;
+    }
+
+    stats.timeMs = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+    return true;
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+/**
+ * @class PresetPack
+ * @brief Single-file archive of presets (.fvpack)
+ *
+ * Layout, all little-endian:
+ * - FileHeader (magic "FVPACK", version, member count, section offsets)
+ * - one Record per member, sorted by member name: content hash, body
+ *   offset and sizes, compression, and the catalog metadata (title,
+ *   author, rating, cost, feature flags, valid / error) worked out when the
+ *   pack was built
+ * - string table for names, titles, authors and errors
+ * - the preset bodies, each zlib-compressed or stored raw, whichever
+ *   is smaller; byte-identical presets share one body
+ *
+ * A member's name is its path relative to the folder the pack was built
+ * from ("Geiss/Reaction Diffusion.milk"). Within the library a member is
+ * addressed as a file inside the pack, <pack>.fvpack/<name>, which is the
+ * path the catalog, the prefetcher and PreparedPreset use.
+ *
+ * open() memory-maps the pack: getMember() is a direct record read and
+ * indexOf() a binary search, and raw bodies are returned as views of the
+ * mapping without copying. Scanning a pack into the catalog only reads
+ * the index, so it costs one file's metadata instead of one per preset.
+ */
+class PresetPack
+{
+public:
+    static constexpr const char* fileExtension = "fvpack";
+
+    struct Member
+    {
+        std::string_view name;
+        std::string_view title;
+        std::string_view author;
+        std::string_view error;
+        uint64_t contentHash = 0;   // PresetCatalog::hashContent() of the UTF-8 body
+        uint64_t normalizedHash = 0;    // PresetCatalog::hashNormalized()
+        uint32_t size = 0;          // Body size once decompressed
+        uint32_t storedSize = 0;
+        float rating = 3.0f;
+        float cost = 0.0f;          // PresetCatalog::estimateCost()
+        uint32_t features = 0;      // PresetCatalog::Feature flags
+        bool valid = true;
+        bool compressed = false;
+    };
+
+    PresetPack();
+    ~PresetPack();
+
+    /** Map a pack and check its header; false (see getLastError()) if unusable */
+    bool open(const juce::File& packFile);
+    void close();
+
+    bool isOpen() const { return mapping != nullptr; }
+    int getNumMembers() const { return numMembers; }
+
+    /** Member metadata; the views stay valid while the pack is open */
+    Member getMember(int index) const;
+
+    /** Index of a member name, or -1 */
+    int indexOf(std::string_view name) const;
+
+    /**
+     * @brief Get a member's UTF-8 text
+     * @param storage Holds decompressed text; raw bodies leave it untouched
+     * @param text Set to the body, in the mapping or in storage
+     * @return false if the body is out of bounds, fails to inflate or
+     *         doesn't match the member's content hash
+     */
+    bool readBody(int index, std::string& storage, std::string_view& text) const;
+
+    std::string getLastError() const { return lastError; }
+
+    //==========================================================================
+    /**
+     * @brief Split a library path into pack file and member name
+     * @return false if no parent directory of file is a .fvpack
+     */
+    static bool splitMemberPath(const juce::File& file, juce::File& packFile, std::string& memberName);
+
+    /** The file a member is addressed by in the library */
+    static juce::File getMemberFile(const juce::File& packFile, std::string_view memberName);
+
+    /**
+     * @brief Read a member addressed by its library path into text
+     *
+     * Maps the pack for this one read. Catalogued members are read through
+     * the pack their catalog entry keeps open instead.
+     */
+    static bool readMemberFile(const juce::File& file, std::string& text);
+
+    //==========================================================================
+    struct BuildOptions
+    {
+        bool compress = true;
+        int numThreads = 0;         // <= 0 uses hardware concurrency - 1
+    };
+
+    struct BuildStats
+    {
+        int members = 0;
+        int invalid = 0;
+        int compressed = 0;
+        int sharedBodies = 0;       // Members stored as another member's body
+        int skipped = 0;            // Unreadable files
+        int64_t rawBytes = 0;
+        int64_t storedBytes = 0;
+        double timeMs = 0.0;
+    };
+
+    /**
+     * @brief Build a pack from every .milk / .milk2 file under a folder
+     *
+     * Each preset is parsed and validated as the catalog would, so loading
+     * the pack into the catalog needs no parsing at all.
+     */
+    static bool build(const juce::File& folder, const juce::File& packFile,
+                      const BuildOptions& options, BuildStats& stats, std::string& error);
+
+private:
+    struct FileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t numMembers;
+        uint64_t recordsOffset;
+        uint64_t stringsOffset;
+        uint64_t stringBytes;
+        uint64_t bodiesOffset;
+        uint64_t bodyBytes;
+    };
+
+    struct Record
+    {
+        uint64_t contentHash;
+        uint64_t normalizedHash;
+        uint64_t bodyOffset;        // From bodiesOffset
+        uint32_t size;
+        uint32_t storedSize;
+        uint32_t nameOffset, nameLength;
+        uint32_t titleOffset, titleLength;
+        uint32_t authorOffset, authorLength;
+        uint32_t errorOffset, errorLength;
+        float rating;
+        uint32_t features;
+        uint32_t compressed;
+        uint32_t valid;
+        float cost;
+        uint32_t reserved;
+    };
+
+    static constexpr uint32_t version = 4;
+
+    Record getRecord(int index) const;
+    std::string_view stringAt(uint32_t offset, uint32_t length) const;
+
+    std::unique_ptr<juce::MemoryMappedFile> mapping;
+    const char* base = nullptr;
+    FileHeader header {};
+    int numMembers = 0;
+    std::string lastError;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetPack)
+};
@@ -0,0 +1,406 @@
+#include "PresetParser.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+namespace
+{
+    //==========================================================================
+    // Key tables. Each key names the member it assigns; only one of the
+    // member pointers is set.
+
+    template <typename Target>
+    struct KeyEntry
+    {
+        std::string_view name;
+        float Target::* floatField = nullptr;
+        int Target::* intField = nullptr;
+        bool Target::* boolField = nullptr;
+        std::string Target::* stringField = nullptr;
+    };
+
+    template <typename Target>
+    constexpr KeyEntry<Target> key(std::string_view name, float Target::* field)
+    {
+        return { name, field, nullptr, nullptr, nullptr };
+    }
+
+    template <typename Target>
+    constexpr KeyEntry<Target> key(std::string_view name, int Target::* field)
+    {
+        return { name, nullptr, field, nullptr, nullptr };
+    }
+
+    template <typename Target>
+    constexpr KeyEntry<Target> key(std::string_view name, bool Target::* field)
+    {
+        return { name, nullptr, nullptr, field, nullptr };
+    }
+
+    template <typename Target>
+    constexpr KeyEntry<Target> key(std::string_view name, std::string Target::* field)
+    {
+        return { name, nullptr, nullptr, nullptr, field };
+    }
+
+    using P = MilkDropPreset;
+    using W = MilkDropPreset::WaveOrShape;
+
+    constexpr std::array presetKeys
+    {
+        // Metadata (the version line has always been stored as the name)
+        key("name", &P::name),
+        key("MILKDROP_PRESET_VERSION", &P::name),
+        key("author", &P::author),
+
+        // Basic parameters
+        key("fRating", &P::fRating),
+        key("fGammaAdj", &P::fGammaAdj),
+        key("fDecay", &P::fDecay),
+        key("fVideoEchoZoom", &P::fVideoEchoZoom),
+        key("fVideoEchoAlpha", &P::fVideoEchoAlpha),
+        key("nVideoEchoOrientation", &P::nVideoEchoOrientation),
+        key("nWaveMode", &P::nWaveMode),
+        key("bAdditiveWaves", &P::bAdditiveWaves),
+        key("bWaveDots", &P::bWaveDots),
+        key("bWaveThick", &P::bWaveThick),
+        key("bModWaveAlphaByVolume", &P::bModWaveAlphaByVolume),
+        key("bMaximizeWaveColor", &P::bMaximizeWaveColor),
+        key("bTexWrap", &P::bTexWrap),
+        key("bDarkenCenter", &P::bDarkenCenter),
+        key("bRedBlueStereo", &P::bRedBlueStereo),
+        key("bBrighten", &P::bBrighten),
+        key("bDarken", &P::bDarken),
+        key("bSolarize", &P::bSolarize),
+        key("bInvert", &P::bInvert),
+
+        // Wave parameters
+        key("fWaveAlpha", &P::fWaveAlpha),
+        key("fWaveScale", &P::fWaveScale),
+        key("fWaveSmoothing", &P::fWaveSmoothing),
+        key("fWaveParam", &P::fWaveParam),
+        key("fModWaveAlphaStart", &P::fModWaveAlphaStart),
+        key("fModWaveAlphaEnd", &P::fModWaveAlphaEnd),
+        key("fWarpAnimSpeed", &P::fWarpAnimSpeed),
+        key("fWarpScale", &P::fWarpScale),
+        key("fZoomExponent", &P::fZoomExponent),
+        key("fShader", &P::fShader),
+
+        // Motion vectors
+        key("fRotCX", &P::fRotCX),
+        key("fRotCY", &P::fRotCY),
+        key("fRot", &P::fRot),
+        key("fXPush", &P::fXPush),
+        key("fYPush", &P::fYPush),
+        key("fWarpAmount", &P::fWarpAmount),
+        key("fStretchX", &P::fStretchX),
+        key("fStretchY", &P::fStretchY),
+
+        // Wave colours
+        key("wave_r", &P::wave_r),
+        key("wave_g", &P::wave_g),
+        key("wave_b", &P::wave_b)
+    };
+
+    constexpr std::array sectionKeys
+    {
+        key("enabled", &W::enabled),
+        key("sides", &W::sides),
+        key("thick", &W::thick),
+        key("additive", &W::additive),
+        key("r", &W::r),
+        key("g", &W::g),
+        key("b", &W::b),
+        key("a", &W::a),
+        key("rad", &W::rad)
+    };
+
+    //==========================================================================
+    // Perfect hashing: a seeded FNV-1a, with the seed searched at compile
+    // time so that every known key lands in its own slot. A lookup is one
+    // hash, one table load and one string compare.
+
+    constexpr uint32_t hashKey(std::string_view s, uint32_t seed)
+    {
+        uint32_t hash = 2166136261u ^ (seed * 0x9e3779b9u);
+
+        for (char c : s)
+        {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 16777619u;
+        }
+
+        return hash ^ (hash >> 16);
+    }
+
+    template <size_t tableSize>
+    struct PerfectHash
+    {
+        static_assert((tableSize & (tableSize - 1)) == 0, "table size must be a power of two");
+
+        uint32_t seed = 0;
+        std::array<uint8_t, tableSize> slots {};   // Key index + 1; 0 is empty
+
+        constexpr uint32_t slotOf(std::string_view s) const { return hashKey(s, seed) & (tableSize - 1); }
+    };
+
+    template <size_t tableSize, typename Entries>
+    constexpr PerfectHash<tableSize> makePerfectHash(const Entries& entries)
+    {
+        static_assert(std::tuple_size<Entries>::value < 255, "too many keys for 8-bit slots");
+
+        PerfectHash<tableSize> table;
+
+        for (uint32_t seed = 0; seed < 100000; ++seed)
+        {
+            table.seed = seed;
+            table.slots = {};
+            bool collision = false;
+
+            for (size_t i = 0; i < entries.size() && !collision; ++i)
+            {
+                auto& slot = table.slots[table.slotOf(entries[i].name)];
+                collision = slot != 0;
+                slot = static_cast<uint8_t>(i + 1);
+            }
+
+            if (!collision)
+                return table;
+        }
+
+        throw "no perfect hash seed found; grow the table";
+    }
+
+    constexpr auto presetKeyHash = makePerfectHash<256>(presetKeys);
+    constexpr auto sectionKeyHash = makePerfectHash<32>(sectionKeys);
+
+    template <size_t tableSize, typename Entries>
+    constexpr int lookup(const PerfectHash<tableSize>& table, const Entries& entries, std::string_view s)
+    {
+        const int slot = table.slots[table.slotOf(s)];
+        if (slot == 0 || entries[static_cast<size_t>(slot - 1)].name != s)
+            return -1;
+
+        return slot - 1;
+    }
+
+    static_assert(lookup(presetKeyHash, presetKeys, "fDecay") >= 0);
+    static_assert(lookup(presetKeyHash, presetKeys, "fDecayX") < 0);
+    static_assert(lookup(sectionKeyHash, sectionKeys, "rad") >= 0);
+
+    //==========================================================================
+    // Values
+
+    constexpr std::string_view whitespace = " \t\r\n\v\f";
+
+    std::string_view trim(std::string_view s)
+    {
+        const auto start = s.find_first_not_of(whitespace);
+        if (start == std::string_view::npos)
+            return {};
+
+        const auto end = s.find_last_not_of(whitespace);
+        return s.substr(start, end - start + 1);
+    }
+
+    // Like juce::String::getIntValue(): digits after an optional '-' (a
+    // '+' reads as 0), wrapping on overflow
+    int parseInt(std::string_view s)
+    {
+        const bool negative = !s.empty() && s.front() == '-';
+        if (negative)
+            s.remove_prefix(1);
+
+        uint32_t value = 0;
+        for (char c : s)
+        {
+            if (c < '0' || c > '9')
+                break;
+
+            value = value * 10 + static_cast<uint32_t>(c - '0');
+        }
+
+        return static_cast<int>(negative ? 0u - value : value);
+    }
+
+    // Like juce::String::getFloatValue(): the leading number read as a
+    // double, or 0; out of range values become infinity or zero as there
+    float parseFloat(std::string_view s)
+    {
+        if (!s.empty() && s.front() == '+')
+        {
+            s.remove_prefix(1);
+            if (!s.empty() && s.front() == '-')
+                return 0.0f;
+        }
+
+        double value = 0.0;
+
+       #if defined(__cpp_lib_to_chars)
+        const auto result = std::from_chars(s.data(), s.data() + s.size(), value);
+        if (result.ec == std::errc::result_out_of_range)
+            value = std::strtod(std::string(s.data(), result.ptr).c_str(), nullptr);
+        else if (result.ec != std::errc())
+            value = 0.0;
+       #else
+        // Standard libraries without floating-point from_chars
+        char buffer[64] = {};
+        s.copy(buffer, std::min(s.size(), sizeof(buffer) - 1));
+        value = std::strtod(buffer, nullptr);
+       #endif
+
+        return static_cast<float>(value);
+    }
+
+    template <typename Target>
+    void assign(const KeyEntry<Target>& entry, std::string_view value, Target& target)
+    {
+        if (entry.floatField != nullptr)
+            target.*entry.floatField = parseFloat(value);
+        else if (entry.intField != nullptr)
+            target.*entry.intField = parseInt(value);
+        else if (entry.boolField != nullptr)
+            target.*entry.boolField = parseInt(value) != 0;
+        else if (entry.stringField != nullptr)
+            (target.*entry.stringField).assign(value.data(), value.size());
+    }
+
+    // [wave_N] / [shape_N]: the index, or -1
+    int sectionIndex(std::string_view section, std::string_view prefix)
+    {
+        // MilkDrop has four of each; the cap only guards against nonsense
+        constexpr int maxIndex = 15;
+
+        if (section.substr(0, prefix.size()) != prefix)
+            return -1;
+
+        section.remove_prefix(prefix.size());
+
+        int index = -1;
+        auto result = std::from_chars(section.data(), section.data() + section.size(), index);
+        if (result.ec != std::errc() || result.ptr != section.data() + section.size()
+            || index < 0 || index > maxIndex)
+            return -1;
+
+        return index;
+    }
+
+    MilkDropPreset::WaveOrShape& getOrAdd(std::vector<MilkDropPreset::WaveOrShape>& items, int index)
+    {
+        if (static_cast<int>(items.size()) <= index)
+            items.resize(static_cast<size_t>(index) + 1);
+
+        return items[static_cast<size_t>(index)];
+    }
+}
+
+//==============================================================================
+int PresetParser::findPresetKey(std::string_view s)
+{
+    return lookup(presetKeyHash, presetKeys, s);
+}
+
+int PresetParser::findSectionKey(std::string_view s)
+{
+    return lookup(sectionKeyHash, sectionKeys, s);
+}
+
+int PresetParser::getNumPresetKeys()
+{
+    return static_cast<int>(presetKeys.size());
+}
+
+bool PresetParser::isUtf16(std::string_view text)
+{
+    return text.size() >= 2
+        && ((static_cast<uint8_t>(text[0]) == 0xff && static_cast<uint8_t>(text[1]) == 0xfe)
+            || (static_cast<uint8_t>(text[0]) == 0xfe && static_cast<uint8_t>(text[1]) == 0xff));
+}
+
+bool PresetParser::parse(std::string_view text, MilkDropPreset& preset)
+{
+    preset.reset();
+
+    if (text.substr(0, 3) == "\xef\xbb\xbf")
+        text.remove_prefix(3);
+
+    std::string* code = nullptr;                    // Code section being collected
+    MilkDropPreset::WaveOrShape* section = nullptr; // [wave_N] / [shape_N] being read
+
+    while (!text.empty())
+    {
+        const auto newline = text.find('\n');
+        const auto line = trim(text.substr(0, newline));
+        text.remove_prefix(newline == std::string_view::npos ? text.size() : newline + 1);
+
+        // Skip empty lines and comments
+        if (line.empty() || line.substr(0, 2) == "//")
+            continue;
+
+        // Section headers [preset00], [wave_0], [per_frame_1], etc.
+        if (line.front() == '[')
+        {
+            auto name = line.substr(1);
+            name = name.substr(0, name.find(']'));
+
+            code = nullptr;
+            section = nullptr;
+
+            if (name == "per_frame_init_1")
+                code = &preset.perFrameInitCode;
+            else if (name == "per_frame_1")
+                code = &preset.perFrameCode;
+            else if (name == "per_pixel_1")
+                code = &preset.perPixelCode;
+            else if (name == "warp_1")
+                code = &preset.warpShaderCode;
+            else if (name == "comp_1")
+                code = &preset.compShaderCode;
+            else if (int wave = sectionIndex(name, "wave_"); wave >= 0)
+                section = &getOrAdd(preset.waves, wave);
+            else if (int shape = sectionIndex(name, "shape_"); shape >= 0)
+                section = &getOrAdd(preset.shapes, shape);
+
+            if (code != nullptr)
+                code->clear();
+
+            if (section != nullptr)
+                section->enabled = true;
+
+            continue;
+        }
+
+        // Every line of a code section is code, assignments included
+        if (code != nullptr)
+        {
+            if (!code->empty())
+                code->push_back('\n');
+
+            code->append(line.data(), line.size());
+            continue;
+        }
+
+        const auto equals = line.find('=');
+        if (equals == std::string_view::npos)
+            continue;
+
+        const auto name = trim(line.substr(0, equals));
+        const auto value = trim(line.substr(equals + 1));
+
+        // Top-level keys win, even inside a [wave_N] / [shape_N] section
+        if (int index = findPresetKey(name); index >= 0)
+        {
+            assign(presetKeys[static_cast<size_t>(index)], value, preset);
+        }
+        else if (section != nullptr)
+        {
+            if (int sectionKey = findSectionKey(name); sectionKey >= 0)
+                assign(sectionKeys[static_cast<size_t>(sectionKey)], value, *section);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Preset.h"
+#include <string_view>
+
+/**
+ * @class PresetParser
+ * @brief Zero-copy parser for .milk preset text
+ *
+ * Walks the text in place (typically a memory-mapped file) one line at a
+ * time as string_views; nothing is copied except the values that end up
+ * in the preset. Keys are looked up through perfect hash tables built at
+ * compile time, and numbers are converted with std::from_chars to the
+ * values juce::String::getFloatValue() / getIntValue() give.
+ *
+ * Accepts what MilkDropPreset::loadFromString always has:
+ * - key=value lines, for the keys MilkDropPreset knows
+ * - [wave_N] / [shape_N] sections with their own keys (enabled, r, ...)
+ * - [per_frame_init_1], [per_frame_1], [per_pixel_1], [warp_1] and
+ *   [comp_1] sections, whose lines (comments excepted) are code
+ */
+class PresetParser
+{
+public:
+    /**
+     * @brief Parse .milk text into a preset, which is reset first
+     * @param text UTF-8 text; a leading byte order mark is skipped
+     */
+    static bool parse(std::string_view text, MilkDropPreset& preset);
+
+    /** Whether text is UTF-16 and has to be converted before parse() */
+    static bool isUtf16(std::string_view text);
+
+    /** Known top-level key -> index in the key table, or -1 */
+    static int findPresetKey(std::string_view key);
+
+    /** Known [wave_N] / [shape_N] key -> index in the section key table, or -1 */
+    static int findSectionKey(std::string_view key);
+
+    /** Number of known top-level keys */
+    static int getNumPresetKeys();
+};
@@ -0,0 +1,332 @@
+#include "PresetPrefetcher.h"
+#include "PresetPack.h"
+#include <algorithm>
+
+PresetPrefetcher::PresetPrefetcher(int numThreads)
+    : pool(numThreads)
+{
+    thread = std::thread([this] { run(); });
+}
+
+PresetPrefetcher::~PresetPrefetcher()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        shouldExit = true;
+    }
+
+    wake.notify_all();
+
+    if (thread.joinable())
+        thread.join();
+}
+
+PresetPrefetcher::Slot* PresetPrefetcher::findSlot(const std::string& path)
+{
+    if (!selected.path.empty() && selected.path == path)
+        return &selected;
+
+    for (auto& slot : upcoming)
+        if (slot.path == path)
+            return &slot;
+
+    return nullptr;
+}
+
+void PresetPrefetcher::setUpcoming(const std::vector<Request>& requests)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    std::vector<Slot> next;
+    next.reserve(requests.size());
+
+    // The same preset under another name needs preparing only once
+    auto isSame = [](const Slot& slot, const std::string& path, uint64_t contentHash)
+    {
+        return slot.path == path || (contentHash != 0 && slot.contentHash == contentHash);
+    };
+
+    for (const auto& request : requests)
+    {
+        auto path = request.file.getFullPathName().toStdString();
+
+        bool listed = !selected.path.empty() && isSame(selected, path, request.contentHash);
+        for (const auto& slot : next)
+            listed = listed || isSame(slot, path, request.contentHash);
+
+        if (listed)
+            continue;
+
+        // Keep whatever has been prepared for it already
+        auto existing = std::find_if(upcoming.begin(), upcoming.end(),
+                                     [&](const Slot& slot) { return slot.path == path; });
+
+        if (existing != upcoming.end())
+        {
+            next.push_back(std::move(*existing));
+            existing->path.clear();
+        }
+        else
+        {
+            Slot slot;
+            if (cache.contains(request.contentHash))
+                slot.prepared = takeCached(path, request.contentHash);
+
+            slot.path = std::move(path);
+            slot.contentHash = request.contentHash;
+            slot.pack = request.pack;
+            slot.packMember = request.packMember;
+            next.push_back(std::move(slot));
+        }
+    }
+
+    // Whatever was prepared for presets that dropped out is kept for later
+    for (auto& slot : upcoming)
+        if (!slot.path.empty())
+            cacheSlot(slot);
+
+    upcoming = std::move(next);
+    wake.notify_one();
+}
+
+void PresetPrefetcher::cacheSlot(Slot& slot)
+{
+    if (slot.prepared != nullptr)
+        cache.put(std::move(slot.prepared));
+}
+
+std::unique_ptr<PreparedPreset> PresetPrefetcher::takeCached(const std::string& path, uint64_t contentHash)
+{
+    auto prepared = cache.take(contentHash);
+
+    // May have been prepared from an alias
+    if (prepared != nullptr)
+        prepared->path = path;
+
+    return prepared;
+}
+
+void PresetPrefetcher::select(const Request& request)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    auto path = request.file.getFullPathName().toStdString();
+
+    if (path == selected.path)
+        return;
+
+    Slot slot;
+    auto existing = std::find_if(upcoming.begin(), upcoming.end(),
+                                 [&](const Slot& candidate) { return candidate.path == path; });
+
+    if (existing != upcoming.end())
+    {
+        slot = std::move(*existing);
+        upcoming.erase(existing);
+    }
+    else
+    {
+        // Shown before, or prepared and dropped from the upcoming list
+        slot.prepared = takeCached(path, request.contentHash);
+        slot.path = std::move(path);
+        slot.contentHash = request.contentHash;
+        slot.pack = request.pack;
+        slot.packMember = request.packMember;
+    }
+
+    if (slot.prepared != nullptr)
+        ++stats.hits;
+    else
+        ++stats.misses;
+
+    // A previous selection that never got shown goes to the cache
+    cacheSlot(selected);
+    selected = std::move(slot);
+    wake.notify_one();
+}
+
+std::unique_ptr<PreparedPreset> PresetPrefetcher::takeSelected()
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (selected.path.empty())
+        return nullptr;
+
+    if (selected.failed)
+    {
+        selected = Slot();
+        return nullptr;
+    }
+
+    if (selected.prepared == nullptr)
+        return nullptr;
+
+    auto prepared = std::move(selected.prepared);
+    selected = Slot();
+    return prepared;
+}
+
+bool PresetPrefetcher::warmNext(const std::function<void(const PreparedPreset&)>& warm)
+{
+    std::unique_lock<std::mutex> guard(lock);
+
+    auto candidate = std::find_if(upcoming.begin(), upcoming.end(),
+                                  [](const Slot& slot) { return slot.prepared != nullptr && !slot.warmed; });
+
+    if (candidate == upcoming.end())
+        return false;
+
+    // The preset leaves its slot while it links, so select() and
+    // setUpcoming() never wait behind a link; preparing keeps it from
+    // being prepared again meanwhile
+    const std::string path = candidate->path;
+    auto prepared = std::move(candidate->prepared);
+    candidate->warmed = true;
+    candidate->preparing = true;
+
+    guard.unlock();
+    warm(*prepared);
+    guard.lock();
+
+    // The slot may have been selected, dropped or re-added meanwhile; a
+    // job still preparing a re-added one sends its result to the cache
+    auto* slot = findSlot(path);
+    if (slot != nullptr && slot->prepared == nullptr)
+    {
+        slot->prepared = std::move(prepared);
+        slot->preparing = false;
+        slot->failed = false;
+        slot->warmed = true;
+    }
+    else
+    {
+        cache.put(std::move(prepared));
+    }
+
+    return true;
+}
+
+void PresetPrefetcher::retire(std::unique_ptr<PreparedPreset> prepared)
+{
+    if (prepared == nullptr)
+        return;
+
+    std::lock_guard<std::mutex> guard(lock);
+    cache.put(std::move(prepared));
+}
+
+void PresetPrefetcher::setCacheBudget(size_t budgetBytes)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    cache.setBudget(budgetBytes);
+}
+
+bool PresetPrefetcher::hasSelection() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return !selected.path.empty();
+}
+
+PresetPrefetcher::Stats PresetPrefetcher::getStats() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return stats;
+}
+
+PreparedPresetCache::Stats PresetPrefetcher::getCacheStats() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return cache.getStats();
+}
+
+void PresetPrefetcher::run()
+{
+    std::unique_lock<std::mutex> guard(lock);
+
+    struct Job
+    {
+        std::string path;
+        uint64_t contentHash;
+        std::shared_ptr<const PresetPack> pack;
+        int packMember;
+    };
+
+    std::vector<Job> jobs;
+
+    // The selection first, then upcoming presets in order; small batches
+    // so a new selection never waits behind the whole queue
+    const size_t batchSize = static_cast<size_t>(pool.getNumThreads() + 1);
+
+    auto collectJobs = [&]
+    {
+        jobs.clear();
+
+        if (!selected.path.empty() && selected.needsWork())
+            jobs.push_back({ selected.path, selected.contentHash, selected.pack, selected.packMember });
+
+        for (const auto& slot : upcoming)
+            if (jobs.size() < batchSize && slot.needsWork())
+                jobs.push_back({ slot.path, slot.contentHash, slot.pack, slot.packMember });
+
+        return !jobs.empty();
+    };
+
+    for (;;)
+    {
+        wake.wait(guard, [&] { return shouldExit || collectJobs(); });
+
+        if (shouldExit)
+            return;
+
+        for (const auto& job : jobs)
+            findSlot(job.path)->preparing = true;
+
+        guard.unlock();
+
+        std::vector<std::unique_ptr<PreparedPreset>> results(jobs.size());
+        std::vector<std::string> errors(jobs.size());
+
+        pool.parallelFor(static_cast<int>(jobs.size()), [&](int i)
+        {
+            const auto index = static_cast<size_t>(i);
+            const auto& job = jobs[index];
+            juce::File file(juce::String::fromUTF8(job.path.c_str()));
+
+            // Catalogued pack members are read straight from the open pack
+            if (job.pack != nullptr)
+                results[index] = PreparedPreset::loadFromPack(*job.pack, job.packMember, file, errors[index]);
+            else
+                results[index] = PreparedPreset::loadFromFile(file, errors[index]);
+
+            if (results[index] != nullptr)
+                results[index]->contentHash = jobs[index].contentHash;
+        });
+
+        guard.lock();
+
+        for (size_t i = 0; i < jobs.size(); ++i)
+        {
+            // The slot may have been dropped (or dropped and re-added) meanwhile
+            auto* slot = findSlot(jobs[i].path);
+            if (slot == nullptr || slot->prepared != nullptr)
+            {
+                if (results[i] != nullptr)
+                    cache.put(std::move(results[i]));
+                continue;
+            }
+
+            slot->preparing = false;
+
+            if (results[i] != nullptr)
+            {
+                ++stats.prepared;
+                stats.lastPrepareMs = results[i]->prepareMs;
+                slot->prepared = std::move(results[i]);
+            }
+            else
+            {
+                ++stats.failed;
+                slot->failed = true;
+                DBG("FlarkViz: Could not prepare " << jobs[i].path << ": " << errors[i]);
+            }
+        }
+    }
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../Core/WorkerPool.h"
+#include "../Rendering/PreparedPreset.h"
+#include "PreparedPresetCache.h"
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @class PresetPrefetcher
+ * @brief Prepares the presets that are likely to be shown next
+ *
+ * PresetManager tells it which presets are up next (the pre-rolled random
+ * pick, the next one in order, ...). A background thread parses, compiles
+ * and translates them into PreparedPresets on a WorkerPool, so when one
+ * of them is select()ed it is usually ready already and the render thread
+ * only has to takeSelected() and hand it to its backend.
+ *
+ * Between switches the render thread can warmNext() to link the programs
+ * of ready presets a few at a time, after which a switch is a pointer swap
+ * and a program bind.
+ *
+ * Presets the renderer replaces come back through retire() and go into a
+ * PreparedPresetCache, as do prepared presets that dropped out of the
+ * upcoming list, so going back to one costs nothing as long as it is
+ * still cached. Presets are cached by content hash, so another file with
+ * the same preset in it gets the same prepared copy.
+ *
+ * setUpcoming() and select() are for the message thread, takeSelected(),
+ * warmNext() and retire() for the render thread.
+ */
+class PresetPrefetcher
+{
+public:
+    struct Stats
+    {
+        int prepared = 0;       // Presets prepared in the background
+        int failed = 0;         // Presets that didn't parse or compile
+        int hits = 0;           // Selected presets that were ready
+        int misses = 0;         // Selected presets that still had to be prepared
+        double lastPrepareMs = 0.0;
+    };
+
+    /** A preset to prepare */
+    struct Request
+    {
+        juce::File file;
+        uint64_t contentHash = 0;   // PresetCatalog::Entry::normalizedHash; 0 if not known
+        std::shared_ptr<const PresetPack> pack;     // Pack members: PresetCatalog::Entry::pack
+        int packMember = -1;
+    };
+
+    /**
+     * @param numThreads Worker count; <= 0 uses hardware concurrency - 1.
+     *                   The prefetch thread works alongside them.
+     */
+    explicit PresetPrefetcher(int numThreads = 1);
+    ~PresetPrefetcher();
+
+    /**
+     * @brief Presets to have ready, most likely first
+     *
+     * Prepared presets that are no longer in the list are dropped.
+     */
+    void setUpcoming(const std::vector<Request>& requests);
+
+    /**
+     * @brief Make a preset the next one to show
+     *
+     * If it isn't prepared yet it is prepared ahead of everything else; the
+     * preset on screen stays until it is.
+     */
+    void select(const Request& request);
+
+    /** The selected preset once it is prepared, else nullptr; render thread */
+    std::unique_ptr<PreparedPreset> takeSelected();
+
+    /**
+     * @brief Pass one prepared, not yet warmed upcoming preset to warm
+     * @param warm Typically PresetRenderer::warmPreset; runs without the
+     *             prefetcher's lock held, so the message thread never
+     *             waits for it
+     * @return false if there was nothing to warm
+     */
+    bool warmNext(const std::function<void(const PreparedPreset&)>& warm);
+
+    /** Hand back a preset the renderer replaced, to be cached; render thread */
+    void retire(std::unique_ptr<PreparedPreset> prepared);
+
+    /** Bound on the memory the cache of prepared presets may hold */
+    void setCacheBudget(size_t budgetBytes);
+
+    /** Whether a preset has been selected and not taken yet */
+    bool hasSelection() const;
+
+    Stats getStats() const;
+
+    /**
+     * Lookups are counted when a preset is selected and wasn't prefetched,
+     * and when an upcoming preset is found cached
+     */
+    PreparedPresetCache::Stats getCacheStats() const;
+
+private:
+    struct Slot
+    {
+        std::string path;
+        uint64_t contentHash = 0;
+        std::shared_ptr<const PresetPack> pack;
+        int packMember = -1;
+        std::unique_ptr<PreparedPreset> prepared;
+        bool preparing = false;
+        bool failed = false;
+        bool warmed = false;
+
+        bool needsWork() const { return prepared == nullptr && !preparing && !failed; }
+    };
+
+    void run();
+    Slot* findSlot(const std::string& path);
+    void cacheSlot(Slot& slot);
+    std::unique_ptr<PreparedPreset> takeCached(const std::string& path, uint64_t contentHash);
+
+    mutable std::mutex lock;
+    std::condition_variable wake;
+
+    std::vector<Slot> upcoming;
+    Slot selected;              // path is empty when nothing is selected
+    Stats stats;
+    PreparedPresetCache cache;
+
+    WorkerPool pool;
+    std::thread thread;
+    bool shouldExit = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetPrefetcher)
+};
@@ -0,0 +1,200 @@
+#include "PresetSampler.h"
+#include <algorithm>
+
+PresetSampler::PresetSampler()
+{
+}
+
+void PresetSampler::assign(const std::vector<double>& newWeights)
+{
+    weights = newWeights;
+
+    for (auto& weight : weights)
+        weight = std::max(weight, 0.0);
+
+    numPickable = static_cast<int>(std::count_if(weights.begin(), weights.end(),
+                                                 [](double weight) { return weight > 0.0; }));
+
+    recentCount.assign(weights.size(), 0);
+    ringStart = 0;
+    ringSize = 0;
+
+    rebuild();
+}
+
+void PresetSampler::setWeight(int index, double weight)
+{
+    if (index < 0 || index >= size())
+        return;
+
+    weight = std::max(weight, 0.0);
+    const double previous = weights[static_cast<size_t>(index)];
+    if (weight == previous)
+        return;
+
+    numPickable += (weight > 0.0 ? 1 : 0) - (previous > 0.0 ? 1 : 0);
+
+    const double oldEffective = getEffectiveWeight(index);
+    weights[static_cast<size_t>(index)] = weight;
+    add(index, getEffectiveWeight(index) - oldEffective);
+
+    trimWindow();
+}
+
+double PresetSampler::getWeight(int index) const
+{
+    return index >= 0 && index < size() ? weights[static_cast<size_t>(index)] : 0.0;
+}
+
+double PresetSampler::getTotal() const
+{
+    double total = 0.0;
+    for (int i = size(); i > 0; i -= i & -i)
+        total += tree[static_cast<size_t>(i)];
+
+    return total;
+}
+
+int PresetSampler::pick(double random) const
+{
+    const int count = size();
+    const double total = getTotal();
+
+    if (count == 0 || total <= 0.0)
+        return -1;
+
+    // Walk down to the first preset whose prefix sum exceeds the target;
+    // zero-weight presets are stepped over
+    double remaining = std::clamp(random, 0.0, 1.0) * total;
+    int position = 0;
+
+    int step = 1;
+    while (step * 2 <= count)
+        step *= 2;
+
+    for (; step > 0; step /= 2)
+    {
+        const int next = position + step;
+        if (next <= count && tree[static_cast<size_t>(next)] <= remaining)
+        {
+            position = next;
+            remaining -= tree[static_cast<size_t>(next)];
+        }
+    }
+
+    // Rounding can land past the end or on an excluded preset
+    if (position >= count || getEffectiveWeight(position) <= 0.0)
+        return -1;
+
+    return position;
+}
+
+//==============================================================================
+void PresetSampler::setWindowSize(int numPresets)
+{
+    numPresets = std::max(numPresets, 0);
+
+    // Keep the newest entries
+    const auto recent = getRecent();
+    const size_t keep = std::min(recent.size(), static_cast<size_t>(numPresets));
+
+    while (ringSize > 0)
+        popOldest();
+
+    windowSize = numPresets;
+    ring.assign(static_cast<size_t>(windowSize), -1);
+    ringStart = 0;
+
+    for (size_t i = recent.size() - keep; i < recent.size(); ++i)
+        markShown(recent[i]);
+}
+
+void PresetSampler::markShown(int index)
+{
+    if (index < 0 || index >= size() || windowSize == 0)
+        return;
+
+    if (ringSize == windowSize)
+        popOldest();
+
+    ring[static_cast<size_t>((ringStart + ringSize) % windowSize)] = index;
+    ++ringSize;
+
+    if (recentCount[static_cast<size_t>(index)]++ == 0)
+        add(index, -weights[static_cast<size_t>(index)]);
+
+    trimWindow();
+}
+
+bool PresetSampler::isRecent(int index) const
+{
+    return index >= 0 && index < size() && recentCount[static_cast<size_t>(index)] > 0;
+}
+
+std::vector<int> PresetSampler::getRecent() const
+{
+    std::vector<int> recent;
+    recent.reserve(static_cast<size_t>(ringSize));
+
+    for (int i = 0; i < ringSize; ++i)
+        recent.push_back(ring[static_cast<size_t>((ringStart + i) % windowSize)]);
+
+    return recent;
+}
+
+//==============================================================================
+double PresetSampler::getEffectiveWeight(int index) const
+{
+    return recentCount[static_cast<size_t>(index)] > 0 ? 0.0 : weights[static_cast<size_t>(index)];
+}
+
+void PresetSampler::add(int index, double delta)
+{
+    if (delta == 0.0)
+        return;
+
+    // Every update leaves a little rounding in the prefix sums; rebuilding
+    // once per size() updates keeps that bounded at O(1) amortized
+    if (++updatesSinceRebuild > size())
+    {
+        rebuild();
+        return;
+    }
+
+    for (int i = index + 1; i <= size(); i += i & -i)
+        tree[static_cast<size_t>(i)] += delta;
+}
+
+void PresetSampler::rebuild()
+{
+    const int count = size();
+    tree.assign(static_cast<size_t>(count) + 1, 0.0);
+
+    for (int i = 1; i <= count; ++i)
+    {
+        tree[static_cast<size_t>(i)] += getEffectiveWeight(i - 1);
+
+        const int parent = i + (i & -i);
+        if (parent <= count)
+            tree[static_cast<size_t>(parent)] += tree[static_cast<size_t>(i)];
+    }
+
+    updatesSinceRebuild = 0;
+}
+
+void PresetSampler::trimWindow()
+{
+    // At most half the pickable presets are held back
+    while (ringSize > 0 && ringSize > numPickable / 2)
+        popOldest();
+}
+
+void PresetSampler::popOldest()
+{
+    const int index = ring[static_cast<size_t>(ringStart)];
+    ringStart = (ringStart + 1) % windowSize;
+    --ringSize;
+
+    if (--recentCount[static_cast<size_t>(index)] == 0)
+        add(index, weights[static_cast<size_t>(index)]);
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class PresetSampler
+ * @brief Weighted random choice over the preset library, without recent repeats
+ *
+ * Each preset has a weight (PresetManager derives it from the rating and
+ * favorites; 0 means never picked) and is picked with probability
+ * proportional to it. The weights live in a Fenwick tree, so a pick is a
+ * walk down the tree and changing one weight updates its prefix sums, both
+ * O(log n); assign() builds the tree in O(n).
+ *
+ * Presets that were shown recently sit in a no-repeat window, a ring
+ * buffer of the last few shown, and are picked as if their weight were 0
+ * until they drop out of it. The window never holds more than half of the
+ * pickable presets, so a small library isn't starved.
+ */
+class PresetSampler
+{
+public:
+    PresetSampler();
+
+    /**
+     * @brief Replace all weights; clears the no-repeat window
+     */
+    void assign(const std::vector<double>& newWeights);
+
+    /**
+     * @brief Change one preset's weight
+     */
+    void setWeight(int index, double weight);
+    double getWeight(int index) const;
+
+    int size() const { return static_cast<int>(weights.size()); }
+
+    /**
+     * @brief Sum of the weights that can be picked now (recent presets excluded)
+     */
+    double getTotal() const;
+
+    /**
+     * @brief Pick a preset
+     * @param random Uniform random number in [0, 1)
+     * @return Index of the preset, or -1 if nothing can be picked
+     */
+    int pick(double random) const;
+
+    /**
+     * @brief Set how many recently shown presets are kept out of picks
+     */
+    void setWindowSize(int numPresets);
+    int getWindowSize() const { return windowSize; }
+
+    /**
+     * @brief A preset was shown; it joins the no-repeat window
+     */
+    void markShown(int index);
+
+    bool isRecent(int index) const;
+
+    /**
+     * @brief Presets in the no-repeat window, oldest first
+     */
+    std::vector<int> getRecent() const;
+
+private:
+    double getEffectiveWeight(int index) const;
+    void add(int index, double delta);
+    void rebuild();
+    void trimWindow();
+    void popOldest();
+
+    std::vector<double> weights;
+    std::vector<double> tree;           // Fenwick tree of effective weights, 1-based
+    std::vector<uint32_t> recentCount;  // Times each preset is in the window
+    int numPickable = 0;                // Presets with weight > 0
+    int updatesSinceRebuild = 0;        // Rounding drift is reset by a rebuild
+
+    // No-repeat window
+    std::vector<int> ring;
+    int ringStart = 0;
+    int ringSize = 0;
+    int windowSize = 0;
+};
@@ -0,0 +1,132 @@
+#include "BlurPyramid.h"
+
+using namespace juce::gl;
+
+BlurPyramid::BlurPyramid()
+{
+}
+
+BlurPyramid::~BlurPyramid()
+{
+}
+
+bool BlurPyramid::initializeGL()
+{
+    blurShader = shaderCompiler.compileShader(MilkDrop::ShaderTemplates::VERTEX_SHADER,
+                                              MilkDrop::ShaderTemplates::BLUR_FRAGMENT);
+    if (!blurShader)
+    {
+        DBG("FlarkViz: Failed to compile blur shader: " << shaderCompiler.getLastError());
+        return false;
+    }
+
+    loc_source = glGetUniformLocation(blurShader->programId, "source");
+    loc_texelStep = glGetUniformLocation(blurShader->programId, "texelStep");
+
+    // The source is always on unit 0; uniforms keep their values
+    if (loc_source >= 0)
+    {
+        glUseProgram(blurShader->programId);
+        glUniform1i(loc_source, 0);
+        glUseProgram(0);
+    }
+
+    return true;
+}
+
+void BlurPyramid::cleanupGL()
+{
+    if (blurShader && blurShader->programId != 0)
+        glDeleteProgram(blurShader->programId);
+
+    blurShader.reset();
+}
+
+BlurPyramid::Levels BlurPyramid::declareLevels(RenderGraph& graph, int sourceWidth, int sourceHeight,
+                                               RenderTargetFormat format) const
+{
+    static const char* const names[maxLevels] = { "blur1", "blur2", "blur3" };
+
+    Levels levels;
+
+    int width = sourceWidth;
+    int height = sourceHeight;
+
+    for (int level = 0; level < maxLevels; ++level)
+    {
+        width = juce::jmax(1, width / 2);
+        height = juce::jmax(1, height / 2);
+
+        levels[static_cast<size_t>(level)] = graph.retainedTexture(names[level], { format, width, height });
+    }
+
+    return levels;
+}
+
+void BlurPyramid::addPasses(RenderGraph& graph, GLStateCache& glState, RenderGraph::ResourceId source,
+                            const Levels& levels, int group,
+                            std::function<void()> drawFullscreen)
+{
+    // Without the shader the levels stay black
+    if (!blurShader)
+        return;
+
+    static const char* const horizontalNames[maxLevels] = { "blur1.h", "blur2.h", "blur3.h" };
+    static const char* const verticalNames[maxLevels] = { "blur1.v", "blur2.v", "blur3.v" };
+    static const char* const tempNames[maxLevels] = { "blur1.temp", "blur2.temp", "blur3.temp" };
+
+    RenderGraph::ResourceId input = source;
+
+    for (int level = 0; level < maxLevels; ++level)
+    {
+        const auto output = levels[static_cast<size_t>(level)];
+        const auto temp = graph.createTexture(tempNames[level], graph.getDesc(output));
+
+        // Horizontal pass, downsampling by 2 (steps are in source texels)
+        const float stepX = 1.0f / static_cast<float>(graph.getDesc(input).width);
+
+        auto horizontal = graph.addPass(horizontalNames[level],
+            [this, &glState, input, temp, stepX, drawFullscreen] (const RenderGraph::Resources& resources)
+            {
+                blurPass(glState, resources.getTexture(input), resources.getFramebuffer(temp),
+                         resources.getWidth(temp), resources.getHeight(temp),
+                         stepX, 0.0f, drawFullscreen);
+            });
+        horizontal.setGroup(group);
+        horizontal.read(input);
+        horizontal.write(temp);
+
+        // Vertical pass at the level's resolution
+        const float stepY = 1.0f / static_cast<float>(graph.getDesc(output).height);
+
+        auto vertical = graph.addPass(verticalNames[level],
+            [this, &glState, temp, output, stepY, drawFullscreen] (const RenderGraph::Resources& resources)
+            {
+                blurPass(glState, resources.getTexture(temp), resources.getFramebuffer(output),
+                         resources.getWidth(output), resources.getHeight(output),
+                         0.0f, stepY, drawFullscreen);
+            });
+        vertical.setGroup(group);
+        vertical.read(temp);
+        vertical.write(output);
+
+        input = output;
+    }
+}
+
+void BlurPyramid::blurPass(GLStateCache& glState, unsigned int sourceTexture,
+                           unsigned int targetFramebuffer, int targetWidth, int targetHeight,
+                           float stepX, float stepY,
+                           const std::function<void()>& drawFullscreen)
+{
+    glState.bindFramebuffer(targetFramebuffer);
+    glState.setViewport(0, 0, targetWidth, targetHeight);
+    glState.setBlendEnabled(false);
+    glState.useProgram(blurShader->programId);
+    glState.bindTexture(0, GL_TEXTURE_2D, sourceTexture);
+
+    if (loc_texelStep >= 0)
+        glState.uniform2f(loc_texelStep, stepX, stepY);
+
+    drawFullscreen();
+}
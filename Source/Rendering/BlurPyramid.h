@@ -0,0 +1,90 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "RenderGraph.h"
+#include "GLStateCache.h"
+#include "ShaderCompiler.h"
+#include <array>
+#include <functional>
+#include <memory>
+
+/**
+ * @class BlurPyramid
+ * @brief Renders MilkDrop 2's blur1/blur2/blur3 textures
+ *
+ * Each level is half the size of the one before it (blur1 is half the
+ * feedback resolution). A level is produced by two passes of a separable
+ * Gaussian: a horizontal pass that also downsamples into a transient
+ * target, then a vertical pass into the level's texture. The kernel uses
+ * linear-sampling tap reduction (9 taps in 5 fetches).
+ *
+ * Shaders read a level through GetBlurN(), which maps the stored value
+ * into the level's range (blurN_min + texel * (blurN_max - blurN_min)),
+ * as MilkDrop 2 does. The levels are stored unscaled, so every range is
+ * MilkDrop's default of 0..1 and the mapping leaves values unchanged.
+ *
+ * The levels are retained RenderGraph textures, so the next warp pass can
+ * sample them too. Levels no shader reads are culled by the graph, along
+ * with the passes that would have produced them.
+ */
+class BlurPyramid
+{
+public:
+    static constexpr int maxLevels = 3;
+
+    /** RenderGraph ids of blur1..blur3 */
+    using Levels = std::array<RenderGraph::ResourceId, maxLevels>;
+
+    /** Values a level's texels 0 and 1 stand for (blurN_min / blurN_max) */
+    struct Range
+    {
+        float min = 0.0f;
+        float max = 1.0f;
+    };
+
+    BlurPyramid();
+    ~BlurPyramid();
+
+    //==========================================================================
+    // OpenGL lifecycle
+    bool initializeGL();
+    void cleanupGL();
+
+    /**
+     * @brief Declare the level textures for this frame
+     * @param sourceWidth Feedback width in pixels
+     * @param sourceHeight Feedback height in pixels
+     * @param format Format for the level textures
+     */
+    Levels declareLevels(RenderGraph& graph, int sourceWidth, int sourceHeight,
+                         RenderTargetFormat format) const;
+
+    /**
+     * @brief Add the passes that rebuild every level from a source texture
+     * @param glState State cache the passes bind through (blending is left off)
+     * @param source Texture to blur (the warp pass output)
+     * @param levels Ids from declareLevels()
+     * @param group RenderGraph pass group for the blur passes
+     * @param drawFullscreen Draws geometry covering the viewport
+     */
+    void addPasses(RenderGraph& graph, GLStateCache& glState, RenderGraph::ResourceId source,
+                   const Levels& levels, int group,
+                   std::function<void()> drawFullscreen);
+
+    /** Range of a level (0 = blur1), for the shaders' blurN_min / blurN_max */
+    Range getRange(int level) const { return ranges[static_cast<size_t>(level)]; }
+
+private:
+    ShaderCompiler shaderCompiler;
+    std::unique_ptr<MilkDrop::CompiledShader> blurShader;
+    int loc_source = -1;
+    int loc_texelStep = -1;
+    std::array<Range, maxLevels> ranges {};
+
+    void blurPass(GLStateCache& glState, unsigned int sourceTexture,
+                  unsigned int targetFramebuffer, int targetWidth, int targetHeight,
+                  float stepX, float stepY,
+                  const std::function<void()>& drawFullscreen);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BlurPyramid)
+};
@@ -0,0 +1,378 @@
+#include "FrameCapture.h"
+#include <cstring>
+
+using namespace juce::gl;
+
+namespace
+{
+    double ticksToMs(juce::int64 ticks)
+    {
+        return juce::Time::highResolutionTicksToSeconds(ticks) * 1000.0;
+    }
+
+    constexpr GLuint64 fenceTimeoutNs = 1000000000;  // 1 s; only hit if the GPU hangs
+}
+
+FrameCapture::FrameCapture(int pbos, int frames, DropPolicy dropPolicy, Sink* frameSink)
+    : numSlots(juce::jlimit(2, 8, pbos))
+    , maxFrames(juce::jmax(1, frames))
+    , policy(dropPolicy)
+    , sink(frameSink)
+    , slots(std::make_unique<Slot[]>(static_cast<size_t>(numSlots)))
+    , freeFrames(static_cast<size_t>(maxFrames))
+    , readyFrames(static_cast<size_t>(maxFrames))
+    , copyJobs(static_cast<size_t>(numSlots))
+{
+    copyThread = std::thread([this] { copyThreadLoop(); });
+}
+
+FrameCapture::~FrameCapture()
+{
+    // PBOs must already have been released with cleanupGL() on the GL thread
+    stopping = true;
+    jobAvailable.signal();
+    frameReleased.signal();
+
+    if (copyThread.joinable())
+        copyThread.join();
+}
+
+//==============================================================================
+void FrameCapture::capture(GLuint fbo, int newWidth, int newHeight, double timeSeconds)
+{
+    if (newWidth <= 0 || newHeight <= 0)
+        return;
+
+    auto startTicks = juce::Time::getHighResolutionTicks();
+
+    if (newWidth != width || newHeight != height)
+        resizeBuffers(newWidth, newHeight);
+
+    // Hand finished readbacks to the copy thread and recycle copied PBOs
+    mapCompletedSlots(false);
+    unmapCopiedSlots();
+
+    auto& slot = slots[static_cast<size_t>(writeIndex)];
+    if (slot.state != Slot::State::Free)
+        retireSlot(slot);
+
+    // Asynchronous readback: returns immediately, the copy lands in the PBO
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.state = Slot::State::Pending;
+    slot.sequence = nextSequence++;
+    slot.timeSeconds = timeSeconds;
+
+    // Make sure the fence reaches the GPU so later polls can see it signal
+    glFlush();
+
+    writeIndex = (writeIndex + 1) % numSlots;
+    framesCaptured++;
+
+    double ms = ticksToMs(juce::Time::getHighResolutionTicks() - startTicks);
+    lastRenderThreadMs = ms;
+    totalRenderThreadMs = totalRenderThreadMs.load() + ms;
+    if (ms > maxRenderThreadMs.load())
+        maxRenderThreadMs = ms;
+}
+
+void FrameCapture::flush()
+{
+    for (;;)
+    {
+        mapCompletedSlots(true);
+        unmapCopiedSlots();
+
+        bool idle = true;
+        for (int i = 0; i < numSlots; ++i)
+            idle = idle && slots[static_cast<size_t>(i)].state == Slot::State::Free;
+
+        if (idle)
+            break;
+
+        std::this_thread::yield();
+    }
+}
+
+void FrameCapture::cleanupGL()
+{
+    if (width > 0)
+        flush();
+
+    for (int i = 0; i < numSlots; ++i)
+    {
+        auto& slot = slots[static_cast<size_t>(i)];
+        if (slot.pbo != 0)
+            glDeleteBuffers(1, &slot.pbo);
+        slot.pbo = 0;
+    }
+
+    width = 0;
+    height = 0;
+}
+
+//==============================================================================
+CapturedFrame* FrameCapture::popFrame(int timeoutMs)
+{
+    CapturedFrame* frame = nullptr;
+
+    for (;;)
+    {
+        if (readyFrames.tryPop(frame))
+        {
+            framesPopped++;
+
+            // One signal may stand for several frames; pass it on to other consumers
+            if (readyFrames.getApproximateSize() > 0)
+                frameAvailable.signal();
+
+            return frame;
+        }
+
+        if (timeoutMs == 0)
+            return nullptr;
+
+        if (!frameAvailable.wait(timeoutMs))
+        {
+            if (!readyFrames.tryPop(frame))
+                return nullptr;
+
+            framesPopped++;
+            return frame;
+        }
+    }
+}
+
+void FrameCapture::releaseFrame(CapturedFrame* frame)
+{
+    if (frame == nullptr)
+        return;
+
+    freeFrames.tryPush(frame);
+    frameReleased.signal();
+}
+
+int64_t FrameCapture::getNumPending() const
+{
+    return framesCaptured.load() - framesPopped.load() - framesDropped.load();
+}
+
+FrameCapture::Stats FrameCapture::getStats() const
+{
+    Stats stats;
+    stats.framesCaptured = framesCaptured.load();
+    stats.framesDelivered = framesDelivered.load();
+    stats.framesDropped = framesDropped.load();
+    stats.gpuWaits = gpuWaits.load();
+    stats.lastRenderThreadMs = lastRenderThreadMs.load();
+    stats.maxRenderThreadMs = maxRenderThreadMs.load();
+    stats.totalRenderThreadMs = totalRenderThreadMs.load();
+    return stats;
+}
+
+//==============================================================================
+void FrameCapture::resizeBuffers(int newWidth, int newHeight)
+{
+    // Outstanding readbacks still refer to the old size
+    if (width > 0)
+        flush();
+
+    width = newWidth;
+    height = newHeight;
+
+    auto bytes = static_cast<GLsizeiptr>(width) * height * 4;
+
+    for (int i = 0; i < numSlots; ++i)
+    {
+        auto& slot = slots[static_cast<size_t>(i)];
+        if (slot.pbo == 0)
+            glGenBuffers(1, &slot.pbo);
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    writeIndex = 0;
+    mapIndex = 0;
+}
+
+void FrameCapture::mapCompletedSlots(bool waitForOldest)
+{
+    auto bytes = static_cast<GLsizeiptr>(width) * height * 4;
+
+    // Map strictly in capture order so the copy thread delivers frames in order
+    while (slots[static_cast<size_t>(mapIndex)].state == Slot::State::Pending)
+    {
+        auto& slot = slots[static_cast<size_t>(mapIndex)];
+
+        GLenum result = waitForOldest
+            ? glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, fenceTimeoutNs)
+            : glClientWaitSync(slot.fence, 0, 0);
+
+        if (result == GL_TIMEOUT_EXPIRED)
+            break;
+
+        // Only the oldest readback is ever waited for
+        waitForOldest = false;
+
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+        mapIndex = (mapIndex + 1) % numSlots;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        slot.mapped = static_cast<const uint8_t*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT));
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        if (result == GL_WAIT_FAILED || slot.mapped == nullptr)
+        {
+            DBG("FlarkViz: Frame capture readback failed for frame " << slot.sequence);
+
+            if (slot.mapped != nullptr)
+            {
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            }
+
+            slot.mapped = nullptr;
+            slot.state = Slot::State::Free;
+            framesDropped++;
+            continue;
+        }
+
+        slot.copied = false;
+        slot.state = Slot::State::Mapped;
+
+        CopyJob job;
+        job.slot = &slot;
+        job.width = width;
+        job.height = height;
+
+        // The job queue holds one entry per slot, so this cannot fail
+        copyJobs.tryPush(job);
+        jobAvailable.signal();
+    }
+}
+
+void FrameCapture::unmapCopiedSlots()
+{
+    for (int i = 0; i < numSlots; ++i)
+    {
+        auto& slot = slots[static_cast<size_t>(i)];
+
+        if (slot.state == Slot::State::Mapped && slot.copied.load(std::memory_order_acquire))
+        {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+            slot.mapped = nullptr;
+            slot.state = Slot::State::Free;
+        }
+    }
+}
+
+void FrameCapture::retireSlot(Slot& slot)
+{
+    // The ring is full; the slot about to be reused is the oldest one
+    gpuWaits++;
+
+    while (slot.state == Slot::State::Pending)
+        mapCompletedSlots(true);
+
+    while (slot.state == Slot::State::Mapped && !slot.copied.load(std::memory_order_acquire))
+        std::this_thread::yield();
+
+    unmapCopiedSlots();
+}
+
+//==============================================================================
+void FrameCapture::copyThreadLoop()
+{
+    while (!stopping)
+    {
+        CopyJob job;
+        if (!copyJobs.tryPop(job))
+        {
+            jobAvailable.wait(100);
+            continue;
+        }
+
+        auto& slot = *job.slot;
+
+        if (sink != nullptr)
+        {
+            sink->consumeFrame(slot.mapped, job.width, job.height, slot.sequence, slot.timeSeconds);
+            slot.copied.store(true, std::memory_order_release);
+
+            // Counted as popped so getNumPending() drains to zero
+            framesDelivered++;
+            framesPopped++;
+            continue;
+        }
+
+        auto* frame = acquireFrameBuffer();
+
+        if (frame != nullptr)
+        {
+            frame->sequence = slot.sequence;
+            frame->timeSeconds = slot.timeSeconds;
+            frame->width = job.width;
+            frame->height = job.height;
+
+            // GL rows run bottom-up; consumers expect the top row first
+            const size_t rowBytes = static_cast<size_t>(job.width) * 4;
+            frame->pixels.resize(rowBytes * static_cast<size_t>(job.height));
+
+            for (int y = 0; y < job.height; ++y)
+            {
+                std::memcpy(frame->pixels.data() + static_cast<size_t>(y) * rowBytes,
+                            slot.mapped + static_cast<size_t>(job.height - 1 - y) * rowBytes,
+                            rowBytes);
+            }
+        }
+
+        // The GL thread may unmap the PBO from here on
+        slot.copied.store(true, std::memory_order_release);
+
+        if (frame != nullptr)
+        {
+            readyFrames.tryPush(frame);
+            framesDelivered++;
+            frameAvailable.signal();
+        }
+        else
+        {
+            framesDropped++;
+        }
+    }
+}
+
+CapturedFrame* FrameCapture::acquireFrameBuffer()
+{
+    CapturedFrame* frame = nullptr;
+
+    while (!freeFrames.tryPop(frame))
+    {
+        if (static_cast<int>(allFrames.size()) < maxFrames)
+        {
+            allFrames.push_back(std::make_unique<CapturedFrame>());
+            return allFrames.back().get();
+        }
+
+        // Every buffer is queued or held by a consumer
+        if (policy == DropPolicy::DropNewest || stopping)
+            return nullptr;
+
+        frameReleased.wait(10);
+    }
+
+    return frame;
+}
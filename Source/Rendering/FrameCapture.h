@@ -0,0 +1,187 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../Core/LockFreeQueue.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/**
+ * @struct CapturedFrame
+ * @brief One read-back frame: tightly packed RGBA8, top row first
+ *
+ * Owned by FrameCapture; consumers hand it back with releaseFrame().
+ */
+struct CapturedFrame
+{
+    int64_t sequence = 0;      // Capture order, starting at 0
+    double timeSeconds = 0.0;  // Preset time the frame was rendered for
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> pixels;
+};
+
+/**
+ * @class FrameCapture
+ * @brief Asynchronous GPU readback through a ring of pixel buffer objects
+ *
+ * capture() only queues a glReadPixels into the next PBO and drops a fence
+ * behind it. On later calls, PBOs whose fence has signalled are mapped and
+ * handed to a copy thread, which flips the rows into a pooled CapturedFrame
+ * and pushes it onto a lock-free queue; the PBO is unmapped once the copy is
+ * done. The render thread therefore never waits for the GPU or copies
+ * pixels in the steady state - it only blocks when every PBO is still busy,
+ * or (with DropPolicy::Block) when consumers fall behind.
+ *
+ * Frames are delivered in capture order. Any number of consumer threads
+ * may call popFrame()/releaseFrame().
+ */
+class FrameCapture
+{
+public:
+    enum class DropPolicy
+    {
+        DropNewest,   // Realtime: skip frames when consumers fall behind
+        Block         // Offline: never lose a frame, stall the render thread instead
+    };
+
+    /**
+     * @brief Takes frames straight from the mapped PBO instead of the queue
+     *
+     * Called on the copy thread with the rows bottom-up, as GL returns them;
+     * the pointer is only valid during the call. Saves a copy for consumers
+     * that have their own destination memory (see SharedFramePublisher).
+     */
+    class Sink
+    {
+    public:
+        virtual ~Sink() = default;
+        virtual void consumeFrame(const uint8_t* bottomUpRgba, int width, int height,
+                                  int64_t sequence, double timeSeconds) = 0;
+    };
+
+    struct Stats
+    {
+        int64_t framesCaptured = 0;
+        int64_t framesDelivered = 0;
+        int64_t framesDropped = 0;
+        int64_t gpuWaits = 0;           // capture() had to wait for a PBO
+        double lastRenderThreadMs = 0.0;
+        double maxRenderThreadMs = 0.0;
+        double totalRenderThreadMs = 0.0;
+    };
+
+    /**
+     * @param numPbos Size of the PBO ring (3-4 keeps readback 2-3 frames behind)
+     * @param maxFrames Upper bound on frames held by the queue and consumers
+     * @param sink If set, receives every frame and popFrame() never returns any
+     */
+    explicit FrameCapture(int numPbos = 4, int maxFrames = 8, DropPolicy policy = DropPolicy::DropNewest,
+                          Sink* sink = nullptr);
+    ~FrameCapture();
+
+    //==========================================================================
+    // GL thread
+
+    /**
+     * @brief Queue a readback of the framebuffer's colour attachment
+     * @param fbo Framebuffer to read (0 = default framebuffer)
+     */
+    void capture(GLuint fbo, int width, int height, double timeSeconds);
+
+    /**
+     * @brief Wait for every outstanding readback and deliver it
+     */
+    void flush();
+
+    /**
+     * @brief Delete the PBOs (requires an active GL context)
+     */
+    void cleanupGL();
+
+    //==========================================================================
+    // Consumer threads
+
+    /**
+     * @brief Next frame in capture order
+     * @param timeoutMs 0 = don't wait, -1 = wait forever
+     * @return nullptr if none arrived in time
+     */
+    CapturedFrame* popFrame(int timeoutMs);
+
+    /**
+     * @brief Return a frame's buffer to the pool
+     */
+    void releaseFrame(CapturedFrame* frame);
+
+    /**
+     * @brief Frames captured but not yet popped (including those in flight)
+     */
+    int64_t getNumPending() const;
+
+    Stats getStats() const;
+
+private:
+    struct Slot
+    {
+        GLuint pbo = 0;
+        GLsync fence = nullptr;
+        enum class State { Free, Pending, Mapped } state = State::Free;
+        std::atomic<bool> copied {false};
+        const uint8_t* mapped = nullptr;
+        int64_t sequence = 0;
+        double timeSeconds = 0.0;
+    };
+
+    struct CopyJob
+    {
+        Slot* slot = nullptr;
+        int width = 0;
+        int height = 0;
+    };
+
+    const int numSlots;
+    const int maxFrames;
+    const DropPolicy policy;
+    Sink* const sink;
+
+    std::unique_ptr<Slot[]> slots;
+    int width = 0;
+    int height = 0;
+    int writeIndex = 0;  // Next slot to issue a readback into
+    int mapIndex = 0;    // Oldest slot still waiting on its fence
+    int64_t nextSequence = 0;
+
+    // Frame pool; frames are only created on the copy thread
+    std::vector<std::unique_ptr<CapturedFrame>> allFrames;
+    LockFreeQueue<CapturedFrame*> freeFrames;
+    LockFreeQueue<CapturedFrame*> readyFrames;
+    LockFreeQueue<CopyJob> copyJobs;
+
+    juce::WaitableEvent jobAvailable;
+    juce::WaitableEvent frameAvailable;
+    juce::WaitableEvent frameReleased;
+
+    std::thread copyThread;
+    std::atomic<bool> stopping {false};
+
+    // Stats (written by the GL and copy threads, read from anywhere)
+    std::atomic<int64_t> framesCaptured {0};
+    std::atomic<int64_t> framesDelivered {0};
+    std::atomic<int64_t> framesDropped {0};
+    std::atomic<int64_t> framesPopped {0};
+    std::atomic<int64_t> gpuWaits {0};
+    std::atomic<double> lastRenderThreadMs {0.0};
+    std::atomic<double> maxRenderThreadMs {0.0};
+    std::atomic<double> totalRenderThreadMs {0.0};
+
+    void resizeBuffers(int newWidth, int newHeight);
+    void mapCompletedSlots(bool waitForOldest);
+    void unmapCopiedSlots();
+    void retireSlot(Slot& slot);
+    void copyThreadLoop();
+    CapturedFrame* acquireFrameBuffer();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FrameCapture)
+};
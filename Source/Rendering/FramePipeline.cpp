@@ -0,0 +1,151 @@
+#include "FramePipeline.h"
+#include <chrono>
+
+void FrameState::assign(const MilkDrop::ExecutionContext& context, int64_t number)
+{
+    frameNumber = number;
+
+    time = context.time;
+    frame = static_cast<float>(context.frame);
+    fps = static_cast<float>(context.fps);
+
+    bass = static_cast<float>(context.bass);
+    mid = static_cast<float>(context.mid);
+    treb = static_cast<float>(context.treb);
+    bassAtt = static_cast<float>(context.bass_att);
+    midAtt = static_cast<float>(context.mid_att);
+    trebAtt = static_cast<float>(context.treb_att);
+
+    zoom = static_cast<float>(context.zoom);
+    rot = static_cast<float>(context.rot);
+    cx = static_cast<float>(context.cx);
+    cy = static_cast<float>(context.cy);
+    dx = static_cast<float>(context.dx);
+    dy = static_cast<float>(context.dy);
+    warp = static_cast<float>(context.warp);
+    sx = static_cast<float>(context.sx);
+    sy = static_cast<float>(context.sy);
+    decay = static_cast<float>(context.decay);
+
+    waveR = static_cast<float>(context.wave_r);
+    waveG = static_cast<float>(context.wave_g);
+    waveB = static_cast<float>(context.wave_b);
+    waveA = static_cast<float>(context.wave_a);
+
+    for (int i = 0; i < 32; ++i)
+        q[i] = static_cast<float>(context.q[i]);
+}
+
+//==============================================================================
+FramePipeline::FramePipeline(RenderState& state)
+    : renderState(state)
+{
+}
+
+FramePipeline::~FramePipeline()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        shuttingDown = true;
+    }
+
+    wake.notify_one();
+
+    if (worker.joinable())
+        worker.join();
+}
+
+void FramePipeline::evaluateInto(FrameState& target, const Inputs& inputs)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    renderState.updateAudioData(inputs.bass, inputs.mid, inputs.treb,
+                                inputs.bassAtt, inputs.midAtt, inputs.trebAtt);
+
+    const auto& context = renderState.executeFrame(inputs.deltaTime);
+    target.assign(context, static_cast<int64_t>(context.frame));
+    target.evalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+const FrameState& FramePipeline::evaluateNow(const Inputs& inputs)
+{
+    discard();
+
+    evaluateInto(slots[1 - front], inputs);
+    front = 1 - front;
+    return slots[front];
+}
+
+void FramePipeline::beginNext(const Inputs& inputs)
+{
+    discard();
+
+    // The worker only exists for pipelined renderers
+    if (!worker.joinable())
+        worker = std::thread([this] { workerLoop(); });
+
+    clockFrame = renderState.getFrameCount();
+    clockSeconds = renderState.getElapsedSeconds();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingInputs = inputs;
+        jobPending = true;
+        jobDone = false;
+    }
+
+    inFlight = true;
+    wake.notify_one();
+}
+
+const FrameState& FramePipeline::waitForNext()
+{
+    if (inFlight)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return jobDone; });
+
+        inFlight = false;
+        front = 1 - front;
+    }
+
+    return slots[front];
+}
+
+void FramePipeline::discard()
+{
+    if (!inFlight)
+        return;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return jobDone; });
+    inFlight = false;
+
+    renderState.setClock(clockFrame, clockSeconds);
+}
+
+void FramePipeline::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for (;;)
+    {
+        wake.wait(lock, [this] { return jobPending || shuttingDown; });
+
+        if (shuttingDown)
+            return;
+
+        jobPending = false;
+        const Inputs inputs = pendingInputs;
+
+        // slots[1 - front] is not read until waitForNext() flips front
+        FrameState& target = slots[1 - front];
+
+        lock.unlock();
+        evaluateInto(target, inputs);
+        lock.lock();
+
+        jobDone = true;
+        done.notify_one();
+    }
+}
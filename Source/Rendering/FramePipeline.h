@@ -0,0 +1,144 @@
+#pragma once
+
+#include "RenderState.h"
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+/**
+ * @struct FrameState
+ * @brief What the GL passes need from one frame's expression evaluation
+ *
+ * Filled in once by whichever thread evaluated the frame and only read
+ * afterwards, so the render thread never looks at RenderState (which the
+ * next frame's evaluation is busy changing).
+ */
+struct FrameState
+{
+    int64_t frameNumber = 0;
+
+    // Time
+    double time = 0.0;
+    float frame = 0.0f;
+    float fps = 60.0f;
+
+    // Audio
+    float bass = 0.0f;
+    float mid = 0.0f;
+    float treb = 0.0f;
+    float bassAtt = 0.0f;
+    float midAtt = 0.0f;
+    float trebAtt = 0.0f;
+
+    // Per-frame variables
+    float zoom = 1.0f;
+    float rot = 0.0f;
+    float cx = 0.5f;
+    float cy = 0.5f;
+    float dx = 0.0f;
+    float dy = 0.0f;
+    float warp = 1.0f;
+    float sx = 1.0f;
+    float sy = 1.0f;
+    float decay = 0.98f;
+
+    float waveR = 1.0f;
+    float waveG = 1.0f;
+    float waveB = 1.0f;
+    float waveA = 1.0f;
+
+    float q[32] = {};
+
+    /** Time the evaluation took, on whichever thread ran it */
+    double evalMs = 0.0;
+
+    void assign(const MilkDrop::ExecutionContext& context, int64_t frameNumber);
+};
+
+//==============================================================================
+/**
+ * @class FramePipeline
+ * @brief Runs per-frame expression evaluation one frame ahead of rendering
+ *
+ * Two FrameState slots: the render thread reads one while a worker thread
+ * evaluates the next frame into the other. A pipelined frame loop is
+ *
+ *   state = isInFlight() ? waitForNext() : evaluateNow(inputs)
+ *   beginNext(inputs)          // frame N+1 evaluates on the worker...
+ *   ... GL passes with state   // ...while frame N's passes are issued
+ *
+ * so evaluation cost hides behind GPU submission, at the price of frame
+ * N+1 seeing the audio levels sampled for frame N. Without beginNext()
+ * every frame is evaluated synchronously, exactly as before.
+ *
+ * The RenderState is only touched by the worker while an evaluation is in
+ * flight; call discard() before loading a preset or setting the clock.
+ * All methods are for a single render thread.
+ */
+class FramePipeline
+{
+public:
+    struct Inputs
+    {
+        float bass = 0.0f;
+        float mid = 0.0f;
+        float treb = 0.0f;
+        float bassAtt = 0.0f;
+        float midAtt = 0.0f;
+        float trebAtt = 0.0f;
+        float deltaTime = 1.0f / 60.0f;
+    };
+
+    explicit FramePipeline(RenderState& state);
+    ~FramePipeline();
+
+    /**
+     * @brief Evaluate a frame on the calling thread
+     * @return The new state, valid until the next evaluateNow() / waitForNext()
+     */
+    const FrameState& evaluateNow(const Inputs& inputs);
+
+    /** Start evaluating the next frame on the worker thread */
+    void beginNext(const Inputs& inputs);
+
+    /** Wait for the frame started by beginNext(); same lifetime as evaluateNow() */
+    const FrameState& waitForNext();
+
+    bool isInFlight() const { return inFlight; }
+
+    /**
+     * @brief Wait for any evaluation in flight and drop its result
+     *
+     * The RenderState clock goes back to where it was before that
+     * evaluation, so a dropped frame isn't counted or timed.
+     */
+    void discard();
+
+private:
+    void workerLoop();
+    void evaluateInto(FrameState& target, const Inputs& inputs);
+
+    RenderState& renderState;
+
+    // slots[front] is being read; the other one is (being) evaluated
+    FrameState slots[2];
+    int front = 0;
+    bool inFlight = false;
+
+    // RenderState's clock before the evaluation in flight
+    int64_t clockFrame = 0;
+    double clockSeconds = 0.0;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    Inputs pendingInputs;
+    bool jobPending = false;
+    bool jobDone = false;
+    bool shuttingDown = false;
+
+    FramePipeline(const FramePipeline&) = delete;
+    FramePipeline& operator=(const FramePipeline&) = delete;
+};
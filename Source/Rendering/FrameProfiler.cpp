@@ -0,0 +1,250 @@
+#include "FrameProfiler.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+//==============================================================================
+// RollingHistogram
+
+RollingHistogram::RollingHistogram(size_t capacity)
+    : samples(juce::jmax<size_t>(1, capacity), 0.0)
+{
+}
+
+void RollingHistogram::add(double value)
+{
+    samples[next] = value;
+    next = (next + 1) % samples.size();
+    count = juce::jmin(count + 1, samples.size());
+    lastValue = value;
+}
+
+void RollingHistogram::clear()
+{
+    next = 0;
+    count = 0;
+    lastValue = 0.0;
+}
+
+RollingHistogram::Percentiles RollingHistogram::compute() const
+{
+    Percentiles result;
+    result.count = static_cast<int>(count);
+    result.last = lastValue;
+
+    if (count == 0)
+        return result;
+
+    // The window is only a few hundred samples; sorting a copy is cheap
+    std::vector<double> sorted(samples.begin(), samples.begin() + static_cast<long>(count));
+    std::sort(sorted.begin(), sorted.end());
+
+    auto at = [&sorted](double fraction)
+    {
+        size_t index = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+        return sorted[index];
+    };
+
+    result.p50 = at(0.50);
+    result.p95 = at(0.95);
+    result.p99 = at(0.99);
+    result.max = sorted.back();
+    return result;
+}
+
+//==============================================================================
+// FrameProfiler
+
+FrameProfiler::FrameProfiler()
+{
+}
+
+FrameProfiler::~FrameProfiler()
+{
+}
+
+void FrameProfiler::initializeGL()
+{
+    for (int i = 0; i < numStages; ++i)
+    {
+        if (stageUsesGpu(static_cast<Stage>(i)))
+            stages[i].gpuTimer.initialize();
+    }
+}
+
+void FrameProfiler::cleanupGL()
+{
+    for (auto& stage : stages)
+        stage.gpuTimer.cleanup();
+}
+
+void FrameProfiler::beginFrame()
+{
+    frameStartTicks = juce::Time::getHighResolutionTicks();
+}
+
+void FrameProfiler::endFrame()
+{
+    lastCpuFrameMs = ticksToMs(juce::Time::getHighResolutionTicks() - frameStartTicks);
+
+    // Collect whatever GPU results are ready; never wait for the rest
+    bool gpuUpdated = false;
+    double gpuTotal = 0.0;
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    for (auto& stage : stages)
+    {
+        const bool ran = stage.ranThisFrame;
+        stage.ranThisFrame = false;
+
+        if (!stage.gpuTimer.isInitialized())
+            continue;
+
+        if (stage.gpuTimer.poll())
+        {
+            stage.gpuHistogram.add(stage.gpuTimer.getLastMs());
+            gpuUpdated = true;
+        }
+
+        // Skipped stages keep their last timing; leave it out of this frame
+        if (ran)
+            gpuTotal += stage.gpuTimer.getLastMs();
+    }
+
+    frameCpuHistogram.add(lastCpuFrameMs);
+
+    if (gpuUpdated)
+    {
+        lastGpuFrameMs = gpuTotal;
+        frameGpuHistogram.add(gpuTotal);
+    }
+
+    frameCount++;
+}
+
+void FrameProfiler::beginStage(Stage stage)
+{
+    auto& data = stages[static_cast<int>(stage)];
+    data.ranThisFrame = true;
+    data.gpuTimer.begin();
+    data.cpuStartTicks = juce::Time::getHighResolutionTicks();
+}
+
+void FrameProfiler::endStage(Stage stage)
+{
+    auto& data = stages[static_cast<int>(stage)];
+    double ms = ticksToMs(juce::Time::getHighResolutionTicks() - data.cpuStartTicks);
+    data.gpuTimer.end();
+
+    std::lock_guard<std::mutex> guard(lock);
+    data.cpuHistogram.add(ms);
+}
+
+void FrameProfiler::addCpuSample(Stage stage, double ms)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    stages[static_cast<int>(stage)].cpuHistogram.add(ms);
+}
+
+FrameProfiler::Report FrameProfiler::getReport() const
+{
+    Report report;
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    for (int i = 0; i < numStages; ++i)
+    {
+        auto stage = static_cast<Stage>(i);
+        report.stages[i].name = getStageName(stage);
+        report.stages[i].hasGpu = stageUsesGpu(stage);
+        report.stages[i].cpu = stages[i].cpuHistogram.compute();
+        report.stages[i].gpu = stages[i].gpuHistogram.compute();
+    }
+
+    report.frameCpu = frameCpuHistogram.compute();
+    report.frameGpu = frameGpuHistogram.compute();
+    report.frames = frameCount;
+    return report;
+}
+
+std::string FrameProfiler::toJSON() const
+{
+    auto report = getReport();
+
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(4);
+
+    auto writePercentiles = [&json](const RollingHistogram::Percentiles& p)
+    {
+        json << "{\"p50\": " << p.p50 << ", \"p95\": " << p.p95
+             << ", \"p99\": " << p.p99 << ", \"max\": " << p.max
+             << ", \"samples\": " << p.count << "}";
+    };
+
+    json << "{\n";
+    json << "  \"frames\": " << report.frames << ",\n";
+    json << "  \"frame\": {\"cpu_ms\": ";
+    writePercentiles(report.frameCpu);
+    json << ", \"gpu_ms\": ";
+    writePercentiles(report.frameGpu);
+    json << "},\n";
+    json << "  \"stages\": {\n";
+
+    for (int i = 0; i < numStages; ++i)
+    {
+        const auto& stage = report.stages[i];
+        json << "    \"" << stage.name << "\": {\"cpu_ms\": ";
+        writePercentiles(stage.cpu);
+        if (stage.hasGpu)
+        {
+            json << ", \"gpu_ms\": ";
+            writePercentiles(stage.gpu);
+        }
+        json << "}" << (i + 1 < numStages ? "," : "") << "\n";
+    }
+
+    json << "  }\n";
+    json << "}\n";
+    return json.str();
+}
+
+void FrameProfiler::reset()
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    for (auto& stage : stages)
+    {
+        stage.cpuHistogram.clear();
+        stage.gpuHistogram.clear();
+    }
+
+    frameCpuHistogram.clear();
+    frameGpuHistogram.clear();
+    frameCount = 0;
+}
+
+const char* FrameProfiler::getStageName(Stage stage)
+{
+    switch (stage)
+    {
+        case Stage::Audio:         return "audio";
+        case Stage::Expressions:   return "expressions";
+        case Stage::WarpPass:      return "warp";
+        case Stage::BlurPass:      return "blur";
+        case Stage::CompositePass: return "composite";
+        case Stage::Capture:       return "capture";
+        case Stage::Swap:          return "swap";
+    }
+    return "unknown";
+}
+
+bool FrameProfiler::stageUsesGpu(Stage stage)
+{
+    return stage == Stage::WarpPass || stage == Stage::BlurPass || stage == Stage::CompositePass;
+}
+
+double FrameProfiler::ticksToMs(int64_t ticks)
+{
+    return juce::Time::highResolutionTicksToSeconds(ticks) * 1000.0;
+}
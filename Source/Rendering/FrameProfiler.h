@@ -0,0 +1,165 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "GpuTimer.h"
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @class RollingHistogram
+ * @brief Keeps the last N samples and reports percentiles over them
+ */
+class RollingHistogram
+{
+public:
+    struct Percentiles
+    {
+        double p50 = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+        double last = 0.0;
+        int count = 0;
+    };
+
+    explicit RollingHistogram(size_t capacity = 600);
+
+    void add(double value);
+    void clear();
+    Percentiles compute() const;
+
+private:
+    std::vector<double> samples;
+    size_t next = 0;
+    size_t count = 0;
+    double lastValue = 0.0;
+};
+
+/**
+ * @class FrameProfiler
+ * @brief Per-stage CPU and GPU timing for the render loop
+ *
+ * Each stage records a CPU timestamp pair and, for stages that issue GL
+ * work, a GL_TIME_ELAPSED query from a per-stage GpuTimer ring. GPU results
+ * are collected without blocking at the end of each frame. Samples go into
+ * rolling histograms so the overlay can show p50/p95/p99 over the last few
+ * seconds, and the whole report can be dumped as JSON.
+ *
+ * Stages must not overlap: GL allows only one active GL_TIME_ELAPSED query.
+ * Reports may be requested from any thread.
+ */
+class FrameProfiler
+{
+public:
+    enum class Stage
+    {
+        Audio,          // Audio analysis (timed on the audio thread)
+        Expressions,    // RenderState::executeFrame (or the wait for a pipelined one)
+        WarpPass,
+        BlurPass,
+        CompositePass,
+        Capture,        // Frame capture readback (render-thread cost only)
+        Swap            // Feedback buffer swap
+    };
+
+    static constexpr int numStages = 7;
+
+    struct StageReport
+    {
+        const char* name = "";
+        bool hasGpu = false;
+        RollingHistogram::Percentiles cpu;
+        RollingHistogram::Percentiles gpu;
+    };
+
+    struct Report
+    {
+        StageReport stages[numStages];
+        RollingHistogram::Percentiles frameCpu;
+        RollingHistogram::Percentiles frameGpu;
+        long long frames = 0;
+    };
+
+    FrameProfiler();
+    ~FrameProfiler();
+
+    //==========================================================================
+    // OpenGL lifecycle
+    void initializeGL();
+    void cleanupGL();
+
+    //==========================================================================
+    // Instrumentation (render thread)
+    void beginFrame();
+    void endFrame();
+    void beginStage(Stage stage);
+    void endStage(Stage stage);
+
+    /**
+     * @brief Record a CPU sample measured elsewhere (e.g. the audio thread)
+     */
+    void addCpuSample(Stage stage, double ms);
+
+    /**
+     * @brief CPU time between beginFrame() and endFrame() of the last frame
+     */
+    double getLastCpuFrameMs() const { return lastCpuFrameMs; }
+
+    /**
+     * @brief Sum of the most recent GPU timings of the stages the last frame ran
+     *
+     * A stage that was skipped (no blur levels, culled pass) keeps its old
+     * timing, which isn't counted.
+     */
+    double getLastGpuFrameMs() const { return lastGpuFrameMs; }
+
+    //==========================================================================
+    // Reporting (any thread)
+    Report getReport() const;
+    std::string toJSON() const;
+    void reset();
+
+    static const char* getStageName(Stage stage);
+    static bool stageUsesGpu(Stage stage);
+
+    /**
+     * @class ScopedStage
+     * @brief RAII helper that times a block as a stage
+     */
+    class ScopedStage
+    {
+    public:
+        ScopedStage(FrameProfiler& p, Stage s) : profiler(p), stage(s) { profiler.beginStage(stage); }
+        ~ScopedStage() { profiler.endStage(stage); }
+
+    private:
+        FrameProfiler& profiler;
+        Stage stage;
+    };
+
+private:
+    struct StageData
+    {
+        GpuTimer gpuTimer;
+        int64_t cpuStartTicks = 0;
+        bool ranThisFrame = false;
+        RollingHistogram cpuHistogram;
+        RollingHistogram gpuHistogram;
+    };
+
+    StageData stages[numStages];
+    RollingHistogram frameCpuHistogram;
+    RollingHistogram frameGpuHistogram;
+
+    int64_t frameStartTicks = 0;
+    double lastCpuFrameMs = 0.0;
+    double lastGpuFrameMs = 0.0;
+    long long frameCount = 0;
+
+    mutable std::mutex lock;
+
+    static double ticksToMs(int64_t ticks);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FrameProfiler)
+};
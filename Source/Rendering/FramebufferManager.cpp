@@ -2,7 +2,8 @@
 
 using namespace juce::gl;
 
-FramebufferManager::FramebufferManager()
+FramebufferManager::FramebufferManager(RenderTargetPool& p)
+    : pool(p)
 {
 }
 
@@ -16,16 +17,21 @@ bool FramebufferManager::initialize(int w, int h)
     if (initialized)
         cleanup();
 
-    width = w;
-    height = h;
+    // Acquire both framebuffers
+    if (!acquireTargets(w, h))
+        return false;
 
-    // Create both framebuffers
-    if (!createFramebuffer(0) || !createFramebuffer(1))
+    // Pooled targets may hold a previous user's pixels
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    for (auto* target : targets)
     {
-        cleanup();
-        return false;
+        glBindFramebuffer(GL_FRAMEBUFFER, target->fbo);
+        glClear(GL_COLOR_BUFFER_BIT);
     }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
+    width = w;
+    height = h;
     initialized = true;
     currentIndex = 0;
 
@@ -37,8 +43,7 @@ void FramebufferManager::cleanup()
     if (!initialized)
         return;
 
-    deleteFramebuffer(0);
-    deleteFramebuffer(1);
+    releaseTargets();
 
     initialized = false;
 }
@@ -48,7 +53,51 @@ void FramebufferManager::resize(int w, int h)
     if (w == width && h == height)
         return;
 
-    initialize(w, h);
+    if (!initialized)
+    {
+        initialize(w, h);
+        return;
+    }
+
+    RenderTarget* oldTargets[2] = {targets[0], targets[1]};
+    int oldReadIndex = 1 - currentIndex;
+
+    if (!acquireTargets(w, h))
+    {
+        // Keep the old buffers rather than losing the feedback loop
+        targets[0] = oldTargets[0];
+        targets[1] = oldTargets[1];
+        return;
+    }
+
+    // Carry the last frame over so trails survive the resize
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, oldTargets[oldReadIndex]->fbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, targets[oldReadIndex]->fbo);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, w, h, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // Return the old buffers to the pool for reuse
+    pool.release(oldTargets[0]);
+    pool.release(oldTargets[1]);
+
+    width = w;
+    height = h;
+}
+
+void FramebufferManager::setFormat(RenderTargetFormat newFormat)
+{
+    if (newFormat == format)
+        return;
+
+    format = newFormat;
+
+    if (initialized)
+        initialize(width, height);
+}
+
+RenderTargetFormat FramebufferManager::getActualFormat() const
+{
+    return targets[0] != nullptr ? targets[0]->format : format;
 }
 
 void FramebufferManager::swap()
@@ -61,7 +110,7 @@ void FramebufferManager::bindWriteFramebuffer()
     if (!initialized)
         return;
 
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo[currentIndex]);
+    glBindFramebuffer(GL_FRAMEBUFFER, targets[currentIndex]->fbo);
 }
 
 void FramebufferManager::bindReadTexture(int textureUnit)
@@ -71,7 +120,7 @@ void FramebufferManager::bindReadTexture(int textureUnit)
 
     int readIndex = 1 - currentIndex;
     glActiveTexture(GL_TEXTURE0 + textureUnit);
-    glBindTexture(GL_TEXTURE_2D, texture[readIndex]);
+    glBindTexture(GL_TEXTURE_2D, targets[readIndex]->texture);
 }
 
 void FramebufferManager::unbindFramebuffer()
@@ -81,62 +130,42 @@ void FramebufferManager::unbindFramebuffer()
 
 unsigned int FramebufferManager::getWriteTextureId() const
 {
-    return texture[currentIndex];
+    return initialized ? targets[currentIndex]->texture : 0;
 }
 
 unsigned int FramebufferManager::getReadTextureId() const
 {
-    return texture[1 - currentIndex];
+    return initialized ? targets[1 - currentIndex]->texture : 0;
 }
 
-bool FramebufferManager::createFramebuffer(int index)
+unsigned int FramebufferManager::getWriteFramebufferId() const
 {
-    // Create texture
-    glGenTextures(1, &texture[index]);
-    glBindTexture(GL_TEXTURE_2D, texture[index]);
-
-    // Allocate texture storage
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0,
-                 GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-
-    // Set texture parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-    // Create framebuffer
-    glGenFramebuffers(1, &fbo[index]);
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo[index]);
+    return initialized ? targets[currentIndex]->fbo : 0;
+}
 
-    // Attach texture to framebuffer
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
-                          GL_TEXTURE_2D, texture[index], 0);
+bool FramebufferManager::acquireTargets(int w, int h)
+{
+    RenderTarget* a = pool.acquire(format, w, h);
+    RenderTarget* b = pool.acquire(format, w, h);
 
-    // Check framebuffer completeness
-    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
-    if (status != GL_FRAMEBUFFER_COMPLETE)
+    if (a == nullptr || b == nullptr)
     {
-        DBG("FlarkViz: Framebuffer " << index << " not complete: " << status);
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        DBG("FlarkViz: Failed to acquire " << w << "x" << h << " feedback buffers");
+        pool.release(a);
+        pool.release(b);
         return false;
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    targets[0] = a;
+    targets[1] = b;
     return true;
 }
 
-void FramebufferManager::deleteFramebuffer(int index)
+void FramebufferManager::releaseTargets()
 {
-    if (fbo[index] != 0)
-    {
-        glDeleteFramebuffers(1, &fbo[index]);
-        fbo[index] = 0;
-    }
+    pool.release(targets[0]);
+    pool.release(targets[1]);
 
-    if (texture[index] != 0)
-    {
-        glDeleteTextures(1, &texture[index]);
-        texture[index] = 0;
-    }
+    targets[0] = nullptr;
+    targets[1] = nullptr;
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "RenderTargetPool.h"
 
 /**
  * @class FramebufferManager
@@ -9,11 +10,14 @@
  * MilkDrop uses texture feedback where the previous frame's output
  * becomes the next frame's input. This requires alternating between
  * two framebuffers (ping-pong technique).
+ *
+ * Both buffers are borrowed from a RenderTargetPool, so resizing back to a
+ * previously used size reuses the existing GPU allocations.
  */
 class FramebufferManager
 {
 public:
-    FramebufferManager();
+    explicit FramebufferManager(RenderTargetPool& pool);
     ~FramebufferManager();
 
     /**
@@ -27,10 +31,27 @@ public:
     void cleanup();
 
     /**
-     * @brief Resize framebuffers
+     * @brief Resize framebuffers, preserving the current feedback image
      */
     void resize(int width, int height);
 
+    /**
+     * @brief Set the colour format of the feedback buffers
+     *
+     * Takes effect immediately if already initialized.
+     */
+    void setFormat(RenderTargetFormat newFormat);
+
+    /**
+     * @brief Get the requested feedback format
+     */
+    RenderTargetFormat getFormat() const { return format; }
+
+    /**
+     * @brief Get the format actually allocated (may have fallen back to RGBA8)
+     */
+    RenderTargetFormat getActualFormat() const;
+
     /**
      * @brief Swap ping and pong buffers
      */
@@ -61,6 +82,11 @@ public:
      */
     unsigned int getReadTextureId() const;
 
+    /**
+     * @brief Get current write framebuffer ID
+     */
+    unsigned int getWriteFramebufferId() const;
+
     /**
      * @brief Check if initialized
      */
@@ -73,20 +99,22 @@ public:
     int getHeight() const { return height; }
 
 private:
+    RenderTargetPool& pool;
+    RenderTargetFormat format = RenderTargetFormat::RGBA16F;
+
     bool initialized = false;
     int width = 0;
     int height = 0;
 
-    // Ping-pong framebuffers
-    unsigned int fbo[2] = {0, 0};
-    unsigned int texture[2] = {0, 0};
+    // Ping-pong render targets (owned by the pool)
+    RenderTarget* targets[2] = {nullptr, nullptr};
 
     // Current buffer index (0 or 1)
     int currentIndex = 0;
 
     // Helper functions
-    bool createFramebuffer(int index);
-    void deleteFramebuffer(int index);
+    bool acquireTargets(int w, int h);
+    void releaseTargets();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FramebufferManager)
 };
@@ -0,0 +1,220 @@
+#include "GLStateCache.h"
+#include <limits>
+
+using namespace juce::gl;
+
+GLStateCache::GLStateCache()
+{
+    invalidate();
+}
+
+void GLStateCache::invalidate()
+{
+    program = unknown;
+    vertexArray = unknown;
+    framebuffer = unknown;
+    activeUnit = -1;
+
+    for (int i = 0; i < maxTextureUnits; ++i)
+    {
+        textures2D[i] = unknown;
+        textures3D[i] = unknown;
+    }
+
+    blendEnabled = -1;
+    blendSource = unknown;
+    blendDestination = unknown;
+
+    for (auto& v : viewport)
+        v = -1;
+
+    // NaN never compares equal, so the first glClearColor always goes through
+    for (auto& c : clearValue)
+        c = std::numeric_limits<float>::quiet_NaN();
+}
+
+void GLStateCache::beginFrame()
+{
+    lastIssued = frame.issued;
+    lastSkipped = frame.skipped;
+    lastDraws = frame.draws;
+    lastClears = frame.clears;
+
+    frame = {};
+    invalidate();
+}
+
+GLStateCache::Stats GLStateCache::getLastFrameStats() const
+{
+    Stats stats;
+    stats.issued = lastIssued.load();
+    stats.skipped = lastSkipped.load();
+    stats.draws = lastDraws.load();
+    stats.clears = lastClears.load();
+    return stats;
+}
+
+//==============================================================================
+void GLStateCache::useProgram(GLuint newProgram)
+{
+    if (newProgram == program)
+    {
+        ++frame.skipped;
+        return;
+    }
+
+    glUseProgram(newProgram);
+    program = newProgram;
+    ++frame.issued;
+}
+
+void GLStateCache::bindVertexArray(GLuint vao)
+{
+    if (vao == vertexArray)
+    {
+        ++frame.skipped;
+        return;
+    }
+
+    glBindVertexArray(vao);
+    vertexArray = vao;
+    ++frame.issued;
+}
+
+void GLStateCache::bindFramebuffer(GLuint fbo)
+{
+    if (fbo == framebuffer)
+    {
+        ++frame.skipped;
+        return;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    framebuffer = fbo;
+    ++frame.issued;
+}
+
+void GLStateCache::activeTexture(int unit)
+{
+    if (unit == activeUnit)
+    {
+        ++frame.skipped;
+        return;
+    }
+
+    glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(unit));
+    activeUnit = unit;
+    ++frame.issued;
+}
+
+void GLStateCache::bindTexture(int unit, GLenum target, GLuint texture)
+{
+    jassert(unit >= 0 && unit < maxTextureUnits);
+    jassert(target == GL_TEXTURE_2D || target == GL_TEXTURE_3D);
+
+    auto& bound = (target == GL_TEXTURE_3D ? textures3D : textures2D)[unit];
+    if (texture == bound)
+    {
+        ++frame.skipped;
+        return;
+    }
+
+    activeTexture(unit);
+    glBindTexture(target, texture);
+    bound = texture;
+    ++frame.issued;
+}
+
+void GLStateCache::setBlendEnabled(bool enabled)
+{
+    if ((enabled ? 1 : 0) == blendEnabled)
+    {
+        ++frame.skipped;
+        return;
+    }
+
+    if (enabled)
+        glEnable(GL_BLEND);
+    else
+        glDisable(GL_BLEND);
+
+    blendEnabled = enabled ? 1 : 0;
+    ++frame.issued;
+}
+
+void GLStateCache::setBlendFunc(GLenum source, GLenum destination)
+{
+    if (source == blendSource && destination == blendDestination)
+    {
+        ++frame.skipped;
+        return;
+    }
+
+    glBlendFunc(source, destination);
+    blendSource = source;
+    blendDestination = destination;
+    ++frame.issued;
+}
+
+void GLStateCache::setViewport(int x, int y, int width, int height)
+{
+    if (x == viewport[0] && y == viewport[1] && width == viewport[2] && height == viewport[3])
+    {
+        ++frame.skipped;
+        return;
+    }
+
+    glViewport(x, y, width, height);
+    viewport[0] = x;
+    viewport[1] = y;
+    viewport[2] = width;
+    viewport[3] = height;
+    ++frame.issued;
+}
+
+//==============================================================================
+void GLStateCache::clear(float r, float g, float b, float a)
+{
+    if (r != clearValue[0] || g != clearValue[1] || b != clearValue[2] || a != clearValue[3])
+    {
+        glClearColor(r, g, b, a);
+        clearValue[0] = r;
+        clearValue[1] = g;
+        clearValue[2] = b;
+        clearValue[3] = a;
+        ++frame.issued;
+    }
+    else
+    {
+        ++frame.skipped;
+    }
+
+    glClear(GL_COLOR_BUFFER_BIT);
+    ++frame.issued;
+    ++frame.clears;
+}
+
+void GLStateCache::drawArrays(GLenum mode, int first, int count)
+{
+    glDrawArrays(mode, first, count);
+    ++frame.issued;
+    ++frame.draws;
+}
+
+void GLStateCache::uniform1f(GLint location, float value)
+{
+    glUniform1f(location, value);
+    ++frame.issued;
+}
+
+void GLStateCache::uniform1i(GLint location, int value)
+{
+    glUniform1i(location, value);
+    ++frame.issued;
+}
+
+void GLStateCache::uniform2f(GLint location, float x, float y)
+{
+    glUniform2f(location, x, y);
+    ++frame.issued;
+}
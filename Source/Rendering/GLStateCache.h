@@ -0,0 +1,93 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+/**
+ * @class GLStateCache
+ * @brief Shadows the GL state the render loop touches and drops redundant calls
+ *
+ * Tracks the bound program, vertex array, draw framebuffer, active texture
+ * unit, per-unit 2D/3D textures, blending, blend function, viewport and
+ * clear colour. Setting a value the cache already holds is skipped.
+ *
+ * The cache only knows about calls made through it. Code that changes the
+ * same state directly (JUCE's component painting between frames, pool
+ * allocations, texture uploads) must be followed by invalidate(), after
+ * which the next call of each kind goes through unconditionally.
+ *
+ * Every call is counted per frame - issued, skipped, draws and clears -
+ * so the effect is visible in the profiler overlay. Render thread only,
+ * except getLastFrameStats().
+ */
+class GLStateCache
+{
+public:
+    static constexpr int maxTextureUnits = 16;
+
+    struct Stats
+    {
+        int issued = 0;     // GL calls made (state changes, uniforms, draws, clears)
+        int skipped = 0;    // State changes dropped as redundant
+        int draws = 0;
+        int clears = 0;
+    };
+
+    GLStateCache();
+
+    /** Forget everything; the next call of each kind is issued */
+    void invalidate();
+
+    /** Publish the finished frame's counters and start a new frame (also invalidates) */
+    void beginFrame();
+
+    /** Counters of the last finished frame; safe from any thread */
+    Stats getLastFrameStats() const;
+
+    //==========================================================================
+    // State
+    void useProgram(GLuint program);
+    void bindVertexArray(GLuint vao);
+    void bindFramebuffer(GLuint fbo);
+    void bindTexture(int unit, GLenum target, GLuint texture);
+    void setBlendEnabled(bool enabled);
+    void setBlendFunc(GLenum source, GLenum destination);
+    void setViewport(int x, int y, int width, int height);
+
+    //==========================================================================
+    // Commands (always issued, only counted)
+
+    /** Clear the colour buffer of the bound framebuffer */
+    void clear(float r, float g, float b, float a);
+    void drawArrays(GLenum mode, int first, int count);
+
+    void uniform1f(GLint location, float value);
+    void uniform1i(GLint location, int value);
+    void uniform2f(GLint location, float x, float y);
+
+private:
+    // Sentinel for "unknown": no real object name or enum has this value
+    static constexpr GLuint unknown = 0xffffffffu;
+
+    void activeTexture(int unit);
+
+    GLuint program = unknown;
+    GLuint vertexArray = unknown;
+    GLuint framebuffer = unknown;
+    int activeUnit = -1;
+    GLuint textures2D[maxTextureUnits];
+    GLuint textures3D[maxTextureUnits];
+    int blendEnabled = -1;
+    GLenum blendSource = unknown;
+    GLenum blendDestination = unknown;
+    int viewport[4] = { -1, -1, -1, -1 };
+    float clearValue[4] = { -1.0f, -1.0f, -1.0f, -1.0f };
+
+    Stats frame;
+    std::atomic<int> lastIssued { 0 };
+    std::atomic<int> lastSkipped { 0 };
+    std::atomic<int> lastDraws { 0 };
+    std::atomic<int> lastClears { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GLStateCache)
+};
@@ -0,0 +1,105 @@
+#include "GpuTimer.h"
+
+using namespace juce::gl;
+
+GpuTimer::GpuTimer()
+{
+}
+
+GpuTimer::~GpuTimer()
+{
+    cleanup();
+}
+
+bool GpuTimer::initialize()
+{
+    if (initialized)
+        return true;
+
+    glGenQueries(numQueries, queries);
+
+    for (int i = 0; i < numQueries; ++i)
+    {
+        if (queries[i] == 0)
+        {
+            DBG("FlarkViz: GL timer queries unavailable");
+            cleanup();
+            return false;
+        }
+        pending[i] = false;
+    }
+
+    writeIndex = 0;
+    readIndex = 0;
+    initialized = true;
+    return true;
+}
+
+void GpuTimer::cleanup()
+{
+    if (queries[0] != 0)
+        glDeleteQueries(numQueries, queries);
+
+    for (int i = 0; i < numQueries; ++i)
+    {
+        queries[i] = 0;
+        pending[i] = false;
+    }
+
+    initialized = false;
+    active = false;
+    resultAvailable = false;
+}
+
+void GpuTimer::begin()
+{
+    if (!initialized || active)
+        return;
+
+    // Ring full: drop this sample instead of waiting on the GPU
+    if (pending[writeIndex])
+        return;
+
+    glBeginQuery(GL_TIME_ELAPSED, queries[writeIndex]);
+    active = true;
+}
+
+void GpuTimer::end()
+{
+    if (!active)
+        return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    pending[writeIndex] = true;
+    writeIndex = (writeIndex + 1) % numQueries;
+    active = false;
+}
+
+bool GpuTimer::poll()
+{
+    if (!initialized)
+        return false;
+
+    bool collected = false;
+
+    // Queries complete in submission order, so stop at the first busy one
+    while (pending[readIndex])
+    {
+        GLint available = 0;
+        glGetQueryObjectiv(queries[readIndex], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            break;
+
+        GLuint64 elapsedNs = 0;
+        glGetQueryObjectui64v(queries[readIndex], GL_QUERY_RESULT, &elapsedNs);
+
+        lastMs = static_cast<double>(elapsedNs) / 1.0e6;
+        resultAvailable = true;
+        collected = true;
+
+        pending[readIndex] = false;
+        readIndex = (readIndex + 1) % numQueries;
+    }
+
+    return collected;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * @class GpuTimer
+ * @brief Non-blocking GPU timing using a ring of GL_TIME_ELAPSED queries
+ *
+ * Results become available a few frames after they are recorded. poll()
+ * only reads queries the driver reports as finished, so timing never
+ * stalls the pipeline. If every query in the ring is still in flight,
+ * the next begin()/end() pair is skipped rather than waited on.
+ */
+class GpuTimer
+{
+public:
+    GpuTimer();
+    ~GpuTimer();
+
+    /**
+     * @brief Create query objects (requires an active GL context)
+     */
+    bool initialize();
+
+    /**
+     * @brief Delete query objects
+     */
+    void cleanup();
+
+    /**
+     * @brief Start timing GPU work
+     */
+    void begin();
+
+    /**
+     * @brief Stop timing GPU work
+     */
+    void end();
+
+    /**
+     * @brief Collect any finished queries without blocking
+     * @return true if at least one new result was collected
+     */
+    bool poll();
+
+    /**
+     * @brief Most recent completed measurement in milliseconds
+     */
+    double getLastMs() const { return lastMs; }
+
+    /**
+     * @brief Check whether any measurement has completed yet
+     */
+    bool hasResult() const { return resultAvailable; }
+
+    bool isInitialized() const { return initialized; }
+
+private:
+    static constexpr int numQueries = 4;
+
+    unsigned int queries[numQueries] = {0, 0, 0, 0};
+    bool pending[numQueries] = {false, false, false, false};
+
+    int writeIndex = 0;
+    int readIndex = 0;
+
+    bool initialized = false;
+    bool active = false;
+    bool resultAvailable = false;
+    double lastMs = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GpuTimer)
+};
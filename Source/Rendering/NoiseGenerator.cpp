@@ -0,0 +1,257 @@
+#include "NoiseGenerator.h"
+#include "../Core/CpuFeatures.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // Same sizes and zoom factors as MilkDrop 2
+    const NoiseGenerator::Spec specs[NoiseGenerator::numTextures] = {
+        { "sampler_noise_lq_lite",  32, false, 1 },
+        { "sampler_noise_lq",      256, false, 1 },
+        { "sampler_noise_mq",      256, false, 4 },
+        { "sampler_noise_hq",      256, false, 8 },
+        { "sampler_noisevol_lq",    32, true,  1 },
+        { "sampler_noisevol_hq",    32, true,  4 }
+    };
+
+    inline uint32_t hash32(uint32_t x)
+    {
+        x ^= x >> 16;
+        x *= 0x7feb352du;
+        x ^= x >> 15;
+        x *= 0x846ca68bu;
+        x ^= x >> 16;
+        return x;
+    }
+
+    inline uint32_t channelSeed(int id, int channel)
+    {
+        return hash32(0x464c524bu + static_cast<uint32_t>(id * 4 + channel) * 0x9e3779b9u);
+    }
+
+    // Catmull-Rom weights for fractional position t
+    inline void cubicWeights(float t, float w[4])
+    {
+        float t2 = t * t;
+        float t3 = t2 * t;
+        w[0] = 0.5f * (-t3 + 2.0f * t2 - t);
+        w[1] = 0.5f * (3.0f * t3 - 5.0f * t2 + 2.0f);
+        w[2] = 0.5f * (-3.0f * t3 + 4.0f * t2 + t);
+        w[3] = 0.5f * (t3 - t2);
+    }
+
+    inline uint8_t toByte(float v)
+    {
+        return static_cast<uint8_t>(std::clamp(v * 255.0f + 0.5f, 0.0f, 255.0f));
+    }
+}
+
+const NoiseGenerator::Spec& NoiseGenerator::getSpec(int id)
+{
+    return specs[id];
+}
+
+size_t NoiseGenerator::getByteSize(int id)
+{
+    const auto& spec = specs[id];
+    size_t texels = static_cast<size_t>(spec.size) * static_cast<size_t>(spec.size);
+    if (spec.volume)
+        texels *= static_cast<size_t>(spec.size);
+    return texels * 4;
+}
+
+size_t NoiseGenerator::getTotalByteSize()
+{
+    size_t total = 0;
+    for (int id = 0; id < numTextures; ++id)
+        total += getByteSize(id);
+    return total;
+}
+
+int NoiseGenerator::getNumSlices(int id)
+{
+    return specs[id].size;
+}
+
+#if FLARKVIZ_AVX2_DISPATCH
+namespace
+{
+    // 8 hashes per iteration; returns how many were written
+    FLARKVIZ_TARGET_AVX2 int hashRowAVX2(uint32_t seed, uint32_t firstIndex, int count, uint32_t* out)
+    {
+        const __m256i vseed = _mm256_set1_epi32(static_cast<int>(seed));
+        const __m256i m1 = _mm256_set1_epi32(0x7feb352d);
+        const __m256i m2 = _mm256_set1_epi32(static_cast<int>(0x846ca68bu));
+        const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+        int i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256i x = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(firstIndex + i)), lanes);
+            x = _mm256_xor_si256(x, vseed);
+            x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+            x = _mm256_mullo_epi32(x, m1);
+            x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 15));
+            x = _mm256_mullo_epi32(x, m2);
+            x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), x);
+        }
+        return i;
+    }
+}
+#endif
+
+bool NoiseGenerator::isAccelerated()
+{
+    return CpuFeatures::hasAVX2();
+}
+
+void NoiseGenerator::hashRow(uint32_t seed, uint32_t firstIndex, int count, uint32_t* out)
+{
+    int i = 0;
+
+#if FLARKVIZ_AVX2_DISPATCH
+    if (CpuFeatures::hasAVX2())
+        i = hashRowAVX2(seed, firstIndex, count, out);
+#endif
+
+    for (; i < count; ++i)
+        out[i] = hash32((firstIndex + static_cast<uint32_t>(i)) ^ seed);
+}
+
+void NoiseGenerator::generateSlice(int id, int slice, uint8_t* dest)
+{
+    const auto& spec = specs[id];
+    const int size = spec.size;
+    const int zoom = spec.zoom;
+    const int lattice = size / zoom;           // Lattice points per axis
+    const size_t rowBytes = static_cast<size_t>(size) * 4;
+
+    std::vector<uint32_t> hashes(static_cast<size_t>(std::max(size, lattice)));
+    std::vector<float> latticeRow(static_cast<size_t>(lattice));
+    std::vector<float> accum(static_cast<size_t>(size));
+
+    // Per-x lattice taps and weights are the same for every row
+    std::vector<int> tapIndex(static_cast<size_t>(size) * 4);
+    std::vector<float> tapWeight(static_cast<size_t>(size) * 4);
+    for (int x = 0; x < size; ++x)
+    {
+        float w[4];
+        cubicWeights(static_cast<float>(x % zoom) / static_cast<float>(zoom), w);
+        for (int k = 0; k < 4; ++k)
+        {
+            tapIndex[static_cast<size_t>(x * 4 + k)] = (x / zoom + k - 1 + lattice) % lattice;
+            tapWeight[static_cast<size_t>(x * 4 + k)] = w[k];
+        }
+    }
+
+    // Each work unit is one row (2D) or one z-slice (volume)
+    const int numRows = spec.volume ? size : 1;
+    const int z = spec.volume ? slice : 0;
+
+    for (int rowIndex = 0; rowIndex < numRows; ++rowIndex)
+    {
+        const int y = spec.volume ? rowIndex : slice;
+        uint8_t* out = dest + (static_cast<size_t>(z) * static_cast<size_t>(size) + static_cast<size_t>(y)) * rowBytes;
+
+        for (int channel = 0; channel < 4; ++channel)
+        {
+            const uint32_t seed = channelSeed(id, channel);
+
+            if (zoom == 1)
+            {
+                // White noise: hash the texels directly
+                uint32_t first = static_cast<uint32_t>((z * size + y) * size);
+                hashRow(seed, first, size, hashes.data());
+
+                for (int x = 0; x < size; ++x)
+                    out[x * 4 + channel] = static_cast<uint8_t>(hashes[static_cast<size_t>(x)] >> 24);
+                continue;
+            }
+
+            // Smooth noise: cubic interpolation of a random lattice, done
+            // separably (x, then y, then z) with wrap-around for tiling
+            float wy[4], wz[4];
+            cubicWeights(static_cast<float>(y % zoom) / static_cast<float>(zoom), wy);
+            cubicWeights(static_cast<float>(z % zoom) / static_cast<float>(zoom), wz);
+
+            const int ly = y / zoom;
+            const int lz = z / zoom;
+            const int zTaps = spec.volume ? 4 : 1;
+
+            std::fill(accum.begin(), accum.end(), 0.0f);
+
+            for (int kz = 0; kz < zTaps; ++kz)
+            {
+                const int latZ = spec.volume ? (lz + kz - 1 + lattice) % lattice : 0;
+                const float weightZ = spec.volume ? wz[kz] : 1.0f;
+
+                for (int ky = 0; ky < 4; ++ky)
+                {
+                    const int latY = (ly + ky - 1 + lattice) % lattice;
+                    const uint32_t first = static_cast<uint32_t>((latZ * lattice + latY) * lattice);
+                    hashRow(seed, first, lattice, hashes.data());
+
+                    for (int i = 0; i < lattice; ++i)
+                        latticeRow[static_cast<size_t>(i)] = static_cast<float>(hashes[static_cast<size_t>(i)] >> 8) * (1.0f / 16777216.0f);
+
+                    // Interpolate this lattice row along x and accumulate
+                    const float weight = wy[ky] * weightZ;
+                    for (int x = 0; x < size; ++x)
+                    {
+                        const int* idx = &tapIndex[static_cast<size_t>(x * 4)];
+                        const float* w = &tapWeight[static_cast<size_t>(x * 4)];
+                        float v = w[0] * latticeRow[static_cast<size_t>(idx[0])]
+                                + w[1] * latticeRow[static_cast<size_t>(idx[1])]
+                                + w[2] * latticeRow[static_cast<size_t>(idx[2])]
+                                + w[3] * latticeRow[static_cast<size_t>(idx[3])];
+                        accum[static_cast<size_t>(x)] += v * weight;
+                    }
+                }
+            }
+
+            for (int x = 0; x < size; ++x)
+                out[x * 4 + channel] = toByte(accum[static_cast<size_t>(x)]);
+        }
+    }
+}
+
+void NoiseGenerator::generateAll(uint8_t* dest, int numThreads)
+{
+    // Flatten (texture, slice) pairs into one work list
+    struct WorkItem { int id; int slice; uint8_t* base; };
+    std::vector<WorkItem> work;
+
+    uint8_t* base = dest;
+    for (int id = 0; id < numTextures; ++id)
+    {
+        for (int slice = 0; slice < getNumSlices(id); ++slice)
+            work.push_back({ id, slice, base });
+        base += getByteSize(id);
+    }
+
+    if (numThreads <= 0)
+        numThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    numThreads = std::min(numThreads, static_cast<int>(work.size()));
+
+    std::atomic<size_t> nextItem {0};
+    auto worker = [&]()
+    {
+        for (size_t i = nextItem++; i < work.size(); i = nextItem++)
+            generateSlice(work[i].id, work[i].slice, work[i].base);
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < numThreads; ++t)
+        threads.emplace_back(worker);
+
+    worker();
+
+    for (auto& thread : threads)
+        thread.join();
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class NoiseGenerator
+ * @brief Deterministic generator for MilkDrop 2's noise textures
+ *
+ * MilkDrop 2 shaders sample a fixed set of random textures: white noise
+ * (noise_lq, noise_lq_lite, noisevol_lq) and smoothed versions made by
+ * cubic interpolation of a coarser random lattice (noise_mq, noise_hq,
+ * noisevol_hq). All textures tile.
+ *
+ * Every texel is a pure function of (texture, position, channel), computed
+ * from an integer hash, so output is identical no matter how the work is
+ * split across threads. Rows are hashed in batches with an AVX2 kernel
+ * when the CPU supports it (checked at runtime, see CpuFeatures.h).
+ */
+class NoiseGenerator
+{
+public:
+    enum TextureId
+    {
+        NoiseLQLite = 0,
+        NoiseLQ,
+        NoiseMQ,
+        NoiseHQ,
+        NoiseVolLQ,
+        NoiseVolHQ,
+        numTextures
+    };
+
+    struct Spec
+    {
+        const char* samplerName;   // Name used in MilkDrop shaders
+        int size;                  // Width = height (= depth for volumes)
+        bool volume;
+        int zoom;                  // Lattice spacing in texels (1 = white noise)
+    };
+
+    static const Spec& getSpec(int id);
+
+    /**
+     * @brief Bytes needed for a texture (RGBA8)
+     */
+    static size_t getByteSize(int id);
+
+    /**
+     * @brief Total bytes for all textures
+     */
+    static size_t getTotalByteSize();
+
+    /**
+     * @brief Number of independent work units (rows, or slices for volumes)
+     */
+    static int getNumSlices(int id);
+
+    /**
+     * @brief Generate one slice of a texture
+     * @param id Texture to generate
+     * @param slice Row (2D) or z-slice (volume) index
+     * @param dest Start of the whole texture's RGBA8 buffer
+     */
+    static void generateSlice(int id, int slice, uint8_t* dest);
+
+    /**
+     * @brief Generate all textures using worker threads
+     * @param dest Buffer of getTotalByteSize() bytes, textures in id order
+     * @param numThreads Worker count (0 = hardware concurrency)
+     */
+    static void generateAll(uint8_t* dest, int numThreads = 0);
+
+    /**
+     * @brief Bump when the generated data changes so caches are rebuilt
+     */
+    static constexpr uint32_t version = 1;
+
+    /**
+     * @brief Whether rows are hashed with the AVX2 kernel on this CPU
+     */
+    static bool isAccelerated();
+
+private:
+    static void hashRow(uint32_t seed, uint32_t firstIndex, int count, uint32_t* out);
+};
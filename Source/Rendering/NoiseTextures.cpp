@@ -0,0 +1,188 @@
+#include "NoiseTextures.h"
+#include <cstring>
+
+using namespace juce::gl;
+
+namespace
+{
+    const char cacheMagic[8] = { 'F', 'V', 'N', 'O', 'I', 'S', 'E', '\0' };
+}
+
+NoiseTextures::NoiseTextures()
+{
+}
+
+NoiseTextures::~NoiseTextures()
+{
+    waitUntilReady();
+}
+
+juce::File NoiseTextures::getDefaultCacheFile()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+             .getChildFile("FlarkViz/cache/noise-textures.bin");
+}
+
+void NoiseTextures::prepare(const juce::File& cacheFile)
+{
+    if (loaderThread.joinable() || ready)
+        return;
+
+    loaderThread = std::thread([this, cacheFile] { load(cacheFile); });
+}
+
+void NoiseTextures::waitUntilReady()
+{
+    if (loaderThread.joinable())
+        loaderThread.join();
+}
+
+void NoiseTextures::load(const juce::File& cacheFile)
+{
+    auto startTicks = juce::Time::getHighResolutionTicks();
+
+    if (mapCache(cacheFile))
+    {
+        loadedFromCache = true;
+    }
+    else
+    {
+        generatedData.resize(NoiseGenerator::getTotalByteSize());
+        NoiseGenerator::generateAll(generatedData.data());
+        texelData = generatedData.data();
+
+        writeCache(cacheFile);
+    }
+
+    creationTimeMs = juce::Time::highResolutionTicksToSeconds(
+        juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+
+    DBG("FlarkViz: Noise textures " << (loadedFromCache ? "mapped from cache" : "generated")
+        << " in " << creationTimeMs << " ms");
+
+    ready = true;
+}
+
+bool NoiseTextures::mapCache(const juce::File& cacheFile)
+{
+    if (!cacheFile.existsAsFile())
+        return false;
+
+    auto mapping = std::make_unique<juce::MemoryMappedFile>(cacheFile, juce::MemoryMappedFile::readOnly);
+    if (mapping->getData() == nullptr || mapping->getSize() < sizeof(CacheHeader))
+        return false;
+
+    CacheHeader header;
+    std::memcpy(&header, mapping->getData(), sizeof(header));
+
+    const uint64_t expectedSize = NoiseGenerator::getTotalByteSize();
+    if (std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0
+        || header.version != NoiseGenerator::version
+        || header.numTextures != static_cast<uint32_t>(NoiseGenerator::numTextures)
+        || header.dataSize != expectedSize
+        || mapping->getSize() < sizeof(CacheHeader) + expectedSize)
+    {
+        DBG("FlarkViz: Ignoring stale noise texture cache");
+        return false;
+    }
+
+    texelData = static_cast<const uint8_t*>(mapping->getData()) + sizeof(CacheHeader);
+    mappedCache = std::move(mapping);
+    return true;
+}
+
+void NoiseTextures::writeCache(const juce::File& cacheFile)
+{
+    cacheFile.getParentDirectory().createDirectory();
+
+    CacheHeader header;
+    std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version = NoiseGenerator::version;
+    header.numTextures = static_cast<uint32_t>(NoiseGenerator::numTextures);
+    header.dataSize = generatedData.size();
+
+    // Write beside the target and swap in, so a crash never leaves a torn cache
+    juce::TemporaryFile temp(cacheFile);
+    {
+        juce::FileOutputStream out(temp.getFile());
+        if (!out.openedOk())
+            return;
+
+        out.write(&header, sizeof(header));
+        out.write(generatedData.data(), generatedData.size());
+        out.flush();
+
+        if (out.getStatus().failed())
+            return;
+    }
+
+    if (!temp.overwriteTargetFileWithTemporary())
+        DBG("FlarkViz: Could not write noise texture cache " << cacheFile.getFullPathName());
+}
+
+bool NoiseTextures::uploadGL()
+{
+    if (uploaded)
+        return true;
+
+    if (!ready)
+        return false;
+
+    // The loader has finished; reap the thread
+    waitUntilReady();
+
+    auto startTicks = juce::Time::getHighResolutionTicks();
+
+    const uint8_t* data = texelData;
+    glGenTextures(NoiseGenerator::numTextures, textures);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (int id = 0; id < NoiseGenerator::numTextures; ++id)
+    {
+        const auto& spec = NoiseGenerator::getSpec(id);
+        GLenum target = spec.volume ? GL_TEXTURE_3D : GL_TEXTURE_2D;
+
+        glBindTexture(target, textures[id]);
+
+        if (spec.volume)
+            glTexImage3D(target, 0, GL_RGBA8, spec.size, spec.size, spec.size, 0,
+                         GL_RGBA, GL_UNSIGNED_BYTE, data);
+        else
+            glTexImage2D(target, 0, GL_RGBA8, spec.size, spec.size, 0,
+                         GL_RGBA, GL_UNSIGNED_BYTE, data);
+
+        // Noise textures tile, and MilkDrop samples them with bilinear filtering
+        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        if (spec.volume)
+            glTexParameteri(target, GL_TEXTURE_WRAP_R, GL_REPEAT);
+
+        data += NoiseGenerator::getByteSize(id);
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindTexture(GL_TEXTURE_3D, 0);
+
+    uploaded = true;
+
+    DBG("FlarkViz: Noise textures uploaded in "
+        << juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0
+        << " ms");
+
+    return true;
+}
+
+void NoiseTextures::cleanupGL()
+{
+    if (uploaded)
+        glDeleteTextures(NoiseGenerator::numTextures, textures);
+
+    for (auto& texture : textures)
+        texture = 0;
+
+    uploaded = false;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "NoiseGenerator.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/**
+ * @class NoiseTextures
+ * @brief MilkDrop 2 noise textures: generated once, cached on disk, uploaded once
+ *
+ * prepare() starts a background thread that memory-maps the texel cache if
+ * it is present and valid, or otherwise generates the textures in parallel
+ * with NoiseGenerator and writes the cache for next time. uploadGL() is
+ * cheap to call every frame: it does nothing until the data is ready, then
+ * creates the GL textures once for the current context.
+ */
+class NoiseTextures
+{
+public:
+    NoiseTextures();
+    ~NoiseTextures();
+
+    /**
+     * @brief Start loading or generating the texel data in the background
+     * @param cacheFile Where the raw texel cache lives
+     */
+    void prepare(const juce::File& cacheFile);
+
+    /**
+     * @brief Check whether texel data is available for upload
+     */
+    bool isReady() const { return ready.load(); }
+
+    /**
+     * @brief Block until the background work has finished
+     */
+    void waitUntilReady();
+
+    /**
+     * @brief Create GL textures if the data is ready and they don't exist yet
+     * @return true if textures are available on this context
+     */
+    bool uploadGL();
+
+    /**
+     * @brief Delete GL textures (the texel data is kept for the next context)
+     */
+    void cleanupGL();
+
+    /**
+     * @brief GL texture for a NoiseGenerator::TextureId, or 0
+     */
+    unsigned int getTexture(int id) const { return textures[id]; }
+
+    /**
+     * @brief Time spent mapping or generating the texel data
+     */
+    double getCreationTimeMs() const { return creationTimeMs; }
+
+    /**
+     * @brief Whether the data came from the on-disk cache
+     */
+    bool wasLoadedFromCache() const { return loadedFromCache; }
+
+    /**
+     * @brief Default cache location in the user's application data folder
+     */
+    static juce::File getDefaultCacheFile();
+
+private:
+    struct CacheHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t numTextures;
+        uint64_t dataSize;
+    };
+
+    std::thread loaderThread;
+    std::atomic<bool> ready {false};
+
+    // Texel data: either a mapping of the cache file or a heap buffer
+    std::unique_ptr<juce::MemoryMappedFile> mappedCache;
+    std::vector<uint8_t> generatedData;
+    const uint8_t* texelData = nullptr;
+
+    double creationTimeMs = 0.0;
+    bool loadedFromCache = false;
+
+    unsigned int textures[NoiseGenerator::numTextures] = {};
+    bool uploaded = false;
+
+    void load(const juce::File& cacheFile);
+    bool mapCache(const juce::File& cacheFile);
+    void writeCache(const juce::File& cacheFile);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NoiseTextures)
+};
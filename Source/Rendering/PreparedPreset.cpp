@@ -0,0 +1,152 @@
+#include "PreparedPreset.h"
+#include "../Presets/Milk2Loader.h"
+#include "../Presets/PresetPack.h"
+#include "ShaderCompiler.h"
+
+namespace
+{
+    MilkDropPreset parseText(std::string_view text, const juce::File& file)
+    {
+        MilkDropPreset preset;
+
+        if (file.hasFileExtension("milk2"))
+            preset = std::move(Milk2Loader::loadFromBuffer(text).presetA);
+        else
+            preset.loadFromBuffer(text);
+
+        return preset;
+    }
+}
+
+std::unique_ptr<PreparedPreset> PreparedPreset::prepare(MilkDropPreset preset, std::string& error)
+{
+    auto startTicks = juce::Time::getHighResolutionTicks();
+
+    auto prepared = std::make_unique<PreparedPreset>();
+    prepared->perFrameInitEval = std::make_unique<MilkdropEval>();
+    prepared->perFrameEval = std::make_unique<MilkdropEval>();
+    prepared->perPixelEval = std::make_unique<MilkdropEval>();
+
+    // Same blocks RenderState::loadPreset() compiles
+    auto compiles = [&error](MilkdropEval& eval, const std::string& code, const char* block)
+    {
+        if (code.empty() || eval.compileBlock(code))
+            return true;
+
+        error = std::string(block) + ": " + eval.getLastError();
+        return false;
+    };
+
+    if (!compiles(*prepared->perFrameInitEval, preset.perFrameInitCode, "per_frame_init")
+        || !compiles(*prepared->perFrameEval, preset.perFrameCode, "per_frame")
+        || !compiles(*prepared->perPixelEval, preset.perPixelCode, "per_pixel"))
+        return nullptr;
+
+    // HLSL -> GLSL is string work; only the link has to wait for the GL thread
+    ShaderCompiler translator;
+    prepared->warpFragmentSource = translator.translateMilkDropShader(preset.warpShaderCode,
+                                                                      MilkDrop::ShaderType::Warp);
+    prepared->compositeFragmentSource = translator.translateMilkDropShader(preset.compShaderCode,
+                                                                           MilkDrop::ShaderType::Composite);
+
+    prepared->preset = std::move(preset);
+    prepared->prepareMs = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks()
+                                                                   - startTicks) * 1000.0;
+    return prepared;
+}
+
+std::unique_ptr<PreparedPreset> PreparedPreset::loadFromFile(const juce::File& file, std::string& error)
+{
+    auto startTicks = juce::Time::getHighResolutionTicks();
+    MilkDropPreset preset;
+    juce::File packFile;
+    std::string memberName;
+
+    if (PresetPack::splitMemberPath(file, packFile, memberName))
+    {
+        std::string text;
+        if (!PresetPack::readMemberFile(file, text))
+        {
+            error = "could not be read from " + packFile.getFullPathName().toStdString();
+            return nullptr;
+        }
+
+        preset = parseText(text, file);
+    }
+    else if (file.hasFileExtension("milk2"))
+    {
+        preset = std::move(Milk2Loader::loadFromFile(file).presetA);
+    }
+    else if (!preset.loadFromFile(file))
+    {
+        error = "could not be read";
+        return nullptr;
+    }
+
+    auto prepared = prepare(std::move(preset), error);
+    if (prepared == nullptr)
+        return nullptr;
+
+    prepared->path = file.getFullPathName().toStdString();
+    prepared->prepareMs = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks()
+                                                                   - startTicks) * 1000.0;
+    return prepared;
+}
+
+std::unique_ptr<PreparedPreset> PreparedPreset::loadFromPack(const PresetPack& pack, int member,
+                                                             const juce::File& file, std::string& error)
+{
+    auto startTicks = juce::Time::getHighResolutionTicks();
+    std::string storage;
+    std::string_view text;
+
+    if (!pack.readBody(member, storage, text))
+    {
+        error = "could not be read from its pack";
+        return nullptr;
+    }
+
+    auto prepared = prepare(parseText(text, file), error);
+    if (prepared == nullptr)
+        return nullptr;
+
+    prepared->path = file.getFullPathName().toStdString();
+    prepared->prepareMs = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks()
+                                                                   - startTicks) * 1000.0;
+    return prepared;
+}
+
+size_t PreparedPreset::getMemorySize() const
+{
+    auto codeSize = [](const MilkDropPreset::WaveOrShape& item)
+    {
+        return item.initCode.capacity() + item.perFrameCode.capacity() + item.perPointCode.capacity();
+    };
+
+    size_t bytes = sizeof(*this) + path.capacity()
+                 + preset.name.capacity() + preset.author.capacity()
+                 + preset.perFrameInitCode.capacity() + preset.perFrameCode.capacity()
+                 + preset.perPixelCode.capacity()
+                 + preset.warpShaderCode.capacity() + preset.compShaderCode.capacity()
+                 + (preset.waves.capacity() + preset.shapes.capacity()) * sizeof(MilkDropPreset::WaveOrShape)
+                 + preset.variables.size() * (sizeof(std::pair<const std::string, float>) + 4 * sizeof(void*))
+                 + warpFragmentSource.capacity() + compositeFragmentSource.capacity();
+
+    for (const auto& wave : preset.waves)
+        bytes += codeSize(wave);
+
+    for (const auto& shape : preset.shapes)
+        bytes += codeSize(shape);
+
+    for (const auto* eval : { perFrameInitEval.get(), perFrameEval.get(), perPixelEval.get() })
+        if (eval != nullptr)
+            bytes += eval->getMemorySize();
+
+    if (warpShader != nullptr)
+        bytes += warpFragmentSource.size();
+
+    if (compositeShader != nullptr)
+        bytes += compositeFragmentSource.size();
+
+    return bytes;
+}
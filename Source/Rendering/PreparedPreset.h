@@ -0,0 +1,78 @@
+#pragma once
+
+#include "../Expression/MilkdropEval.h"
+#include "../Presets/Preset.h"
+#include "ShaderTypes.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+class PresetPack;
+
+/**
+ * @struct PreparedPreset
+ * @brief A preset with all of its CPU-side loading already done
+ *
+ * Holds the parsed preset, its compiled expression blocks and the
+ * translated GLSL fragment sources. Building one touches no GL state, so
+ * it can happen on any thread; RenderState::loadPrepared() then takes it
+ * over, and switching to it is a pointer swap plus a program lookup in the
+ * renderer's ShaderProgramCache.
+ *
+ * When a preset is replaced, RenderState hands it back with its
+ * evaluators and linked programs, so it can be kept in a
+ * PreparedPresetCache and shown again without any work.
+ */
+struct PreparedPreset
+{
+    std::string path;
+    uint64_t contentHash = 0;   // PresetCatalog::Entry::normalizedHash; 0 if not known
+    MilkDropPreset preset;
+
+    std::unique_ptr<MilkdropEval> perFrameInitEval;
+    std::unique_ptr<MilkdropEval> perFrameEval;
+    std::unique_ptr<MilkdropEval> perPixelEval;
+
+    // Complete fragment shader sources (defaults when the preset has none)
+    std::string warpFragmentSource;
+    std::string compositeFragmentSource;
+
+    // Programs it was last shown with; holding them keeps them in the
+    // program cache (they are looked up again by source when shown)
+    std::shared_ptr<MilkDrop::CompiledShader> warpShader;
+    std::shared_ptr<MilkDrop::CompiledShader> compositeShader;
+
+    double prepareMs = 0.0;
+
+    /**
+     * @brief Approximate memory held by the preset, its bytecode and sources
+     *
+     * Driver-side program memory isn't visible, so linked programs count
+     * as the size of their fragment source.
+     */
+    size_t getMemorySize() const;
+
+    /**
+     * @brief Compile and translate a parsed preset
+     * @param error Set to the failing block when nullptr is returned
+     */
+    static std::unique_ptr<PreparedPreset> prepare(MilkDropPreset preset, std::string& error);
+
+    /**
+     * @brief Load a .milk / .milk2 file, or a member of a preset pack, and prepare it
+     *
+     * Of a .milk2 file only the first preset is prepared, which is what
+     * the renderer shows outside double-preset mode.
+     */
+    static std::unique_ptr<PreparedPreset> loadFromFile(const juce::File& file, std::string& error);
+
+    /**
+     * @brief Prepare a pack member by its record index in an open pack
+     * @param file The member's library path, which the preset is known by
+     *
+     * What the catalog's entries use; loadFromFile() has to map the pack
+     * and look the member up by name first.
+     */
+    static std::unique_ptr<PreparedPreset> loadFromPack(const PresetPack& pack, int member,
+                                                        const juce::File& file, std::string& error);
+};
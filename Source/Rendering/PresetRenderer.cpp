@@ -5,7 +5,15 @@ using namespace juce::gl;
 PresetRenderer::PresetRenderer()
 {
     renderState = std::make_unique<RenderState>();
-    framebufferManager = std::make_unique<FramebufferManager>();
+    framePipeline = std::make_unique<FramePipeline>(*renderState);
+    renderTargetPool = std::make_unique<RenderTargetPool>();
+    framebufferManager = std::make_unique<FramebufferManager>(*renderTargetPool);
+    blurPyramid = std::make_unique<BlurPyramid>();
+    renderGraph = std::make_unique<RenderGraph>(*renderTargetPool);
+
+    // Noise textures are mapped from cache or generated in the background
+    noiseTextures = std::make_unique<NoiseTextures>();
+    noiseTextures->prepare(NoiseTextures::getDefaultCacheFile());
 }
 
 PresetRenderer::~PresetRenderer()
@@ -15,21 +23,26 @@ PresetRenderer::~PresetRenderer()
 
 void PresetRenderer::initializeGL()
 {
-    // Create fullscreen quad geometry
-    createFullscreenQuad();
+    // Create fullscreen triangle geometry
+    createFullscreenTriangle();
 
     // Initialize framebuffer manager
+    renderTargetPool->setBaseSize(viewportWidth, viewportHeight);
     if (!framebufferManager->initialize(viewportWidth, viewportHeight))
     {
         DBG("FlarkViz: Failed to initialize framebuffer manager");
         return;
     }
 
-    // Enable blending
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // Blur pyramid shader (levels are allocated on demand)
+    blurPyramid->initializeGL();
 
-    DBG("FlarkViz: OpenGL initialized (MilkDrop pipeline ready)");
+    // Timer queries feed the profiler and the dynamic resolution scaler
+    profiler.initializeGL();
+
+    DBG("FlarkViz: OpenGL initialized (MilkDrop pipeline ready, "
+        << RenderTargetPool::getFormatName(framebufferManager->getActualFormat())
+        << " feedback, " << (renderTargetPool->getBytesInUse() / 1024) << " KB)");
 }
 
 void PresetRenderer::cleanupGL()
@@ -40,9 +53,26 @@ void PresetRenderer::cleanupGL()
     if (gl.fullscreenVBO != 0)
         glDeleteBuffers(1, &gl.fullscreenVBO);
 
+    if (blurPyramid)
+        blurPyramid->cleanupGL();
+
+    if (renderState)
+        renderState->releasePrograms();
+
+    if (renderGraph)
+        renderGraph->releaseRetained();
+
+    if (noiseTextures)
+        noiseTextures->cleanupGL();
+
     if (framebufferManager)
         framebufferManager->cleanup();
 
+    if (renderTargetPool)
+        renderTargetPool->cleanup();
+
+    profiler.cleanupGL();
+
     gl.fullscreenVAO = 0;
     gl.fullscreenVBO = 0;
 }
@@ -52,20 +82,28 @@ void PresetRenderer::setViewportSize(int width, int height)
     viewportWidth = width;
     viewportHeight = height;
 
-    glViewport(0, 0, width, height);
+    if (renderTargetPool)
+        renderTargetPool->setBaseSize(width, height);
+
+    // Framebuffers are resized on the GL thread at the start of the next frame
+}
 
-    // Resize framebuffers
-    if (framebufferManager && framebufferManager->isInitialized())
-        framebufferManager->resize(width, height);
+void PresetRenderer::waitUntilResourcesReady()
+{
+    if (noiseTextures)
+        noiseTextures->waitUntilReady();
 }
 
 void PresetRenderer::beginFrame(float dt)
 {
     deltaTime = dt;
 
-    // Clear screen
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    // Anything may have changed GL state since the last frame (JUCE's own
+    // painting, captures, other renderers sharing the context)
+    glState.beginFrame();
+
+    // The composite pass overwrites the output; clear only if it doesn't run
+    outputClearPending = true;
 }
 
 void PresetRenderer::renderPreset(float bass, float mid, float treb,
@@ -74,25 +112,119 @@ void PresetRenderer::renderPreset(float bass, float mid, float treb,
     if (!presetLoaded || !renderState)
         return;
 
-    // Update audio data in render state
-    renderState->updateAudioData(bass, mid, treb, bassAtt, midAtt, trebAtt);
+    profiler.beginFrame();
+
+    // Match the feedback buffers to the current internal resolution
+    updateFeedbackResolution();
+
+    // One-time upload once the background noise data is ready
+    noiseTextures->uploadGL();
+
+    // The resize and upload above bind behind the state cache's back
+    glState.invalidate();
+
+    FramePipeline::Inputs inputs;
+    inputs.bass = bass;
+    inputs.mid = mid;
+    inputs.treb = treb;
+    inputs.bassAtt = bassAtt;
+    inputs.midAtt = midAtt;
+    inputs.trebAtt = trebAtt;
+    inputs.deltaTime = deltaTime;
+
+    // Execute per-frame expressions. When pipelined, this frame was evaluated
+    // during the previous one and the stage only measures the wait for it.
+    {
+        FrameProfiler::ScopedStage stage(profiler, FrameProfiler::Stage::Expressions);
+
+        if (framePipeline->isInFlight())
+            frameState = &framePipeline->waitForNext();
+        else
+            frameState = &framePipeline->evaluateNow(inputs);
+    }
+
+    lastEvaluationMs = frameState->evalMs;
+
+    // Start on the next frame while this one's passes are submitted.
+    // Frame N+1 is evaluated with frame N's audio levels, so pipelined
+    // expressions react to audio one frame late.
+    if (pipelinedEvaluation)
+        framePipeline->beginNext(inputs);
+
+    // Declare this frame's passes; the graph culls what nobody reads
+    // and allocates the rest
+    buildRenderGraph();
+
+    if (!renderGraph->compile())
+        DBG("FlarkViz: Render graph could not allocate every target; some passes skipped");
+
+    // Allocations bind behind the state cache's back
+    glState.invalidate();
 
-    // Execute per-frame expressions
-    auto& context = renderState->executeFrame(deltaTime);
+    {
+        std::function<void(const std::string&)> callback;
+        {
+            std::lock_guard<std::mutex> lock(framePlanLock);
+            std::swap(callback, framePlanCallback);
+        }
+
+        if (callback)
+            callback(renderGraph->getPlan());
+    }
 
-    // Render warp pass (texture feedback)
-    renderWarpPass();
+    // Warp, blur, composite and capture passes, each group as its profiler stage
+    renderGraph->execute([this](int group, bool begin)
+    {
+        auto stage = static_cast<FrameProfiler::Stage>(group);
 
-    // Render composite pass (final output to screen)
-    renderCompositePass();
+        if (begin)
+            profiler.beginStage(stage);
+        else
+            profiler.endStage(stage);
+    });
 
     // Swap framebuffers for next frame
-    framebufferManager->swap();
+    {
+        FrameProfiler::ScopedStage stage(profiler, FrameProfiler::Stage::Swap);
+        framebufferManager->swap();
+    }
+
+    // Leave no VAO bound for whoever draws after us
+    glState.bindVertexArray(0);
 }
 
 void PresetRenderer::endFrame()
 {
-    // Nothing needed for now
+    // No preset rendered: show black rather than whatever was there
+    if (outputClearPending)
+        clearOutput();
+
+    if (!presetLoaded)
+        return;
+
+    profiler.endFrame();
+
+    // GPU results lag a few frames behind; use whichever side is slower
+    double frameMs = juce::jmax(profiler.getLastCpuFrameMs(), profiler.getLastGpuFrameMs());
+
+    resolutionScaler.addFrameTime(frameMs);
+}
+
+void PresetRenderer::setClock(int64_t frameNumber, double elapsedSeconds)
+{
+    if (!renderState)
+        return;
+
+    // A frame evaluated ahead was timed by the old clock
+    framePipeline->discard();
+    renderState->setClock(frameNumber, elapsedSeconds);
+}
+
+void PresetRenderer::setPipelinedEvaluation(bool enable)
+{
+    // A frame already evaluated ahead is still picked up by the next
+    // renderPreset(), so switching off neither drops nor repeats a frame
+    pipelinedEvaluation = enable;
 }
 
 bool PresetRenderer::loadPreset(const MilkDropPreset& preset)
@@ -100,6 +232,9 @@ bool PresetRenderer::loadPreset(const MilkDropPreset& preset)
     if (!renderState)
         return false;
 
+    // The worker must not be evaluating the old preset while it is replaced
+    framePipeline->discard();
+
     // Load preset into render state (compiles expressions and shaders)
     if (!renderState->loadPreset(preset))
     {
@@ -112,24 +247,65 @@ bool PresetRenderer::loadPreset(const MilkDropPreset& preset)
     return true;
 }
 
+bool PresetRenderer::loadPreparedPreset(std::unique_ptr<PreparedPreset> prepared)
+{
+    if (!renderState || prepared == nullptr)
+        return false;
+
+    framePipeline->discard();
+
+    const std::string name = prepared->preset.name;
+    if (!renderState->loadPrepared(std::move(prepared)))
+        return false;
+
+    presetLoaded = true;
+    DBG("FlarkViz: Prepared preset loaded: " << name);
+    return true;
+}
+
+std::unique_ptr<PreparedPreset> PresetRenderer::takeRetiredPreset()
+{
+    return renderState ? renderState->takeRetired() : nullptr;
+}
+
+bool PresetRenderer::warmPreset(const PreparedPreset& prepared)
+{
+    return renderState && renderState->warmPrograms(prepared);
+}
+
 void PresetRenderer::enableDoublePresetMode(bool enable)
 {
     doublePresetMode = enable;
     DBG("FlarkViz: Double-preset mode " << (enable ? "enabled" : "disabled"));
 }
 
-void PresetRenderer::createFullscreenQuad()
+void PresetRenderer::setDynamicResolutionEnabled(bool enable)
+{
+    resolutionScaler.setEnabled(enable);
+}
+
+void PresetRenderer::requestFramePlan(std::function<void(const std::string&)> callback)
+{
+    std::lock_guard<std::mutex> lock(framePlanLock);
+    framePlanCallback = std::move(callback);
+}
+
+void PresetRenderer::setFeedbackFormat(RenderTargetFormat format)
+{
+    if (framebufferManager)
+        framebufferManager->setFormat(format);
+}
+
+void PresetRenderer::createFullscreenTriangle()
 {
-    // Fullscreen quad vertices (position + texcoord)
+    // One triangle covering the viewport (position + texcoord); the parts
+    // outside clip space are discarded, and unlike a two-triangle quad there
+    // is no diagonal seam where fragments get shaded twice
     float vertices[] = {
         // Position (x, y)  // TexCoord (u, v)
-        -1.0f,  1.0f,       0.0f, 1.0f,  // Top-left
         -1.0f, -1.0f,       0.0f, 0.0f,  // Bottom-left
-         1.0f, -1.0f,       1.0f, 0.0f,  // Bottom-right
-
-        -1.0f,  1.0f,       0.0f, 1.0f,  // Top-left
-         1.0f, -1.0f,       1.0f, 0.0f,  // Bottom-right
-         1.0f,  1.0f,       1.0f, 1.0f   // Top-right
+         3.0f, -1.0f,       2.0f, 0.0f,  // Past bottom-right
+        -1.0f,  3.0f,       0.0f, 2.0f   // Past top-left
     };
 
     // Create VAO
@@ -153,142 +329,287 @@ void PresetRenderer::createFullscreenQuad()
     glBindVertexArray(0);
 }
 
-void PresetRenderer::renderWarpPass()
+void PresetRenderer::updateFeedbackResolution()
 {
-    if (!framebufferManager || !renderState)
+    if (!framebufferManager || !framebufferManager->isInitialized())
         return;
 
-    auto* warpShader = renderState->getWarpShader();
-    if (!warpShader || warpShader->programId == 0)
+    float scale = resolutionScaler.getScale();
+    int width = juce::jmax(1, juce::roundToInt(viewportWidth * scale));
+    int height = juce::jmax(1, juce::roundToInt(viewportHeight * scale));
+
+    // No-op unless the viewport or scale changed; quantised scales keep
+    // the set of sizes small so the pool can reuse earlier allocations
+    framebufferManager->resize(width, height);
+}
+
+void PresetRenderer::buildRenderGraph()
+{
+    renderGraph->reset();
+
+    if (!framebufferManager->isInitialized())
         return;
 
-    // Bind write framebuffer
-    framebufferManager->bindWriteFramebuffer();
+    const int feedbackWidth = framebufferManager->getWidth();
+    const int feedbackHeight = framebufferManager->getHeight();
+    const RenderGraph::TextureDesc feedbackDesc { framebufferManager->getActualFormat(),
+                                                  feedbackWidth, feedbackHeight };
 
-    // Clear framebuffer
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
+    const auto previousFrame = renderGraph->importTexture("feedback.prev", feedbackDesc,
+                                                          framebufferManager->getReadTextureId(), 0);
+    const auto warpOutput = renderGraph->importTexture("feedback.next", feedbackDesc,
+                                                       framebufferManager->getWriteTextureId(),
+                                                       framebufferManager->getWriteFramebufferId());
+    const auto output = renderGraph->importTexture("output", { RenderTargetFormat::RGBA8, viewportWidth, viewportHeight },
+                                                   0, outputFramebuffer);
 
-    // Use warp shader
-    glUseProgram(warpShader->programId);
+    const auto blurLevels = blurPyramid->declareLevels(*renderGraph, feedbackWidth, feedbackHeight,
+                                                       framebufferManager->getActualFormat());
 
-    // Bind previous frame texture
-    framebufferManager->bindReadTexture(0);
+    // Only what the shader samples counts as read, so unused blur levels get culled
+    auto readBlurLevels = [&blurLevels](RenderGraph::PassBuilder& pass, const MilkDrop::CompiledShader& shader)
+    {
+        for (int i = 0; i < BlurPyramid::maxLevels; ++i)
+        {
+            if (shader.loc_blur[i] >= 0)
+                pass.read(blurLevels[static_cast<size_t>(i)]);
+        }
+    };
 
-    // Bind uniforms
-    auto& context = renderState->getContext();
-    bindShaderUniforms(*warpShader, context);
+    // Warp: texture feedback at the internal resolution; it samples last
+    // frame's blur levels, which keeps them for the next frame as well
+    auto* warpShader = renderState->getWarpShader();
+    if (warpShader != nullptr && warpShader->programId != 0)
+    {
+        auto pass = renderGraph->addPass("warp",
+            [this, previousFrame, warpOutput, blurLevels](const RenderGraph::Resources& resources)
+            {
+                renderWarpPass(resources, previousFrame, warpOutput, blurLevels);
+            });
+        pass.setGroup(static_cast<int>(FrameProfiler::Stage::WarpPass));
+        pass.read(previousFrame);
+        readBlurLevels(pass, *warpShader);
+        pass.write(warpOutput);
+    }
 
-    // Draw fullscreen quad
-    drawFullscreenQuad();
+    // Blur pyramid from the warp output
+    blurPyramid->addPasses(*renderGraph, glState, warpOutput, blurLevels,
+                           static_cast<int>(FrameProfiler::Stage::BlurPass),
+                           [this] { drawFullscreenTriangle(); });
+
+    // Composite to the output (screen by default), upscaling the feedback image
+    auto* compositeShader = renderState->getCompositeShader();
+    if (compositeShader != nullptr && compositeShader->programId != 0)
+    {
+        auto pass = renderGraph->addPass("composite",
+            [this, warpOutput, output, blurLevels](const RenderGraph::Resources& resources)
+            {
+                renderCompositePass(resources, warpOutput, output, blurLevels);
+            });
+        pass.setGroup(static_cast<int>(FrameProfiler::Stage::CompositePass));
+        pass.read(warpOutput);
+        readBlurLevels(pass, *compositeShader);
+        pass.write(output);
+    }
+    else
+    {
+        auto pass = renderGraph->addPass("clear", [this](const RenderGraph::Resources&) { clearOutput(); });
+        pass.setGroup(static_cast<int>(FrameProfiler::Stage::CompositePass));
+        pass.write(output);
+    }
 
-    // Unbind framebuffer
-    framebufferManager->unbindFramebuffer();
+    // Queue asynchronous readbacks of the finished frame
+    if (frameCapture != nullptr || framePublisher != nullptr)
+    {
+        auto pass = renderGraph->addPass("capture", [this](const RenderGraph::Resources&)
+        {
+            const double time = frameState->time;
+
+            if (frameCapture != nullptr)
+                frameCapture->capture(outputFramebuffer, viewportWidth, viewportHeight, time);
+
+            if (framePublisher != nullptr)
+                framePublisher->publish(outputFramebuffer, viewportWidth, viewportHeight, time);
+        });
+        pass.setGroup(static_cast<int>(FrameProfiler::Stage::Capture));
+        pass.read(output);
+        pass.setSideEffect();
+    }
 }
 
-void PresetRenderer::renderCompositePass()
+void PresetRenderer::renderWarpPass(const RenderGraph::Resources& resources, RenderGraph::ResourceId source,
+                                    RenderGraph::ResourceId target, const BlurPyramid::Levels& blurLevels)
 {
-    if (!framebufferManager || !renderState)
-        return;
+    auto* warpShader = renderState->getWarpShader();
 
+    // Bind write framebuffer at the internal resolution; the pass writes
+    // every pixel, so there is nothing to clear
+    glState.bindFramebuffer(resources.getFramebuffer(target));
+    glState.setViewport(0, 0, resources.getWidth(target), resources.getHeight(target));
+    glState.setBlendEnabled(false);
+
+    // Use warp shader
+    glState.useProgram(warpShader->programId);
+
+    // Bind previous frame texture (plus last frame's blur levels and noise)
+    glState.bindTexture(0, GL_TEXTURE_2D, resources.getTexture(source));
+    bindInputTextures(*warpShader, resources, blurLevels);
+
+    // Bind uniforms
+    bindShaderUniforms(*warpShader, *frameState, resources.getWidth(target), resources.getHeight(target));
+
+    drawFullscreenTriangle();
+}
+
+void PresetRenderer::renderCompositePass(const RenderGraph::Resources& resources, RenderGraph::ResourceId source,
+                                         RenderGraph::ResourceId target, const BlurPyramid::Levels& blurLevels)
+{
     auto* compositeShader = renderState->getCompositeShader();
-    if (!compositeShader || compositeShader->programId == 0)
-        return;
 
-    // Render to screen (framebuffer 0)
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glState.bindFramebuffer(resources.getFramebuffer(target));
+    glState.setViewport(0, 0, resources.getWidth(target), resources.getHeight(target));
+    glState.setBlendEnabled(false);
 
     // Use composite shader
-    glUseProgram(compositeShader->programId);
+    glState.useProgram(compositeShader->programId);
 
     // Bind warp pass output texture
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, framebufferManager->getWriteTextureId());
+    glState.bindTexture(0, GL_TEXTURE_2D, resources.getTexture(source));
+    bindInputTextures(*compositeShader, resources, blurLevels);
 
     // Bind uniforms
-    auto& context = renderState->getContext();
-    bindShaderUniforms(*compositeShader, context);
+    bindShaderUniforms(*compositeShader, *frameState, resources.getWidth(target), resources.getHeight(target));
 
-    // Draw fullscreen quad
-    drawFullscreenQuad();
+    drawFullscreenTriangle();
+    outputClearPending = false;
 }
 
 void PresetRenderer::bindShaderUniforms(const MilkDrop::CompiledShader& shader,
-                                       const MilkDrop::ExecutionContext& context)
+                                       const FrameState& state,
+                                       int targetWidth, int targetHeight)
 {
     // Time variables
     if (shader.loc_time >= 0)
-        glUniform1f(shader.loc_time, static_cast<float>(context.time));
+        glState.uniform1f(shader.loc_time, static_cast<float>(state.time));
     if (shader.loc_frame >= 0)
-        glUniform1f(shader.loc_frame, static_cast<float>(context.frame));
+        glState.uniform1f(shader.loc_frame, state.frame);
     if (shader.loc_fps >= 0)
-        glUniform1f(shader.loc_fps, static_cast<float>(context.fps));
+        glState.uniform1f(shader.loc_fps, state.fps);
 
     // Audio variables
     if (shader.loc_bass >= 0)
-        glUniform1f(shader.loc_bass, static_cast<float>(context.bass));
+        glState.uniform1f(shader.loc_bass, state.bass);
     if (shader.loc_mid >= 0)
-        glUniform1f(shader.loc_mid, static_cast<float>(context.mid));
+        glState.uniform1f(shader.loc_mid, state.mid);
     if (shader.loc_treb >= 0)
-        glUniform1f(shader.loc_treb, static_cast<float>(context.treb));
+        glState.uniform1f(shader.loc_treb, state.treb);
     if (shader.loc_bass_att >= 0)
-        glUniform1f(shader.loc_bass_att, static_cast<float>(context.bass_att));
+        glState.uniform1f(shader.loc_bass_att, state.bassAtt);
     if (shader.loc_mid_att >= 0)
-        glUniform1f(shader.loc_mid_att, static_cast<float>(context.mid_att));
+        glState.uniform1f(shader.loc_mid_att, state.midAtt);
     if (shader.loc_treb_att >= 0)
-        glUniform1f(shader.loc_treb_att, static_cast<float>(context.treb_att));
+        glState.uniform1f(shader.loc_treb_att, state.trebAtt);
 
     // Preset state
     if (shader.loc_zoom >= 0)
-        glUniform1f(shader.loc_zoom, static_cast<float>(context.zoom));
+        glState.uniform1f(shader.loc_zoom, state.zoom);
     if (shader.loc_rot >= 0)
-        glUniform1f(shader.loc_rot, static_cast<float>(context.rot));
+        glState.uniform1f(shader.loc_rot, state.rot);
     if (shader.loc_cx >= 0)
-        glUniform1f(shader.loc_cx, static_cast<float>(context.cx));
+        glState.uniform1f(shader.loc_cx, state.cx);
     if (shader.loc_cy >= 0)
-        glUniform1f(shader.loc_cy, static_cast<float>(context.cy));
+        glState.uniform1f(shader.loc_cy, state.cy);
     if (shader.loc_dx >= 0)
-        glUniform1f(shader.loc_dx, static_cast<float>(context.dx));
+        glState.uniform1f(shader.loc_dx, state.dx);
     if (shader.loc_dy >= 0)
-        glUniform1f(shader.loc_dy, static_cast<float>(context.dy));
+        glState.uniform1f(shader.loc_dy, state.dy);
     if (shader.loc_warp >= 0)
-        glUniform1f(shader.loc_warp, static_cast<float>(context.warp));
+        glState.uniform1f(shader.loc_warp, state.warp);
     if (shader.loc_sx >= 0)
-        glUniform1f(shader.loc_sx, static_cast<float>(context.sx));
+        glState.uniform1f(shader.loc_sx, state.sx);
     if (shader.loc_sy >= 0)
-        glUniform1f(shader.loc_sy, static_cast<float>(context.sy));
+        glState.uniform1f(shader.loc_sy, state.sy);
+    if (shader.loc_decay >= 0)
+        glState.uniform1f(shader.loc_decay, state.decay);
 
     // Wave colors
     if (shader.loc_wave_r >= 0)
-        glUniform1f(shader.loc_wave_r, static_cast<float>(context.wave_r));
+        glState.uniform1f(shader.loc_wave_r, state.waveR);
     if (shader.loc_wave_g >= 0)
-        glUniform1f(shader.loc_wave_g, static_cast<float>(context.wave_g));
+        glState.uniform1f(shader.loc_wave_g, state.waveG);
     if (shader.loc_wave_b >= 0)
-        glUniform1f(shader.loc_wave_b, static_cast<float>(context.wave_b));
+        glState.uniform1f(shader.loc_wave_b, state.waveB);
     if (shader.loc_wave_a >= 0)
-        glUniform1f(shader.loc_wave_a, static_cast<float>(context.wave_a));
+        glState.uniform1f(shader.loc_wave_a, state.waveA);
 
     // Resolution
     if (shader.loc_resolution >= 0)
-        glUniform2f(shader.loc_resolution,
-                   static_cast<float>(viewportWidth),
-                   static_cast<float>(viewportHeight));
+        glState.uniform2f(shader.loc_resolution,
+                   static_cast<float>(targetWidth),
+                   static_cast<float>(targetHeight));
 
-    // Texture sampler
+    // Texture samplers
     if (shader.loc_mainTexture >= 0)
-        glUniform1i(shader.loc_mainTexture, 0);  // Texture unit 0
+        glState.uniform1i(shader.loc_mainTexture, 0);  // Texture unit 0
+
+    for (int i = 0; i < 3; ++i)
+    {
+        if (shader.loc_blur[i] >= 0)
+            glState.uniform1i(shader.loc_blur[i], 1 + i);  // Texture units 1-3
+
+        const auto range = blurPyramid->getRange(i);
+        if (shader.loc_blurMin[i] >= 0)
+            glState.uniform1f(shader.loc_blurMin[i], range.min);
+        if (shader.loc_blurMax[i] >= 0)
+            glState.uniform1f(shader.loc_blurMax[i], range.max);
+    }
+
+    for (int i = 0; i < NoiseGenerator::numTextures; ++i)
+    {
+        if (shader.loc_noise[i] >= 0)
+            glState.uniform1i(shader.loc_noise[i], 4 + i);  // Texture units 4-9
+    }
 
     // Custom variables (q1-q32)
     for (int i = 0; i < 32; ++i)
     {
         if (shader.loc_q[i] >= 0)
-            glUniform1f(shader.loc_q[i], static_cast<float>(context.q[i]));
+            glState.uniform1f(shader.loc_q[i], state.q[i]);
     }
 }
 
-void PresetRenderer::drawFullscreenQuad()
+void PresetRenderer::bindInputTextures(const MilkDrop::CompiledShader& shader,
+                                       const RenderGraph::Resources& resources,
+                                       const BlurPyramid::Levels& blurLevels)
 {
-    glBindVertexArray(gl.fullscreenVAO);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
+    // Only bind what the shader actually samples
+    for (int i = 0; i < 3; ++i)
+    {
+        if (shader.loc_blur[i] < 0)
+            continue;
+
+        glState.bindTexture(1 + i, GL_TEXTURE_2D, resources.getTexture(blurLevels[static_cast<size_t>(i)]));
+    }
+
+    for (int i = 0; i < NoiseGenerator::numTextures; ++i)
+    {
+        if (shader.loc_noise[i] < 0)
+            continue;
+
+        glState.bindTexture(4 + i, NoiseGenerator::getSpec(i).volume ? GL_TEXTURE_3D : GL_TEXTURE_2D,
+                            noiseTextures->getTexture(i));
+    }
+}
+
+void PresetRenderer::drawFullscreenTriangle()
+{
+    glState.bindVertexArray(gl.fullscreenVAO);
+    glState.drawArrays(GL_TRIANGLES, 0, 3);
+}
+
+void PresetRenderer::clearOutput()
+{
+    glState.bindFramebuffer(outputFramebuffer);
+    glState.clear(0.0f, 0.0f, 0.0f, 1.0f);
+    outputClearPending = false;
 }
@@ -4,42 +4,158 @@
 #include "../Audio/AudioAnalyzer.h"
 #include "../Presets/Preset.h"
 #include "RenderState.h"
+#include "FramePipeline.h"
 #include "FramebufferManager.h"
+#include "GLStateCache.h"
+#include "RenderTargetPool.h"
+#include "BlurPyramid.h"
+#include "RenderGraph.h"
+#include "NoiseTextures.h"
+#include "ResolutionScaler.h"
+#include "FrameProfiler.h"
+#include "FrameCapture.h"
+#include "SharedFramePublisher.h"
 #include "ShaderCompiler.h"
+#include "RenderBackend.h"
 
 /**
  * @class PresetRenderer
  * @brief Complete MilkDrop preset renderer with full pipeline
  *
  * Implements the complete MilkDrop rendering pipeline:
- * 1. Execute per-frame expressions
+ * 1. Execute per-frame expressions (optionally one frame ahead, see
+ *    setPipelinedEvaluation)
  * 2. Render warp pass (texture feedback + warp shader)
- * 3. Render composite pass (final output)
+ * 3. Render blur pyramid (only the levels the preset's shaders sample)
+ * 4. Render composite pass (final output)
+ *
+ * The passes are declared each frame on a RenderGraph, which culls the blur
+ * levels no shader samples and backs the transient textures from the
+ * RenderTargetPool. Every pass draws one fullscreen triangle with blending
+ * off and replaces its whole target, so targets are never cleared first;
+ * GL state goes through a GLStateCache that drops redundant binds.
+ *
+ * The feedback loop (warp pass and feedback buffers) runs at an internal
+ * resolution chosen by a ResolutionScaler from measured CPU/GPU frame time;
+ * the composite pass upscales it to the viewport.
+ *
+ * This is the OpenGL RenderBackend; see SoftwareRenderer for the CPU one.
  */
-class PresetRenderer
+class PresetRenderer : public RenderBackend
 {
 public:
     PresetRenderer();
-    ~PresetRenderer();
+    ~PresetRenderer() override;
+
+    Type getType() const override { return Type::OpenGL; }
 
     //==========================================================================
     // OpenGL lifecycle
     void initializeGL();
     void cleanupGL();
-    void setViewportSize (int width, int height);
+    void setViewportSize (int width, int height) override;
+
+    void initialise() override { initializeGL(); }
+    void release() override { cleanupGL(); }
+
+    /**
+     * @brief Framebuffer the composite pass draws into (0 = default framebuffer)
+     *
+     * Headless rendering points this at an offscreen target.
+     */
+    void setOutputFramebuffer (GLuint fbo) { outputFramebuffer = fbo; }
+
+    /**
+     * @brief Block until background resources (noise textures) are ready
+     *
+     * The interactive app renders without them for the first few frames;
+     * offline renders wait so every frame is reproducible.
+     */
+    void waitUntilResourcesReady();
+
+    /**
+     * @brief Read back every composited frame through a FrameCapture
+     *
+     * The capture is not owned; pass nullptr to stop capturing. The caller
+     * must call FrameCapture::cleanupGL() while the context is still current.
+     */
+    void setFrameCapture (FrameCapture* capture) { frameCapture = capture; }
+
+    /**
+     * @brief Publish every composited frame to shared memory for other processes
+     *
+     * Not owned; pass nullptr to stop. The caller must call
+     * SharedFramePublisher::cleanupGL() while the context is still current.
+     */
+    void setFramePublisher (SharedFramePublisher* publisher) { framePublisher = publisher; }
 
     //==========================================================================
     // Rendering
-    void beginFrame(float deltaTime);
+    void beginFrame (float deltaTime) override;
     void renderPreset (float bass, float mid, float treb,
-                      float bassAtt, float midAtt, float trebAtt);
-    void endFrame();
+                      float bassAtt, float midAtt, float trebAtt) override;
+    void endFrame() override;
+
+    /**
+     * @brief Position the preset clock before beginFrame() (see RenderState::setClock)
+     */
+    void setClock (int64_t frameNumber, double elapsedSeconds) override;
+
+    /**
+     * @brief Evaluate frame N+1's expressions on a worker while frame N renders
+     *
+     * Hides expression cost behind GL submission; each frame then reacts to
+     * the audio levels passed one renderPreset() earlier. Off by default so
+     * offline renders stay bit-exact.
+     */
+    void setPipelinedEvaluation (bool enable);
+    bool isPipelinedEvaluation() const { return pipelinedEvaluation; }
+
+    /** Expression evaluation time of the last rendered frame, on whichever thread ran it */
+    double getLastEvaluationMs() const { return lastEvaluationMs.load(); }
 
     //==========================================================================
     // Preset management
-    bool loadPreset (const MilkDropPreset& preset);
+    bool loadPreset (const MilkDropPreset& preset) override;
+    bool loadPreparedPreset (std::unique_ptr<PreparedPreset> prepared) override;
+    std::unique_ptr<PreparedPreset> takeRetiredPreset() override;
     void enableDoublePresetMode (bool enable);
 
+    /**
+     * @brief Link an upcoming preset's programs now, so switching to it is a bind
+     * @return true if a program was linked (i.e. this frame paid for it)
+     */
+    bool warmPreset (const PreparedPreset& prepared);
+
+    //==========================================================================
+    // Render targets
+    void setFeedbackFormat (RenderTargetFormat format);
+    RenderTargetPool& getRenderTargetPool() { return *renderTargetPool; }
+
+    //==========================================================================
+    // Dynamic resolution
+    void setDynamicResolutionEnabled (bool enable);
+    ResolutionScaler& getResolutionScaler() { return resolutionScaler; }
+    float getResolutionScale() const { return resolutionScaler.getScale(); }
+    int getFeedbackWidth() const { return framebufferManager->getWidth(); }
+    int getFeedbackHeight() const { return framebufferManager->getHeight(); }
+
+    //==========================================================================
+    // Profiling
+    FrameProfiler& getProfiler() { return profiler; }
+    const NoiseTextures& getNoiseTextures() const { return *noiseTextures; }
+
+    /**
+     * @brief Have the next frame's plan (passes, culling, texture memory) delivered
+     *
+     * The callback runs once, on the render thread, after the next frame's
+     * graph is compiled.
+     */
+    void requestFramePlan (std::function<void (const std::string&)> callback);
+
+    /** GL calls issued/skipped in the last frame (any thread) */
+    GLStateCache::Stats getGLStats() const { return glState.getLastFrameStats(); }
+
 private:
     //==========================================================================
     // OpenGL objects
@@ -52,24 +168,58 @@ private:
     // Viewport
     int viewportWidth = 1280;
     int viewportHeight = 720;
+    GLuint outputFramebuffer = 0;
+
+    // Set by beginFrame(); the composite pass covers the whole output, so
+    // it is only cleared if nothing was drawn
+    bool outputClearPending = false;
 
     // Rendering state
     std::unique_ptr<RenderState> renderState;
+    std::unique_ptr<FramePipeline> framePipeline;   // after renderState: its worker uses it
+    std::unique_ptr<RenderTargetPool> renderTargetPool;
     std::unique_ptr<FramebufferManager> framebufferManager;
+    std::unique_ptr<BlurPyramid> blurPyramid;
+    std::unique_ptr<RenderGraph> renderGraph;       // after the pool: releases into it
+    std::unique_ptr<NoiseTextures> noiseTextures;
+    FrameCapture* frameCapture = nullptr;
+    SharedFramePublisher* framePublisher = nullptr;
+
+    GLStateCache glState;
+
+    std::mutex framePlanLock;
+    std::function<void (const std::string&)> framePlanCallback;
+
+    // Dynamic resolution and profiling
+    ResolutionScaler resolutionScaler;
+    FrameProfiler profiler;
 
     // State
     bool doublePresetMode = false;
     bool presetLoaded = false;
+    bool pipelinedEvaluation = false;
     float deltaTime = 1.0f / 60.0f;
 
+    // Evaluated state of the frame being rendered (owned by framePipeline)
+    const FrameState* frameState = nullptr;
+    std::atomic<double> lastEvaluationMs { 0.0 };
+
     //==========================================================================
     // Internal rendering
-    void createFullscreenQuad();
-    void renderWarpPass();
-    void renderCompositePass();
+    void createFullscreenTriangle();
+    void updateFeedbackResolution();
+    void buildRenderGraph();
+    void renderWarpPass(const RenderGraph::Resources& resources, RenderGraph::ResourceId source,
+                        RenderGraph::ResourceId target, const BlurPyramid::Levels& blurLevels);
+    void renderCompositePass(const RenderGraph::Resources& resources, RenderGraph::ResourceId source,
+                             RenderGraph::ResourceId target, const BlurPyramid::Levels& blurLevels);
+    void bindInputTextures(const MilkDrop::CompiledShader& shader, const RenderGraph::Resources& resources,
+                           const BlurPyramid::Levels& blurLevels);
     void bindShaderUniforms(const MilkDrop::CompiledShader& shader,
-                           const MilkDrop::ExecutionContext& context);
-    void drawFullscreenQuad();
+                           const FrameState& state,
+                           int targetWidth, int targetHeight);
+    void drawFullscreenTriangle();
+    void clearOutput();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetRenderer)
 };
@@ -0,0 +1,49 @@
+#include "RenderBackend.h"
+
+const char* RenderBackend::getTypeName(Type type)
+{
+    return type == Type::Software ? "software" : "opengl";
+}
+
+bool RenderBackend::parseType(const juce::String& name, Type& type)
+{
+    auto lower = name.trim().toLowerCase();
+
+    if (lower == "gl" || lower == "opengl")
+        type = Type::OpenGL;
+    else if (lower == "cpu" || lower == "software")
+        type = Type::Software;
+    else
+        return false;
+
+    return true;
+}
+
+RenderBackend::Type RenderBackend::getPreferredType(const juce::String& commandLine)
+{
+    Type type = Type::OpenGL;
+
+    // The command line wins over the environment
+    auto tokens = juce::StringArray::fromTokens(commandLine, true);
+    for (int i = 0; i < tokens.size(); ++i)
+    {
+        auto token = tokens[i].unquoted();
+
+        if (token.startsWith("--renderer="))
+        {
+            if (parseType(token.fromFirstOccurrenceOf("=", false, false), type))
+                return type;
+        }
+        else if (token == "--renderer" && i + 1 < tokens.size())
+        {
+            if (parseType(tokens[i + 1].unquoted(), type))
+                return type;
+        }
+    }
+
+    auto environment = juce::SystemStats::getEnvironmentVariable("FLARKVIZ_RENDERER", {});
+    if (environment.isNotEmpty() && !parseType(environment, type))
+        DBG("FlarkViz: Ignoring unknown FLARKVIZ_RENDERER '" << environment << "'");
+
+    return type;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../Presets/Preset.h"
+#include "PreparedPreset.h"
+#include <memory>
+
+/**
+ * @class RenderBackend
+ * @brief What the app, the plugin editor and the offline renderer need from a renderer
+ *
+ * Two implementations: PresetRenderer runs the pipeline on the GPU and
+ * draws into the current GL framebuffer; SoftwareRenderer runs it on the
+ * CPU into a pixel buffer, for machines without a usable OpenGL 3.3
+ * driver. A host picks one at startup (see getPreferredType) and then
+ * drives either the same way: loadPreset() once, then beginFrame(),
+ * renderPreset() and endFrame() per frame. Collecting the finished frame
+ * is backend-specific.
+ *
+ * Like PresetRenderer, backends keep a pointer to the loaded preset, so it
+ * must outlive them or the next loadPreset(). A preset handed over with
+ * loadPreparedPreset() is owned by the backend instead.
+ */
+class RenderBackend
+{
+public:
+    enum class Type
+    {
+        OpenGL,
+        Software
+    };
+
+    virtual ~RenderBackend() = default;
+
+    virtual Type getType() const = 0;
+
+    //==========================================================================
+    // Lifecycle; the OpenGL backend needs its context current for both
+    virtual void initialise() = 0;
+    virtual void release() = 0;
+    virtual void setViewportSize (int width, int height) = 0;
+
+    //==========================================================================
+    virtual bool loadPreset (const MilkDropPreset& preset) = 0;
+
+    /** Switch to a preset compiled and translated off-thread (see PresetPrefetcher) */
+    virtual bool loadPreparedPreset (std::unique_ptr<PreparedPreset> prepared) = 0;
+
+    /** The prepared preset the last load replaced, with its compiled code, for caching */
+    virtual std::unique_ptr<PreparedPreset> takeRetiredPreset() = 0;
+
+    /** Position the preset clock before beginFrame() (see RenderState::setClock) */
+    virtual void setClock (int64_t frameNumber, double elapsedSeconds) = 0;
+
+    virtual void beginFrame (float deltaTime) = 0;
+    virtual void renderPreset (float bass, float mid, float treb,
+                               float bassAtt, float midAtt, float trebAtt) = 0;
+    virtual void endFrame() = 0;
+
+    //==========================================================================
+    /** "opengl" or "software" */
+    static const char* getTypeName (Type type);
+
+    /** Accepts gl/opengl and cpu/software (any case); false if unrecognised */
+    static bool parseType (const juce::String& name, Type& type);
+
+    /**
+     * @brief Backend requested with --renderer=<name> on the command line or
+     *        the FLARKVIZ_RENDERER environment variable, else OpenGL
+     */
+    static Type getPreferredType (const juce::String& commandLine = {});
+};
@@ -0,0 +1,534 @@
+#include "RenderGraph.h"
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+    size_t getBytes(const RenderGraph::TextureDesc& desc)
+    {
+        return static_cast<size_t>(desc.width) * static_cast<size_t>(desc.height)
+             * RenderTargetPool::getBytesPerPixel(desc.format);
+    }
+
+    std::string formatBytes(size_t bytes)
+    {
+        std::ostringstream text;
+        text << std::fixed << std::setprecision(2) << (bytes / (1024.0 * 1024.0)) << " MB";
+        return text.str();
+    }
+}
+
+//==============================================================================
+unsigned int RenderGraph::Resources::getTexture(ResourceId id) const
+{
+    const auto& resource = graph.getResource(id);
+    if (resource.kind == Kind::Imported)
+        return resource.texture;
+
+    return resource.target != nullptr ? resource.target->texture : 0;
+}
+
+unsigned int RenderGraph::Resources::getFramebuffer(ResourceId id) const
+{
+    const auto& resource = graph.getResource(id);
+    if (resource.kind == Kind::Imported)
+        return resource.framebuffer;
+
+    return resource.target != nullptr ? resource.target->fbo : 0;
+}
+
+int RenderGraph::Resources::getWidth(ResourceId id) const
+{
+    return graph.getResource(id).desc.width;
+}
+
+int RenderGraph::Resources::getHeight(ResourceId id) const
+{
+    return graph.getResource(id).desc.height;
+}
+
+//==============================================================================
+void RenderGraph::PassBuilder::read(ResourceId id)
+{
+    jassert(id >= 0 && id < static_cast<int>(graph.resources.size()));
+
+    auto& pass = graph.passes[static_cast<size_t>(passIndex)];
+    auto& resource = graph.resources[static_cast<size_t>(id)];
+
+    if (resource.lastWriter >= 0)
+    {
+        pass.producers.push_back(resource.lastWriter);
+    }
+    else if (resource.kind == Kind::Retained)
+    {
+        // Last frame's contents: whoever writes it this frame writes it for the next one
+        resource.historyRead = true;
+        resource.keep = true;
+    }
+    else
+    {
+        // Transients have no contents before their first write
+        jassert(resource.kind == Kind::Imported);
+    }
+
+    pass.reads.push_back(id);
+}
+
+void RenderGraph::PassBuilder::write(ResourceId id)
+{
+    jassert(id >= 0 && id < static_cast<int>(graph.resources.size()));
+
+    auto& resource = graph.resources[static_cast<size_t>(id)];
+
+    graph.passes[static_cast<size_t>(passIndex)].writes.push_back(id);
+
+    if (resource.firstWriter < 0)
+        resource.firstWriter = passIndex;
+    resource.lastWriter = passIndex;
+}
+
+void RenderGraph::PassBuilder::setSideEffect()
+{
+    graph.passes[static_cast<size_t>(passIndex)].sideEffect = true;
+}
+
+void RenderGraph::PassBuilder::setGroup(int group)
+{
+    graph.passes[static_cast<size_t>(passIndex)].group = group;
+}
+
+//==============================================================================
+RenderGraph::RenderGraph(RenderTargetPool& p)
+    : pool(p)
+{
+}
+
+RenderGraph::~RenderGraph()
+{
+    releaseTransients();
+    releaseRetained();
+}
+
+void RenderGraph::reset()
+{
+    releaseTransients();
+
+    passes.clear();
+    resources.clear();
+
+    for (auto& entry : retained)
+        entry.declared = false;
+
+    stats = {};
+    compiled = false;
+}
+
+RenderGraph::ResourceId RenderGraph::importTexture(const char* name, const TextureDesc& desc,
+                                                   unsigned int texture, unsigned int framebuffer)
+{
+    Resource resource;
+    resource.name = name;
+    resource.kind = Kind::Imported;
+    resource.desc = desc;
+    resource.texture = texture;
+    resource.framebuffer = framebuffer;
+
+    // Visible outside the graph
+    resource.keep = true;
+
+    return addResource(std::move(resource));
+}
+
+RenderGraph::ResourceId RenderGraph::createTexture(const char* name, const TextureDesc& desc)
+{
+    Resource resource;
+    resource.name = name;
+    resource.kind = Kind::Transient;
+    resource.desc = desc;
+
+    return addResource(std::move(resource));
+}
+
+RenderGraph::ResourceId RenderGraph::retainedTexture(const char* name, const TextureDesc& desc)
+{
+    for (size_t i = 0; i < resources.size(); ++i)
+    {
+        if (resources[i].kind == Kind::Retained && resources[i].name == name)
+            return static_cast<ResourceId>(i);
+    }
+
+    int index = -1;
+    for (size_t i = 0; i < retained.size(); ++i)
+    {
+        if (retained[i].name == name)
+            index = static_cast<int>(i);
+    }
+
+    if (index < 0)
+    {
+        Retained entry;
+        entry.name = name;
+        retained.push_back(entry);
+        index = static_cast<int>(retained.size()) - 1;
+    }
+
+    auto& entry = retained[static_cast<size_t>(index)];
+    if (!(entry.desc == desc))
+    {
+        // Different size or format: the old contents are of no use
+        pool.release(entry.target);
+        entry.target = nullptr;
+        entry.desc = desc;
+    }
+    entry.declared = true;
+
+    Resource resource;
+    resource.name = name;
+    resource.kind = Kind::Retained;
+    resource.desc = desc;
+    resource.retainedIndex = index;
+
+    return addResource(std::move(resource));
+}
+
+RenderGraph::PassBuilder RenderGraph::addPass(const char* name, ExecuteFunction execute)
+{
+    Pass pass;
+    pass.name = name;
+    pass.execute = std::move(execute);
+    passes.push_back(std::move(pass));
+
+    return PassBuilder(*this, static_cast<int>(passes.size()) - 1);
+}
+
+RenderGraph::ResourceId RenderGraph::addResource(Resource resource)
+{
+    resources.push_back(std::move(resource));
+    return static_cast<ResourceId>(resources.size()) - 1;
+}
+
+const RenderGraph::Resource& RenderGraph::getResource(ResourceId id) const
+{
+    jassert(id >= 0 && id < static_cast<int>(resources.size()));
+    return resources[static_cast<size_t>(id)];
+}
+
+//==============================================================================
+bool RenderGraph::compile()
+{
+    cull();
+    computeLifetimes();
+
+    bool allocated = allocateRetained();
+    allocated = allocateTransients() && allocated;
+
+    if (!allocated)
+    {
+        // Never let a pass draw into framebuffer 0 because its target is missing
+        for (auto& pass : passes)
+        {
+            for (auto id : pass.writes)
+            {
+                const auto& resource = resources[static_cast<size_t>(id)];
+                if (resource.kind != Kind::Imported && resource.target == nullptr)
+                    pass.live = false;
+            }
+        }
+    }
+
+    stats.passes = static_cast<int>(passes.size());
+    for (const auto& pass : passes)
+        stats.culledPasses += pass.live ? 0 : 1;
+
+    compiled = true;
+    return allocated;
+}
+
+void RenderGraph::cull()
+{
+    for (auto& pass : passes)
+        pass.live = pass.sideEffect;
+
+    // Writers of anything needed after the frame
+    for (const auto& resource : resources)
+    {
+        if (resource.keep && resource.lastWriter >= 0)
+            passes[static_cast<size_t>(resource.lastWriter)].live = true;
+    }
+
+    // Producers always come before their readers, so one backwards sweep
+    // carries liveness through the whole chain
+    for (int i = static_cast<int>(passes.size()) - 1; i >= 0; --i)
+    {
+        const auto& pass = passes[static_cast<size_t>(i)];
+        if (!pass.live)
+            continue;
+
+        for (auto producer : pass.producers)
+            passes[static_cast<size_t>(producer)].live = true;
+    }
+}
+
+void RenderGraph::computeLifetimes()
+{
+    for (int i = 0; i < static_cast<int>(passes.size()); ++i)
+    {
+        const auto& pass = passes[static_cast<size_t>(i)];
+        if (!pass.live)
+            continue;
+
+        auto touch = [this, i](ResourceId id)
+        {
+            auto& resource = resources[static_cast<size_t>(id)];
+            if (resource.firstUse < 0)
+                resource.firstUse = i;
+            resource.lastUse = i;
+        };
+
+        for (auto id : pass.reads)
+            touch(id);
+        for (auto id : pass.writes)
+            touch(id);
+    }
+}
+
+bool RenderGraph::allocateRetained()
+{
+    bool allocated = true;
+
+    for (auto& resource : resources)
+    {
+        if (resource.kind != Kind::Retained)
+            continue;
+
+        auto& entry = retained[static_cast<size_t>(resource.retainedIndex)];
+
+        if (resource.firstUse < 0 && !resource.historyRead)
+        {
+            // No live pass touches it this frame; stale contents aren't worth the memory
+            pool.release(entry.target);
+            entry.target = nullptr;
+            continue;
+        }
+
+        if (entry.target == nullptr)
+            entry.target = pool.acquire(resource.desc.format, resource.desc.width, resource.desc.height);
+
+        resource.target = entry.target;
+        allocated = allocated && entry.target != nullptr;
+
+        if (entry.target != nullptr)
+            stats.retainedBytes += entry.target->sizeInBytes;
+    }
+
+    // Retained textures nobody declared this frame
+    for (auto& entry : retained)
+    {
+        if (!entry.declared)
+        {
+            pool.release(entry.target);
+            entry.target = nullptr;
+        }
+    }
+
+    return allocated;
+}
+
+bool RenderGraph::allocateTransients()
+{
+    bool allocated = true;
+
+    for (int i = 0; i < static_cast<int>(passes.size()); ++i)
+    {
+        if (!passes[static_cast<size_t>(i)].live)
+            continue;
+
+        for (auto& resource : resources)
+        {
+            if (resource.kind != Kind::Transient || resource.firstUse != i)
+                continue;
+
+            stats.transients++;
+            stats.transientBytes += getBytes(resource.desc);
+
+            // Alias a target whose previous user is finished with it
+            for (int p = 0; p < static_cast<int>(transientTargets.size()); ++p)
+            {
+                auto& physical = transientTargets[static_cast<size_t>(p)];
+                if (physical.freeAfter < i && physical.desc == resource.desc)
+                {
+                    resource.physical = p;
+                    break;
+                }
+            }
+
+            if (resource.physical < 0)
+            {
+                PhysicalTarget physical;
+                physical.desc = resource.desc;
+                physical.target = pool.acquire(resource.desc.format, resource.desc.width, resource.desc.height);
+
+                if (physical.target == nullptr)
+                {
+                    allocated = false;
+                    continue;
+                }
+
+                stats.transientTargets++;
+                stats.transientTargetBytes += physical.target->sizeInBytes;
+
+                transientTargets.push_back(physical);
+                resource.physical = static_cast<int>(transientTargets.size()) - 1;
+            }
+
+            auto& physical = transientTargets[static_cast<size_t>(resource.physical)];
+            physical.freeAfter = resource.lastUse;
+            resource.target = physical.target;
+        }
+    }
+
+    return allocated;
+}
+
+void RenderGraph::execute(const GroupHook& groupHook)
+{
+    jassert(compiled);
+
+    Resources view(*this);
+    int openGroup = -1;
+
+    for (const auto& pass : passes)
+    {
+        if (!pass.live)
+            continue;
+
+        if (groupHook && pass.group != openGroup)
+        {
+            if (openGroup >= 0)
+                groupHook(openGroup, false);
+            if (pass.group >= 0)
+                groupHook(pass.group, true);
+            openGroup = pass.group;
+        }
+
+        if (pass.execute)
+            pass.execute(view);
+    }
+
+    if (groupHook && openGroup >= 0)
+        groupHook(openGroup, false);
+
+    releaseTransients();
+    compiled = false;
+}
+
+void RenderGraph::releaseTransients()
+{
+    for (auto& physical : transientTargets)
+        pool.release(physical.target);
+
+    transientTargets.clear();
+
+    for (auto& resource : resources)
+    {
+        if (resource.kind == Kind::Transient)
+            resource.target = nullptr;
+    }
+}
+
+void RenderGraph::releaseRetained()
+{
+    for (auto& entry : retained)
+        pool.release(entry.target);
+
+    retained.clear();
+
+    for (auto& resource : resources)
+    {
+        if (resource.kind == Kind::Retained)
+            resource.target = nullptr;
+    }
+}
+
+bool RenderGraph::isPassLive(const char* name) const
+{
+    for (const auto& pass : passes)
+    {
+        if (pass.name == name)
+            return pass.live;
+    }
+
+    return false;
+}
+
+//==============================================================================
+std::string RenderGraph::getPlan() const
+{
+    std::ostringstream plan;
+
+    plan << "Frame plan: " << stats.passes << " passes, "
+         << (stats.passes - stats.culledPasses) << " live, " << stats.culledPasses << " culled\n"
+         << "  transient: " << stats.transients << " textures in " << stats.transientTargets
+         << " targets, " << formatBytes(stats.transientTargetBytes)
+         << " (" << formatBytes(stats.transientBytes) << " without aliasing)\n"
+         << "  retained: " << formatBytes(stats.retainedBytes) << "\n\n";
+
+    auto names = [this](const std::vector<ResourceId>& ids, int passIndex)
+    {
+        std::string list;
+        for (auto id : ids)
+        {
+            const auto& resource = resources[static_cast<size_t>(id)];
+            if (!list.empty())
+                list += ", ";
+            list += resource.name;
+
+            // Retained texture read before this frame writes it
+            if (passIndex >= 0 && resource.kind == Kind::Retained
+                && (resource.firstWriter < 0 || passIndex <= resource.firstWriter))
+                list += " (last frame)";
+        }
+        return list.empty() ? std::string("-") : list;
+    };
+
+    plan << "Passes (in order)\n";
+    for (int i = 0; i < static_cast<int>(passes.size()); ++i)
+    {
+        const auto& pass = passes[static_cast<size_t>(i)];
+        plan << "  " << std::setw(2) << i << "  " << std::left << std::setw(16) << pass.name << std::right;
+
+        if (!pass.live)
+        {
+            plan << "culled\n";
+            continue;
+        }
+
+        plan << "reads " << names(pass.reads, i) << "  writes " << names(pass.writes, -1) << "\n";
+    }
+
+    plan << "\nTextures\n";
+    for (const auto& resource : resources)
+    {
+        const char* kind = resource.kind == Kind::Imported ? "imported"
+                         : resource.kind == Kind::Retained ? "retained" : "transient";
+
+        plan << "  " << std::left << std::setw(16) << resource.name << std::setw(10) << kind
+             << std::setw(11) << RenderTargetPool::getFormatName(resource.desc.format) << std::right
+             << std::setw(5) << resource.desc.width << "x" << std::left << std::setw(5) << resource.desc.height
+             << std::right << std::setw(10) << formatBytes(getBytes(resource.desc));
+
+        if (resource.firstUse < 0)
+            plan << "  unused";
+        else
+            plan << "  passes " << resource.firstUse << "-" << resource.lastUse;
+
+        if (resource.physical >= 0)
+            plan << "  target T" << resource.physical;
+        if (resource.keep)
+            plan << "  kept";
+
+        plan << "\n";
+    }
+
+    return plan.str();
+}
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "RenderTargetPool.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @class RenderGraph
+ * @brief Per-frame graph of GPU passes and the textures they read and write
+ *
+ * Each frame the renderer declares its passes in execution order, and for
+ * each pass the textures it reads and writes. compile() then
+ * - culls passes whose outputs nobody needs
+ * - works out when each transient texture is first and last used
+ * - backs transients from the RenderTargetPool, aliasing transients whose
+ *   lifetimes don't overlap onto the same target
+ * and execute() runs the surviving passes.
+ *
+ * Textures come in three kinds:
+ * - imported: owned elsewhere (feedback buffers, the output framebuffer).
+ *   Writing one is visible outside the graph, so its writers always run.
+ * - retained: owned by the graph and kept from frame to frame by name
+ *   (the blur levels the next warp pass samples). Reading one before any
+ *   pass writes it this frame reads last frame's contents and keeps the
+ *   texture alive for the next frame; retained textures no live pass
+ *   touches go back to the pool.
+ * - transient: only valid within the frame.
+ *
+ * getPlan() describes the compiled frame (passes, culling, every texture
+ * and its memory) for debugging VRAM use.
+ */
+class RenderGraph
+{
+public:
+    using ResourceId = int;
+
+    struct TextureDesc
+    {
+        RenderTargetFormat format = RenderTargetFormat::RGBA8;
+        int width = 0;
+        int height = 0;
+
+        bool operator==(const TextureDesc& other) const
+        {
+            return format == other.format && width == other.width && height == other.height;
+        }
+    };
+
+    /** What a pass sees when it runs */
+    class Resources
+    {
+    public:
+        unsigned int getTexture(ResourceId id) const;
+        unsigned int getFramebuffer(ResourceId id) const;
+        int getWidth(ResourceId id) const;
+        int getHeight(ResourceId id) const;
+
+    private:
+        friend class RenderGraph;
+        explicit Resources(const RenderGraph& g) : graph(g) {}
+        const RenderGraph& graph;
+    };
+
+    using ExecuteFunction = std::function<void(const Resources&)>;
+    using GroupHook = std::function<void(int group, bool begin)>;
+
+    /** Declares one pass's inputs and outputs; returned by addPass() */
+    class PassBuilder
+    {
+    public:
+        void read(ResourceId id);
+        void write(ResourceId id);
+
+        /** Run even if no other pass uses the outputs (e.g. readbacks) */
+        void setSideEffect();
+
+        /** Consecutive live passes of one group are bracketed by execute()'s hook */
+        void setGroup(int group);
+
+    private:
+        friend class RenderGraph;
+        PassBuilder(RenderGraph& g, int index) : graph(g), passIndex(index) {}
+        RenderGraph& graph;
+        int passIndex;
+    };
+
+    struct Stats
+    {
+        int passes = 0;
+        int culledPasses = 0;
+        int transients = 0;
+        int transientTargets = 0;        // Pool targets backing the transients
+        size_t transientBytes = 0;       // What the transients would need unaliased
+        size_t transientTargetBytes = 0; // What they actually use
+        size_t retainedBytes = 0;
+    };
+
+    explicit RenderGraph(RenderTargetPool& pool);
+    ~RenderGraph();
+
+    //==========================================================================
+    // Declaration (each frame)
+
+    /** Forget last frame's passes; retained textures stay */
+    void reset();
+
+    ResourceId importTexture(const char* name, const TextureDesc& desc,
+                             unsigned int texture, unsigned int framebuffer);
+
+    /** A texture that only lives within this frame; a pass must write it before any reads it */
+    ResourceId createTexture(const char* name, const TextureDesc& desc);
+
+    /** A texture kept across frames under this name; reallocated if the desc changes */
+    ResourceId retainedTexture(const char* name, const TextureDesc& desc);
+
+    /** Passes run in the order they are added */
+    PassBuilder addPass(const char* name, ExecuteFunction execute);
+
+    TextureDesc getDesc(ResourceId id) const { return getResource(id).desc; }
+
+    //==========================================================================
+    // Per frame, after declaration
+
+    /** Cull, schedule and allocate; returns false if a target couldn't be allocated */
+    bool compile();
+
+    /**
+     * @brief Run the live passes, then return the transients to the pool
+     * @param groupHook Called before the first and after the last pass of
+     *                  each run of same-group passes (e.g. profiler stages)
+     */
+    void execute(const GroupHook& groupHook = nullptr);
+
+    /** Whether a pass survived culling (after compile()) */
+    bool isPassLive(const char* name) const;
+
+    //==========================================================================
+    // Debugging
+    Stats getStats() const { return stats; }
+    std::string getPlan() const;
+
+    /** Return every retained texture to the pool (requires the GL context) */
+    void releaseRetained();
+
+private:
+    enum class Kind { Imported, Retained, Transient };
+
+    struct Resource
+    {
+        std::string name;
+        Kind kind = Kind::Transient;
+        TextureDesc desc;
+        unsigned int texture = 0;
+        unsigned int framebuffer = 0;
+        RenderTarget* target = nullptr;   // Retained and transient, once allocated
+        int retainedIndex = -1;
+        bool keep = false;                // Contents needed after this frame
+        bool historyRead = false;         // Retained: read before written (last frame's contents)
+        int firstWriter = -1;
+        int lastWriter = -1;
+        int firstUse = -1;                // Live passes only, after compile()
+        int lastUse = -1;
+        int physical = -1;                // Transients: index into transientTargets
+    };
+
+    struct Pass
+    {
+        std::string name;
+        ExecuteFunction execute;
+        std::vector<ResourceId> reads;
+        std::vector<ResourceId> writes;
+        std::vector<int> producers;       // Passes whose output this pass reads
+        int group = -1;
+        bool sideEffect = false;
+        bool live = false;
+    };
+
+    struct Retained
+    {
+        std::string name;
+        TextureDesc desc;
+        RenderTarget* target = nullptr;
+        bool declared = false;            // This frame
+    };
+
+    struct PhysicalTarget
+    {
+        RenderTarget* target = nullptr;
+        TextureDesc desc;
+        int freeAfter = -1;               // Last pass index using it so far
+    };
+
+    ResourceId addResource(Resource resource);
+    void cull();
+    void computeLifetimes();
+    bool allocateRetained();
+    bool allocateTransients();
+    void releaseTransients();
+    const Resource& getResource(ResourceId id) const;
+
+    RenderTargetPool& pool;
+    std::vector<Pass> passes;
+    std::vector<Resource> resources;
+    std::vector<Retained> retained;
+    std::vector<PhysicalTarget> transientTargets;
+    Stats stats;
+    bool compiled = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RenderGraph)
+};
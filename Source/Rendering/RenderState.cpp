@@ -1,7 +1,8 @@
 #include "RenderState.h"
 #include <cmath>
 
-RenderState::RenderState()
+RenderState::RenderState(bool shouldCompileShaders)
+    : compileShaders(shouldCompileShaders)
 {
     perFrameInitEval = std::make_unique<MilkdropEval>();
     perFrameEval = std::make_unique<MilkdropEval>();
@@ -16,9 +17,10 @@ void RenderState::reset()
 {
     context = MilkDrop::ExecutionContext();
     frameCount = 0;
-    totalTime = 0.0f;
+    totalTime = 0.0;
     perFrameInitExecuted = false;
     currentPreset = nullptr;
+    retirePrepared();
 
     perFrameInitEval->clear();
     perFrameEval->clear();
@@ -60,31 +62,82 @@ bool RenderState::loadPreset(const MilkDropPreset& preset)
         }
     }
 
-    // Compile shaders
-    if (!preset.warpShaderCode.empty())
+    // Compile shaders; identical sources share one linked program
+    if (compileShaders)
     {
-        warpShader = shaderCompiler.compileMilkDropShader(
-            preset.warpShaderCode,
-            MilkDrop::ShaderType::Warp);
-    }
-    else
-    {
-        warpShader = shaderCompiler.createDefaultShader(MilkDrop::ShaderType::Warp);
+        warpShader = programCache.get(shaderCompiler.translateMilkDropShader(
+            preset.warpShaderCode, MilkDrop::ShaderType::Warp));
+        compositeShader = programCache.get(shaderCompiler.translateMilkDropShader(
+            preset.compShaderCode, MilkDrop::ShaderType::Composite));
     }
 
-    if (!preset.compShaderCode.empty())
-    {
-        compositeShader = shaderCompiler.compileMilkDropShader(
-            preset.compShaderCode,
-            MilkDrop::ShaderType::Composite);
-    }
-    else
+    applyPresetParameters(preset);
+    return true;
+}
+
+bool RenderState::loadPrepared(std::unique_ptr<PreparedPreset> preparedPreset)
+{
+    if (preparedPreset == nullptr)
+        return false;
+
+    reset();
+    prepared = std::move(preparedPreset);
+    currentPreset = &prepared->preset;
+
+    perFrameInitEval = std::move(prepared->perFrameInitEval);
+    perFrameEval = std::move(prepared->perFrameEval);
+    perPixelEval = std::move(prepared->perPixelEval);
+
+    if (compileShaders)
     {
-        compositeShader = shaderCompiler.createDefaultShader(MilkDrop::ShaderType::Composite);
+        warpShader = programCache.get(prepared->warpFragmentSource);
+        compositeShader = programCache.get(prepared->compositeFragmentSource);
     }
 
+    applyPresetParameters(prepared->preset);
+    return true;
+}
+
+void RenderState::retirePrepared()
+{
+    if (prepared == nullptr)
+        return;
+
+    // Give the compiled code back so the preset can be shown again as it is
+    prepared->perFrameInitEval = std::move(perFrameInitEval);
+    prepared->perFrameEval = std::move(perFrameEval);
+    prepared->perPixelEval = std::move(perPixelEval);
+    prepared->warpShader = warpShader;
+    prepared->compositeShader = compositeShader;
+
+    perFrameInitEval = std::make_unique<MilkdropEval>();
+    perFrameEval = std::make_unique<MilkdropEval>();
+    perPixelEval = std::make_unique<MilkdropEval>();
+
+    retired = std::move(prepared);
+}
+
+bool RenderState::warmPrograms(const PreparedPreset& preparedPreset)
+{
+    if (!compileShaders)
+        return false;
+
+    const bool linkedWarp = programCache.warm(preparedPreset.warpFragmentSource);
+    const bool linkedComposite = programCache.warm(preparedPreset.compositeFragmentSource);
+    return linkedWarp || linkedComposite;
+}
+
+void RenderState::releasePrograms()
+{
+    warpShader.reset();
+    compositeShader.reset();
+    programCache.releaseGL();
+}
+
+void RenderState::applyPresetParameters(const MilkDropPreset& preset)
+{
     // Initialize preset parameters into context
-    context.zoom = preset.fDecay;
+    context.decay = preset.fDecay;
     context.rot = preset.fRot;
     context.cx = preset.fRotCX;
     context.cy = preset.fRotCY;
@@ -98,8 +151,6 @@ bool RenderState::loadPreset(const MilkDropPreset& preset)
     context.wave_g = preset.wave_g;
     context.wave_b = preset.wave_b;
     context.wave_a = 1.0f;
-
-    return true;
 }
 
 MilkDrop::ExecutionContext& RenderState::executeFrame(float deltaTime)
@@ -131,6 +182,12 @@ MilkDrop::ExecutionContext& RenderState::executeFrame(float deltaTime)
     return context;
 }
 
+void RenderState::setClock(int64_t frameNumber, double elapsedSeconds)
+{
+    frameCount = frameNumber;
+    totalTime = elapsedSeconds;
+}
+
 void RenderState::updateAudioData(float bass, float mid, float treb,
                                   float bassAtt, float midAtt, float trebAtt)
 {
@@ -3,7 +3,9 @@
 #include "../Expression/ExpressionTypes.h"
 #include "../Expression/MilkdropEval.h"
 #include "../Presets/Preset.h"
+#include "PreparedPreset.h"
 #include "ShaderCompiler.h"
+#include "ShaderProgramCache.h"
 #include "ShaderTypes.h"
 #include <memory>
 
@@ -17,7 +19,11 @@
 class RenderState
 {
 public:
-    RenderState();
+    /**
+     * @param compileShaders false skips the warp/composite shaders, which
+     *        need a GL context (the software renderer only runs expressions)
+     */
+    explicit RenderState(bool compileShaders = true);
     ~RenderState();
 
     /**
@@ -27,6 +33,32 @@ public:
      */
     bool loadPreset(const MilkDropPreset& preset);
 
+    /**
+     * @brief Switch to a preset that was compiled and translated off-thread
+     *
+     * Takes the compiled expressions over instead of compiling them, and
+     * only looks its programs up in the program cache (linking them if
+     * warmPrograms() hasn't). The state owns the preset from then on.
+     */
+    bool loadPrepared(std::unique_ptr<PreparedPreset> prepared);
+
+    /**
+     * @brief The prepared preset the last load or reset() replaced, if any
+     *
+     * It has its evaluators and programs back, ready to be loaded again.
+     * Only the most recent one is kept.
+     */
+    std::unique_ptr<PreparedPreset> takeRetired() { return std::move(retired); }
+
+    /**
+     * @brief Link a prepared preset's programs ahead of its loadPrepared()
+     * @return true if anything had to be linked
+     */
+    bool warmPrograms(const PreparedPreset& prepared);
+
+    /** Delete the cached programs; needs the GL context */
+    void releasePrograms();
+
     /**
      * @brief Execute per-frame code and update state
      * @param deltaTime Time since last frame (seconds)
@@ -34,6 +66,19 @@ public:
      */
     MilkDrop::ExecutionContext& executeFrame(float deltaTime);
 
+    /**
+     * @brief Set the frame counter and elapsed time before the next executeFrame()
+     *
+     * Offline renders set this every frame so `time` is exact rather than
+     * accumulated, and a render started part-way through a timeline sees
+     * the same clock as one that started at frame 0.
+     */
+    void setClock(int64_t frameNumber, double elapsedSeconds);
+
+    /** The clock the next executeFrame() continues from */
+    int64_t getFrameCount() const { return frameCount; }
+    double getElapsedSeconds() const { return totalTime; }
+
     /**
      * @brief Get the current execution context
      */
@@ -80,18 +125,25 @@ private:
     std::unique_ptr<MilkdropEval> perFrameEval;
     std::unique_ptr<MilkdropEval> perPixelEval;
 
-    // Compiled shaders
-    std::unique_ptr<MilkDrop::CompiledShader> warpShader;
-    std::unique_ptr<MilkDrop::CompiledShader> compositeShader;
+    // Compiled shaders, shared with the program cache
+    std::shared_ptr<MilkDrop::CompiledShader> warpShader;
+    std::shared_ptr<MilkDrop::CompiledShader> compositeShader;
 
-    // Shader compiler
+    // Shader translation and linked programs
     ShaderCompiler shaderCompiler;
+    ShaderProgramCache programCache;
+    const bool compileShaders;
 
-    // Current preset (not owned)
+    // Current preset (not owned, unless it came from loadPrepared())
     const MilkDropPreset* currentPreset = nullptr;
+    std::unique_ptr<PreparedPreset> prepared;
+    std::unique_ptr<PreparedPreset> retired;
+
+    void retirePrepared();
+    void applyPresetParameters(const MilkDropPreset& preset);
 
     // Frame tracking
-    int frameCount = 0;
-    float totalTime = 0.0f;
+    int64_t frameCount = 0;
+    double totalTime = 0.0;
     bool perFrameInitExecuted = false;
 };
@@ -0,0 +1,254 @@
+#include "RenderTargetPool.h"
+
+using namespace juce::gl;
+
+RenderTargetPool::RenderTargetPool()
+{
+}
+
+RenderTargetPool::~RenderTargetPool()
+{
+    cleanup();
+}
+
+void RenderTargetPool::setBaseSize(int width, int height)
+{
+    baseWidth = width;
+    baseHeight = height;
+}
+
+RenderTarget* RenderTargetPool::acquire(RenderTargetFormat format, RenderTargetSize size)
+{
+    int divisor = static_cast<int>(size);
+    return acquire(format,
+                   juce::jmax(1, baseWidth / divisor),
+                   juce::jmax(1, baseHeight / divisor));
+}
+
+RenderTarget* RenderTargetPool::acquire(RenderTargetFormat format, int width, int height)
+{
+    if (width <= 0 || height <= 0)
+        return nullptr;
+
+    if (!isFormatSupported(format))
+        format = RenderTargetFormat::RGBA8;
+
+    // Reuse an idle target with matching format and dimensions
+    for (auto& entry : entries)
+    {
+        auto& t = *entry.target;
+        if (!entry.inUse && t.format == format && t.width == width && t.height == height)
+        {
+            entry.inUse = true;
+            bytesInUse += t.sizeInBytes;
+            numReuses++;
+            return entry.target.get();
+        }
+    }
+
+    auto target = std::make_unique<RenderTarget>();
+    target->width = width;
+    target->height = height;
+    target->format = format;
+
+    if (!createTarget(*target))
+    {
+        destroyTarget(*target);
+
+        if (format == RenderTargetFormat::RGBA8)
+            return nullptr;
+
+        // Float formats are optional on some drivers; fall back to RGBA8
+        DBG("FlarkViz: " << getFormatName(format) << " render targets unsupported, using RGBA8");
+        formatUnsupported[static_cast<int>(format)] = true;
+        return acquire(RenderTargetFormat::RGBA8, width, height);
+    }
+
+    target->sizeInBytes = static_cast<size_t>(width) * static_cast<size_t>(height)
+                        * getBytesPerPixel(format);
+
+    bytesAllocated += target->sizeInBytes;
+    bytesInUse += target->sizeInBytes;
+    numAllocations++;
+
+    Entry entry;
+    entry.target = std::move(target);
+    entry.inUse = true;
+    entries.push_back(std::move(entry));
+
+    // A new allocation may push idle targets over budget
+    trim();
+
+    return entries.back().target.get();
+}
+
+void RenderTargetPool::release(RenderTarget* target)
+{
+    if (target == nullptr)
+        return;
+
+    for (auto& entry : entries)
+    {
+        if (entry.target.get() == target && entry.inUse)
+        {
+            entry.inUse = false;
+            entry.lastReleased = ++releaseCounter;
+            bytesInUse -= target->sizeInBytes;
+            break;
+        }
+    }
+
+    trim();
+}
+
+void RenderTargetPool::setCacheBudget(size_t bytes)
+{
+    cacheBudget = bytes;
+    trim();
+}
+
+void RenderTargetPool::trim()
+{
+    while (getBytesCached() > cacheBudget)
+    {
+        // Evict the idle target that was released longest ago
+        auto oldest = entries.end();
+        for (auto it = entries.begin(); it != entries.end(); ++it)
+        {
+            if (!it->inUse && (oldest == entries.end() || it->lastReleased < oldest->lastReleased))
+                oldest = it;
+        }
+
+        if (oldest == entries.end())
+            break;
+
+        bytesAllocated -= oldest->target->sizeInBytes;
+        destroyTarget(*oldest->target);
+        entries.erase(oldest);
+    }
+}
+
+void RenderTargetPool::purgeUnused()
+{
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+        if (!it->inUse)
+        {
+            bytesAllocated -= it->target->sizeInBytes;
+            destroyTarget(*it->target);
+            it = entries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void RenderTargetPool::cleanup()
+{
+    for (auto& entry : entries)
+        destroyTarget(*entry.target);
+
+    entries.clear();
+    bytesAllocated = 0;
+    bytesInUse = 0;
+}
+
+bool RenderTargetPool::isFormatSupported(RenderTargetFormat format) const
+{
+    return !formatUnsupported[static_cast<int>(format)];
+}
+
+size_t RenderTargetPool::getBytesPerPixel(RenderTargetFormat format)
+{
+    switch (format)
+    {
+        case RenderTargetFormat::RGBA8:      return 4;
+        case RenderTargetFormat::RGBA16F:    return 8;
+        case RenderTargetFormat::R11G11B10F: return 4;
+    }
+    return 4;
+}
+
+const char* RenderTargetPool::getFormatName(RenderTargetFormat format)
+{
+    switch (format)
+    {
+        case RenderTargetFormat::RGBA8:      return "RGBA8";
+        case RenderTargetFormat::RGBA16F:    return "RGBA16F";
+        case RenderTargetFormat::R11G11B10F: return "R11G11B10F";
+    }
+    return "unknown";
+}
+
+bool RenderTargetPool::createTarget(RenderTarget& target)
+{
+    GLint internalFormat = GL_RGBA8;
+    GLenum pixelFormat = GL_RGBA;
+    GLenum pixelType = GL_UNSIGNED_BYTE;
+
+    switch (target.format)
+    {
+        case RenderTargetFormat::RGBA8:
+            break;
+        case RenderTargetFormat::RGBA16F:
+            internalFormat = GL_RGBA16F;
+            pixelType = GL_HALF_FLOAT;
+            break;
+        case RenderTargetFormat::R11G11B10F:
+            internalFormat = GL_R11F_G11F_B10F;
+            pixelFormat = GL_RGB;
+            pixelType = GL_FLOAT;
+            break;
+    }
+
+    // Create texture
+    glGenTextures(1, &target.texture);
+    glBindTexture(GL_TEXTURE_2D, target.texture);
+
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, target.width, target.height, 0,
+                 pixelFormat, pixelType, nullptr);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // Create framebuffer
+    glGenFramebuffers(1, &target.fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                          GL_TEXTURE_2D, target.texture, 0);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        DBG("FlarkViz: " << getFormatName(target.format) << " render target "
+            << target.width << "x" << target.height << " not complete: " << status);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return false;
+    }
+
+    // Start from black so the first feedback frame is well-defined
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return true;
+}
+
+void RenderTargetPool::destroyTarget(RenderTarget& target)
+{
+    if (target.fbo != 0)
+    {
+        glDeleteFramebuffers(1, &target.fbo);
+        target.fbo = 0;
+    }
+
+    if (target.texture != 0)
+    {
+        glDeleteTextures(1, &target.texture);
+        target.texture = 0;
+    }
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <memory>
+#include <vector>
+
+/**
+ * @enum RenderTargetFormat
+ * @brief Colour formats available for offscreen render targets
+ *
+ * RGBA8 is the classic MilkDrop format but bands badly when the feedback
+ * loop repeatedly multiplies by fDecay. RGBA16F keeps enough precision for
+ * long trails to fade smoothly; R11G11B10F is a cheaper HDR option when
+ * the alpha channel is not needed.
+ */
+enum class RenderTargetFormat
+{
+    RGBA8,
+    RGBA16F,
+    R11G11B10F
+};
+
+/**
+ * @enum RenderTargetSize
+ * @brief Size classes relative to the pool's base (viewport) size
+ */
+enum class RenderTargetSize
+{
+    Full = 1,
+    Half = 2,
+    Quarter = 4,
+    Eighth = 8
+};
+
+/**
+ * @struct RenderTarget
+ * @brief A texture with an attached framebuffer object
+ */
+struct RenderTarget
+{
+    unsigned int fbo = 0;
+    unsigned int texture = 0;
+    int width = 0;
+    int height = 0;
+    RenderTargetFormat format = RenderTargetFormat::RGBA8;
+    size_t sizeInBytes = 0;
+};
+
+/**
+ * @class RenderTargetPool
+ * @brief Hands out render targets by format and size, reusing allocations
+ *
+ * Released targets are kept in the pool and handed back out when a target
+ * with the same format and dimensions is requested again, so window resizes
+ * (e.g. toggling fullscreen), double-preset mode and blur passes do not
+ * reallocate GPU memory every time. Idle targets are evicted oldest-first
+ * once they exceed the cache budget.
+ */
+class RenderTargetPool
+{
+public:
+    RenderTargetPool();
+    ~RenderTargetPool();
+
+    /**
+     * @brief Set the base size that size classes are resolved against
+     */
+    void setBaseSize(int width, int height);
+
+    int getBaseWidth() const { return baseWidth; }
+    int getBaseHeight() const { return baseHeight; }
+
+    /**
+     * @brief Acquire a target of the given format and size class
+     * @return Target owned by the pool, or nullptr on failure
+     */
+    RenderTarget* acquire(RenderTargetFormat format, RenderTargetSize size = RenderTargetSize::Full);
+
+    /**
+     * @brief Acquire a target with explicit dimensions
+     * @return Target owned by the pool, or nullptr on failure
+     */
+    RenderTarget* acquire(RenderTargetFormat format, int width, int height);
+
+    /**
+     * @brief Return a target to the pool so it can be reused
+     */
+    void release(RenderTarget* target);
+
+    /**
+     * @brief Set how many bytes of idle targets may stay allocated
+     */
+    void setCacheBudget(size_t bytes);
+
+    /**
+     * @brief Free idle targets until the cache budget is met
+     */
+    void trim();
+
+    /**
+     * @brief Free all idle targets
+     */
+    void purgeUnused();
+
+    /**
+     * @brief Delete every target (requires an active GL context)
+     */
+    void cleanup();
+
+    //==========================================================================
+    // Memory accounting
+    size_t getBytesInUse() const { return bytesInUse; }
+    size_t getBytesCached() const { return bytesAllocated - bytesInUse; }
+    size_t getBytesAllocated() const { return bytesAllocated; }
+    int getNumTargets() const { return static_cast<int>(entries.size()); }
+    int getNumAllocations() const { return numAllocations; }
+    int getNumReuses() const { return numReuses; }
+
+    /**
+     * @brief Check whether a format can be rendered to on this context
+     *
+     * Only meaningful after a target of that format has been requested;
+     * unsupported formats fall back to RGBA8.
+     */
+    bool isFormatSupported(RenderTargetFormat format) const;
+
+    static size_t getBytesPerPixel(RenderTargetFormat format);
+    static const char* getFormatName(RenderTargetFormat format);
+
+private:
+    struct Entry
+    {
+        std::unique_ptr<RenderTarget> target;
+        bool inUse = false;
+        uint64_t lastReleased = 0;
+    };
+
+    std::vector<Entry> entries;
+
+    int baseWidth = 0;
+    int baseHeight = 0;
+
+    size_t cacheBudget = 256 * 1024 * 1024;
+    size_t bytesAllocated = 0;
+    size_t bytesInUse = 0;
+    uint64_t releaseCounter = 0;
+
+    int numAllocations = 0;
+    int numReuses = 0;
+
+    bool formatUnsupported[3] = {false, false, false};
+
+    bool createTarget(RenderTarget& target);
+    void destroyTarget(RenderTarget& target);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RenderTargetPool)
+};
@@ -0,0 +1,160 @@
+#include "ResolutionScaler.h"
+#include <algorithm>
+#include <cmath>
+
+ResolutionScaler::ResolutionScaler()
+{
+    reset();
+}
+
+void ResolutionScaler::setSettings(const Settings& newSettings)
+{
+    settings = newSettings;
+    settings.minScale = std::clamp(settings.minScale, 0.1f, 1.0f);
+    settings.maxScale = std::clamp(settings.maxScale, settings.minScale, 1.0f);
+    settings.step = std::max(settings.step, 0.01f);
+
+    scale = quantise(scale);
+    framesOver = 0;
+    framesUnder = 0;
+}
+
+void ResolutionScaler::setEnabled(bool shouldBeEnabled)
+{
+    if (enabled == shouldBeEnabled)
+        return;
+
+    enabled = shouldBeEnabled;
+
+    if (!enabled && scale != settings.maxScale)
+        changeScale(settings.maxScale);
+
+    framesOver = 0;
+    framesUnder = 0;
+}
+
+void ResolutionScaler::reset()
+{
+    scale = settings.maxScale;
+    averageMs = 0.0;
+    lastMs = 0.0;
+    haveAverage = false;
+    framesOver = 0;
+    framesUnder = 0;
+    cooldown = 0;
+    frameCounter = 0;
+    numScaleDowns = 0;
+    numScaleUps = 0;
+    decisions.clear();
+}
+
+bool ResolutionScaler::addFrameTime(double frameMs)
+{
+    frameCounter++;
+    lastMs = frameMs;
+
+    if (!haveAverage)
+    {
+        averageMs = frameMs;
+        haveAverage = true;
+    }
+    else
+    {
+        averageMs = averageMs * settings.smoothing + frameMs * (1.0 - settings.smoothing);
+    }
+
+    if (!enabled)
+        return false;
+
+    // Let the new resolution settle before judging it
+    if (cooldown > 0)
+    {
+        cooldown--;
+        return false;
+    }
+
+    if (averageMs > settings.targetFrameMs * settings.downThreshold)
+    {
+        framesOver++;
+        framesUnder = 0;
+    }
+    else if (averageMs < settings.targetFrameMs * settings.upThreshold)
+    {
+        framesUnder++;
+        framesOver = 0;
+    }
+    else
+    {
+        framesOver = 0;
+        framesUnder = 0;
+    }
+
+    if (framesOver >= settings.framesBeforeDown && scale > settings.minScale)
+    {
+        // Pixel cost scales with area, so estimate the scale that fits the
+        // budget but never drop more than two steps at once
+        double ratio = settings.targetFrameMs * settings.upThreshold / averageMs;
+        float wanted = scale * static_cast<float>(std::sqrt(std::max(ratio, 0.0)));
+        float newScale = std::max(quantise(wanted), scale - 2.0f * settings.step);
+        newScale = std::min(newScale, scale - settings.step);
+
+        changeScale(quantise(newScale));
+        return true;
+    }
+
+    if (framesUnder >= settings.framesBeforeUp && scale < settings.maxScale)
+    {
+        changeScale(quantise(scale + settings.step));
+        return true;
+    }
+
+    return false;
+}
+
+ResolutionScaler::Stats ResolutionScaler::getStats() const
+{
+    Stats stats;
+    stats.scale = scale;
+    stats.averageFrameMs = averageMs;
+    stats.lastFrameMs = lastMs;
+    stats.targetFrameMs = settings.targetFrameMs;
+    stats.numScaleDowns = numScaleDowns;
+    stats.numScaleUps = numScaleUps;
+    stats.framesMeasured = frameCounter;
+    return stats;
+}
+
+float ResolutionScaler::quantise(float value) const
+{
+    // Steps are counted down from maxScale so full resolution is always reachable
+    float steps = std::round((settings.maxScale - value) / settings.step);
+    float result = settings.maxScale - steps * settings.step;
+    return std::clamp(result, settings.minScale, settings.maxScale);
+}
+
+void ResolutionScaler::changeScale(float newScale)
+{
+    Decision decision;
+    decision.frame = frameCounter;
+    decision.oldScale = scale;
+    decision.newScale = newScale;
+    decision.averageFrameMs = averageMs;
+    decision.targetFrameMs = settings.targetFrameMs;
+
+    if (newScale < scale)
+        numScaleDowns++;
+    else
+        numScaleUps++;
+
+    scale = newScale;
+    framesOver = 0;
+    framesUnder = 0;
+    cooldown = settings.cooldownFrames;
+
+    if (decisions.size() >= maxDecisions)
+        decisions.erase(decisions.begin());
+    decisions.push_back(decision);
+
+    if (onScaleChanged)
+        onScaleChanged(decision);
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+/**
+ * @class ResolutionScaler
+ * @brief Picks an internal render scale from measured frame times
+ *
+ * Feed it one frame time per frame (the larger of CPU and GPU time for the
+ * feedback loop). It smooths the measurements and steps the scale down when
+ * the frame budget is exceeded and back up when there is comfortable
+ * headroom. Separate thresholds, sustain periods and a cooldown after every
+ * change provide hysteresis so the scale doesn't oscillate.
+ *
+ * Scales are quantised to fixed steps so the render target pool only ever
+ * sees a handful of distinct sizes.
+ */
+class ResolutionScaler
+{
+public:
+    /**
+     * @struct Settings
+     * @brief Tuning parameters
+     */
+    struct Settings
+    {
+        double targetFrameMs = 1000.0 / 60.0;  // Frame budget
+        float minScale = 0.5f;
+        float maxScale = 1.0f;
+        float step = 0.1f;
+
+        double downThreshold = 0.95;   // Scale down above this fraction of budget
+        double upThreshold = 0.70;     // Scale up below this fraction of budget
+        int framesBeforeDown = 8;      // Sustained overload needed to scale down
+        int framesBeforeUp = 90;       // Sustained headroom needed to scale up
+        int cooldownFrames = 30;       // Ignore measurements after a change
+        double smoothing = 0.9;        // Exponential moving average factor
+    };
+
+    /**
+     * @struct Decision
+     * @brief Record of a scale change, for telemetry
+     */
+    struct Decision
+    {
+        long long frame = 0;
+        float oldScale = 1.0f;
+        float newScale = 1.0f;
+        double averageFrameMs = 0.0;
+        double targetFrameMs = 0.0;
+    };
+
+    /**
+     * @struct Stats
+     * @brief Snapshot of scaler state, for telemetry
+     */
+    struct Stats
+    {
+        float scale = 1.0f;
+        double averageFrameMs = 0.0;
+        double lastFrameMs = 0.0;
+        double targetFrameMs = 0.0;
+        int numScaleDowns = 0;
+        int numScaleUps = 0;
+        long long framesMeasured = 0;
+    };
+
+    ResolutionScaler();
+
+    /**
+     * @brief Replace the tuning parameters
+     */
+    void setSettings(const Settings& newSettings);
+    const Settings& getSettings() const { return settings; }
+
+    /**
+     * @brief Enable or disable automatic scaling
+     *
+     * When disabled the scale snaps back to maxScale.
+     */
+    void setEnabled(bool shouldBeEnabled);
+    bool isEnabled() const { return enabled; }
+
+    /**
+     * @brief Record the cost of one frame
+     * @param frameMs Time spent on the frame's rendering work (milliseconds)
+     * @return true if the scale changed
+     */
+    bool addFrameTime(double frameMs);
+
+    /**
+     * @brief Current internal resolution scale (per axis)
+     */
+    float getScale() const { return scale; }
+
+    /**
+     * @brief Forget measurements and return to full scale
+     */
+    void reset();
+
+    /**
+     * @brief Get a telemetry snapshot
+     */
+    Stats getStats() const;
+
+    /**
+     * @brief Most recent scale changes, oldest first
+     */
+    const std::vector<Decision>& getRecentDecisions() const { return decisions; }
+
+    /**
+     * @brief Called whenever the scale changes
+     */
+    std::function<void(const Decision&)> onScaleChanged;
+
+private:
+    Settings settings;
+    bool enabled = true;
+
+    float scale = 1.0f;
+    double averageMs = 0.0;
+    double lastMs = 0.0;
+    bool haveAverage = false;
+
+    int framesOver = 0;
+    int framesUnder = 0;
+    int cooldown = 0;
+    long long frameCounter = 0;
+
+    int numScaleDowns = 0;
+    int numScaleUps = 0;
+
+    static constexpr size_t maxDecisions = 32;
+    std::vector<Decision> decisions;
+
+    float quantise(float value) const;
+    void changeScale(float newScale);
+};
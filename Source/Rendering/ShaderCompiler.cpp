@@ -1,4 +1,5 @@
 #include "ShaderCompiler.h"
+#include "NoiseGenerator.h"
 #include <JuceHeader.h>
 #include <algorithm>
 #include <regex>
@@ -148,6 +149,18 @@ std::unique_ptr<MilkDrop::CompiledShader> ShaderCompiler::compileMilkDropShader(
     const std::string& hlsl,
     MilkDrop::ShaderType type)
 {
+    return compileShader(MilkDrop::ShaderTemplates::VERTEX_SHADER, translateMilkDropShader(hlsl, type));
+}
+
+std::string ShaderCompiler::translateMilkDropShader(const std::string& hlsl, MilkDrop::ShaderType type)
+{
+    if (hlsl.empty())
+    {
+        return (type == MilkDrop::ShaderType::Warp) ?
+            MilkDrop::ShaderTemplates::DEFAULT_WARP_FRAGMENT :
+            MilkDrop::ShaderTemplates::DEFAULT_COMPOSITE_FRAGMENT;
+    }
+
     // Convert HLSL to GLSL
     std::string glsl = convertHLSLtoGLSL(hlsl, type);
 
@@ -157,10 +170,7 @@ std::unique_ptr<MilkDrop::CompiledShader> ShaderCompiler::compileMilkDropShader(
         MilkDrop::ShaderTemplates::COMPOSITE_FRAGMENT_BASE;
 
     // Inject user code into template
-    std::string fragmentSource = injectCodeIntoTemplate(templateCode, glsl);
-
-    // Compile the shader
-    return compileShader(MilkDrop::ShaderTemplates::VERTEX_SHADER, fragmentSource);
+    return injectCodeIntoTemplate(templateCode, glsl);
 }
 
 std::unique_ptr<MilkDrop::CompiledShader> ShaderCompiler::createDefaultShader(
@@ -292,6 +302,7 @@ void ShaderCompiler::extractUniformLocations(unsigned int programId,
     shader.loc_warp = glGetUniformLocation(programId, "warp");
     shader.loc_sx = glGetUniformLocation(programId, "sx");
     shader.loc_sy = glGetUniformLocation(programId, "sy");
+    shader.loc_decay = glGetUniformLocation(programId, "decay");
 
     // Wave colors
     shader.loc_wave_r = glGetUniformLocation(programId, "wave_r");
@@ -305,6 +316,21 @@ void ShaderCompiler::extractUniformLocations(unsigned int programId,
     // Texture sampler
     shader.loc_mainTexture = glGetUniformLocation(programId, "mainTexture");
 
+    // Blur pyramid samplers
+    for (int i = 0; i < 3; ++i)
+    {
+        std::string blurName = "sampler_blur" + std::to_string(i + 1);
+        shader.loc_blur[i] = glGetUniformLocation(programId, blurName.c_str());
+
+        std::string rangeName = "blur" + std::to_string(i + 1);
+        shader.loc_blurMin[i] = glGetUniformLocation(programId, (rangeName + "_min").c_str());
+        shader.loc_blurMax[i] = glGetUniformLocation(programId, (rangeName + "_max").c_str());
+    }
+
+    // Noise texture samplers
+    for (int i = 0; i < NoiseGenerator::numTextures; ++i)
+        shader.loc_noise[i] = glGetUniformLocation(programId, NoiseGenerator::getSpec(i).samplerName);
+
     // Custom variables (q1-q32)
     for (int i = 0; i < 32; ++i)
     {
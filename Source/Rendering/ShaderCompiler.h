@@ -26,6 +26,16 @@ public:
      */
     std::string convertHLSLtoGLSL(const std::string& hlsl, MilkDrop::ShaderType type);
 
+    /**
+     * @brief Build the complete GLSL fragment source for a MilkDrop shader
+     * @param hlsl HLSL shader code; empty gives the default shader
+     * @param type Shader type
+     *
+     * String work only, so it can run on any thread; compileShader() with
+     * the result and VERTEX_SHADER is what compileMilkDropShader() does.
+     */
+    std::string translateMilkDropShader(const std::string& hlsl, MilkDrop::ShaderType type);
+
     /**
      * @brief Compile a complete shader program
      * @param vertexSource Vertex shader GLSL source
@@ -54,6 +64,16 @@ public:
     std::unique_ptr<MilkDrop::CompiledShader> createDefaultShader(
         MilkDrop::ShaderType type);
 
+    /**
+     * @brief Find how many blur pyramid levels a MilkDrop shader samples
+     * @param hlsl HLSL shader code
+     * @return 0 if no blur texture is referenced, otherwise the deepest level (1-3)
+     *
+     * Defined in this header so the preset catalog can use it without the
+     * GL half of the compiler.
+     */
+    static int getRequiredBlurLevels(const std::string& hlsl);
+
     /**
      * @brief Get the last compilation error
      */
@@ -76,3 +96,22 @@ private:
     std::string getShaderInfoLog(unsigned int shaderId);
     std::string getProgramInfoLog(unsigned int programId);
 };
+
+inline int ShaderCompiler::getRequiredBlurLevels(const std::string& hlsl)
+{
+    // sampler_blurN, GetBlurN() and the blurN_min/max range uniforms all
+    // mean level N (and therefore every level below it) must be rendered
+    for (int level = 3; level >= 1; --level)
+    {
+        std::string n = std::to_string(level);
+        if (hlsl.find("sampler_blur" + n) != std::string::npos ||
+            hlsl.find("GetBlur" + n) != std::string::npos ||
+            hlsl.find("blur" + n + "_min") != std::string::npos ||
+            hlsl.find("blur" + n + "_max") != std::string::npos)
+        {
+            return level;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include "ShaderProgramCache.h"
+#include "ShaderTemplates.h"
+#include <JuceHeader.h>
+
+using namespace juce::gl;
+
+namespace
+{
+    uint64_t hashSource(const std::string& source)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (unsigned char c : source)
+        {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+}
+
+ShaderProgramCache::ShaderProgramCache(size_t maxProgramsToKeep)
+    : maxPrograms(maxProgramsToKeep)
+{
+}
+
+ShaderProgramCache::~ShaderProgramCache()
+{
+    // Programs belong to the GL context; releaseGL() deletes them while it is current
+}
+
+int ShaderProgramCache::indexOf(const std::string& fragmentSource, uint64_t hash) const
+{
+    for (size_t i = 0; i < programs.size(); ++i)
+        if (programs[i].hash == hash && programs[i].fragmentSource == fragmentSource)
+            return static_cast<int>(i);
+
+    return -1;
+}
+
+std::shared_ptr<MilkDrop::CompiledShader> ShaderProgramCache::get(const std::string& fragmentSource)
+{
+    const uint64_t hash = hashSource(fragmentSource);
+
+    const int index = indexOf(fragmentSource, hash);
+    if (index >= 0)
+    {
+        auto& program = programs[static_cast<size_t>(index)];
+        program.lastUsed = ++useCounter;
+        return program.shader;
+    }
+
+    std::shared_ptr<MilkDrop::CompiledShader> shader =
+        compiler.compileShader(MilkDrop::ShaderTemplates::VERTEX_SHADER, fragmentSource);
+
+    if (!shader)
+    {
+        DBG("FlarkViz: Failed to link preset shader: " << compiler.getLastError());
+        return nullptr;
+    }
+
+    evict();
+
+    Program program;
+    program.hash = hash;
+    program.fragmentSource = fragmentSource;
+    program.shader = shader;
+    program.lastUsed = ++useCounter;
+    programs.push_back(std::move(program));
+
+    return shader;
+}
+
+bool ShaderProgramCache::warm(const std::string& fragmentSource)
+{
+    if (contains(fragmentSource))
+        return false;
+
+    return get(fragmentSource) != nullptr;
+}
+
+bool ShaderProgramCache::contains(const std::string& fragmentSource) const
+{
+    return indexOf(fragmentSource, hashSource(fragmentSource)) >= 0;
+}
+
+void ShaderProgramCache::evict()
+{
+    while (programs.size() >= maxPrograms)
+    {
+        // Least recently used program that no render state still holds
+        auto victim = programs.end();
+        for (auto it = programs.begin(); it != programs.end(); ++it)
+            if (it->shader.use_count() == 1 && (victim == programs.end() || it->lastUsed < victim->lastUsed))
+                victim = it;
+
+        if (victim == programs.end())
+            return;
+
+        glDeleteProgram(victim->shader->programId);
+        programs.erase(victim);
+    }
+}
+
+void ShaderProgramCache::releaseGL()
+{
+    for (auto& program : programs)
+        if (program.shader->programId != 0)
+            glDeleteProgram(program.shader->programId);
+
+    programs.clear();
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "ShaderCompiler.h"
+#include "ShaderTypes.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @class ShaderProgramCache
+ * @brief Linked preset programs keyed by their fragment source
+ *
+ * Presets that translate to the same GLSL (every preset without a warp or
+ * composite shader shares the default ones) get the same program, and a
+ * program linked ahead of time by warm() is only bound when its preset is
+ * switched to.
+ *
+ * Holds at most maxPrograms; beyond that the least recently used program
+ * that nothing else references is deleted. GL thread only.
+ */
+class ShaderProgramCache
+{
+public:
+    explicit ShaderProgramCache(size_t maxPrograms = 16);
+    ~ShaderProgramCache();
+
+    /**
+     * @brief The program for a fragment source, linked on first use
+     * @return nullptr if the source failed to compile or link
+     */
+    std::shared_ptr<MilkDrop::CompiledShader> get(const std::string& fragmentSource);
+
+    /**
+     * @brief Link a program now so a later get() is a lookup
+     * @return true if it was linked by this call, false if cached or failed
+     */
+    bool warm(const std::string& fragmentSource);
+
+    bool contains(const std::string& fragmentSource) const;
+
+    /** Delete every program; needs the GL context */
+    void releaseGL();
+
+    size_t getNumPrograms() const { return programs.size(); }
+
+    /** Compile/link error of the last program that failed */
+    std::string getLastError() const { return compiler.getLastError(); }
+
+private:
+    struct Program
+    {
+        uint64_t hash = 0;
+        std::string fragmentSource;
+        std::shared_ptr<MilkDrop::CompiledShader> shader;
+        uint64_t lastUsed = 0;
+    };
+
+    int indexOf(const std::string& fragmentSource, uint64_t hash) const;
+    void evict();
+
+    ShaderCompiler compiler;
+    std::vector<Program> programs;
+    const size_t maxPrograms;
+    uint64_t useCounter = 0;
+};
@@ -33,6 +33,28 @@ out vec4 FragColor;
 
 // Texture samplers
 uniform sampler2D mainTexture;
+uniform sampler2D sampler_blur1;
+uniform sampler2D sampler_blur2;
+uniform sampler2D sampler_blur3;
+
+// Range the blur levels are stored in (MilkDrop 2's blurN_min / blurN_max)
+uniform float blur1_min, blur1_max;
+uniform float blur2_min, blur2_max;
+uniform float blur3_min, blur3_max;
+
+// MilkDrop 2 noise textures (see NoiseGenerator)
+uniform sampler2D sampler_noise_lq_lite;
+uniform sampler2D sampler_noise_lq;
+uniform sampler2D sampler_noise_mq;
+uniform sampler2D sampler_noise_hq;
+uniform sampler3D sampler_noisevol_lq;
+uniform sampler3D sampler_noisevol_hq;
+const vec4 texsize_noise_lq_lite = vec4(32.0, 32.0, 1.0 / 32.0, 1.0 / 32.0);
+const vec4 texsize_noise_lq = vec4(256.0, 256.0, 1.0 / 256.0, 1.0 / 256.0);
+const vec4 texsize_noise_mq = vec4(256.0, 256.0, 1.0 / 256.0, 1.0 / 256.0);
+const vec4 texsize_noise_hq = vec4(256.0, 256.0, 1.0 / 256.0, 1.0 / 256.0);
+const vec4 texsize_noisevol_lq = vec4(32.0, 32.0, 1.0 / 32.0, 1.0 / 32.0);
+const vec4 texsize_noisevol_hq = vec4(32.0, 32.0, 1.0 / 32.0, 1.0 / 32.0);
 
 // Time variables
 uniform float time;
@@ -57,6 +79,7 @@ uniform float dy;
 uniform float warp;
 uniform float sx;
 uniform float sy;
+uniform float decay;
 
 // Resolution
 uniform vec2 resolution;
@@ -67,6 +90,11 @@ uniform float q9, q10, q11, q12, q13, q14, q15, q16;
 uniform float q17, q18, q19, q20, q21, q22, q23, q24;
 uniform float q25, q26, q27, q28, q29, q30, q31, q32;
 
+// MilkDrop 2 blur helpers
+vec3 GetBlur1(vec2 p) { return blur1_min + texture(sampler_blur1, p).xyz * (blur1_max - blur1_min); }
+vec3 GetBlur2(vec2 p) { return blur2_min + texture(sampler_blur2, p).xyz * (blur2_max - blur2_min); }
+vec3 GetBlur3(vec2 p) { return blur3_min + texture(sampler_blur3, p).xyz * (blur3_max - blur3_min); }
+
 // Helper variables
 vec2 uv_center = uv - vec2(0.5, 0.5);
 float rad = length(uv_center);
@@ -81,7 +109,8 @@ void main()
 
     // USER_MAIN_CODE
 
-    FragColor = texture(mainTexture, uv_warped);
+    // Feedback fade (stored in a half-float target so it doesn't band)
+    FragColor = texture(mainTexture, uv_warped) * decay;
 }
 )";
 
@@ -95,6 +124,28 @@ out vec4 FragColor;
 
 // Texture samplers
 uniform sampler2D mainTexture;
+uniform sampler2D sampler_blur1;
+uniform sampler2D sampler_blur2;
+uniform sampler2D sampler_blur3;
+
+// Range the blur levels are stored in (MilkDrop 2's blurN_min / blurN_max)
+uniform float blur1_min, blur1_max;
+uniform float blur2_min, blur2_max;
+uniform float blur3_min, blur3_max;
+
+// MilkDrop 2 noise textures (see NoiseGenerator)
+uniform sampler2D sampler_noise_lq_lite;
+uniform sampler2D sampler_noise_lq;
+uniform sampler2D sampler_noise_mq;
+uniform sampler2D sampler_noise_hq;
+uniform sampler3D sampler_noisevol_lq;
+uniform sampler3D sampler_noisevol_hq;
+const vec4 texsize_noise_lq_lite = vec4(32.0, 32.0, 1.0 / 32.0, 1.0 / 32.0);
+const vec4 texsize_noise_lq = vec4(256.0, 256.0, 1.0 / 256.0, 1.0 / 256.0);
+const vec4 texsize_noise_mq = vec4(256.0, 256.0, 1.0 / 256.0, 1.0 / 256.0);
+const vec4 texsize_noise_hq = vec4(256.0, 256.0, 1.0 / 256.0, 1.0 / 256.0);
+const vec4 texsize_noisevol_lq = vec4(32.0, 32.0, 1.0 / 32.0, 1.0 / 32.0);
+const vec4 texsize_noisevol_hq = vec4(32.0, 32.0, 1.0 / 32.0, 1.0 / 32.0);
 
 // Time variables
 uniform float time;
@@ -119,6 +170,7 @@ uniform float dy;
 uniform float warp;
 uniform float sx;
 uniform float sy;
+uniform float decay;
 
 // Resolution
 uniform vec2 resolution;
@@ -129,6 +181,11 @@ uniform float q9, q10, q11, q12, q13, q14, q15, q16;
 uniform float q17, q18, q19, q20, q21, q22, q23, q24;
 uniform float q25, q26, q27, q28, q29, q30, q31, q32;
 
+// MilkDrop 2 blur helpers
+vec3 GetBlur1(vec2 p) { return blur1_min + texture(sampler_blur1, p).xyz * (blur1_max - blur1_min); }
+vec3 GetBlur2(vec2 p) { return blur2_min + texture(sampler_blur2, p).xyz * (blur2_max - blur2_min); }
+vec3 GetBlur3(vec2 p) { return blur3_min + texture(sampler_blur3, p).xyz * (blur3_max - blur3_min); }
+
 // Helper variables
 vec2 uv_center = uv - vec2(0.5, 0.5);
 float rad = length(uv_center);
@@ -147,7 +204,7 @@ void main()
 }
 )";
 
-// Default passthrough warp shader
+// Default passthrough warp shader (applies feedback decay only)
 inline const char* DEFAULT_WARP_FRAGMENT = R"(
 #version 330 core
 
@@ -155,10 +212,11 @@ in vec2 uv;
 out vec4 FragColor;
 
 uniform sampler2D mainTexture;
+uniform float decay;
 
 void main()
 {
-    FragColor = texture(mainTexture, uv);
+    FragColor = texture(mainTexture, uv) * decay;
 }
 )";
 
@@ -177,5 +235,33 @@ void main()
 }
 )";
 
+// Separable Gaussian blur pass for the blur pyramid.
+// A 9-tap kernel folded into 5 fetches by sampling between texel pairs
+// and letting bilinear filtering do the weighting.
+inline const char* BLUR_FRAGMENT = R"(
+#version 330 core
+
+in vec2 uv;
+out vec4 FragColor;
+
+uniform sampler2D source;
+uniform vec2 texelStep;  // One source texel along the blur direction
+
+const float offsets[3] = float[](0.0, 1.3846153846, 3.2307692308);
+const float weights[3] = float[](0.2270270270, 0.3162162162, 0.0702702703);
+
+void main()
+{
+    vec4 color = texture(source, uv) * weights[0];
+    for (int i = 1; i < 3; ++i)
+    {
+        vec2 offset = texelStep * offsets[i];
+        color += texture(source, uv + offset) * weights[i];
+        color += texture(source, uv - offset) * weights[i];
+    }
+    FragColor = color;
+}
+)";
+
 } // namespace ShaderTemplates
 } // namespace MilkDrop
@@ -60,6 +60,7 @@ struct CompiledShader
     int loc_warp = -1;
     int loc_sx = -1;
     int loc_sy = -1;
+    int loc_decay = -1;
 
     // Wave colors
     int loc_wave_r = -1;
@@ -73,6 +74,10 @@ struct CompiledShader
     // Textures
     int loc_texture = -1;
     int loc_mainTexture = -1;
+    int loc_blur[3] = {-1, -1, -1};  // sampler_blur1..3
+    int loc_blurMin[3] = {-1, -1, -1};  // blur1_min..blur3_min
+    int loc_blurMax[3] = {-1, -1, -1};
+    int loc_noise[6] = {-1, -1, -1, -1, -1, -1};  // NoiseGenerator::TextureId order
 
     // Custom q variables (q1-q32)
     int loc_q[32];
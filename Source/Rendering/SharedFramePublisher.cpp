@@ -0,0 +1,64 @@
+#include "SharedFramePublisher.h"
+#include <cstring>
+
+SharedFramePublisher::SharedFramePublisher(const juce::String& ringName, int slots)
+    : name(ringName)
+    , numSlots(juce::jmax(2, slots))
+    , capture(3, 1, FrameCapture::DropPolicy::DropNewest, this)
+{
+}
+
+SharedFramePublisher::~SharedFramePublisher()
+{
+    // cleanupGL() must have flushed the capture; `capture` is destroyed
+    // first (reverse declaration order), stopping its copy thread before
+    // the ring goes away
+}
+
+void SharedFramePublisher::publish(GLuint fbo, int width, int height, double timeSeconds)
+{
+    if (!failed)
+        capture.capture(fbo, width, height, timeSeconds);
+}
+
+void SharedFramePublisher::cleanupGL()
+{
+    capture.cleanupGL();
+}
+
+void SharedFramePublisher::consumeFrame(const uint8_t* bottomUpRgba, int width, int height,
+                                        int64_t sequence, double timeSeconds)
+{
+    const size_t rowBytes = static_cast<size_t>(width) * 4;
+    const size_t frameBytes = rowBytes * static_cast<size_t>(height);
+
+    if (ring == nullptr || ring->getSlotCapacity() < frameBytes)
+    {
+        // Close the old ring first so its name is free for the new one
+        ring.reset();
+
+        std::string error;
+        ring = SharedFrameRing::create(name.toStdString(), frameBytes, numSlots, error);
+
+        if (ring == nullptr)
+        {
+            DBG("FlarkViz: Shared frame output '" << name << "' failed: " << juce::String(error));
+            failed = true;
+            return;
+        }
+
+        DBG("FlarkViz: Publishing " << width << "x" << height << " frames to shared memory '" << name << "'");
+    }
+
+    // The only copy between the GPU and consumers: flip rows into the slot
+    uint8_t* dest = ring->beginWrite();
+    for (int y = 0; y < height; ++y)
+    {
+        std::memcpy(dest + static_cast<size_t>(y) * rowBytes,
+                    bottomUpRgba + static_cast<size_t>(height - 1 - y) * rowBytes,
+                    rowBytes);
+    }
+
+    ring->commitWrite(sequence, timeSeconds, width, height, static_cast<int>(rowBytes), SharedFrameRing::RGBA8);
+    framesPublished++;
+}
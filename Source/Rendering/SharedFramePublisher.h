@@ -0,0 +1,68 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "FrameCapture.h"
+#include "../Core/SharedFrameRing.h"
+#include <atomic>
+#include <memory>
+
+/**
+ * @class SharedFramePublisher
+ * @brief Publishes rendered frames to other processes through a SharedFrameRing
+ *
+ * Frames are read back asynchronously by a FrameCapture whose copy thread
+ * writes the flipped rows straight into the next shared-memory slot, so
+ * each frame is copied exactly once on its way from the GPU to every
+ * consumer. Readback is lossy (DropNewest): a slow copy never stalls the
+ * render thread.
+ *
+ * The ring is created on the first frame, sized for it, and recreated
+ * (consumers see the old one close) when a larger frame arrives.
+ */
+class SharedFramePublisher : private FrameCapture::Sink
+{
+public:
+    /**
+     * @param name Shared-memory name consumers open, e.g. "flarkviz"
+     * @param numSlots Frames kept in the ring; consumers have numSlots - 1
+     *                 frame times to finish reading before a slot is reused
+     */
+    explicit SharedFramePublisher(const juce::String& name = "flarkviz", int numSlots = 3);
+    ~SharedFramePublisher() override;
+
+    //==========================================================================
+    // GL thread
+
+    /**
+     * @brief Queue the framebuffer for publishing
+     */
+    void publish(GLuint fbo, int width, int height, double timeSeconds);
+
+    /**
+     * @brief Release the readback buffers (requires an active GL context)
+     */
+    void cleanupGL();
+
+    //==========================================================================
+    juce::String getName() const { return name; }
+    int64_t getFramesPublished() const { return framesPublished.load(); }
+    bool hasFailed() const { return failed.load(); }
+
+private:
+    void consumeFrame(const uint8_t* bottomUpRgba, int width, int height,
+                      int64_t sequence, double timeSeconds) override;
+
+    const juce::String name;
+    const int numSlots;
+
+    // Only touched on the capture's copy thread
+    std::unique_ptr<SharedFrameRing> ring;
+
+    std::atomic<int64_t> framesPublished {0};
+    std::atomic<bool> failed {false};
+
+    // Declared last: its copy thread calls consumeFrame() until destroyed
+    FrameCapture capture;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SharedFramePublisher)
+};
@@ -0,0 +1,779 @@
+#include "SoftwareRenderer.h"
+#include "../Core/CpuFeatures.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr float twoPi = 6.2831853f;
+
+    double ticksToMs(juce::int64 ticks)
+    {
+        return juce::Time::highResolutionTicksToSeconds(ticks) * 1000.0;
+    }
+
+    /** Texels either side of a coordinate along one axis, and the weight of the second */
+    inline float texelPair(float coord, int size, bool wrap, int& i0, int& i1)
+    {
+        // Written so NaN (also what wrapping turns inf into) lands on 0
+        // instead of an out-of-range texel index
+        if (wrap)
+            coord -= std::floor(coord);
+
+        coord = coord >= 0.0f ? std::min(coord, 1.0f) : 0.0f;
+
+        const float f = coord * static_cast<float>(size) - 0.5f;
+        const float fl = std::floor(f);
+        i0 = static_cast<int>(fl);
+        i1 = i0 + 1;
+
+        if (wrap)
+        {
+            if (i0 < 0)
+                i0 = size - 1;
+            if (i1 == size)
+                i1 = 0;
+        }
+        else
+        {
+            i0 = std::max(i0, 0);
+            i1 = std::min(i1, size - 1);
+        }
+
+        return f - fl;
+    }
+
+#if FLARKVIZ_AVX2_DISPATCH
+    /** Eight lanes of texelPair() */
+    FLARKVIZ_TARGET_AVX2 inline __m256 texelPairs(__m256 coord, int size, bool wrap, __m256i& i0, __m256i& i1)
+    {
+        const __m256i zeroI = _mm256_setzero_si256();
+        const __m256i sizeI = _mm256_set1_epi32(size);
+        const __m256i lastI = _mm256_set1_epi32(size - 1);
+
+        if (wrap)
+            coord = _mm256_sub_ps(coord, _mm256_floor_ps(coord));
+
+        // max_ps returns its second operand when either is NaN, so NaN lanes become 0
+        coord = _mm256_min_ps(_mm256_max_ps(coord, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+
+        const __m256 f = _mm256_sub_ps(_mm256_mul_ps(coord, _mm256_set1_ps(static_cast<float>(size))),
+                                       _mm256_set1_ps(0.5f));
+        const __m256 fl = _mm256_floor_ps(f);
+        i0 = _mm256_cvttps_epi32(fl);
+        i1 = _mm256_add_epi32(i0, _mm256_set1_epi32(1));
+
+        if (wrap)
+        {
+            i0 = _mm256_blendv_epi8(i0, lastI, _mm256_cmpgt_epi32(zeroI, i0));
+            i1 = _mm256_andnot_si256(_mm256_cmpeq_epi32(i1, sizeI), i1);
+        }
+        else
+        {
+            i0 = _mm256_max_epi32(i0, zeroI);
+            i1 = _mm256_min_epi32(i1, lastI);
+        }
+
+        return _mm256_sub_ps(f, fl);
+    }
+
+    /** Eight bilinear samples of one plane from gathered corner texels */
+    FLARKVIZ_TARGET_AVX2 inline __m256 filterLanes(const float* plane, __m256i i00, __m256i i01, __m256i i10, __m256i i11,
+                                                   __m256 tx, __m256 ty, __m256 scale)
+    {
+        const __m256 a = _mm256_i32gather_ps(plane, i00, 4);
+        const __m256 b = _mm256_i32gather_ps(plane, i01, 4);
+        const __m256 c = _mm256_i32gather_ps(plane, i10, 4);
+        const __m256 d = _mm256_i32gather_ps(plane, i11, 4);
+
+        const __m256 upper = _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), tx));
+        const __m256 lower = _mm256_add_ps(c, _mm256_mul_ps(_mm256_sub_ps(d, c), tx));
+        return _mm256_mul_ps(_mm256_add_ps(upper, _mm256_mul_ps(_mm256_sub_ps(lower, upper), ty)), scale);
+    }
+
+    /** sampleBilinear() eight pixels at a time; returns how many were written */
+    FLARKVIZ_TARGET_AVX2 int sampleBilinearAVX2(const float* r, const float* g, const float* b, int w, int h,
+                                                const float* u, const float* v, int count, float scale, bool wrap,
+                                                float* outR, float* outG, float* outB)
+    {
+        const __m256 scaleV = _mm256_set1_ps(scale);
+        const __m256i widthI = _mm256_set1_epi32(w);
+
+        int i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256i x0, x1, y0, y1;
+            const __m256 tx = texelPairs(_mm256_loadu_ps(u + i), w, wrap, x0, x1);
+            const __m256 ty = texelPairs(_mm256_loadu_ps(v + i), h, wrap, y0, y1);
+
+            const __m256i row0 = _mm256_mullo_epi32(y0, widthI);
+            const __m256i row1 = _mm256_mullo_epi32(y1, widthI);
+            const __m256i i00 = _mm256_add_epi32(row0, x0);
+            const __m256i i01 = _mm256_add_epi32(row0, x1);
+            const __m256i i10 = _mm256_add_epi32(row1, x0);
+            const __m256i i11 = _mm256_add_epi32(row1, x1);
+
+            _mm256_storeu_ps(outR + i, filterLanes(r, i00, i01, i10, i11, tx, ty, scaleV));
+            _mm256_storeu_ps(outG + i, filterLanes(g, i00, i01, i10, i11, tx, ty, scaleV));
+            _mm256_storeu_ps(outB + i, filterLanes(b, i00, i01, i10, i11, tx, ty, scaleV));
+        }
+        return i;
+    }
+#endif
+
+    inline uint8_t toByte(float value)
+    {
+        return static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+
+    /** MilkDrop's per-channel composite filters, in MilkDrop's order */
+    inline float applyFilters(float c, bool brighten, bool darken, bool solarize, bool invert)
+    {
+        c = std::clamp(c, 0.0f, 1.0f);
+
+        if (brighten)
+            c = 1.0f - (1.0f - c) * (1.0f - c);
+        if (darken)
+            c = c * c;
+        if (solarize)
+            c = c * (1.0f - c) * 4.0f;
+        if (invert)
+            c = 1.0f - c;
+
+        return c;
+    }
+}
+
+//==============================================================================
+void SoftwareRenderer::Planes::resize(int newWidth, int newHeight)
+{
+    width = newWidth;
+    height = newHeight;
+
+    const size_t size = static_cast<size_t>(width) * static_cast<size_t>(height);
+    r.assign(size, 0.0f);
+    g.assign(size, 0.0f);
+    b.assign(size, 0.0f);
+}
+
+void SoftwareRenderer::Planes::clear()
+{
+    width = height = 0;
+    r = {};
+    g = {};
+    b = {};
+}
+
+//==============================================================================
+SoftwareRenderer::SoftwareRenderer(int numThreads)
+    : pool(numThreads)
+{
+    renderState = std::make_unique<RenderState>(false);
+}
+
+SoftwareRenderer::~SoftwareRenderer()
+{
+    release();
+}
+
+void SoftwareRenderer::initialise()
+{
+    allocateBuffers();
+
+    const char* sampler = CpuFeatures::hasAVX2() ? "AVX2" : "scalar";
+
+    DBG("FlarkViz: Software renderer initialized (" << width << "x" << height << ", "
+        << getNumThreads() << " threads, " << sampler << " sampling)");
+    juce::ignoreUnused(sampler);
+}
+
+void SoftwareRenderer::release()
+{
+    feedback[0].clear();
+    feedback[1].clear();
+    output = {};
+}
+
+void SoftwareRenderer::setViewportSize(int newWidth, int newHeight)
+{
+    width = juce::jmax(1, newWidth);
+    height = juce::jmax(1, newHeight);
+
+    // Buffers are reallocated at the start of the next frame
+}
+
+void SoftwareRenderer::allocateBuffers()
+{
+    feedback[0].resize(width, height);
+    feedback[1].resize(width, height);
+    output.assign(static_cast<size_t>(width) * static_cast<size_t>(height) * 4, 0);
+
+    // Alpha never changes
+    for (size_t i = 3; i < output.size(); i += 4)
+        output[i] = 255;
+
+    meshU.assign(static_cast<size_t>((meshWidth + 1) * (meshHeight + 1)), 0.0f);
+    meshV.assign(meshU.size(), 0.0f);
+
+    // Pixel centres map onto the mesh the same way for every row
+    columnCell.resize(static_cast<size_t>(width));
+    columnFraction.resize(static_cast<size_t>(width));
+
+    for (int x = 0; x < width; ++x)
+    {
+        const float mx = (static_cast<float>(x) + 0.5f) / static_cast<float>(width) * meshWidth;
+        const int cell = std::min(static_cast<int>(mx), meshWidth - 1);
+        columnCell[static_cast<size_t>(x)] = cell;
+        columnFraction[static_cast<size_t>(x)] = mx - static_cast<float>(cell);
+    }
+}
+
+//==============================================================================
+bool SoftwareRenderer::loadPreset(const MilkDropPreset& preset)
+{
+    if (!renderState->loadPreset(preset))
+    {
+        DBG("FlarkViz: Failed to load preset into RenderState");
+        return false;
+    }
+
+    applyLook(preset);
+    return true;
+}
+
+bool SoftwareRenderer::loadPreparedPreset(std::unique_ptr<PreparedPreset> prepared)
+{
+    if (prepared == nullptr)
+        return false;
+
+    // The render state owns the preset from here on
+    const MilkDropPreset& preset = prepared->preset;
+    if (!renderState->loadPrepared(std::move(prepared)))
+        return false;
+
+    applyLook(preset);
+    return true;
+}
+
+std::unique_ptr<PreparedPreset> SoftwareRenderer::takeRetiredPreset()
+{
+    return renderState->takeRetired();
+}
+
+void SoftwareRenderer::applyLook(const MilkDropPreset& preset)
+{
+    look = {};
+    look.warpAnimSpeed = preset.fWarpAnimSpeed;
+    look.warpScale = preset.fWarpScale;
+    look.zoomExponent = preset.fZoomExponent;
+    look.gamma = preset.fGammaAdj;
+    look.echoZoom = preset.fVideoEchoZoom;
+    look.echoAlpha = preset.fVideoEchoAlpha;
+    look.echoOrientation = preset.nVideoEchoOrientation;
+    look.waveMode = preset.nWaveMode;
+    look.waveAlpha = preset.fWaveAlpha;
+    look.waveScale = preset.fWaveScale;
+    look.waveX = preset.wave_x;
+    look.waveY = preset.wave_y;
+    look.modWaveAlphaStart = preset.fModWaveAlphaStart;
+    look.modWaveAlphaEnd = preset.fModWaveAlphaEnd;
+    look.additiveWaves = preset.bAdditiveWaves;
+    look.waveDots = preset.bWaveDots;
+    look.waveThick = preset.bWaveThick;
+    look.modWaveAlphaByVolume = preset.bModWaveAlphaByVolume;
+    look.maximizeWaveColor = preset.bMaximizeWaveColor;
+    look.texWrap = preset.bTexWrap;
+    look.brighten = preset.bBrighten;
+    look.darken = preset.bDarken;
+    look.solarize = preset.bSolarize;
+    look.invert = preset.bInvert;
+
+    for (const auto& shape : preset.shapes)
+        if (shape.enabled)
+            look.shapes.push_back(shape);
+
+    if (!preset.warpShaderCode.empty() || !preset.compShaderCode.empty())
+        DBG("FlarkViz: Software renderer ignores the custom shaders of " << preset.name);
+
+    presetLoaded = true;
+    DBG("FlarkViz: Preset loaded (software): " << preset.name);
+}
+
+void SoftwareRenderer::setClock(int64_t frameNumber, double elapsedSeconds)
+{
+    renderState->setClock(frameNumber, elapsedSeconds);
+}
+
+void SoftwareRenderer::beginFrame(float dt)
+{
+    deltaTime = dt;
+}
+
+void SoftwareRenderer::renderPreset(float bass, float mid, float treb,
+                                    float bassAtt, float midAtt, float trebAtt)
+{
+    if (!presetLoaded)
+        return;
+
+    auto startTicks = juce::Time::getHighResolutionTicks();
+
+    if (feedback[0].width != width || feedback[0].height != height)
+        allocateBuffers();
+
+    renderState->updateAudioData(bass, mid, treb, bassAtt, midAtt, trebAtt);
+    const auto& context = renderState->executeFrame(deltaTime);
+
+    // Render into the buffer that held the frame before last
+    current = 1 - current;
+    updateMesh(context);
+
+    const float decay = juce::jlimit(0.0f, 1.0f, static_cast<float>(context.decay));
+
+    forEachRowBand([this, decay](int rowBegin, int rowEnd)
+    {
+        renderWarpRows(rowBegin, rowEnd, decay);
+        drawShapeRows(rowBegin, rowEnd);
+    });
+
+    // A few hundred points; not worth splitting
+    drawWave(context);
+
+    forEachRowBand([this](int rowBegin, int rowEnd)
+    {
+        compositeRows(rowBegin, rowEnd);
+    });
+
+    lastFrameMs = ticksToMs(juce::Time::getHighResolutionTicks() - startTicks);
+}
+
+void SoftwareRenderer::endFrame()
+{
+    // Nothing is queued; the frame is complete when renderPreset() returns
+}
+
+void SoftwareRenderer::copyToImage(juce::Image& image)
+{
+    if (output.empty())
+        return;
+
+    if (!image.isValid() || image.getWidth() != width || image.getHeight() != height
+        || image.getFormat() != juce::Image::ARGB)
+        image = juce::Image(juce::Image::ARGB, width, height, false);
+
+    juce::Image::BitmapData data(image, juce::Image::BitmapData::writeOnly);
+
+    forEachRowBand([this, &data](int rowBegin, int rowEnd)
+    {
+        for (int y = rowBegin; y < rowEnd; ++y)
+        {
+            const uint8_t* src = output.data() + static_cast<size_t>(y) * static_cast<size_t>(width) * 4;
+            uint8_t* line = data.getLinePointer(y);
+
+            for (int x = 0; x < width; ++x, src += 4)
+                reinterpret_cast<juce::PixelARGB*>(line + x * data.pixelStride)->setARGB(255, src[0], src[1], src[2]);
+        }
+    });
+}
+
+//==============================================================================
+void SoftwareRenderer::forEachRowBand(const std::function<void(int, int)>& body)
+{
+    const int numTasks = (height + rowsPerTask - 1) / rowsPerTask;
+
+    pool.parallelFor(numTasks, [this, &body](int task)
+    {
+        const int rowBegin = task * rowsPerTask;
+        body(rowBegin, std::min(rowBegin + rowsPerTask, height));
+    });
+}
+
+void SoftwareRenderer::updateMesh(const MilkDrop::ExecutionContext& context)
+{
+    const float zoom = static_cast<float>(context.zoom);
+    const float rot = static_cast<float>(context.rot);
+    const float cx = static_cast<float>(context.cx);
+    const float cy = static_cast<float>(context.cy);
+    const float dx = static_cast<float>(context.dx);
+    const float dy = static_cast<float>(context.dy);
+    const float sx = context.sx != 0.0 ? static_cast<float>(context.sx) : 1.0f;
+    const float sy = context.sy != 0.0 ? static_cast<float>(context.sy) : 1.0f;
+    const float warp = static_cast<float>(context.warp) * 0.0035f;
+
+    // MilkDrop's warp animation: four slowly drifting frequencies
+    const float warpTime = static_cast<float>(context.time) * look.warpAnimSpeed;
+    const float warpScaleInv = look.warpScale != 0.0f ? 1.0f / look.warpScale : 1.0f;
+    const float f0 = 11.68f + 4.0f * std::cos(warpTime * 1.413f + 10.0f);
+    const float f1 = 8.77f + 3.0f * std::cos(warpTime * 1.113f + 7.0f);
+    const float f2 = 10.54f + 3.0f * std::cos(warpTime * 1.233f + 3.0f);
+    const float f3 = 11.49f + 4.0f * std::cos(warpTime * 0.933f + 5.0f);
+
+    const float aspect = static_cast<float>(width) / static_cast<float>(height);
+    const float cosRot = std::cos(rot);
+    const float sinRot = std::sin(rot);
+
+    for (int j = 0; j <= meshHeight; ++j)
+    {
+        for (int i = 0; i <= meshWidth; ++i)
+        {
+            // Mesh space: x right, y up, both -1..1
+            const float x = static_cast<float>(i) / meshWidth * 2.0f - 1.0f;
+            const float y = 1.0f - static_cast<float>(j) / meshHeight * 2.0f;
+            const float rad = std::sqrt(x * x + y * y) * 0.70710678f;
+
+            const float zoom2 = std::pow(zoom, std::pow(look.zoomExponent, rad * 2.0f - 1.0f));
+            const float zoomInv = zoom2 != 0.0f ? 1.0f / zoom2 : 1.0f;
+
+            float u = x * 0.5f * zoomInv + 0.5f;
+            float v = -y * 0.5f * zoomInv + 0.5f;
+
+            // Stretch
+            u = (u - cx) / sx + cx;
+            v = (v - cy) / sy + cy;
+
+            // Warp
+            u += warp * std::sin(warpTime * 0.333f + warpScaleInv * (x * f0 - y * f3));
+            v += warp * std::cos(warpTime * 0.375f - warpScaleInv * (x * f2 + y * f1));
+            u += warp * std::cos(warpTime * 0.753f - warpScaleInv * (x * f1 - y * f2));
+            v += warp * std::sin(warpTime * 0.825f + warpScaleInv * (x * f0 + y * f3));
+
+            // Rotate about (cx, cy) in square units so the image doesn't shear
+            const float u2 = (u - cx) * aspect;
+            const float v2 = v - cy;
+            u = (u2 * cosRot - v2 * sinRot) / aspect + cx;
+            v = u2 * sinRot + v2 * cosRot + cy;
+
+            // Translate
+            const size_t index = static_cast<size_t>(j * (meshWidth + 1) + i);
+            meshU[index] = u - dx;
+            meshV[index] = v - dy;
+        }
+    }
+}
+
+void SoftwareRenderer::renderWarpRows(int rowBegin, int rowEnd, float decay)
+{
+    const Planes& src = feedback[1 - current];
+    Planes& dst = feedback[current];
+
+    std::vector<float> rowU(meshWidth + 1), rowV(meshWidth + 1);
+    std::vector<float> u(static_cast<size_t>(width)), v(static_cast<size_t>(width));
+
+    for (int y = rowBegin; y < rowEnd; ++y)
+    {
+        // Interpolate the mesh down to this row, then across to each pixel
+        const float my = (static_cast<float>(y) + 0.5f) / static_cast<float>(height) * meshHeight;
+        const int cell = std::min(static_cast<int>(my), meshHeight - 1);
+        const float t = my - static_cast<float>(cell);
+
+        const float* u0 = meshU.data() + cell * (meshWidth + 1);
+        const float* v0 = meshV.data() + cell * (meshWidth + 1);
+        const float* u1 = u0 + meshWidth + 1;
+        const float* v1 = v0 + meshWidth + 1;
+
+        for (int i = 0; i <= meshWidth; ++i)
+        {
+            rowU[static_cast<size_t>(i)] = u0[i] + (u1[i] - u0[i]) * t;
+            rowV[static_cast<size_t>(i)] = v0[i] + (v1[i] - v0[i]) * t;
+        }
+
+        for (size_t x = 0; x < u.size(); ++x)
+        {
+            const size_t c = static_cast<size_t>(columnCell[x]);
+            const float s = columnFraction[x];
+            u[x] = rowU[c] + (rowU[c + 1] - rowU[c]) * s;
+            v[x] = rowV[c] + (rowV[c + 1] - rowV[c]) * s;
+        }
+
+        const size_t offset = static_cast<size_t>(y) * static_cast<size_t>(width);
+        sampleBilinear(src, u.data(), v.data(), width, decay, look.texWrap,
+                       dst.r.data() + offset, dst.g.data() + offset, dst.b.data() + offset);
+    }
+}
+
+void SoftwareRenderer::drawShapeRows(int rowBegin, int rowEnd)
+{
+    Planes& dst = feedback[current];
+    const float radiusScale = 0.5f * static_cast<float>(std::min(width, height));
+
+    for (const auto& shape : look.shapes)
+    {
+        const int sides = juce::jlimit(3, 100, shape.sides);
+        const float radius = shape.rad * radiusScale;
+        const float centreX = shape.x * static_cast<float>(width);
+        const float centreY = (1.0f - shape.y) * static_cast<float>(height);
+
+        // Convex polygon, first corner at 45 degrees like MilkDrop
+        float px[101], py[101];
+        float top = centreY, bottom = centreY;
+
+        for (int k = 0; k <= sides; ++k)
+        {
+            const float angle = shape.ang + twoPi * static_cast<float>(k) / static_cast<float>(sides) + twoPi * 0.125f;
+            px[k] = centreX + radius * std::cos(angle);
+            py[k] = centreY - radius * std::sin(angle);
+            top = std::min(top, py[k]);
+            bottom = std::max(bottom, py[k]);
+        }
+
+        const Rgba colour { juce::jlimit(0.0f, 1.0f, shape.r), juce::jlimit(0.0f, 1.0f, shape.g),
+                            juce::jlimit(0.0f, 1.0f, shape.b), juce::jlimit(0.0f, 1.0f, shape.a) };
+
+        const int yBegin = std::max(rowBegin, static_cast<int>(std::ceil(top - 0.5f)));
+        const int yEnd = std::min(rowEnd, static_cast<int>(std::floor(bottom - 0.5f)) + 1);
+
+        for (int y = yBegin; y < yEnd; ++y)
+        {
+            // Span of pixel centres inside the polygon on this row
+            const float fy = static_cast<float>(y) + 0.5f;
+            float left = static_cast<float>(width), right = -1.0f;
+
+            for (int k = 0; k < sides; ++k)
+            {
+                const float y0 = py[k], y1 = py[k + 1];
+                if ((fy < y0) == (fy < y1))
+                    continue;
+
+                const float x = px[k] + (fy - y0) * (px[k + 1] - px[k]) / (y1 - y0);
+                left = std::min(left, x);
+                right = std::max(right, x);
+            }
+
+            const int xBegin = std::max(0, static_cast<int>(std::ceil(left - 0.5f)));
+            const int xEnd = std::min(width, static_cast<int>(std::floor(right - 0.5f)) + 1);
+            const size_t offset = static_cast<size_t>(y) * static_cast<size_t>(width);
+
+            for (int x = xBegin; x < xEnd; ++x)
+            {
+                const size_t i = offset + static_cast<size_t>(x);
+
+                if (shape.additive)
+                {
+                    dst.r[i] += colour.r * colour.a;
+                    dst.g[i] += colour.g * colour.a;
+                    dst.b[i] += colour.b * colour.a;
+                }
+                else
+                {
+                    dst.r[i] += (colour.r - dst.r[i]) * colour.a;
+                    dst.g[i] += (colour.g - dst.g[i]) * colour.a;
+                    dst.b[i] += (colour.b - dst.b[i]) * colour.a;
+                }
+            }
+        }
+    }
+}
+
+void SoftwareRenderer::drawWave(const MilkDrop::ExecutionContext& context)
+{
+    const float bass = static_cast<float>(context.bass);
+    const float mid = static_cast<float>(context.mid);
+    const float treb = static_cast<float>(context.treb);
+    const float time = static_cast<float>(context.time);
+
+    float alpha = look.waveAlpha * static_cast<float>(context.wave_a);
+    if (look.modWaveAlphaByVolume)
+    {
+        const float volume = (bass + mid + treb) / 3.0f;
+        const float range = look.modWaveAlphaEnd - look.modWaveAlphaStart;
+        alpha *= range > 0.0f ? juce::jlimit(0.0f, 1.0f, (volume - look.modWaveAlphaStart) / range) : 1.0f;
+    }
+
+    Rgba colour { juce::jlimit(0.0f, 1.0f, static_cast<float>(context.wave_r)),
+                  juce::jlimit(0.0f, 1.0f, static_cast<float>(context.wave_g)),
+                  juce::jlimit(0.0f, 1.0f, static_cast<float>(context.wave_b)),
+                  juce::jlimit(0.0f, 1.0f, alpha) };
+
+    if (colour.a <= 0.0f)
+        return;
+
+    if (look.maximizeWaveColor)
+    {
+        const float brightest = std::max({ colour.r, colour.g, colour.b });
+        if (brightest > 0.0f)
+        {
+            colour.r /= brightest;
+            colour.g /= brightest;
+            colour.b /= brightest;
+        }
+    }
+
+    // Stand-in waveform: one partial per band
+    constexpr int numPoints = 256;
+    float px[numPoints], py[numPoints];
+
+    const float centreX = look.waveX * static_cast<float>(width);
+    const float centreY = (1.0f - look.waveY) * static_cast<float>(height);
+    const float halfSize = 0.5f * static_cast<float>(std::min(width, height));
+    const bool circle = look.waveMode <= 1;
+
+    for (int k = 0; k < numPoints; ++k)
+    {
+        const float t = static_cast<float>(k) / (numPoints - 1);
+        const float sample = 0.5f * look.waveScale
+                           * (bass * std::sin(twoPi * 2.0f * t + time * 2.0f)
+                              + 0.6f * mid * std::sin(twoPi * 7.0f * t + time * 3.1f)
+                              + 0.35f * treb * std::sin(twoPi * 19.0f * t + time * 4.7f));
+
+        if (circle)
+        {
+            const float radius = halfSize * (0.5f + 0.2f * sample);
+            px[k] = centreX + radius * std::cos(twoPi * t);
+            py[k] = centreY - radius * std::sin(twoPi * t);
+        }
+        else
+        {
+            px[k] = t * static_cast<float>(width);
+            py[k] = centreY - sample * halfSize * 0.5f;
+        }
+    }
+
+    const int size = look.waveThick ? 2 : 1;
+
+    if (look.waveDots)
+    {
+        for (int k = 0; k < numPoints; ++k)
+            blendPixel(static_cast<int>(px[k]), static_cast<int>(py[k]), colour, look.additiveWaves, size);
+        return;
+    }
+
+    // Line segments, one step per pixel, each end point drawn once
+    for (int k = 0; k + 1 < numPoints; ++k)
+    {
+        const float deltaX = px[k + 1] - px[k];
+        const float deltaY = py[k + 1] - py[k];
+        const int steps = std::max(1, static_cast<int>(std::ceil(std::max(std::abs(deltaX), std::abs(deltaY)))));
+
+        for (int s = 0; s < steps; ++s)
+        {
+            const float f = static_cast<float>(s) / static_cast<float>(steps);
+            blendPixel(static_cast<int>(px[k] + deltaX * f), static_cast<int>(py[k] + deltaY * f),
+                       colour, look.additiveWaves, size);
+        }
+    }
+}
+
+void SoftwareRenderer::blendPixel(int x, int y, const Rgba& colour, bool additive, int size)
+{
+    Planes& dst = feedback[current];
+
+    for (int yy = std::max(0, y); yy < std::min(height, y + size); ++yy)
+    {
+        for (int xx = std::max(0, x); xx < std::min(width, x + size); ++xx)
+        {
+            const size_t i = static_cast<size_t>(yy) * static_cast<size_t>(width) + static_cast<size_t>(xx);
+
+            if (additive)
+            {
+                dst.r[i] += colour.r * colour.a;
+                dst.g[i] += colour.g * colour.a;
+                dst.b[i] += colour.b * colour.a;
+            }
+            else
+            {
+                dst.r[i] += (colour.r - dst.r[i]) * colour.a;
+                dst.g[i] += (colour.g - dst.g[i]) * colour.a;
+                dst.b[i] += (colour.b - dst.b[i]) * colour.a;
+            }
+        }
+    }
+}
+
+void SoftwareRenderer::compositeRows(int rowBegin, int rowEnd)
+{
+    const Planes& src = feedback[current];
+
+    // Video echo: a zoomed (and optionally flipped) copy mixed over the frame
+    const bool echo = look.echoAlpha > 0.001f && (look.echoZoom != 1.0f || look.echoOrientation != 0);
+    const float echoZoomInv = look.echoZoom != 0.0f ? 1.0f / look.echoZoom : 1.0f;
+    const float echoAlpha = juce::jlimit(0.0f, 1.0f, look.echoAlpha);
+
+    std::vector<float> echoU, echoV, echoR, echoG, echoB;
+    if (echo)
+    {
+        echoU.resize(static_cast<size_t>(width));
+        echoV.resize(static_cast<size_t>(width));
+        echoR.resize(static_cast<size_t>(width));
+        echoG.resize(static_cast<size_t>(width));
+        echoB.resize(static_cast<size_t>(width));
+
+        for (int x = 0; x < width; ++x)
+        {
+            const float u = ((static_cast<float>(x) + 0.5f) / static_cast<float>(width) - 0.5f) * echoZoomInv + 0.5f;
+            echoU[static_cast<size_t>(x)] = (look.echoOrientation & 1) != 0 ? 1.0f - u : u;
+        }
+    }
+
+    for (int y = rowBegin; y < rowEnd; ++y)
+    {
+        const size_t offset = static_cast<size_t>(y) * static_cast<size_t>(width);
+        const float* r = src.r.data() + offset;
+        const float* g = src.g.data() + offset;
+        const float* b = src.b.data() + offset;
+        uint8_t* out = output.data() + offset * 4;
+
+        if (echo)
+        {
+            float v = ((static_cast<float>(y) + 0.5f) / static_cast<float>(height) - 0.5f) * echoZoomInv + 0.5f;
+            if ((look.echoOrientation & 2) != 0)
+                v = 1.0f - v;
+
+            std::fill(echoV.begin(), echoV.end(), v);
+            sampleBilinear(src, echoU.data(), echoV.data(), width, 1.0f, false,
+                           echoR.data(), echoG.data(), echoB.data());
+        }
+
+        for (int x = 0; x < width; ++x)
+        {
+            float red = r[x], green = g[x], blue = b[x];
+
+            if (echo)
+            {
+                red += (echoR[static_cast<size_t>(x)] - red) * echoAlpha;
+                green += (echoG[static_cast<size_t>(x)] - green) * echoAlpha;
+                blue += (echoB[static_cast<size_t>(x)] - blue) * echoAlpha;
+            }
+
+            out[x * 4 + 0] = toByte(applyFilters(red * look.gamma, look.brighten, look.darken, look.solarize, look.invert));
+            out[x * 4 + 1] = toByte(applyFilters(green * look.gamma, look.brighten, look.darken, look.solarize, look.invert));
+            out[x * 4 + 2] = toByte(applyFilters(blue * look.gamma, look.brighten, look.darken, look.solarize, look.invert));
+        }
+    }
+}
+
+//==============================================================================
+void SoftwareRenderer::sampleBilinear(const Planes& src, const float* u, const float* v, int count,
+                                      float scale, bool wrap, float* outR, float* outG, float* outB)
+{
+    const int w = src.width;
+    const int h = src.height;
+    int i = 0;
+
+   #if FLARKVIZ_AVX2_DISPATCH
+    if (CpuFeatures::hasAVX2())
+        i = sampleBilinearAVX2(src.r.data(), src.g.data(), src.b.data(), w, h, u, v, count, scale, wrap,
+                               outR, outG, outB);
+   #endif
+
+    for (; i < count; ++i)
+    {
+        int x0, x1, y0, y1;
+        const float tx = texelPair(u[i], w, wrap, x0, x1);
+        const float ty = texelPair(v[i], h, wrap, y0, y1);
+
+        const size_t i00 = static_cast<size_t>(y0) * static_cast<size_t>(w) + static_cast<size_t>(x0);
+        const size_t i01 = static_cast<size_t>(y0) * static_cast<size_t>(w) + static_cast<size_t>(x1);
+        const size_t i10 = static_cast<size_t>(y1) * static_cast<size_t>(w) + static_cast<size_t>(x0);
+        const size_t i11 = static_cast<size_t>(y1) * static_cast<size_t>(w) + static_cast<size_t>(x1);
+
+        auto filter = [&](const std::vector<float>& plane)
+        {
+            const float upper = plane[i00] + (plane[i01] - plane[i00]) * tx;
+            const float lower = plane[i10] + (plane[i11] - plane[i10]) * tx;
+            return (upper + (lower - upper) * ty) * scale;
+        };
+
+        outR[i] = filter(src.r);
+        outG[i] = filter(src.g);
+        outB[i] = filter(src.b);
+    }
+}
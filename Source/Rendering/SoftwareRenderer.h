@@ -0,0 +1,175 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "RenderBackend.h"
+#include "RenderState.h"
+#include "../Core/WorkerPool.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * @class SoftwareRenderer
+ * @brief MilkDrop pipeline on the CPU, for machines without usable OpenGL
+ *
+ * Same stages as PresetRenderer, each split into bands of rows that run on
+ * a WorkerPool:
+ * 1. Execute per-frame expressions (RenderState, without shaders)
+ * 2. Warp: each pixel samples the previous frame through MilkDrop's
+ *    48x36 motion mesh (zoom, rot, cx/cy, dx/dy, sx/sy, warp) with
+ *    bilinear filtering, times decay
+ * 3. Draw the preset's shapes and the main wave into the new frame, so
+ *    they feed back like in MilkDrop
+ * 4. Composite: video echo, gamma and the brighten/darken/solarize/invert
+ *    filters into an RGBA8 frame
+ *
+ * The feedback buffers are float planes (the CPU equivalent of the GL
+ * path's RGBA16F targets, so slow decays don't stall at 8-bit steps).
+ * Bilinear sampling uses AVX2 gathers on CPUs that have them, eight
+ * pixels at a time, with a scalar path otherwise.
+ *
+ * Custom warp/composite shaders (HLSL) are GPU-only: presets that have them
+ * render with the fixed-function stages above. There is no audio waveform
+ * in the renderPreset() interface, so the main wave is shaped from the
+ * bass/mid/treb levels.
+ */
+class SoftwareRenderer : public RenderBackend
+{
+public:
+    /**
+     * @param numThreads Worker count; <= 0 uses hardware concurrency - 1
+     */
+    explicit SoftwareRenderer (int numThreads = 0);
+    ~SoftwareRenderer() override;
+
+    Type getType() const override { return Type::Software; }
+
+    //==========================================================================
+    void initialise() override;
+    void release() override;
+    void setViewportSize (int width, int height) override;
+
+    //==========================================================================
+    bool loadPreset (const MilkDropPreset& preset) override;
+    bool loadPreparedPreset (std::unique_ptr<PreparedPreset> prepared) override;
+    std::unique_ptr<PreparedPreset> takeRetiredPreset() override;
+    void setClock (int64_t frameNumber, double elapsedSeconds) override;
+
+    void beginFrame (float deltaTime) override;
+    void renderPreset (float bass, float mid, float treb,
+                      float bassAtt, float midAtt, float trebAtt) override;
+    void endFrame() override;
+
+    //==========================================================================
+    // Output
+
+    /** Last composited frame: RGBA8, top row first, getWidth() * 4 bytes per row */
+    const uint8_t* getPixels() const { return output.data(); }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    /** Copy the last frame into an ARGB image, reallocating it if the size changed */
+    void copyToImage (juce::Image& image);
+
+    double getLastFrameMs() const { return lastFrameMs; }
+    int getNumThreads() const { return pool.getNumThreads() + 1; }
+
+    //==========================================================================
+    /** Motion mesh resolution (cells), as in MilkDrop's default mesh */
+    static constexpr int meshWidth = 48;
+    static constexpr int meshHeight = 36;
+
+    /** Rows per parallel task */
+    static constexpr int rowsPerTask = 16;
+
+    /** Float RGB planes, top row first */
+    struct Planes
+    {
+        int width = 0;
+        int height = 0;
+        std::vector<float> r, g, b;
+
+        void resize (int newWidth, int newHeight);
+        void clear();
+    };
+
+    /**
+     * @brief Bilinear samples of src at texture coordinates (u[i], v[i]), times scale
+     *
+     * Coordinates are in [0, 1] with v = 0 at the top row; outside that
+     * range they wrap or clamp to the edge. NaN samples the top / left
+     * edge, so a preset whose motion blows up can't index past the planes.
+     */
+    static void sampleBilinear (const Planes& src, const float* u, const float* v, int count,
+                                float scale, bool wrap, float* outR, float* outG, float* outB);
+
+private:
+    /** Preset parameters the stages read; copied at load so the preset can change under us */
+    struct Look
+    {
+        float warpAnimSpeed = 1.0f;
+        float warpScale = 1.0f;
+        float zoomExponent = 1.0f;
+        float gamma = 1.0f;
+        float echoZoom = 1.0f;
+        float echoAlpha = 0.0f;
+        int echoOrientation = 0;
+        int waveMode = 0;
+        float waveAlpha = 0.8f;
+        float waveScale = 1.0f;
+        float waveX = 0.5f;
+        float waveY = 0.5f;
+        float modWaveAlphaStart = 0.75f;
+        float modWaveAlphaEnd = 0.95f;
+        bool additiveWaves = false;
+        bool waveDots = false;
+        bool waveThick = false;
+        bool modWaveAlphaByVolume = false;
+        bool maximizeWaveColor = false;
+        bool texWrap = false;
+        bool brighten = false;
+        bool darken = false;
+        bool solarize = false;
+        bool invert = false;
+        std::vector<MilkDropPreset::WaveOrShape> shapes;
+    };
+
+    struct Rgba
+    {
+        float r, g, b, a;
+    };
+
+    void allocateBuffers();
+    void applyLook (const MilkDropPreset& preset);
+    void updateMesh (const MilkDrop::ExecutionContext& context);
+    void renderWarpRows (int rowBegin, int rowEnd, float decay);
+    void drawShapeRows (int rowBegin, int rowEnd);
+    void drawWave (const MilkDrop::ExecutionContext& context);
+    void compositeRows (int rowBegin, int rowEnd);
+    void blendPixel (int x, int y, const Rgba& colour, bool additive, int size);
+    void forEachRowBand (const std::function<void(int, int)>& body);
+
+    WorkerPool pool;
+    std::unique_ptr<RenderState> renderState;
+    Look look;
+
+    int width = 1280;
+    int height = 720;
+    bool presetLoaded = false;
+    float deltaTime = 1.0f / 60.0f;
+    double lastFrameMs = 0.0;
+
+    // Feedback: previous frame and the one being rendered
+    Planes feedback[2];
+    int current = 0;
+
+    // Motion mesh: source texture coordinates per vertex, and where each
+    // pixel column falls between vertex columns
+    std::vector<float> meshU, meshV;
+    std::vector<int> columnCell;
+    std::vector<float> columnFraction;
+
+    std::vector<uint8_t> output;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SoftwareRenderer)
+};
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../Presets/Preset.h"
+#include <string>
+
+/**
+ * @brief The juce::StringArray preset parser that PresetParser replaced
+ *
+ * Kept as the baseline for flarkviz-parse-bench and the parser parity
+ * test. It splits the text into trimmed juce::Strings and converts values
+ * with getFloatValue() / getIntValue(). Only the last code section of a
+ * file survives, without its assignment lines, and [wave_N] / [shape_N]
+ * keys go to the last wave (or shape) seen rather than the current
+ * section.
+ */
+namespace LegacyPresetParser
+{
+    inline bool parse(const juce::String& content, MilkDropPreset& preset)
+    {
+        preset.reset();
+
+        juce::StringArray lines = juce::StringArray::fromLines(content);
+
+        std::string currentSection;
+        std::string multilineBuffer;
+        bool inMultiline = false;
+        int waveIndex = -1;
+        int shapeIndex = -1;
+
+        for (const auto& rawLine : lines)
+        {
+            juce::String line = rawLine.trim();
+
+            if (line.isEmpty() || line.startsWith("//"))
+                continue;
+
+            if (line.startsWith("["))
+            {
+                if (inMultiline)
+                {
+                    inMultiline = false;
+                    multilineBuffer.clear();
+                }
+
+                currentSection = line.fromFirstOccurrenceOf("[", false, false)
+                                     .upToFirstOccurrenceOf("]", false, false)
+                                     .toStdString();
+
+                if (currentSection.find("wave_") == 0)
+                {
+                    waveIndex = currentSection[5] - '0';
+                    while (static_cast<int>(preset.waves.size()) <= waveIndex)
+                        preset.waves.push_back(MilkDropPreset::WaveOrShape());
+                    preset.waves[waveIndex].enabled = true;
+                }
+                else if (currentSection.find("shape_") == 0)
+                {
+                    shapeIndex = currentSection[6] - '0';
+                    while (static_cast<int>(preset.shapes.size()) <= shapeIndex)
+                        preset.shapes.push_back(MilkDropPreset::WaveOrShape());
+                    preset.shapes[shapeIndex].enabled = true;
+                }
+
+                continue;
+            }
+
+            if (line.contains("="))
+            {
+                juce::String key = line.upToFirstOccurrenceOf("=", false, true).trim();
+                juce::String value = line.fromFirstOccurrenceOf("=", false, true).trim();
+
+                if (key == "name" || key == "MILKDROP_PRESET_VERSION") preset.name = value.toStdString();
+                else if (key == "author") preset.author = value.toStdString();
+                else if (key == "fRating") preset.fRating = value.getFloatValue();
+                else if (key == "fGammaAdj") preset.fGammaAdj = value.getFloatValue();
+                else if (key == "fDecay") preset.fDecay = value.getFloatValue();
+                else if (key == "fVideoEchoZoom") preset.fVideoEchoZoom = value.getFloatValue();
+                else if (key == "fVideoEchoAlpha") preset.fVideoEchoAlpha = value.getFloatValue();
+                else if (key == "nVideoEchoOrientation") preset.nVideoEchoOrientation = value.getIntValue();
+                else if (key == "nWaveMode") preset.nWaveMode = value.getIntValue();
+                else if (key == "bAdditiveWaves") preset.bAdditiveWaves = (value.getIntValue() != 0);
+                else if (key == "bWaveDots") preset.bWaveDots = (value.getIntValue() != 0);
+                else if (key == "bWaveThick") preset.bWaveThick = (value.getIntValue() != 0);
+                else if (key == "bModWaveAlphaByVolume") preset.bModWaveAlphaByVolume = (value.getIntValue() != 0);
+                else if (key == "bMaximizeWaveColor") preset.bMaximizeWaveColor = (value.getIntValue() != 0);
+                else if (key == "bTexWrap") preset.bTexWrap = (value.getIntValue() != 0);
+                else if (key == "bDarkenCenter") preset.bDarkenCenter = (value.getIntValue() != 0);
+                else if (key == "bRedBlueStereo") preset.bRedBlueStereo = (value.getIntValue() != 0);
+                else if (key == "bBrighten") preset.bBrighten = (value.getIntValue() != 0);
+                else if (key == "bDarken") preset.bDarken = (value.getIntValue() != 0);
+                else if (key == "bSolarize") preset.bSolarize = (value.getIntValue() != 0);
+                else if (key == "bInvert") preset.bInvert = (value.getIntValue() != 0);
+                else if (key == "fWaveAlpha") preset.fWaveAlpha = value.getFloatValue();
+                else if (key == "fWaveScale") preset.fWaveScale = value.getFloatValue();
+                else if (key == "fWaveSmoothing") preset.fWaveSmoothing = value.getFloatValue();
+                else if (key == "fWaveParam") preset.fWaveParam = value.getFloatValue();
+                else if (key == "fModWaveAlphaStart") preset.fModWaveAlphaStart = value.getFloatValue();
+                else if (key == "fModWaveAlphaEnd") preset.fModWaveAlphaEnd = value.getFloatValue();
+                else if (key == "fWarpAnimSpeed") preset.fWarpAnimSpeed = value.getFloatValue();
+                else if (key == "fWarpScale") preset.fWarpScale = value.getFloatValue();
+                else if (key == "fZoomExponent") preset.fZoomExponent = value.getFloatValue();
+                else if (key == "fShader") preset.fShader = value.getFloatValue();
+                else if (key == "fRotCX") preset.fRotCX = value.getFloatValue();
+                else if (key == "fRotCY") preset.fRotCY = value.getFloatValue();
+                else if (key == "fRot") preset.fRot = value.getFloatValue();
+                else if (key == "fXPush") preset.fXPush = value.getFloatValue();
+                else if (key == "fYPush") preset.fYPush = value.getFloatValue();
+                else if (key == "fWarpAmount") preset.fWarpAmount = value.getFloatValue();
+                else if (key == "fStretchX") preset.fStretchX = value.getFloatValue();
+                else if (key == "fStretchY") preset.fStretchY = value.getFloatValue();
+                else if (key == "wave_r") preset.wave_r = value.getFloatValue();
+                else if (key == "wave_g") preset.wave_g = value.getFloatValue();
+                else if (key == "wave_b") preset.wave_b = value.getFloatValue();
+                else if (waveIndex >= 0 && waveIndex < static_cast<int>(preset.waves.size()))
+                {
+                    auto& wave = preset.waves[waveIndex];
+                    if (key == "enabled") wave.enabled = (value.getIntValue() != 0);
+                    else if (key == "r") wave.r = value.getFloatValue();
+                    else if (key == "g") wave.g = value.getFloatValue();
+                    else if (key == "b") wave.b = value.getFloatValue();
+                    else if (key == "a") wave.a = value.getFloatValue();
+                }
+                else if (shapeIndex >= 0 && shapeIndex < static_cast<int>(preset.shapes.size()))
+                {
+                    auto& shape = preset.shapes[shapeIndex];
+                    if (key == "enabled") shape.enabled = (value.getIntValue() != 0);
+                    else if (key == "sides") shape.sides = value.getIntValue();
+                    else if (key == "thick") shape.thick = (value.getIntValue() != 0);
+                    else if (key == "additive") shape.additive = (value.getIntValue() != 0);
+                    else if (key == "r") shape.r = value.getFloatValue();
+                    else if (key == "g") shape.g = value.getFloatValue();
+                    else if (key == "b") shape.b = value.getFloatValue();
+                    else if (key == "a") shape.a = value.getFloatValue();
+                    else if (key == "rad") shape.rad = value.getFloatValue();
+                }
+
+                continue;
+            }
+
+            if (currentSection == "per_frame_init_1" || currentSection == "per_frame_1"
+                || currentSection == "per_pixel_1" || currentSection == "warp_1"
+                || currentSection == "comp_1")
+            {
+                if (!multilineBuffer.empty())
+                    multilineBuffer += "\n";
+                multilineBuffer += line.toStdString();
+                inMultiline = true;
+            }
+        }
+
+        if (inMultiline)
+        {
+            if (currentSection == "per_frame_init_1") preset.perFrameInitCode = multilineBuffer;
+            else if (currentSection == "per_frame_1") preset.perFrameCode = multilineBuffer;
+            else if (currentSection == "per_pixel_1") preset.perPixelCode = multilineBuffer;
+            else if (currentSection == "warp_1") preset.warpShaderCode = multilineBuffer;
+            else if (currentSection == "comp_1") preset.compShaderCode = multilineBuffer;
+        }
+
+        return true;
+    }
+}
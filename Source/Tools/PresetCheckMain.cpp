@@ -0,0 +1,693 @@
+/**
+ * flarkviz-check: vet presets before they go on stage
+ *
+ *   flarkviz-check ~/presets/NewPack
+ *   flarkviz-check --frames 600 --format json -o report.json NewPack.fvpack
+ *   flarkviz-check --threads 1 a.milk b.milk2
+ *
+ * Every preset (loose .milk / .milk2 files, folders of them and members of
+ * .fvpack packs) is parsed, every expression block is compiled with
+ * MilkdropEval and both shaders are translated with ShaderCompiler. The
+ * preset then runs for a number of frames against synthetic audio:
+ * per_frame_init once, per_frame every frame and per_pixel over the warp
+ * mesh, as RenderState sets them up.
+ *
+ * The report has one row per preset: status (ok, warning when a per-frame
+ * or per-pixel variable went NaN or infinite, failed when it couldn't be
+ * read or a block didn't compile), every problem found, the estimated
+ * cost the catalog ranks it by, the parse, compile and translate times and
+ * the average eval cost per frame.
+ * Presets are checked in parallel; --threads 1 gives the steadiest
+ * timings. The exit code is 2 if any preset failed.
+ */
+
+#include <JuceHeader.h>
+#include "../Core/WorkerPool.h"
+#include "../Expression/MilkdropEval.h"
+#include "../Presets/Milk2Loader.h"
+#include "../Presets/Preset.h"
+#include "../Presets/PresetCatalog.h"
+#include "../Presets/PresetPack.h"
+#include "../Presets/PresetParser.h"
+#include "../Rendering/ShaderCompiler.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+    struct Options
+    {
+        int frames = 300;
+        int meshWidth = 48;         // Warp mesh cells, as SoftwareRenderer's
+        int meshHeight = 36;
+        int numThreads = 0;
+        bool json = false;
+        juce::File output;          // stdout when not set
+    };
+
+    struct Source
+    {
+        juce::File file;            // The preset, or its library path in a pack
+        const PresetPack* pack = nullptr;
+        int member = -1;
+    };
+
+    struct Result
+    {
+        std::string path;
+        std::string status = "ok";
+        std::vector<std::string> problems;
+        int blocks = 0;
+        double cost = 0.0;          // PresetCatalog::estimateCost
+        double parseMs = 0.0;
+        double compileMs = 0.0;
+        double translateMs = 0.0;
+        double perFrameNs = 0.0;    // Averages per frame
+        double perPixelNs = 0.0;
+        int nonFiniteFrame = -1;
+
+        double getEvalNs() const { return perFrameNs + perPixelNs; }
+    };
+
+    double millisecondsSince(juce::int64 startTicks)
+    {
+        return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+    }
+
+    //==========================================================================
+    // Stands in for music: a 128 BPM kick on the bass, a slow swell on the
+    // mids and off-beat hats on the treble, around the 1.0 level presets are
+    // tuned for. _att is smoothed per frame the way AudioAnalyzer does it.
+    struct SyntheticAudio
+    {
+        double bass = 1.0, mid = 1.0, treb = 1.0;
+        double bassAtt = 1.0, midAtt = 1.0, trebAtt = 1.0;
+
+        void advance(double time)
+        {
+            const double beat = time * 128.0 / 60.0;
+            const double beatPhase = beat - std::floor(beat);
+            const double offBeatPhase = beat + 0.5 - std::floor(beat + 0.5);
+
+            bass = 0.4 + 1.6 * std::exp(-6.0 * beatPhase);
+            mid = 1.0 + 0.4 * std::sin(time * 0.7) + 0.2 * std::exp(-10.0 * beatPhase);
+            treb = 0.6 + 1.0 * std::exp(-14.0 * offBeatPhase);
+
+            bassAtt = bassAtt * 0.95 + bass * 0.05;
+            midAtt = midAtt * 0.95 + mid * 0.05;
+            trebAtt = trebAtt * 0.95 + treb * 0.05;
+        }
+    };
+
+    struct MeshPoint
+    {
+        double x, y, rad, ang;
+    };
+
+    std::vector<MeshPoint> makeMesh(int width, int height)
+    {
+        std::vector<MeshPoint> mesh;
+        mesh.reserve(static_cast<size_t>((width + 1) * (height + 1)));
+
+        for (int j = 0; j <= height; ++j)
+        {
+            for (int i = 0; i <= width; ++i)
+            {
+                const double x = i / static_cast<double>(width);
+                const double y = j / static_cast<double>(height);
+                const double dx = (x - 0.5) * 2.0;
+                const double dy = (y - 0.5) * 2.0;
+                mesh.push_back({ x, y, std::sqrt(dx * dx + dy * dy) * 0.7071067811865476, std::atan2(dy, dx) });
+            }
+        }
+
+        return mesh;
+    }
+
+    // What per_pixel code may change per vertex; each vertex starts from
+    // the values per_frame left
+    struct MotionValues
+    {
+        double zoom, rot, cx, cy, dx, dy, warp, sx, sy;
+
+        static MotionValues from(const MilkDrop::ExecutionContext& context)
+        {
+            return { context.zoom, context.rot, context.cx, context.cy, context.dx, context.dy,
+                     context.warp, context.sx, context.sy };
+        }
+
+        void applyTo(MilkDrop::ExecutionContext& context) const
+        {
+            context.zoom = zoom;
+            context.rot = rot;
+            context.cx = cx;
+            context.cy = cy;
+            context.dx = dx;
+            context.dy = dy;
+            context.warp = warp;
+            context.sx = sx;
+            context.sy = sy;
+        }
+
+        bool isFinite() const
+        {
+            for (double value : { zoom, rot, cx, cy, dx, dy, warp, sx, sy })
+                if (!std::isfinite(value))
+                    return false;
+
+            return true;
+        }
+    };
+
+    // The variables per_frame and per_pixel code hands on to the renderer
+    bool isFinite(const MilkDrop::ExecutionContext& context)
+    {
+        for (double value : { context.zoom, context.rot, context.cx, context.cy, context.dx, context.dy,
+                              context.warp, context.sx, context.sy, context.decay,
+                              context.wave_r, context.wave_g, context.wave_b, context.wave_a })
+            if (!std::isfinite(value))
+                return false;
+
+        for (double value : context.q)
+            if (!std::isfinite(value))
+                return false;
+
+        return true;
+    }
+
+    //==========================================================================
+    struct Compiled
+    {
+        MilkdropEval perFrameInit;
+        MilkdropEval perFrame;
+        MilkdropEval perPixel;
+    };
+
+    // Every block, reporting each one that fails rather than stopping at the first
+    bool compileAll(const MilkDropPreset& preset, const std::string& prefix, Compiled& compiled, Result& result)
+    {
+        bool ok = true;
+
+        auto compile = [&](MilkdropEval& eval, const std::string& code, const std::string& block)
+        {
+            if (code.empty())
+                return;
+
+            ++result.blocks;
+
+            if (!eval.compileBlock(code))
+            {
+                result.problems.push_back(prefix + block + ": " + eval.getLastError());
+                ok = false;
+            }
+        };
+
+        compile(compiled.perFrameInit, preset.perFrameInitCode, "per_frame_init");
+        compile(compiled.perFrame, preset.perFrameCode, "per_frame");
+        compile(compiled.perPixel, preset.perPixelCode, "per_pixel");
+
+        MilkdropEval scratch;
+
+        auto compileItems = [&](const std::vector<MilkDropPreset::WaveOrShape>& items, const char* kind)
+        {
+            for (size_t i = 0; i < items.size(); ++i)
+            {
+                const std::string name = kind + std::to_string(i) + " ";
+                compile(scratch, items[i].initCode, name + "init");
+                compile(scratch, items[i].perFrameCode, name + "per_frame");
+                compile(scratch, items[i].perPointCode, name + "per_point");
+            }
+        };
+
+        compileItems(preset.waves, "wave_");
+        compileItems(preset.shapes, "shape_");
+        return ok;
+    }
+
+    void translate(const MilkDropPreset& preset)
+    {
+        ShaderCompiler translator;
+        translator.translateMilkDropShader(preset.warpShaderCode, MilkDrop::ShaderType::Warp);
+        translator.translateMilkDropShader(preset.compShaderCode, MilkDrop::ShaderType::Composite);
+    }
+
+    void runFrames(const MilkDropPreset& preset, Compiled& compiled, const std::vector<MeshPoint>& mesh,
+                   const Options& options, const std::string& prefix, Result& result)
+    {
+        // Starting values as RenderState::applyPresetParameters() sets them
+        MilkDrop::ExecutionContext context;
+        context.decay = preset.fDecay;
+        context.rot = preset.fRot;
+        context.cx = preset.fRotCX;
+        context.cy = preset.fRotCY;
+        context.dx = preset.fXPush;
+        context.dy = preset.fYPush;
+        context.warp = preset.fWarpAmount;
+        context.sx = preset.fStretchX;
+        context.sy = preset.fStretchY;
+        context.wave_r = preset.wave_r;
+        context.wave_g = preset.wave_g;
+        context.wave_b = preset.wave_b;
+
+        // Each vertex's result, checked after the timed loop like the
+        // renderer would read it from its mesh
+        std::vector<MotionValues> vertices(mesh.size());
+
+        SyntheticAudio audio;
+        juce::int64 frameTicks = 0;
+        juce::int64 pixelTicks = 0;
+
+        for (int frame = 0; frame < options.frames; ++frame)
+        {
+            context.time = frame / context.fps;
+            context.frame = frame;
+
+            audio.advance(context.time);
+            context.bass = audio.bass;
+            context.mid = audio.mid;
+            context.treb = audio.treb;
+            context.bass_att = audio.bassAtt;
+            context.mid_att = audio.midAtt;
+            context.treb_att = audio.trebAtt;
+
+            auto start = juce::Time::getHighResolutionTicks();
+
+            if (frame == 0 && !preset.perFrameInitCode.empty())
+                compiled.perFrameInit.execute(context);
+
+            if (!preset.perFrameCode.empty())
+                compiled.perFrame.execute(context);
+
+            auto afterFrame = juce::Time::getHighResolutionTicks();
+            frameTicks += afterFrame - start;
+
+            bool finite = isFinite(context);
+
+            if (!preset.perPixelCode.empty())
+            {
+                const auto frameValues = MotionValues::from(context);
+
+                for (size_t i = 0; i < mesh.size(); ++i)
+                {
+                    const auto& point = mesh[i];
+                    frameValues.applyTo(context);
+                    context.x = point.x;
+                    context.y = point.y;
+                    context.rad = point.rad;
+                    context.ang = point.ang;
+                    compiled.perPixel.execute(context);
+                    vertices[i] = MotionValues::from(context);
+                }
+
+                pixelTicks += juce::Time::getHighResolutionTicks() - afterFrame;
+
+                // Anything else per_pixel code wrote (q, wave colour) as the last vertex left it
+                finite = finite && isFinite(context);
+                for (const auto& vertex : vertices)
+                    finite = finite && vertex.isFinite();
+
+                frameValues.applyTo(context);
+            }
+
+            if (!finite && result.nonFiniteFrame < 0)
+            {
+                result.nonFiniteFrame = frame;
+                result.problems.push_back(prefix + "non-finite value at frame " + std::to_string(frame));
+            }
+        }
+
+        const double nsPerFrame = 1.0e9 / static_cast<double>(juce::jmax(1, options.frames));
+        result.perFrameNs += juce::Time::highResolutionTicksToSeconds(frameTicks) * nsPerFrame;
+        result.perPixelNs += juce::Time::highResolutionTicksToSeconds(pixelTicks) * nsPerFrame;
+    }
+
+    //==========================================================================
+    bool readText(const Source& source, std::string& text)
+    {
+        if (source.pack != nullptr)
+        {
+            std::string storage;
+            std::string_view body;
+
+            if (!source.pack->readBody(source.member, storage, body))
+                return false;
+
+            text.assign(body.data(), body.size());
+            return true;
+        }
+
+        juce::MemoryBlock data;
+        if (!source.file.loadFileAsData(data))
+            return false;
+
+        text.assign(static_cast<const char*>(data.getData()), data.getSize());
+
+        if (PresetParser::isUtf16(text))
+            text = source.file.loadFileAsString().toStdString();
+
+        return true;
+    }
+
+    Result check(const Source& source, const std::vector<MeshPoint>& mesh, const Options& options)
+    {
+        Result result;
+        result.path = source.file.getFullPathName().toStdString();
+
+        std::string text;
+        if (!readText(source, text))
+        {
+            result.status = "failed";
+            result.problems.push_back("could not be read");
+            return result;
+        }
+
+        // A .milk2 holds two presets, both of which get shown
+        std::vector<std::pair<std::string, MilkDropPreset>> presets;
+        auto startTicks = juce::Time::getHighResolutionTicks();
+
+        if (source.file.hasFileExtension("milk2"))
+        {
+            auto pair = Milk2Loader::loadFromBuffer(text);
+            presets.emplace_back("preset A ", std::move(pair.presetA));
+            presets.emplace_back("preset B ", std::move(pair.presetB));
+        }
+        else
+        {
+            presets.emplace_back("", MilkDropPreset());
+            presets.back().second.loadFromBuffer(text);
+        }
+
+        result.parseMs = millisecondsSince(startTicks);
+
+        for (const auto& [prefix, preset] : presets)
+            result.cost += PresetCatalog::estimateCost(preset);
+
+        std::vector<std::unique_ptr<Compiled>> compiled;
+        bool compiledAll = true;
+
+        startTicks = juce::Time::getHighResolutionTicks();
+
+        for (const auto& [prefix, preset] : presets)
+        {
+            compiled.push_back(std::make_unique<Compiled>());
+            compiledAll = compileAll(preset, prefix, *compiled.back(), result) && compiledAll;
+        }
+
+        result.compileMs = millisecondsSince(startTicks);
+
+        startTicks = juce::Time::getHighResolutionTicks();
+
+        for (const auto& [prefix, preset] : presets)
+            translate(preset);
+
+        result.translateMs = millisecondsSince(startTicks);
+
+        if (!compiledAll)
+        {
+            result.status = "failed";
+            return result;
+        }
+
+        for (size_t i = 0; i < presets.size(); ++i)
+            runFrames(presets[i].second, *compiled[i], mesh, options, presets[i].first, result);
+
+        if (result.nonFiniteFrame >= 0)
+            result.status = "warning";
+
+        return result;
+    }
+
+    //==========================================================================
+    std::string joinProblems(const Result& result)
+    {
+        std::string joined;
+        for (const auto& problem : result.problems)
+            joined += (joined.empty() ? "" : "; ") + problem;
+
+        return joined;
+    }
+
+    std::string csvField(const std::string& value)
+    {
+        if (value.find_first_of(",\"\n\r") == std::string::npos)
+            return value;
+
+        std::string quoted = "\"";
+        for (char c : value)
+            quoted += (c == '"') ? std::string("\"\"") : std::string(1, c);
+
+        return quoted + "\"";
+    }
+
+    std::string jsonString(const std::string& value)
+    {
+        std::ostringstream escaped;
+        escaped << '"';
+
+        for (unsigned char c : value)
+        {
+            if (c == '"' || c == '\\')
+                escaped << '\\' << c;
+            else if (c == '\n')
+                escaped << "\\n";
+            else if (c == '\t')
+                escaped << "\\t";
+            else if (c < 0x20)
+                escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c)
+                        << std::dec << std::setfill(' ');
+            else
+                escaped << c;
+        }
+
+        escaped << '"';
+        return escaped.str();
+    }
+
+    std::string toCSV(const std::vector<Result>& results)
+    {
+        std::ostringstream csv;
+        csv << std::fixed << std::setprecision(3);
+        csv << "path,status,problems,blocks,cost,parse_ms,compile_ms,translate_ms,"
+               "per_frame_ns,per_pixel_ns,eval_ns_per_frame,nonfinite_frame\n";
+
+        for (const auto& result : results)
+        {
+            csv << csvField(result.path) << "," << result.status << "," << csvField(joinProblems(result)) << ","
+                << result.blocks << "," << std::setprecision(0) << result.cost << std::setprecision(3) << ","
+                << result.parseMs << "," << result.compileMs << "," << result.translateMs << ","
+                << std::setprecision(0) << result.perFrameNs << "," << result.perPixelNs << "," << result.getEvalNs()
+                << std::setprecision(3) << "," << result.nonFiniteFrame << "\n";
+        }
+
+        return csv.str();
+    }
+
+    std::string toJSON(const std::vector<Result>& results, const Options& options)
+    {
+        std::ostringstream json;
+        json << std::fixed << std::setprecision(3);
+
+        json << "{\n";
+        json << "  \"frames\": " << options.frames << ",\n";
+        json << "  \"mesh\": [" << options.meshWidth << ", " << options.meshHeight << "],\n";
+        json << "  \"presets\": [\n";
+
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const auto& result = results[i];
+
+            json << "    {\"path\": " << jsonString(result.path)
+                 << ", \"status\": \"" << result.status << "\", \"problems\": [";
+
+            for (size_t p = 0; p < result.problems.size(); ++p)
+                json << (p > 0 ? ", " : "") << jsonString(result.problems[p]);
+
+            json << "], \"blocks\": " << result.blocks
+                 << std::setprecision(0) << ", \"cost\": " << result.cost << std::setprecision(3)
+                 << ", \"parse_ms\": " << result.parseMs
+                 << ", \"compile_ms\": " << result.compileMs
+                 << ", \"translate_ms\": " << result.translateMs
+                 << std::setprecision(0)
+                 << ", \"per_frame_ns\": " << result.perFrameNs
+                 << ", \"per_pixel_ns\": " << result.perPixelNs
+                 << ", \"eval_ns_per_frame\": " << result.getEvalNs()
+                 << std::setprecision(3)
+                 << ", \"nonfinite_frame\": " << result.nonFiniteFrame
+                 << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+
+        json << "  ]\n";
+        json << "}\n";
+        return json.str();
+    }
+
+    //==========================================================================
+    void printUsage()
+    {
+        std::cerr << "Usage: flarkviz-check [options] <folder | preset.milk | preset.milk2 | pack.fvpack> ...\n"
+                     "  --frames <n>          Frames to run each preset for (default 300)\n"
+                     "  --mesh <w>x<h>        Per-pixel mesh (default 48x36)\n"
+                     "  --threads <n>         Worker threads (default: cores - 1, plus this one)\n"
+                     "  --format csv|json     Report format (default csv)\n"
+                     "  -o, --output <file>   Write the report here instead of stdout\n";
+    }
+
+    bool addInput(const juce::File& file, std::vector<Source>& sources,
+                  std::vector<std::unique_ptr<PresetPack>>& packs)
+    {
+        if (file.isDirectory())
+        {
+            for (const auto& item : juce::RangedDirectoryIterator(file, true, "*.milk;*.milk2;*.fvpack",
+                                                                  juce::File::findFiles))
+                if (!addInput(item.getFile(), sources, packs))
+                    return false;
+
+            return true;
+        }
+
+        if (file.hasFileExtension(PresetPack::fileExtension))
+        {
+            auto pack = std::make_unique<PresetPack>();
+            if (!pack->open(file))
+            {
+                std::cerr << "flarkviz-check: " << file.getFullPathName() << ": " << pack->getLastError() << "\n";
+                return false;
+            }
+
+            for (int i = 0; i < pack->getNumMembers(); ++i)
+                sources.push_back({ PresetPack::getMemberFile(file, pack->getMember(i).name), pack.get(), i });
+
+            packs.push_back(std::move(pack));
+            return true;
+        }
+
+        if (!file.existsAsFile())
+        {
+            std::cerr << "flarkviz-check: no such file " << file.getFullPathName() << "\n";
+            return false;
+        }
+
+        sources.push_back({ file, nullptr, -1 });
+        return true;
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    Options options;
+    std::vector<Source> sources;
+    std::vector<std::unique_ptr<PresetPack>> packs;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const juce::String arg(argv[i]);
+        const bool hasValue = i + 1 < argc;
+
+        if (arg == "--frames" && hasValue)
+        {
+            options.frames = juce::jmax(1, juce::String(argv[++i]).getIntValue());
+        }
+        else if (arg == "--mesh" && hasValue)
+        {
+            const juce::String size(argv[++i]);
+            options.meshWidth = juce::jmax(1, size.upToFirstOccurrenceOf("x", false, true).getIntValue());
+            options.meshHeight = juce::jmax(1, size.fromFirstOccurrenceOf("x", false, true).getIntValue());
+        }
+        else if (arg == "--threads" && hasValue)
+        {
+            options.numThreads = juce::String(argv[++i]).getIntValue();
+        }
+        else if (arg == "--format" && hasValue)
+        {
+            const juce::String format(argv[++i]);
+            if (format != "csv" && format != "json")
+            {
+                printUsage();
+                return 1;
+            }
+
+            options.json = format == "json";
+        }
+        else if ((arg == "-o" || arg == "--output") && hasValue)
+        {
+            options.output = juce::File::getCurrentWorkingDirectory().getChildFile(juce::String(argv[++i]));
+        }
+        else if (arg.startsWith("-"))
+        {
+            printUsage();
+            return 1;
+        }
+        else if (!addInput(juce::File::getCurrentWorkingDirectory().getChildFile(arg), sources, packs))
+        {
+            return 1;
+        }
+    }
+
+    if (sources.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    const auto mesh = makeMesh(options.meshWidth, options.meshHeight);
+    std::vector<Result> results(sources.size());
+
+    auto startTicks = juce::Time::getHighResolutionTicks();
+    WorkerPool pool(options.numThreads);
+
+    pool.parallelFor(static_cast<int>(sources.size()), [&](int i)
+    {
+        results[static_cast<size_t>(i)] = check(sources[static_cast<size_t>(i)], mesh, options);
+    });
+
+    const double seconds = millisecondsSince(startTicks) / 1000.0;
+
+    std::sort(results.begin(), results.end(),
+              [](const Result& a, const Result& b) { return a.path < b.path; });
+
+    const std::string report = options.json ? toJSON(results, options) : toCSV(results);
+
+    if (options.output == juce::File())
+    {
+        std::cout << report;
+    }
+    else if (!options.output.replaceWithData(report.data(), report.size()))
+    {
+        std::cerr << "flarkviz-check: could not write " << options.output.getFullPathName() << "\n";
+        return 1;
+    }
+
+    // Summary and the most expensive presets, on stderr so stdout stays a clean report
+    int failed = 0;
+    int warnings = 0;
+
+    for (const auto& result : results)
+    {
+        failed += result.status == "failed" ? 1 : 0;
+        warnings += result.status == "warning" ? 1 : 0;
+    }
+
+    std::cerr << results.size() << " presets checked on " << pool.getNumThreads() + 1 << " threads in "
+              << juce::String(seconds, 2) << " s: " << results.size() - static_cast<size_t>(failed + warnings)
+              << " ok, " << warnings << " warnings, " << failed << " failed\n";
+
+    std::vector<const Result*> slowest;
+    for (const auto& result : results)
+        if (result.status != "failed")
+            slowest.push_back(&result);
+
+    std::sort(slowest.begin(), slowest.end(),
+              [](const Result* a, const Result* b) { return a->getEvalNs() > b->getEvalNs(); });
+
+    for (size_t i = 0; i < slowest.size() && i < 5; ++i)
+        std::cerr << "  " << juce::String(slowest[i]->getEvalNs() / 1000.0, 1).paddedLeft(' ', 9)
+                  << " us/frame  " << slowest[i]->path << "\n";
+
+    return failed == 0 ? 0 : 2;
+}
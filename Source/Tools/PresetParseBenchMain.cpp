@@ -0,0 +1,196 @@
+/**
+ * flarkviz-parse-bench: preset parser throughput
+ *
+ * Parses a preset library with PresetParser and with the juce::StringArray
+ * parser it replaced, and reports presets/sec and MB/sec for each:
+ *
+ *   flarkviz-parse-bench ~/Documents/FlarkViz/presets
+ *   flarkviz-parse-bench --iterations 20 a.milk b.milk
+ *
+ * "parse" times only the parsing of files already in memory; "load" also
+ * includes getting each file off disk (mapping for PresetParser,
+ * File::loadFileAsString for the old parser), page cache warm.
+ */
+
+#include <JuceHeader.h>
+#include "../Presets/Preset.h"
+#include "../Presets/PresetParser.h"
+#include "LegacyPresetParser.h"
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    struct Result
+    {
+        double seconds = 0.0;
+        int presets = 0;
+        double bytes = 0.0;
+
+        double presetsPerSecond() const { return seconds > 0.0 ? presets / seconds : 0.0; }
+        double megabytesPerSecond() const { return seconds > 0.0 ? bytes / (1024.0 * 1024.0) / seconds : 0.0; }
+    };
+
+    template <typename Function>
+    Result timeRuns(int iterations, int presetsPerRun, double bytesPerRun, Function&& run)
+    {
+        Result result;
+        auto start = juce::Time::getHighResolutionTicks();
+
+        for (int i = 0; i < iterations; ++i)
+            run();
+
+        result.seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        result.presets = presetsPerRun * iterations;
+        result.bytes = bytesPerRun * iterations;
+        return result;
+    }
+
+    void printRow(const char* label, const Result& result)
+    {
+        std::cout << juce::String(label).paddedRight(' ', 22)
+                  << juce::String(result.presetsPerSecond(), 0).paddedLeft(' ', 12) << " presets/s"
+                  << juce::String(result.megabytesPerSecond(), 1).paddedLeft(' ', 10) << " MB/s\n";
+    }
+
+    // Fields both parsers read the same way; code sections differ on
+    // purpose (the old parser dropped most of them)
+    bool sameScalars(const MilkDropPreset& a, const MilkDropPreset& b)
+    {
+        return a.name == b.name && a.author == b.author
+            && a.fRating == b.fRating && a.fGammaAdj == b.fGammaAdj && a.fDecay == b.fDecay
+            && a.fVideoEchoZoom == b.fVideoEchoZoom && a.fVideoEchoAlpha == b.fVideoEchoAlpha
+            && a.nVideoEchoOrientation == b.nVideoEchoOrientation && a.nWaveMode == b.nWaveMode
+            && a.bAdditiveWaves == b.bAdditiveWaves && a.bTexWrap == b.bTexWrap
+            && a.fWaveAlpha == b.fWaveAlpha && a.fWaveScale == b.fWaveScale
+            && a.fWarpAnimSpeed == b.fWarpAnimSpeed && a.fWarpScale == b.fWarpScale
+            && a.fRot == b.fRot && a.fWarpAmount == b.fWarpAmount;
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    int iterations = 5;
+    juce::Array<juce::File> files;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const juce::String arg(argv[i]);
+
+        if (arg == "--iterations" && i + 1 < argc)
+        {
+            iterations = juce::jmax(1, juce::String(argv[++i]).getIntValue());
+            continue;
+        }
+
+        if (arg.startsWith("-"))
+        {
+            std::cerr << "Usage: flarkviz-parse-bench [--iterations n] [folder | file.milk ...]\n";
+            return 1;
+        }
+
+        const auto file = juce::File::getCurrentWorkingDirectory().getChildFile(arg);
+
+        if (file.isDirectory())
+        {
+            for (const auto& entry : juce::RangedDirectoryIterator(file, true, "*.milk", juce::File::findFiles))
+                files.add(entry.getFile());
+        }
+        else
+        {
+            files.add(file);
+        }
+    }
+
+    if (argc == 1)
+    {
+        const auto folder = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+                              .getChildFile("FlarkViz/presets");
+
+        for (const auto& entry : juce::RangedDirectoryIterator(folder, true, "*.milk", juce::File::findFiles))
+            files.add(entry.getFile());
+    }
+
+    // Both parsers get their natural input: UTF-8 bytes and juce::Strings
+    std::vector<std::string> texts;
+    std::vector<juce::String> strings;
+    juce::Array<juce::File> loadedFiles;
+    double totalBytes = 0.0;
+
+    for (const auto& file : files)
+    {
+        juce::MemoryBlock data;
+        if (!file.loadFileAsData(data))
+            continue;
+
+        loadedFiles.add(file);
+        texts.emplace_back(static_cast<const char*>(data.getData()), data.getSize());
+        strings.push_back(file.loadFileAsString());
+        totalBytes += static_cast<double>(data.getSize());
+    }
+
+    if (texts.empty())
+    {
+        std::cerr << "No .milk files found\n";
+        return 1;
+    }
+
+    const int count = static_cast<int>(texts.size());
+    std::cout << count << " presets, " << juce::String(totalBytes / (1024.0 * 1024.0), 1) << " MB, "
+              << iterations << " iterations, " << PresetParser::getNumPresetKeys() << " known keys\n\n";
+
+    MilkDropPreset preset;
+
+    auto parsed = timeRuns(iterations, count, totalBytes, [&]
+    {
+        for (const auto& text : texts)
+            PresetParser::parse(text, preset);
+    });
+
+    auto legacy = timeRuns(iterations, count, totalBytes, [&]
+    {
+        for (const auto& string : strings)
+            LegacyPresetParser::parse(string, preset);
+    });
+
+    auto loaded = timeRuns(iterations, count, totalBytes, [&]
+    {
+        for (const auto& file : loadedFiles)
+            preset.loadFromFile(file);
+    });
+
+    auto legacyLoaded = timeRuns(iterations, count, totalBytes, [&]
+    {
+        for (const auto& file : loadedFiles)
+            LegacyPresetParser::parse(file.loadFileAsString(), preset);
+    });
+
+    printRow("parse  PresetParser", parsed);
+    printRow("parse  StringArray", legacy);
+    printRow("load   PresetParser", loaded);
+    printRow("load   StringArray", legacyLoaded);
+
+    std::cout << "\nspeedup: parse " << juce::String(parsed.presetsPerSecond() / juce::jmax(1.0, legacy.presetsPerSecond()), 2)
+              << "x, load " << juce::String(loaded.presetsPerSecond() / juce::jmax(1.0, legacyLoaded.presetsPerSecond()), 2)
+              << "x\n";
+
+    // Sanity check: the parameters both parsers understand must agree
+    int mismatches = 0;
+    MilkDropPreset other;
+
+    for (int i = 0; i < count; ++i)
+    {
+        PresetParser::parse(texts[static_cast<size_t>(i)], preset);
+        LegacyPresetParser::parse(strings[static_cast<size_t>(i)], other);
+
+        if (!sameScalars(preset, other))
+        {
+            if (++mismatches <= 10)
+                std::cout << "differs: " << loadedFiles[i].getFullPathName() << "\n";
+        }
+    }
+
+    std::cout << "parameter mismatches: " << mismatches << " of " << count << "\n";
+    return mismatches == 0 ? 0 : 2;
+}
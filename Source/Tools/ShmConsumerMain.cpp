@@ -0,0 +1,210 @@
+/**
+ * flarkviz-shm-consumer: reference reader for FlarkViz's shared-memory output
+ *
+ * Attaches to the ring FlarkViz publishes with F8, follows the newest frame
+ * and reports frame rate, latency and skipped frames once a second. Reads
+ * pixels straight from the mapping; with --dump the first complete frame is
+ * also saved as a PPM.
+ *
+ *   flarkviz-shm-consumer
+ *   flarkviz-shm-consumer flarkviz --frames 600 --dump frame.ppm
+ *
+ * Deliberately uses nothing but the standard library and SharedFrameRing so
+ * it doubles as a template for consumers in other projects.
+ */
+
+#include "../Core/SharedFrameRing.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    void printUsage()
+    {
+        std::cerr <<
+            "Usage: flarkviz-shm-consumer [name] [options]\n"
+            "\n"
+            "  name              Shared-memory ring to attach to (default: flarkviz)\n"
+            "  --frames <n>      Exit after reading n frames (default: run until interrupted)\n"
+            "  --dump <file.ppm> Save the first complete frame\n";
+    }
+
+    bool writePPM(const std::string& path, const std::vector<uint8_t>& rgba, int width, int height)
+    {
+        FILE* file = std::fopen(path.c_str(), "wb");
+        if (file == nullptr)
+            return false;
+
+        std::fprintf(file, "P6\n%d %d\n255\n", width, height);
+
+        std::vector<uint8_t> row(static_cast<size_t>(width) * 3);
+        for (int y = 0; y < height; ++y)
+        {
+            const uint8_t* src = rgba.data() + static_cast<size_t>(y) * static_cast<size_t>(width) * 4;
+            for (int x = 0; x < width; ++x)
+            {
+                row[static_cast<size_t>(x) * 3 + 0] = src[x * 4 + 0];
+                row[static_cast<size_t>(x) * 3 + 1] = src[x * 4 + 1];
+                row[static_cast<size_t>(x) * 3 + 2] = src[x * 4 + 2];
+            }
+            std::fwrite(row.data(), 1, row.size(), file);
+        }
+
+        return std::fclose(file) == 0;
+    }
+
+    std::unique_ptr<SharedFrameRing> openRing(const std::string& name)
+    {
+        bool reported = false;
+
+        for (;;)
+        {
+            std::string error;
+            if (auto ring = SharedFrameRing::open(name, error))
+                return ring;
+
+            if (!reported)
+            {
+                std::cerr << "Waiting for '" << name << "' (" << error << ")\n";
+                reported = true;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string name = "flarkviz";
+    std::string dumpPath;
+    int64_t maxFrames = -1;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+
+        if (arg == "--frames" && i + 1 < argc)
+            maxFrames = std::atoll(argv[++i]);
+        else if (arg == "--dump" && i + 1 < argc)
+            dumpPath = argv[++i];
+        else if (arg == "--help" || arg == "-h")
+        {
+            printUsage();
+            return 0;
+        }
+        else if (!arg.empty() && arg[0] != '-')
+            name = arg;
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    auto ring = openRing(name);
+    std::cerr << "Attached to '" << name << "' (" << ring->getNumSlots() << " slots)\n";
+
+    uint64_t lastSequence = 0;
+    int64_t lastFrameNumber = -1;
+    int64_t framesRead = 0;
+
+    // Per-interval stats
+    int64_t intervalFrames = 0;
+    int64_t intervalSkipped = 0;
+    int64_t intervalTorn = 0;
+    uint64_t latencySumNs = 0;
+    uint64_t latencyMaxNs = 0;
+    uint32_t checksum = 0;
+    auto intervalStart = std::chrono::steady_clock::now();
+
+    while (maxFrames < 0 || framesRead < maxFrames)
+    {
+        if (!ring->waitForFrame(lastSequence, 1000))
+        {
+            if (ring->isClosed())
+            {
+                // Publisher went away or recreated the ring at a new size
+                std::cerr << "Ring closed, reattaching...\n";
+                ring.reset();
+                ring = openRing(name);
+                lastSequence = 0;
+                lastFrameNumber = -1;
+            }
+            continue;
+        }
+
+        SharedFrameRing::FrameView view;
+        if (!ring->acquireLatest(view) || view.sequence <= lastSequence)
+            continue;
+
+        // Read the pixels in place; a real consumer would upload or encode them here
+        const size_t frameBytes = static_cast<size_t>(view.stride) * static_cast<size_t>(view.height);
+        uint32_t sum = 0;
+        for (size_t i = 0; i < frameBytes; i += 64)
+            sum += view.pixels[i];
+
+        std::vector<uint8_t> copy;
+        if (!dumpPath.empty())
+            copy.assign(view.pixels, view.pixels + frameBytes);
+
+        if (!ring->isStillValid(view))
+        {
+            // The publisher lapped the ring while we were reading
+            intervalTorn++;
+            continue;
+        }
+
+        const uint64_t now = SharedFrameRing::getMonotonicNanos();
+        const uint64_t latency = now > view.timestampNs ? now - view.timestampNs : 0;
+        latencySumNs += latency;
+        latencyMaxNs = std::max(latencyMaxNs, latency);
+        checksum += sum;
+
+        if (lastFrameNumber >= 0 && view.frameNumber > lastFrameNumber + 1)
+            intervalSkipped += view.frameNumber - lastFrameNumber - 1;
+
+        lastSequence = view.sequence;
+        lastFrameNumber = view.frameNumber;
+        framesRead++;
+        intervalFrames++;
+
+        if (!dumpPath.empty())
+        {
+            if (writePPM(dumpPath, copy, view.width, view.height))
+                std::cerr << "Saved " << view.width << "x" << view.height << " frame to " << dumpPath << "\n";
+            else
+                std::cerr << "Could not write " << dumpPath << "\n";
+
+            dumpPath.clear();
+        }
+
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - intervalStart).count();
+        if (elapsed >= 1.0)
+        {
+            std::fprintf(stderr, "seq %llu  %dx%d  %.1f fps  latency avg %.2f ms max %.2f ms  skipped %lld  torn %lld  sum %08x\n",
+                         static_cast<unsigned long long>(view.sequence), view.width, view.height,
+                         static_cast<double>(intervalFrames) / elapsed,
+                         static_cast<double>(latencySumNs) / static_cast<double>(intervalFrames) / 1.0e6,
+                         static_cast<double>(latencyMaxNs) / 1.0e6,
+                         static_cast<long long>(intervalSkipped), static_cast<long long>(intervalTorn),
+                         checksum);
+
+            intervalFrames = 0;
+            intervalSkipped = 0;
+            intervalTorn = 0;
+            latencySumNs = 0;
+            latencyMaxNs = 0;
+            intervalStart = std::chrono::steady_clock::now();
+        }
+    }
+
+    return 0;
+}
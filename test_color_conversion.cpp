@@ -0,0 +1,134 @@
+#include "Source/Headless/ColorConversion.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+/**
+ * @brief Checks RGBA -> I420/NV12 against reference values and between layouts
+ *
+ * Build: g++ -std=c++20 -O2 test_color_conversion.cpp Source/Headless/ColorConversion.cpp
+ * The AVX2 kernels are picked at runtime; machines with and without AVX2
+ * must print the same checksum
+ */
+
+namespace
+{
+    void fill(std::vector<uint8_t>& rgba, uint8_t r, uint8_t g, uint8_t b)
+    {
+        for (size_t i = 0; i < rgba.size(); i += 4)
+        {
+            rgba[i + 0] = r;
+            rgba[i + 1] = g;
+            rgba[i + 2] = b;
+            rgba[i + 3] = 255;
+        }
+    }
+}
+
+int main()
+{
+    std::cout << "============================================" << std::endl;
+    std::cout << "  FlarkViz Color Conversion Test" << std::endl;
+    std::cout << "============================================" << std::endl;
+    std::cout << "AVX2 kernels: " << (ColorConversion::isAccelerated() ? "yes" : "no") << std::endl << std::endl;
+
+    bool passed = true;
+
+    // Flat colours hit the BT.601 limited-range reference values exactly
+    {
+        struct Case { const char* name; uint8_t r, g, b, y, u, v; };
+        const Case cases[] = {
+            { "black",   0,   0,   0,  16, 128, 128 },
+            { "white", 255, 255, 255, 235, 128, 128 },
+            { "red",   255,   0,   0,  82,  90, 240 },
+            { "green",   0, 255,   0, 144,  54,  34 },   // 145 in floating point
+            { "blue",    0,   0, 255,  41, 240, 110 },
+        };
+
+        const int w = 40, h = 6;
+        std::vector<uint8_t> rgba(static_cast<size_t>(w * h * 4));
+        std::vector<uint8_t> y(static_cast<size_t>(w * h)), u(static_cast<size_t>(w * h / 4)), v(u.size());
+
+        for (const auto& c : cases)
+        {
+            fill(rgba, c.r, c.g, c.b);
+            ColorConversion::rgbaToI420(rgba.data(), w, h, y.data(), u.data(), v.data());
+
+            bool ok = true;
+            for (auto value : y) ok = ok && value == c.y;
+            for (auto value : u) ok = ok && value == c.u;
+            for (auto value : v) ok = ok && value == c.v;
+
+            if (ok)
+                std::cout << "✅ " << c.name << " -> Y" << int(c.y) << " U" << int(c.u) << " V" << int(c.v) << std::endl;
+            else
+            {
+                std::cout << "❌ FAIL: " << c.name << " got Y" << int(y[0]) << " U" << int(u[0]) << " V" << int(v[0]) << std::endl;
+                passed = false;
+            }
+        }
+    }
+
+    // NV12 is I420 with U and V interleaved, for odd sizes and SIMD tails too;
+    // banded conversion matches whole-frame conversion
+    {
+        const int sizes[][2] = { { 1920, 1080 }, { 33, 17 }, { 1, 1 }, { 15, 3 }, { 17, 2 } };
+        std::mt19937 rng(1);
+        uint64_t checksum = 1469598103934665603ull;
+        bool consistent = true;
+
+        for (const auto& size : sizes)
+        {
+            const int w = size[0], h = size[1];
+            const size_t lumaSize = static_cast<size_t>(w) * h;
+            const size_t chromaSize = static_cast<size_t>((w + 1) / 2) * ((h + 1) / 2);
+
+            std::vector<uint8_t> rgba(lumaSize * 4);
+            for (auto& b : rgba)
+                b = static_cast<uint8_t>(rng());
+
+            std::vector<uint8_t> i420(static_cast<size_t>(ColorConversion::getYUV420Size(w, h)));
+            std::vector<uint8_t> nv12(i420.size()), banded(i420.size());
+
+            ColorConversion::rgbaToI420(rgba.data(), w, h, i420.data(), i420.data() + lumaSize,
+                                        i420.data() + lumaSize + chromaSize);
+            ColorConversion::rgbaToNV12(rgba.data(), w, h, nv12.data(), nv12.data() + lumaSize);
+
+            for (int row = 0; row < h; row += 4)
+                ColorConversion::rgbaToI420Rows(rgba.data(), w, h, row, std::min(h, row + 4),
+                                                banded.data(), banded.data() + lumaSize,
+                                                banded.data() + lumaSize + chromaSize);
+
+            consistent = consistent && std::memcmp(i420.data(), nv12.data(), lumaSize) == 0 && i420 == banded;
+            for (size_t i = 0; i < chromaSize; ++i)
+            {
+                consistent = consistent && nv12[lumaSize + i * 2] == i420[lumaSize + i]
+                                        && nv12[lumaSize + i * 2 + 1] == i420[lumaSize + chromaSize + i];
+            }
+
+            for (auto b : i420)
+                checksum = (checksum ^ b) * 1099511628211ull;
+        }
+
+        if (consistent)
+            std::cout << "✅ I420/NV12/banded agree (checksum " << std::hex << checksum << std::dec << ")" << std::endl;
+        else
+        {
+            std::cout << "❌ FAIL: layouts disagree" << std::endl;
+            passed = false;
+        }
+    }
+
+    std::cout << std::endl << "============================================" << std::endl;
+    if (!passed)
+    {
+        std::cout << "  Some tests FAILED" << std::endl;
+        return 1;
+    }
+    std::cout << "  All tests completed!" << std::endl;
+    std::cout << "============================================" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include "Source/Core/LockFreeQueue.h"
+#include <iostream>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Checks LockFreeQueue bounds, FIFO order and MPMC delivery
+ *
+ * Build: g++ -std=c++20 -O2 -pthread test_lock_free_queue.cpp -o test_lock_free_queue
+ */
+
+int main()
+{
+    std::cout << "============================================" << std::endl;
+    std::cout << "  FlarkViz Lock-Free Queue Test" << std::endl;
+    std::cout << "============================================" << std::endl << std::endl;
+
+    bool passed = true;
+
+    // Capacity rounds up and the queue refuses to overfill
+    {
+        LockFreeQueue<int> queue(5);
+        int pushed = 0;
+        while (queue.tryPush(pushed))
+            pushed++;
+
+        int value = -1;
+        bool fifo = true;
+        for (int i = 0; i < pushed; ++i)
+            fifo = fifo && queue.tryPop(value) && value == i;
+
+        if (queue.getCapacity() == 8 && pushed == 8 && fifo && !queue.tryPop(value))
+            std::cout << "✅ Bounded FIFO (capacity " << queue.getCapacity() << ")" << std::endl;
+        else
+        {
+            std::cout << "❌ FAIL: bounded FIFO (pushed " << pushed << ")" << std::endl;
+            passed = false;
+        }
+    }
+
+    // Single producer, single consumer: order preserved across wrap-around
+    {
+        LockFreeQueue<int> queue(16);
+        const int count = 200000;
+        bool ordered = true;
+
+        std::thread consumer([&]
+        {
+            int expected = 0, value = 0;
+            while (expected < count)
+            {
+                if (queue.tryPop(value))
+                {
+                    ordered = ordered && value == expected;
+                    expected++;
+                }
+            }
+        });
+
+        for (int i = 0; i < count; ++i)
+            while (!queue.tryPush(i))
+                std::this_thread::yield();
+
+        consumer.join();
+
+        if (ordered)
+            std::cout << "✅ SPSC order preserved over " << count << " items" << std::endl;
+        else
+        {
+            std::cout << "❌ FAIL: SPSC order broken" << std::endl;
+            passed = false;
+        }
+    }
+
+    // Multiple producers and consumers: every item delivered exactly once
+    {
+        LockFreeQueue<int> queue(64);
+        const int producers = 3, consumers = 3, perProducer = 50000;
+        const int total = producers * perProducer;
+
+        std::vector<std::atomic<int>> seen(static_cast<size_t>(total));
+        std::atomic<int> received {0};
+        std::vector<std::thread> threads;
+
+        for (int p = 0; p < producers; ++p)
+        {
+            threads.emplace_back([&, p]
+            {
+                for (int i = 0; i < perProducer; ++i)
+                    while (!queue.tryPush(p * perProducer + i))
+                        std::this_thread::yield();
+            });
+        }
+
+        for (int c = 0; c < consumers; ++c)
+        {
+            threads.emplace_back([&]
+            {
+                int value = 0;
+                while (received.load() < total)
+                {
+                    if (queue.tryPop(value))
+                    {
+                        seen[static_cast<size_t>(value)]++;
+                        received++;
+                    }
+                }
+            });
+        }
+
+        for (auto& t : threads)
+            t.join();
+
+        bool exactlyOnce = true;
+        for (auto& s : seen)
+            exactlyOnce = exactlyOnce && s.load() == 1;
+
+        if (exactlyOnce && received == total)
+            std::cout << "✅ MPMC delivered " << total << " items exactly once" << std::endl;
+        else
+        {
+            std::cout << "❌ FAIL: MPMC lost or duplicated items" << std::endl;
+            passed = false;
+        }
+    }
+
+    std::cout << std::endl << "============================================" << std::endl;
+    if (!passed)
+    {
+        std::cout << "  Some tests FAILED" << std::endl;
+        return 1;
+    }
+    std::cout << "  All tests completed!" << std::endl;
+    std::cout << "============================================" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include "Source/Presets/PresetBudget.h"
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+
+/**
+ * @brief Drives PresetBudget with synthetic frame times
+ *
+ * Frame cost is modelled as a fixed overhead plus a time per unit of
+ * estimated cost, which is what the budget's fit assumes.
+ */
+
+static double simulatedFrameMs(double cost)
+{
+    return 4.0 + cost * 0.001;
+}
+
+// GPU-bound: rendering at a lower scale costs proportionally fewer pixels
+static void showPreset(PresetBudget& budget, float cost, int frames, float scale = 1.0f)
+{
+    budget.presetSelected(cost);
+    budget.presetSwitched();
+
+    for (int i = 0; i < frames; ++i)
+        budget.addFrameTime(1.0, simulatedFrameMs(cost) * scale * scale, scale);
+}
+
+int main()
+{
+    std::cout << "============================================" << std::endl;
+    std::cout << "  FlarkViz Preset Budget Test" << std::endl;
+    std::cout << "============================================" << std::endl << std::endl;
+
+    bool passed = true;
+
+    PresetBudget budget;
+    const auto settings = budget.getSettings();
+    const int framesPerPreset = settings.settleFrames + settings.framesPerSample;
+
+    // Nothing is excluded before anything has been measured
+    if (budget.getWeight(1.0e6f) == 1.0f && !budget.getStats().enforcing)
+        std::cout << "✅ Unmeasured budget excludes nothing" << std::endl;
+    else
+    {
+        std::cout << "❌ FAIL: excluded presets before measuring" << std::endl;
+        passed = false;
+    }
+
+    // Frames during the settle period don't count
+    showPreset(budget, 2000.0f, settings.settleFrames);
+    if (budget.getStats().samples == 0)
+        std::cout << "✅ Ignored frames right after a switch" << std::endl;
+    else
+    {
+        std::cout << "❌ FAIL: sampled during the settle period" << std::endl;
+        passed = false;
+    }
+
+    // 4 ms + 1 us per unit against 16.7 ms: the budget is about 12700
+    std::cout << std::endl << "Measuring presets (4 ms + 0.001 ms/cost):" << std::endl;
+    // The heavier presets are rendered at a lowered resolution scale, as the
+    // ResolutionScaler would; the fit should still see their full cost
+    for (float cost : { 2000.0f, 6000.0f, 3000.0f, 9000.0f, 5000.0f })
+        showPreset(budget, cost, framesPerPreset, cost > 5000.0f ? 0.5f : 1.0f);
+
+    auto stats = budget.getStats();
+    std::cout << "  " << stats.samples << " samples, base " << std::fixed << std::setprecision(2)
+              << stats.baseMs << " ms, " << std::setprecision(5) << stats.msPerCost
+              << " ms/cost, budget " << std::setprecision(0) << stats.costBudget << std::endl;
+
+    const double expectedBudget = (settings.targetFrameMs - 4.0) / 0.001;
+    if (stats.enforcing && std::abs(stats.costBudget - expectedBudget) < expectedBudget * 0.01)
+        std::cout << "✅ Fitted the frame time model" << std::endl;
+    else
+    {
+        std::cout << "❌ FAIL: budget " << stats.costBudget << ", expected " << expectedBudget << std::endl;
+        passed = false;
+    }
+
+    const float cheap = 3000.0f;
+    const float nearLimit = static_cast<float>(expectedBudget * 0.95);
+    const float expensive = static_cast<float>(expectedBudget * 1.5);
+
+    if (budget.getWeight(cheap) == 1.0f && budget.getWeight(expensive) == 0.0f
+        && budget.getWeight(nearLimit) > 0.0f && budget.getWeight(nearLimit) < 1.0f)
+        std::cout << "✅ Cheap presets kept, expensive ones excluded, weight fades near the limit" << std::endl;
+    else
+    {
+        std::cout << "❌ FAIL: weights " << budget.getWeight(cheap) << " / " << budget.getWeight(nearLimit)
+                  << " / " << budget.getWeight(expensive) << std::endl;
+        passed = false;
+    }
+
+    // Disabling stops excluding but keeps the measurements
+    budget.setEnabled(false);
+    if (budget.getWeight(expensive) == 1.0f && budget.getStats().samples == stats.samples)
+        std::cout << "✅ Disabled budget excludes nothing" << std::endl;
+    else
+    {
+        std::cout << "❌ FAIL: disabled budget still excludes" << std::endl;
+        passed = false;
+    }
+
+    std::cout << std::endl << "============================================" << std::endl;
+    if (!passed)
+    {
+        std::cout << "  Some tests FAILED" << std::endl;
+        return 1;
+    }
+    std::cout << "  All tests completed!" << std::endl;
+    std::cout << "============================================" << std::endl;
+
+    return 0;
+}
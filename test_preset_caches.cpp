@@ -0,0 +1,225 @@
+#include "Source/Presets/PreparedPresetCache.h"
+#include "Source/Rendering/ShaderProgramCache.h"
+#include "Source/Rendering/ShaderTemplates.h"
+#include "Source/Headless/HeadlessGLContext.h"
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace juce::gl;
+
+/**
+ * @brief Checks the eviction rules of PreparedPresetCache and ShaderProgramCache
+ *
+ * The preset cache must stay within its byte budget and evict least
+ * recently used presets first. The program cache must keep to its program
+ * count the same way, but never delete a program that a render state or
+ * prepared preset still holds. The program cache needs a headless GL
+ * context; without one its checks are skipped.
+ */
+
+static void check(bool condition, const std::string& description, bool& passed)
+{
+    if (condition)
+        std::cout << "✅ " << description << std::endl;
+    else
+    {
+        std::cout << "❌ FAIL: " << description << std::endl;
+        passed = false;
+    }
+}
+
+// A preset whose size is set by its composite source
+static std::unique_ptr<PreparedPreset> makePrepared(uint64_t contentHash, size_t sourceBytes)
+{
+    auto prepared = std::make_unique<PreparedPreset>();
+    prepared->contentHash = contentHash;
+    prepared->compositeFragmentSource.assign(sourceBytes, ' ');
+    return prepared;
+}
+
+static std::string variant(int n)
+{
+    return std::string(MilkDrop::ShaderTemplates::DEFAULT_COMPOSITE_FRAGMENT) + "// variant " + std::to_string(n) + "\n";
+}
+
+static void testPreparedPresetCache(bool& passed)
+{
+    std::cout << "PreparedPresetCache:" << std::endl;
+
+    const size_t presetBytes = makePrepared(1, 4096)->getMemorySize();
+    PreparedPresetCache cache(presetBytes * 3 + presetBytes / 2);
+
+    for (uint64_t hash = 1; hash <= 3; ++hash)
+        cache.put(makePrepared(hash, 4096));
+
+    auto stats = cache.getStats();
+    check(stats.numPresets == 3 && stats.residentBytes == presetBytes * 3 && stats.evictions == 0,
+          "Three presets fit a budget of three and a half", passed);
+
+    // A fourth pushes out the first, which is the least recently used
+    cache.put(makePrepared(4, 4096));
+    stats = cache.getStats();
+    check(!cache.contains(1) && cache.contains(2) && cache.contains(3) && cache.contains(4)
+              && stats.evictions == 1 && stats.residentBytes <= stats.budgetBytes,
+          "Evicted the oldest preset to stay within the budget", passed);
+
+    // Taking a preset and putting it back makes it the most recently used
+    auto taken = cache.take(2);
+    cache.put(std::move(taken));
+    cache.put(makePrepared(5, 4096));
+    check(cache.contains(2) && !cache.contains(3) && cache.contains(4) && cache.contains(5),
+          "A preset shown again is evicted after older ones", passed);
+
+    // A second copy replaces the first rather than taking more room
+    cache.put(makePrepared(5, 4096));
+    stats = cache.getStats();
+    check(stats.numPresets == 3 && stats.residentBytes == presetBytes * 3,
+          "Putting the same hash again replaces the cached copy", passed);
+
+    check(cache.take(3) == nullptr && cache.take(4) != nullptr && !cache.contains(4)
+              && cache.getStats().hits == 2 && cache.getStats().misses == 1,
+          "take() removes the preset and counts hits and misses", passed);
+
+    // Neither too big for the budget nor without a hash: not kept, nothing evicted
+    cache.put(makePrepared(6, presetBytes * 4));
+    cache.put(makePrepared(0, 16));
+    stats = cache.getStats();
+    check(!cache.contains(6) && !cache.contains(0) && stats.numPresets == 2,
+          "Skipped a preset over budget and one without a hash", passed);
+
+    // Shrinking the budget evicts straight away, oldest first
+    cache.put(makePrepared(7, 4096));
+    cache.setBudget(presetBytes);
+    stats = cache.getStats();
+    check(stats.numPresets == 1 && cache.contains(7) && stats.residentBytes <= stats.budgetBytes,
+          "Shrinking the budget kept only the newest preset", passed);
+
+    // Random traffic never takes the cache over its budget, and the
+    // byte count always matches what is cached
+    std::mt19937 engine(7);
+    std::uniform_int_distribution<int> sizes(0, 20000);
+    std::uniform_int_distribution<int> hashes(1, 40);
+
+    cache.clear();
+    cache.setBudget(presetBytes * 8);
+    bool withinBudget = true;
+    bool countsMatch = true;
+
+    for (int i = 0; i < 2000; ++i)
+    {
+        const auto hash = static_cast<uint64_t>(hashes(engine));
+
+        if (i % 3 == 0)
+            cache.take(hash);
+        else
+            cache.put(makePrepared(hash, static_cast<size_t>(sizes(engine))));
+
+        stats = cache.getStats();
+        withinBudget = withinBudget && stats.residentBytes <= stats.budgetBytes;
+
+        size_t bytes = 0;
+        int count = 0;
+        for (uint64_t h = 1; h <= 40; ++h)
+        {
+            if (!cache.contains(h))
+                continue;
+
+            // Take it out and put it back to read its size; the order changes
+            // but the contents and the total don't
+            auto prepared = cache.take(h);
+            bytes += prepared->getMemorySize();
+            ++count;
+            cache.put(std::move(prepared));
+        }
+
+        countsMatch = countsMatch && bytes == cache.getStats().residentBytes && count == stats.numPresets;
+    }
+
+    check(withinBudget, "Stayed within the budget over 2000 random puts and takes", passed);
+    check(countsMatch, "Resident bytes always matched the cached presets", passed);
+}
+
+static void testShaderProgramCache(bool& passed)
+{
+    std::cout << std::endl << "ShaderProgramCache:" << std::endl;
+
+    HeadlessGLContext context;
+    if (!context.create())
+    {
+        std::cout << "⚠️  Skipped, no GL context: " << context.getLastError() << std::endl;
+        return;
+    }
+
+    {
+        ShaderProgramCache cache(3);
+
+        auto held = cache.get(variant(1));
+        const GLuint evictedId = cache.get(variant(2))->programId;
+        cache.get(variant(3));
+        check(held != nullptr && cache.getNumPrograms() == 3, "Linked three programs", passed);
+
+        // Full: the least recently used program nothing holds goes, not the held one
+        cache.get(variant(4));
+        check(cache.getNumPrograms() == 3 && cache.contains(variant(1)) && !cache.contains(variant(2))
+                  && cache.contains(variant(3)) && cache.contains(variant(4)),
+              "Evicted the oldest program that nothing holds", passed);
+        check(glIsProgram(held->programId) == GL_TRUE && glIsProgram(evictedId) == GL_FALSE,
+              "Deleted the evicted program and kept the held one", passed);
+
+        // A lookup counts as a use
+        cache.get(variant(3));
+        cache.get(variant(5));
+        check(cache.contains(variant(3)) && !cache.contains(variant(4)) && cache.contains(variant(5)),
+              "A program looked up again outlives an older one", passed);
+
+        // Everything held: the cache grows rather than deleting a program in use
+        auto held3 = cache.get(variant(3));
+        auto held5 = cache.get(variant(5));
+        auto held6 = cache.get(variant(6));
+        check(cache.getNumPrograms() == 4 && held3 != nullptr && held5 != nullptr && held6 != nullptr
+                  && glIsProgram(held3->programId) == GL_TRUE && glIsProgram(held5->programId) == GL_TRUE
+                  && glIsProgram(held->programId) == GL_TRUE,
+              "Kept every held program when none could be evicted", passed);
+
+        // Once released, the surplus goes at the next link
+        held3.reset();
+        held5.reset();
+        held6.reset();
+        cache.get(variant(7));
+        check(cache.getNumPrograms() == 3 && cache.contains(variant(1)) && cache.contains(variant(7)),
+              "Shrank back to the limit once programs were released", passed);
+
+        check(!cache.warm(variant(7)) && cache.warm(variant(8)) && cache.contains(variant(8)),
+              "warm() links only what isn't cached", passed);
+
+        cache.releaseGL();
+        check(cache.getNumPrograms() == 0, "releaseGL() deleted every program", passed);
+    }
+
+    context.destroy();
+}
+
+int main()
+{
+    std::cout << "============================================" << std::endl;
+    std::cout << "  FlarkViz Preset Cache Test" << std::endl;
+    std::cout << "============================================" << std::endl << std::endl;
+
+    bool passed = true;
+
+    testPreparedPresetCache(passed);
+    testShaderProgramCache(passed);
+
+    std::cout << std::endl << "============================================" << std::endl;
+    if (!passed)
+    {
+        std::cout << "  Some tests FAILED" << std::endl;
+        return 1;
+    }
+    std::cout << "  All tests completed!" << std::endl;
+    std::cout << "============================================" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,285 @@
+#include "Source/Presets/PresetCatalog.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Checks that PresetCatalog persists its entries and reconciles changes
+ *
+ * Builds a small library in a temporary folder, then reopens its catalog
+ * file with fresh PresetCatalogs: unchanged files must come back from the
+ * file exactly as written, and added, removed and changed files must be
+ * picked up by the next reconcile. Copies that only differ in whitespace
+ * or comment lines must fold into one entry; any other difference keeps
+ * presets apart.
+ */
+
+static void check(bool condition, const std::string& description, bool& passed)
+{
+    if (condition)
+        std::cout << "✅ " << description << std::endl;
+    else
+    {
+        std::cout << "❌ FAIL: " << description << std::endl;
+        passed = false;
+    }
+}
+
+static std::string writePreset(const juce::File& folder, const juce::String& name, const std::string& text)
+{
+    const auto file = folder.getChildFile(name);
+    file.getParentDirectory().createDirectory();
+    file.replaceWithText(juce::String(text));
+    return file.getFullPathName().toStdString();
+}
+
+static std::string presetText(const std::string& name, const std::string& rating, const std::string& perFrame)
+{
+    return "[preset00]\nname=" + name + "\nauthor=FlarkViz\nfRating=" + rating
+         + "\nfDecay=0.95\n[per_frame_1]\n" + perFrame + "\n";
+}
+
+static bool sameEntry(const PresetCatalog::Entry& a, const PresetCatalog::Entry& b)
+{
+    return a.path == b.path && a.modificationTime == b.modificationTime && a.fileSize == b.fileSize
+        && a.contentHash == b.contentHash && a.normalizedHash == b.normalizedHash
+        && a.name == b.name && a.author == b.author && a.rating == b.rating && a.cost == b.cost
+        && a.features == b.features && a.valid == b.valid && a.error == b.error
+        && a.aliases.size() == b.aliases.size();
+}
+
+static bool sameEntries(const std::vector<PresetCatalog::Entry>& a, const std::vector<PresetCatalog::Entry>& b)
+{
+    if (a.size() != b.size())
+        return false;
+
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        if (!sameEntry(a[i], b[i]))
+            return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    std::cout << "============================================" << std::endl;
+    std::cout << "  FlarkViz Preset Catalog Test" << std::endl;
+    std::cout << "============================================" << std::endl << std::endl;
+
+    bool passed = true;
+
+    const auto root = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                          .getNonexistentChildFile("flarkviz-catalog-test", "", false);
+    const auto folder = root.getChildFile("presets");
+    const auto catalogFile = root.getChildFile("preset-catalog.bin");
+    folder.createDirectory();
+
+    const auto alpha = writePreset(folder, "alpha.milk", presetText("Alpha", "4", "zoom = zoom * 1.01;"));
+    const auto beta = writePreset(folder, "beta.milk", presetText("Beta", "2", "rot = rot + 0.02;"));
+    const auto broken = writePreset(folder, "broken.milk", presetText("Broken", "3", "zoom = (1 +;"));
+    const auto nested = writePreset(folder, "more/gamma.milk", presetText("Gamma", "5", "warp = bass * 0.5;"));
+
+    // First scan: everything is parsed and the catalog file is written
+    std::cout << "First scan:" << std::endl;
+    PresetCatalog::Snapshot scanned;
+    {
+        PresetCatalog catalog;
+        catalog.open(folder, catalogFile);
+        catalog.waitForReconcile();
+
+        const auto stats = catalog.getLastReconcileStats();
+        scanned = catalog.getSnapshot();
+
+        check(stats.files == 4 && stats.parsed == 4 && stats.reused == 0 && stats.removed == 0,
+              "Parsed all 4 presets, including the nested one", passed);
+        check(stats.invalid == 1, "Counted the preset with broken code as invalid", passed);
+        check(catalogFile.existsAsFile(), "Wrote the catalog file", passed);
+
+        const int a = PresetCatalog::indexOf(*scanned, alpha);
+        const int b = PresetCatalog::indexOf(*scanned, broken);
+        check(a >= 0 && (*scanned)[static_cast<size_t>(a)].name == "Alpha"
+                  && (*scanned)[static_cast<size_t>(a)].author == "FlarkViz"
+                  && (*scanned)[static_cast<size_t>(a)].rating == 4.0f
+                  && (*scanned)[static_cast<size_t>(a)].valid,
+              "Read name, author and rating", passed);
+        check(b >= 0 && !(*scanned)[static_cast<size_t>(b)].valid
+                  && !(*scanned)[static_cast<size_t>(b)].error.empty(),
+              "Kept the compile error of the broken preset", passed);
+    }
+
+    // Round trip: a fresh catalog lists the same entries from the file
+    // alone and reuses every one of them
+    std::cout << std::endl << "Reopening the catalog file:" << std::endl;
+    {
+        PresetCatalog catalog;
+        catalog.open(folder, catalogFile);
+        const auto mapped = catalog.getSnapshot();
+        catalog.waitForReconcile();
+
+        const auto stats = catalog.getLastReconcileStats();
+        check(sameEntries(*mapped, *scanned), "Catalog file gave back every entry field for field", passed);
+        check(stats.reused == 4 && stats.parsed == 0 && stats.removed == 0,
+              "Reused all 4 entries without parsing", passed);
+        check(catalog.getGeneration() == 1 && sameEntries(*catalog.getSnapshot(), *scanned),
+              "Published nothing new for an unchanged library", passed);
+    }
+
+    // Change one file, remove one and add one
+    writePreset(folder, "alpha.milk", presetText("Alpha Two", "1", "zoom = zoom * 0.99 + 0.02;"));
+    folder.getChildFile("beta.milk").deleteFile();
+    const auto delta = writePreset(folder, "delta.milk", presetText("Delta", "3", "dx = 0.01;"));
+
+    std::cout << std::endl << "Reconciling changes:" << std::endl;
+    {
+        PresetCatalog catalog;
+        catalog.open(folder, catalogFile);
+        catalog.waitForReconcile();
+
+        const auto stats = catalog.getLastReconcileStats();
+        const auto entries = catalog.getSnapshot();
+
+        check(stats.files == 4 && stats.parsed == 2 && stats.reused == 2 && stats.removed == 1,
+              "Parsed the changed and the new file, reused 2, removed 1", passed);
+        check(PresetCatalog::indexOf(*entries, beta) < 0, "Dropped the removed preset", passed);
+
+        const int a = PresetCatalog::indexOf(*entries, alpha);
+        check(a >= 0 && (*entries)[static_cast<size_t>(a)].name == "Alpha Two"
+                  && (*entries)[static_cast<size_t>(a)].rating == 1.0f,
+              "Updated the changed preset", passed);
+        check(PresetCatalog::indexOf(*entries, delta) >= 0, "Listed the new preset", passed);
+
+        const int n = PresetCatalog::indexOf(*entries, nested);
+        const int s = PresetCatalog::indexOf(*scanned, nested);
+        check(n >= 0 && s >= 0 && sameEntry((*entries)[static_cast<size_t>(n)], (*scanned)[static_cast<size_t>(s)]),
+              "Kept the unchanged entry as it was", passed);
+        check(catalog.getGeneration() == 2, "Published the reconciled entries once", passed);
+    }
+
+    // The rewritten file holds the reconciled library
+    {
+        PresetCatalog catalog;
+        catalog.open(folder, catalogFile);
+        catalog.waitForReconcile();
+
+        const auto stats = catalog.getLastReconcileStats();
+        check(stats.reused == 4 && stats.parsed == 0, "Rewrote the catalog file after the changes", passed);
+    }
+
+    // A catalog belongs to one folder
+    {
+        const auto otherFolder = root.getChildFile("other");
+        writePreset(otherFolder, "epsilon.milk", presetText("Epsilon", "3", "dy = 0.01;"));
+
+        PresetCatalog catalog;
+        catalog.open(otherFolder, catalogFile);
+        const auto mapped = catalog.getSnapshot();
+        catalog.waitForReconcile();
+
+        const auto stats = catalog.getLastReconcileStats();
+        check(mapped->empty() && stats.files == 1 && stats.parsed == 1 && stats.removed == 0,
+              "Ignored a catalog written for another folder", passed);
+    }
+
+    // Duplicates: whitespace and comment lines don't count, anything else does
+    std::cout << std::endl << "Duplicates:" << std::endl;
+    {
+        const auto dupes = root.getChildFile("dupes");
+        const auto dupesCatalog = root.getChildFile("dupes-catalog.bin");
+        const std::string original = "[preset00]\nname=Original\nfDecay=0.95\n[per_frame_1]\n"
+                                     "zoom = zoom * 1.01;\nrot = rot + 0.02;\n";
+
+        const std::vector<std::pair<juce::String, std::string>> copies = {
+            { "b-whitespace.milk", "\xEF\xBB\xBF[preset00]\r\n\r\n  name=Original  \r\nfDecay=0.95\r\n"
+                                   "[per_frame_1]\r\n\tzoom =  zoom\t* 1.01;\r\n    rot = rot + 0.02;" },
+            { "c-comments.milk", "// Saved by MilkDrop\n[preset00]\nname=Original\n// fDecay=0.9\nfDecay=0.95\n"
+                                 "[per_frame_1]\n  // Slow zoom\nzoom = zoom * 1.01;\n//\nrot = rot + 0.02;\n" },
+            { "d-both.milk", "\n\n[preset00]\r\n    // Renamed copy\r\nname=Original\r\nfDecay=0.95\r\n"
+                             "[per_frame_1]\r\n zoom = zoom * 1.01; \r\n\t//rot = 0;\r\nrot = rot + 0.02;\r\n// end" }
+        };
+        const std::vector<std::pair<juce::String, std::string>> different = {
+            { "e-value.milk", "[preset00]\nname=Original\nfDecay=0.96\n[per_frame_1]\n"
+                              "zoom = zoom * 1.01;\nrot = rot + 0.02;\n" },
+            { "f-code.milk", "[preset00]\nname=Original\nfDecay=0.95\n[per_frame_1]\n"
+                             "zoom = zoom * 1.01;\nrot = rot + 0.02;\ndx = 0.01;\n" },
+            { "g-comment-in-code.milk", "[preset00]\nname=Original\nfDecay=0.95\n[per_frame_1]\n"
+                                        "zoom = zoom * 1.01; // Slow zoom\nrot = rot + 0.02;\n" },
+            { "h-split-line.milk", "[preset00]\nname=Original\nfDecay=0.95\n[per_frame_1]\n"
+                                   "zoom = zoom\n* 1.01;\nrot = rot + 0.02;\n" }
+        };
+
+        const uint64_t originalHash = PresetCatalog::hashNormalized(original);
+        bool copiesMatch = true;
+        bool differencesKept = true;
+
+        const auto originalPath = writePreset(dupes, "a-original.milk", original);
+        std::vector<std::string> copyPaths;
+
+        for (const auto& [name, text] : copies)
+        {
+            copiesMatch = copiesMatch && PresetCatalog::hashNormalized(text) == originalHash;
+            copyPaths.push_back(writePreset(dupes, name, text));
+        }
+
+        for (const auto& [name, text] : different)
+        {
+            differencesKept = differencesKept && PresetCatalog::hashNormalized(text) != originalHash;
+            writePreset(dupes, name, text);
+        }
+
+        check(copiesMatch, "Whitespace and comment-only copies have the original's normalized hash", passed);
+        check(differencesKept, "Changed values, code, trailing comments and line breaks change the hash", passed);
+
+        PresetCatalog catalog;
+        catalog.open(dupes, dupesCatalog);
+        catalog.waitForReconcile();
+
+        const auto stats = catalog.getLastReconcileStats();
+        const auto entries = catalog.getSnapshot();
+        const int index = PresetCatalog::indexOf(*entries, originalPath);
+
+        check(stats.files == 8 && stats.duplicates == 3 && entries->size() == 5,
+              "Folded the 3 copies into the original: 8 files, 5 entries", passed);
+
+        bool aliased = index >= 0 && (*entries)[static_cast<size_t>(index)].aliases.size() == copyPaths.size();
+        for (size_t i = 0; aliased && i < copyPaths.size(); ++i)
+        {
+            aliased = (*entries)[static_cast<size_t>(index)].aliases[i].path == copyPaths[i]
+                   && PresetCatalog::indexOf(*entries, copyPaths[i]) < 0
+                   && PresetCatalog::findEntry(*entries, copyPaths[i]) == index;
+        }
+        check(aliased, "The copies are aliases of the first file by path", passed);
+
+        bool separate = true;
+        for (const auto& [name, text] : different)
+        {
+            const int other = PresetCatalog::indexOf(*entries, dupes.getChildFile(name).getFullPathName().toStdString());
+            separate = separate && other >= 0 && (*entries)[static_cast<size_t>(other)].aliases.empty();
+        }
+        check(separate, "Presets with real differences stay separate entries", passed);
+
+        // Aliases are written to the catalog file and come back from it
+        PresetCatalog reopened;
+        reopened.open(dupes, dupesCatalog);
+        reopened.waitForReconcile();
+
+        const auto reread = reopened.getSnapshot();
+        check(reopened.getLastReconcileStats().reused == 8 && sameEntries(*reread, *entries)
+                  && (*reread)[static_cast<size_t>(index)].aliases.size() == copyPaths.size(),
+              "Aliases survive the catalog file round trip", passed);
+    }
+
+    root.deleteRecursively();
+
+    std::cout << std::endl << "============================================" << std::endl;
+    if (!passed)
+    {
+        std::cout << "  Some tests FAILED" << std::endl;
+        return 1;
+    }
+    std::cout << "  All tests completed!" << std::endl;
+    std::cout << "============================================" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,216 @@
+#include "Source/Presets/PresetPack.h"
+#include "Source/Presets/PresetCatalog.h"
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Builds preset packs and reads them back, whole and damaged
+ *
+ * Every member of a built pack must come back with its metadata and the
+ * exact text of its file, compressed or stored raw. A pack with the wrong
+ * magic or version, a truncated one or one with a corrupt header must be
+ * refused by open(), and a damaged body must never be returned as text.
+ */
+
+static void check(bool condition, const std::string& description, bool& passed)
+{
+    if (condition)
+        std::cout << "✅ " << description << std::endl;
+    else
+    {
+        std::cout << "❌ FAIL: " << description << std::endl;
+        passed = false;
+    }
+}
+
+static std::string readBytes(const juce::File& file)
+{
+    juce::MemoryBlock data;
+    file.loadFileAsData(data);
+    return std::string(static_cast<const char*>(data.getData()), data.getSize());
+}
+
+static juce::File writeBytes(const juce::File& file, const std::string& bytes)
+{
+    file.replaceWithData(bytes.data(), bytes.size());
+    return file;
+}
+
+// Every member matches its source file
+static bool membersMatch(const PresetPack& pack, const std::map<std::string, std::string>& sources)
+{
+    if (pack.getNumMembers() != static_cast<int>(sources.size()))
+        return false;
+
+    for (const auto& [name, source] : sources)
+    {
+        const int index = pack.indexOf(name);
+        std::string storage;
+        std::string_view text;
+
+        if (index < 0 || pack.getMember(index).name != name || !pack.readBody(index, storage, text)
+            || text != source || pack.getMember(index).size != source.size()
+            || pack.getMember(index).contentHash != PresetCatalog::hashContent(source.data(), source.size()))
+            return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    std::cout << "============================================" << std::endl;
+    std::cout << "  FlarkViz Preset Pack Test" << std::endl;
+    std::cout << "============================================" << std::endl << std::endl;
+
+    bool passed = true;
+
+    const auto root = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                          .getNonexistentChildFile("flarkviz-pack-test", "", false);
+    const auto folder = root.getChildFile("presets");
+
+    // A long preset that compresses, a short one that doesn't, a copy, a
+    // broken one and one in a subfolder
+    std::string longPreset = "[preset00]\nname=Long\nauthor=FlarkViz\nfRating=4\n[per_frame_1]\n";
+    for (int i = 0; i < 200; ++i)
+        longPreset += "zoom = zoom * 1.0001 + " + std::to_string(i) + " * 0.00001;\n";
+
+    const std::map<std::string, std::string> sources = {
+        { "long.milk", longPreset },
+        { "short.milk", "[preset00]\nname=Short\nfDecay=0.9\n" },
+        { "copy of long.milk", longPreset },
+        { "broken.milk", "[preset00]\nname=Broken\n[per_frame_1]\nzoom = (1 +;\n" },
+        { "Artist/nested.milk", "[preset00]\nname=Nested\nauthor=Someone\nfRating=2\n" }
+    };
+
+    for (const auto& [name, source] : sources)
+    {
+        const auto file = folder.getChildFile(juce::String(name));
+        file.getParentDirectory().createDirectory();
+        writeBytes(file, source);
+    }
+
+    // Compressed: build, open, read every member back
+    std::cout << "Round trip:" << std::endl;
+    const auto packFile = root.getChildFile("test.fvpack");
+    PresetPack::BuildStats stats;
+    std::string error;
+
+    const bool built = PresetPack::build(folder, packFile, { true, 2 }, stats, error);
+    check(built && stats.members == 5 && stats.invalid == 1 && stats.sharedBodies == 1 && stats.compressed >= 1,
+          "Built 5 members, one invalid, one sharing the body of its copy", passed);
+
+    PresetPack pack;
+    check(pack.open(packFile), "Opened the pack", passed);
+    check(membersMatch(pack, sources), "Every member reads back as the exact text of its file", passed);
+
+    bool sorted = true;
+    for (int i = 1; i < pack.getNumMembers(); ++i)
+        sorted = sorted && pack.getMember(i - 1).name < pack.getMember(i).name;
+    check(sorted && pack.indexOf("missing.milk") < 0, "Members are sorted by name; unknown names aren't found", passed);
+
+    const auto longMember = pack.getMember(pack.indexOf("long.milk"));
+    const auto shortMember = pack.getMember(pack.indexOf("short.milk"));
+    const auto brokenMember = pack.getMember(pack.indexOf("broken.milk"));
+    const auto nestedMember = pack.getMember(pack.indexOf("Artist/nested.milk"));
+    check(longMember.compressed && longMember.storedSize < longMember.size && !shortMember.compressed,
+          "Compressed the long preset and stored the short one raw", passed);
+    check(nestedMember.title == "Nested" && nestedMember.author == "Someone" && nestedMember.rating == 2.0f
+              && nestedMember.valid && !brokenMember.valid && !brokenMember.error.empty(),
+          "Kept title, author, rating and the validation result", passed);
+
+    // Library paths of members
+    juce::File splitPack;
+    std::string memberName;
+    std::string text;
+    const auto memberFile = PresetPack::getMemberFile(packFile, "Artist/nested.milk");
+    check(PresetPack::splitMemberPath(memberFile, splitPack, memberName) && splitPack == packFile
+              && memberName == "Artist/nested.milk"
+              && PresetPack::readMemberFile(memberFile, text) && text == sources.at("Artist/nested.milk"),
+          "A member's library path splits back and reads its text", passed);
+
+    // Raw: bodies are views of the mapping
+    const auto rawFile = root.getChildFile("raw.fvpack");
+    PresetPack raw;
+    const bool rawBuilt = PresetPack::build(folder, rawFile, { false, 1 }, stats, error);
+
+    std::string storage;
+    std::string_view view;
+    check(rawBuilt && raw.open(rawFile) && membersMatch(raw, sources) && stats.compressed == 0
+              && raw.readBody(raw.indexOf("long.milk"), storage, view) && storage.empty(),
+          "Uncompressed pack reads back in place, without copying", passed);
+    raw.close();
+
+    // Damaged packs
+    std::cout << std::endl << "Damaged packs:" << std::endl;
+    const std::string bytes = readBytes(packFile);
+
+    auto openDamaged = [&](std::string damaged, std::string& lastError)
+    {
+        PresetPack damagedPack;
+        const bool opened = damagedPack.open(writeBytes(root.getChildFile("damaged.fvpack"), damaged));
+        lastError = damagedPack.getLastError();
+        return opened;
+    };
+
+    std::string notPack = bytes;
+    notPack[0] = 'X';
+    check(!openDamaged(notPack, error) && error == "not a preset pack", "Refused a file without the magic", passed);
+
+    // FileHeader: 8 bytes of magic, then the version
+    std::string newer = bytes;
+    const uint32_t futureVersion = 99;
+    std::memcpy(&newer[8], &futureVersion, sizeof(futureVersion));
+    check(!openDamaged(newer, error) && error == "unsupported pack version 99",
+          "Refused a pack of another version", passed);
+
+    check(!openDamaged(bytes.substr(0, bytes.size() - 1), error) && error == "truncated pack",
+          "Refused a pack missing its last byte", passed);
+    check(!openDamaged(bytes.substr(0, bytes.size() / 2), error) && error == "truncated pack",
+          "Refused a pack cut in half", passed);
+    check(!openDamaged(bytes.substr(0, 20), error), "Refused a file shorter than the header", passed);
+
+    // ... then the member count and the record offset, which must not wrap
+    // around when the count's records are added to it
+    std::string wrapping = bytes;
+    const uint64_t hugeOffset = ~static_cast<uint64_t>(0) - 64;
+    std::memcpy(&wrapping[16], &hugeOffset, sizeof(hugeOffset));
+    check(!openDamaged(wrapping, error) && error == "truncated pack", "Refused a record offset past the end", passed);
+
+    // A damaged body can fail to read, but never reads as the wrong text
+    std::string damagedBody = bytes;
+    for (size_t i = damagedBody.size() - longMember.storedSize; i < damagedBody.size(); i += 7)
+        damagedBody[i] = static_cast<char>(damagedBody[i] ^ 0x5a);
+
+    PresetPack damagedPack;
+    int failed = 0;
+    bool neverWrong = damagedPack.open(writeBytes(root.getChildFile("damaged.fvpack"), damagedBody));
+    for (const auto& [name, source] : sources)
+    {
+        const int index = damagedPack.indexOf(name);
+        if (!damagedPack.readBody(index, storage, view))
+            ++failed;
+        else
+            neverWrong = neverWrong && view == source;
+    }
+    check(neverWrong && failed > 0, "Damaged bodies failed to read (" + std::to_string(failed) + " of "
+              + std::to_string(sources.size()) + ") instead of giving the wrong text", passed);
+
+    damagedPack.close();
+    pack.close();
+    root.deleteRecursively();
+
+    std::cout << std::endl << "============================================" << std::endl;
+    if (!passed)
+    {
+        std::cout << "  Some tests FAILED" << std::endl;
+        return 1;
+    }
+    std::cout << "  All tests completed!" << std::endl;
+    std::cout << "============================================" << std::endl;
+
+    return 0;
+}
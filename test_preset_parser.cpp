@@ -0,0 +1,219 @@
+#include "Source/Presets/PresetParser.h"
+#include "Source/Tools/LegacyPresetParser.h"
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Checks PresetParser against the juce::StringArray parser it replaced
+ *
+ * Both parsers read the same text and must agree on every key, on the
+ * numbers juce::String::getFloatValue() / getIntValue() accept or reject,
+ * and on the code block the old parser kept. Where PresetParser does
+ * better on purpose (every code section, assignment lines in code), the
+ * result is checked on its own.
+ */
+
+static void check(bool condition, const std::string& description, bool& passed)
+{
+    if (condition)
+        std::cout << "✅ " << description << std::endl;
+    else
+    {
+        std::cout << "❌ FAIL: " << description << std::endl;
+        passed = false;
+    }
+}
+
+// NaN from "nan" must match NaN; +0 and -0 count as equal, as in the old parser's comparisons
+static bool sameFloat(float a, float b)
+{
+    return a == b || (std::isnan(a) && std::isnan(b));
+}
+
+static bool sameItems(const std::vector<MilkDropPreset::WaveOrShape>& a,
+                      const std::vector<MilkDropPreset::WaveOrShape>& b)
+{
+    if (a.size() != b.size())
+        return false;
+
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        const auto& x = a[i];
+        const auto& y = b[i];
+
+        if (x.enabled != y.enabled || x.sides != y.sides || x.thick != y.thick || x.additive != y.additive
+            || !sameFloat(x.r, y.r) || !sameFloat(x.g, y.g) || !sameFloat(x.b, y.b) || !sameFloat(x.a, y.a)
+            || !sameFloat(x.rad, y.rad))
+            return false;
+    }
+
+    return true;
+}
+
+// Every field the old parser could set
+static bool samePreset(const MilkDropPreset& a, const MilkDropPreset& b)
+{
+    return a.name == b.name && a.author == b.author
+        && sameFloat(a.fRating, b.fRating) && sameFloat(a.fGammaAdj, b.fGammaAdj) && sameFloat(a.fDecay, b.fDecay)
+        && sameFloat(a.fVideoEchoZoom, b.fVideoEchoZoom) && sameFloat(a.fVideoEchoAlpha, b.fVideoEchoAlpha)
+        && a.nVideoEchoOrientation == b.nVideoEchoOrientation && a.nWaveMode == b.nWaveMode
+        && a.bAdditiveWaves == b.bAdditiveWaves && a.bWaveDots == b.bWaveDots && a.bWaveThick == b.bWaveThick
+        && a.bModWaveAlphaByVolume == b.bModWaveAlphaByVolume && a.bMaximizeWaveColor == b.bMaximizeWaveColor
+        && a.bTexWrap == b.bTexWrap && a.bDarkenCenter == b.bDarkenCenter && a.bRedBlueStereo == b.bRedBlueStereo
+        && a.bBrighten == b.bBrighten && a.bDarken == b.bDarken && a.bSolarize == b.bSolarize
+        && a.bInvert == b.bInvert
+        && sameFloat(a.fWaveAlpha, b.fWaveAlpha) && sameFloat(a.fWaveScale, b.fWaveScale)
+        && sameFloat(a.fWaveSmoothing, b.fWaveSmoothing) && sameFloat(a.fWaveParam, b.fWaveParam)
+        && sameFloat(a.fModWaveAlphaStart, b.fModWaveAlphaStart) && sameFloat(a.fModWaveAlphaEnd, b.fModWaveAlphaEnd)
+        && sameFloat(a.fWarpAnimSpeed, b.fWarpAnimSpeed) && sameFloat(a.fWarpScale, b.fWarpScale)
+        && sameFloat(a.fZoomExponent, b.fZoomExponent) && sameFloat(a.fShader, b.fShader)
+        && sameFloat(a.fRotCX, b.fRotCX) && sameFloat(a.fRotCY, b.fRotCY) && sameFloat(a.fRot, b.fRot)
+        && sameFloat(a.fXPush, b.fXPush) && sameFloat(a.fYPush, b.fYPush) && sameFloat(a.fWarpAmount, b.fWarpAmount)
+        && sameFloat(a.fStretchX, b.fStretchX) && sameFloat(a.fStretchY, b.fStretchY)
+        && sameFloat(a.wave_r, b.wave_r) && sameFloat(a.wave_g, b.wave_g) && sameFloat(a.wave_b, b.wave_b)
+        && a.perFrameInitCode == b.perFrameInitCode && a.perFrameCode == b.perFrameCode
+        && a.perPixelCode == b.perPixelCode && a.warpShaderCode == b.warpShaderCode
+        && a.compShaderCode == b.compShaderCode
+        && sameItems(a.waves, b.waves) && sameItems(a.shapes, b.shapes);
+}
+
+static bool parsersAgree(const std::string& text, MilkDropPreset& parsed)
+{
+    MilkDropPreset legacy;
+    PresetParser::parse(text, parsed);
+    LegacyPresetParser::parse(juce::String::fromUTF8(text.data(), static_cast<int>(text.size())), legacy);
+    return samePreset(parsed, legacy);
+}
+
+int main()
+{
+    std::cout << "============================================" << std::endl;
+    std::cout << "  FlarkViz Preset Parser Test" << std::endl;
+    std::cout << "============================================" << std::endl << std::endl;
+
+    bool passed = true;
+    MilkDropPreset preset;
+
+    // Every key the old parser knew, each with its own value
+    std::cout << "Keys:" << std::endl;
+
+    const std::vector<std::string> floatKeys = {
+        "fRating", "fGammaAdj", "fDecay", "fVideoEchoZoom", "fVideoEchoAlpha", "fWaveAlpha", "fWaveScale",
+        "fWaveSmoothing", "fWaveParam", "fModWaveAlphaStart", "fModWaveAlphaEnd", "fWarpAnimSpeed",
+        "fWarpScale", "fZoomExponent", "fShader", "fRotCX", "fRotCY", "fRot", "fXPush", "fYPush",
+        "fWarpAmount", "fStretchX", "fStretchY", "wave_r", "wave_g", "wave_b"
+    };
+    const std::vector<std::string> intKeys = { "nVideoEchoOrientation", "nWaveMode" };
+    const std::vector<std::string> boolKeys = {
+        "bAdditiveWaves", "bWaveDots", "bWaveThick", "bModWaveAlphaByVolume", "bMaximizeWaveColor",
+        "bTexWrap", "bDarkenCenter", "bRedBlueStereo", "bBrighten", "bDarken", "bSolarize", "bInvert"
+    };
+
+    std::string text = "[preset00]\nname=Every Key\nauthor=FlarkViz\n";
+    for (size_t i = 0; i < floatKeys.size(); ++i)
+        text += floatKeys[i] + "=" + std::to_string(0.125 * static_cast<double>(i + 1)) + "\n";
+    for (size_t i = 0; i < intKeys.size(); ++i)
+        text += intKeys[i] + "=" + std::to_string(i + 2) + "\n";
+    for (const auto& key : boolKeys)
+        text += key + "=1\n";
+
+    // Shapes before waves: the old parser sent section keys to the last
+    // wave seen, whatever section it was in
+    text += "[shape_0]\nsides=7\nthick=1\nadditive=1\nr=0.1\ng=0.2\nb=0.3\na=0.4\nrad=0.55\n"
+            "[shape_2]\nenabled=0\nsides=3\n"
+            "[wave_0]\nr=0.6\ng=0.7\nb=0.8\na=0.9\n"
+            "[wave_1]\nenabled=1\nb=0.25\nfDecay=0.5\n";
+
+    const bool agree = parsersAgree(text, preset);
+    check(agree, "Every key and [wave_N] / [shape_N] key parses as before", passed);
+    check(preset.name == "Every Key" && preset.nWaveMode == 3 && preset.bInvert && preset.fStretchY == 2.875f
+              && preset.shapes.size() == 3 && preset.shapes[0].sides == 7 && !preset.shapes[2].enabled
+              && preset.waves.size() == 2 && preset.waves[1].b == 0.25f && preset.fDecay == 0.5f,
+          "Keys reached their fields", passed);
+
+    bool allKnown = PresetParser::findPresetKey("name") >= 0 && PresetParser::findPresetKey("author") >= 0
+                 && PresetParser::findPresetKey("MILKDROP_PRESET_VERSION") >= 0;
+    for (const auto* keys : { &floatKeys, &intKeys, &boolKeys })
+    {
+        for (const auto& key : *keys)
+            allKnown = allKnown && PresetParser::findPresetKey(key) >= 0;
+    }
+    const auto numKeys = 3 + floatKeys.size() + intKeys.size() + boolKeys.size();
+    check(allKnown && PresetParser::getNumPresetKeys() == static_cast<int>(numKeys),
+          "Key table holds exactly the " + std::to_string(numKeys) + " keys", passed);
+
+    check(parsersAgree("MILKDROP_PRESET_VERSION=201\nname = Spaced Name \nauthor=\nfDecay\nfRating==2\n"
+                       "fdecay=0.1\nunknownKey=5\n", preset),
+          "Version line, spacing, empty values, unknown and misspelt keys", passed);
+
+    // Numbers as juce::String::getFloatValue() / getIntValue() read them
+    std::cout << std::endl << "Numbers:" << std::endl;
+
+    const std::vector<std::string> numbers = {
+        "0", "-0", "-0.5", "1e-3", "2.5E+2", ".25", "-.25", "7.", "+3", "+-3", "-+3", "- 3", "00012",
+        "3.99", "-3.99", "1.5abc", "1,5", "1.2.3", "abc", "", ".", "-", "e5", "1e", "5e+", "0x1A",
+        "1e50", "-1e50", "1e400", "1e-40", "1e-50", "nan", "inf", "-inf", "Infinity",
+        "2147483647", "2147483648", "-2147483649", "99999999999", "0.1000000000000000055511151231257827",
+        "3.4028235e38", "16777217"
+    };
+
+    std::vector<std::string> mismatches;
+    for (const auto& number : numbers)
+    {
+        // A float, an int and a bool key, at the top level and in a section
+        const std::string numberText = "fDecay=" + number + "\nnWaveMode=" + number + "\nbTexWrap=" + number
+                                     + "\n[shape_0]\nrad=" + number + "\nsides=" + number
+                                     + "\nadditive=" + number + "\n";
+
+        if (!parsersAgree(numberText, preset))
+            mismatches.push_back(number);
+    }
+
+    std::string mismatchList;
+    for (const auto& number : mismatches)
+        mismatchList += " \"" + number + "\"";
+
+    check(mismatches.empty(), mismatches.empty()
+              ? "All " + std::to_string(numbers.size()) + " numeric edge cases convert as before"
+              : "Numbers convert differently:" + mismatchList,
+          passed);
+
+    // The code block the old parser kept: the last section, without assignments
+    std::cout << std::endl << "Code blocks:" << std::endl;
+
+    const std::string shader = "[preset00]\nfDecay=0.9\n[comp_1]\nshader_body\n{\n"
+                               "    // Tint the frame\n    ret.xyz\n      tex2D(sampler_main, uv).xyz\n"
+                               "\n  \t  * float3(0.9, 1.0, 1.1)\n}\n";
+    check(parsersAgree(shader, preset) && preset.compShaderCode.find("ret.xyz\ntex2D") != std::string::npos,
+          "Multi-line block is trimmed and joined as before", passed);
+
+    std::string crlf;
+    for (char c : shader)
+        crlf += c == '\n' ? std::string("\r\n") : std::string(1, c);
+    check(parsersAgree(crlf, preset), "CRLF line endings give the same block", passed);
+
+    check(parsersAgree("[per_frame_1]\n[warp_1]\n\n[comp_1]\n", preset),
+          "Empty sections, and an empty last one", passed);
+
+    // What PresetParser keeps that the old parser dropped
+    PresetParser::parse("[per_frame_init_1]\nq1 = 0;\n[per_frame_1]\nzoom = zoom\n  * 1.01;\n// comment\n"
+                        "rot = 0.1;\n[per_pixel_1]\nzoom = zoom + rad * 0.1;\n[preset00]\nfDecay=0.5\n",
+                        preset);
+    check(preset.perFrameInitCode == "q1 = 0;" && preset.perFrameCode == "zoom = zoom\n* 1.01;\nrot = 0.1;"
+              && preset.perPixelCode == "zoom = zoom + rad * 0.1;" && preset.fDecay == 0.5f,
+          "Every code section is kept, assignment lines included", passed);
+
+    std::cout << std::endl << "============================================" << std::endl;
+    if (!passed)
+    {
+        std::cout << "  Some tests FAILED" << std::endl;
+        return 1;
+    }
+    std::cout << "  All tests completed!" << std::endl;
+    std::cout << "============================================" << std::endl;
+
+    return 0;
+}
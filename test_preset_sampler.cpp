@@ -0,0 +1,173 @@
+#include "Source/Presets/PresetSampler.h"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+/**
+ * @brief Checks PresetSampler's weighting, no-repeat window and speed
+ *
+ * Picks are drawn with a fixed seed, so the counts are reproducible.
+ */
+
+int main()
+{
+    std::cout << "============================================" << std::endl;
+    std::cout << "  FlarkViz Preset Sampler Test" << std::endl;
+    std::cout << "============================================" << std::endl << std::endl;
+
+    bool passed = true;
+    std::mt19937 engine(42);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    // Ratings 0-5 as weights: picks should follow them, rating 0 never
+    PresetSampler sampler;
+    sampler.assign({ 1.0, 2.0, 0.0, 5.0, 2.0 });
+
+    std::vector<int> counts(5, 0);
+    const int numPicks = 200000;
+    for (int i = 0; i < numPicks; ++i)
+        counts[static_cast<size_t>(sampler.pick(uniform(engine)))]++;
+
+    bool proportional = counts[2] == 0;
+    for (size_t i = 0; i < counts.size(); ++i)
+    {
+        const double expected = numPicks * sampler.getWeight(static_cast<int>(i)) / 10.0;
+        proportional = proportional && std::abs(counts[i] - expected) <= numPicks * 0.01;
+    }
+
+    if (proportional)
+        std::cout << "✅ Picks proportional to weight, weight 0 never picked" << std::endl;
+    else
+    {
+        std::cout << "❌ FAIL: counts " << counts[0] << " " << counts[1] << " " << counts[2]
+                  << " " << counts[3] << " " << counts[4] << std::endl;
+        passed = false;
+    }
+
+    // Updating one weight takes effect straight away
+    sampler.setWeight(3, 0.0);
+    sampler.setWeight(2, 4.0);
+    bool updated = sampler.getTotal() == 9.0;
+    for (int i = 0; i < 10000; ++i)
+        updated = updated && sampler.pick(uniform(engine)) != 3;
+
+    if (updated)
+        std::cout << "✅ Weight updates applied incrementally" << std::endl;
+    else
+    {
+        std::cout << "❌ FAIL: total " << sampler.getTotal() << " after updates" << std::endl;
+        passed = false;
+    }
+
+    // No-repeat window over a larger library
+    std::vector<double> weights(100, 3.0);
+    sampler.assign(weights);
+    sampler.setWindowSize(10);
+
+    std::vector<int> recent;
+    bool repeated = false;
+    for (int i = 0; i < 5000; ++i)
+    {
+        const int index = sampler.pick(uniform(engine));
+        for (int shown : recent)
+            repeated = repeated || shown == index;
+
+        sampler.markShown(index);
+        recent.push_back(index);
+        if (recent.size() > 10)
+            recent.erase(recent.begin());
+    }
+
+    if (!repeated && sampler.getRecent() == recent)
+        std::cout << "✅ No repeats within the last 10 shown" << std::endl;
+    else
+    {
+        std::cout << "❌ FAIL: a recently shown preset was picked again" << std::endl;
+        passed = false;
+    }
+
+    // Shrinking the window keeps the newest entries and the ring stays in bounds
+    sampler.assign(weights);
+    sampler.setWindowSize(10);
+    for (int i = 0; i < 17; ++i)
+        sampler.markShown(i);
+
+    sampler.setWindowSize(5);
+    bool shrunk = sampler.getRecent() == std::vector<int>{ 12, 13, 14, 15, 16 };
+
+    for (int i = 50; i < 60; ++i)
+        sampler.markShown(i);
+
+    shrunk = shrunk && sampler.getRecent() == std::vector<int>{ 55, 56, 57, 58, 59 }
+             && sampler.getTotal() == 95 * 3.0;
+    for (int i = 0; i < sampler.size(); ++i)
+        shrunk = shrunk && sampler.isRecent(i) == (i >= 55 && i < 60);
+
+    if (shrunk)
+        std::cout << "✅ Shrunk window keeps the newest presets" << std::endl;
+    else
+    {
+        std::cout << "❌ FAIL: shrunk window holds the wrong presets" << std::endl;
+        passed = false;
+    }
+
+    // A small library keeps at least half of its presets pickable
+    sampler.assign({ 1.0, 1.0, 1.0, 1.0 });
+    for (int i = 0; i < 4; ++i)
+        sampler.markShown(i);
+
+    if (sampler.getRecent().size() == 2 && sampler.pick(0.5) >= 0)
+        std::cout << "✅ Window limited to half of a small library" << std::endl;
+    else
+    {
+        std::cout << "❌ FAIL: window holds " << sampler.getRecent().size() << " of 4 presets" << std::endl;
+        passed = false;
+    }
+
+    // 100k presets: build once, then pick and update in O(log n)
+    std::cout << std::endl << "100k presets:" << std::endl;
+    std::vector<double> library(100000);
+    for (size_t i = 0; i < library.size(); ++i)
+        library[i] = static_cast<double>(i % 6);
+
+    auto start = std::chrono::steady_clock::now();
+    sampler.assign(library);
+    sampler.setWindowSize(50);
+    const double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    const int numOperations = 100000;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < numOperations; ++i)
+    {
+        const int index = sampler.pick(uniform(engine));
+        sampler.markShown(index);
+        sampler.setWeight(i, static_cast<double>((i + 1) % 6));
+    }
+    const double operationNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()
+                             / numOperations;
+
+    std::cout << "  build " << std::fixed << std::setprecision(2) << buildMs << " ms, pick + update "
+              << std::setprecision(0) << operationNs << " ns" << std::endl;
+
+    if (operationNs < 20000.0)
+        std::cout << "✅ Picks stay fast at 100k presets" << std::endl;
+    else
+    {
+        std::cout << "❌ FAIL: " << operationNs << " ns per pick" << std::endl;
+        passed = false;
+    }
+
+    std::cout << std::endl << "============================================" << std::endl;
+    if (!passed)
+    {
+        std::cout << "  Some tests FAILED" << std::endl;
+        return 1;
+    }
+    std::cout << "  All tests completed!" << std::endl;
+    std::cout << "============================================" << std::endl;
+
+    return 0;
+}
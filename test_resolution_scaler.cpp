@@ -0,0 +1,103 @@
+#include "Source/Rendering/ResolutionScaler.h"
+#include <iostream>
+#include <iomanip>
+
+/**
+ * @brief Drives ResolutionScaler with synthetic frame times
+ *
+ * Frame cost is modelled as proportional to the number of pixels rendered,
+ * which is how the warp and composite passes behave when fill-rate bound.
+ */
+
+static double simulatedFrameMs(double fullResMs, float scale)
+{
+    return fullResMs * scale * scale;
+}
+
+int main()
+{
+    std::cout << "============================================" << std::endl;
+    std::cout << "  FlarkViz Resolution Scaler Test" << std::endl;
+    std::cout << "============================================" << std::endl << std::endl;
+
+    bool passed = true;
+
+    ResolutionScaler scaler;
+    int changes = 0;
+    scaler.onScaleChanged = [&changes](const ResolutionScaler::Decision& d)
+    {
+        std::cout << "  frame " << std::setw(4) << d.frame
+                  << ": scale " << d.oldScale << " -> " << d.newScale
+                  << " (avg " << std::fixed << std::setprecision(2) << d.averageFrameMs
+                  << " ms, budget " << d.targetFrameMs << " ms)" << std::endl;
+        changes++;
+    };
+
+    // Heavy preset: 30 ms at full resolution against a 16.7 ms budget
+    std::cout << "Overloaded (30 ms at full res):" << std::endl;
+    for (int i = 0; i < 600; ++i)
+        scaler.addFrameTime(simulatedFrameMs(30.0, scaler.getScale()));
+
+    double loadedMs = simulatedFrameMs(30.0, scaler.getScale());
+    if (scaler.getScale() < 1.0f && loadedMs <= scaler.getSettings().targetFrameMs)
+        std::cout << "✅ Scaled down to " << scaler.getScale() << " (" << loadedMs << " ms)" << std::endl;
+    else
+    {
+        std::cout << "❌ FAIL: scale " << scaler.getScale() << " still costs " << loadedMs << " ms" << std::endl;
+        passed = false;
+    }
+
+    // Stable load should not cause oscillation
+    int changesBefore = changes;
+    for (int i = 0; i < 600; ++i)
+        scaler.addFrameTime(simulatedFrameMs(30.0, scaler.getScale()));
+
+    if (changes == changesBefore)
+        std::cout << "✅ Stable under constant load (no oscillation)" << std::endl;
+    else
+    {
+        std::cout << "❌ FAIL: " << (changes - changesBefore) << " changes under constant load" << std::endl;
+        passed = false;
+    }
+
+    // Light preset: scale should recover to full resolution
+    std::cout << std::endl << "Light load (5 ms at full res):" << std::endl;
+    for (int i = 0; i < 2000; ++i)
+        scaler.addFrameTime(simulatedFrameMs(5.0, scaler.getScale()));
+
+    if (scaler.getScale() == scaler.getSettings().maxScale)
+        std::cout << "✅ Recovered to full resolution" << std::endl;
+    else
+    {
+        std::cout << "❌ FAIL: stuck at scale " << scaler.getScale() << std::endl;
+        passed = false;
+    }
+
+    // Brief spikes must not trigger a change
+    changesBefore = changes;
+    for (int i = 0; i < 300; ++i)
+        scaler.addFrameTime(i % 50 == 0 ? 40.0 : 5.0);
+
+    if (changes == changesBefore)
+        std::cout << "✅ Ignored isolated spikes" << std::endl;
+    else
+    {
+        std::cout << "❌ FAIL: reacted to isolated spikes" << std::endl;
+        passed = false;
+    }
+
+    auto stats = scaler.getStats();
+    std::cout << std::endl << "Stats: " << stats.numScaleDowns << " down, "
+              << stats.numScaleUps << " up, " << stats.framesMeasured << " frames" << std::endl;
+
+    std::cout << std::endl << "============================================" << std::endl;
+    if (!passed)
+    {
+        std::cout << "  Some tests FAILED" << std::endl;
+        return 1;
+    }
+    std::cout << "  All tests completed!" << std::endl;
+    std::cout << "============================================" << std::endl;
+
+    return 0;
+}